@@ -0,0 +1,121 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// unix
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Shared helpers for the benchmarks. The benchmarks only use the public SDK api so
+// they can be built against an installed SDK as well.
+
+namespace bench {
+
+// generates a config with `num_groups` maps of `leaves_per_group` integer leaves
+// ("bench.group_<i>.leaf_<j>" = i * leaves_per_group + j) along with a schema for it
+// and returns the paths to the (schema, instance) files
+inline std::pair<std::filesystem::path, std::filesystem::path> generate_config(
+    const std::filesystem::path& dir,
+    size_t num_groups,
+    size_t leaves_per_group
+) {
+    std::filesystem::create_directories(dir);
+    std::filesystem::path schema_path = dir / "bench-schema.json";
+    std::filesystem::path instance_path = dir / "bench-instance.json";
+
+    std::ofstream schema(schema_path);
+    schema << "{\"$miru_config_type_slug\": \"bench\", \"type\": \"object\"}";
+
+    std::ofstream instance(instance_path);
+    instance << "{";
+    for (size_t i = 0; i < num_groups; i++) {
+        instance << (i == 0 ? "" : ",") << "\"group_" << i << "\": {";
+        for (size_t j = 0; j < leaves_per_group; j++) {
+            instance << (j == 0 ? "" : ",") << "\"leaf_" << j << "\": "
+                     << i * leaves_per_group + j;
+        }
+        instance << "}";
+    }
+    instance << "}";
+    return {schema_path, instance_path};
+}
+
+// generates the same config as generate_config() as (block style) yaml
+inline std::pair<std::filesystem::path, std::filesystem::path> generate_yaml_config(
+    const std::filesystem::path& dir,
+    size_t num_groups,
+    size_t leaves_per_group
+) {
+    std::filesystem::create_directories(dir);
+    std::filesystem::path schema_path = dir / "bench-schema.yaml";
+    std::filesystem::path instance_path = dir / "bench-instance.yaml";
+
+    std::ofstream schema(schema_path);
+    schema << "$miru_config_type_slug: bench\ntype: object\n";
+
+    std::ofstream instance(instance_path);
+    for (size_t i = 0; i < num_groups; i++) {
+        instance << "group_" << i << ":\n";
+        for (size_t j = 0; j < leaves_per_group; j++) {
+            instance << "  leaf_" << j << ": " << i * leaves_per_group + j << "\n";
+        }
+    }
+    return {schema_path, instance_path};
+}
+
+// runs `func` `iterations` times and returns the average time per call in nanoseconds
+template <typename FuncT>
+double time_per_op_ns(size_t iterations, FuncT&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        func(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+inline void report(const std::string& name, double ns_per_op) {
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(14)
+              << std::fixed << std::setprecision(1) << ns_per_op << " ns/op"
+              << std::endl;
+}
+
+// runs `func` in a forked child and returns the peak resident set size of the child in
+// kilobytes (or -1 if the child failed). The child starts with the memory of the
+// parent so compare against the peak of a child which does nothing.
+template <typename FuncT>
+long peak_rss_kb(FuncT&& func) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        func();
+        _exit(0);
+    }
+    int status = 0;
+    struct rusage usage {};
+    if (pid < 0 || wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+    return usage.ru_maxrss;
+}
+
+inline void report_rss(const std::string& name, long peak_rss_kb) {
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(14)
+              << peak_rss_kb << " KB peak rss" << std::endl;
+}
+
+// prevents the compiler from optimizing away the benchmarked work
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+}  // namespace bench
@@ -0,0 +1,55 @@
+// std
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// miru
+#include <miru/configs/instance.hpp>
+#include <miru/query/parallel.hpp>
+#include <miru/query/query.hpp>
+
+// benchmarks
+#include <bench.hpp>
+
+// Compares the serial traversal against the parallel traversal for a wide config (a
+// root map with many children) at different pool sizes.
+
+int main() {
+    const size_t num_groups = 20000;
+    const size_t leaves_per_group = 10;
+    const size_t iterations = 20;
+
+    std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "miru-parallel-query-benchmark";
+    auto [schema_path, instance_path] =
+        bench::generate_config(dir, num_groups, leaves_per_group);
+    miru::config::ConfigInstance config_instance =
+        miru::config::ConfigInstance::from_file(schema_path, instance_path);
+    const miru::params::Parameter& root = config_instance.root_parameter();
+    std::cout << "config: " << num_groups * leaves_per_group << " leaves" << std::endl;
+
+    // a prefix filter defeats the name index so every query is a full traversal
+    const miru::query::SearchParamFilters filters =
+        miru::query::SearchParamFiltersBuilder().with_prefix("bench.group_1").build();
+
+    bench::report("serial", bench::time_per_op_ns(iterations, [&](size_t) {
+                      bench::do_not_optimize(miru::query::get_param_refs(root, filters));
+                  }));
+
+    for (size_t num_threads : {1, 2, 4, 8}) {
+        miru::parallel::ThreadPool pool(num_threads);
+        miru::query::ParallelQueryOptions options;
+        options.pool = &pool;
+        bench::report(
+            "parallel [" + std::to_string(num_threads) + " threads]",
+            bench::time_per_op_ns(iterations, [&](size_t) {
+                bench::do_not_optimize(
+                    miru::query::get_param_refs(root, filters, options)
+                );
+            })
+        );
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,94 @@
+// std
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// miru
+#include <miru/configs/instance.hpp>
+#include <miru/query/path.hpp>
+#include <miru/query/query.hpp>
+
+// benchmarks
+#include <bench.hpp>
+
+// Compares looking up a parameter by name with a filter based query against looking it
+// up with a runtime ParamPath and a compile time _mp literal.
+
+using namespace miru::query::literals;
+
+int main() {
+    const size_t num_groups = 100;
+    const size_t leaves_per_group = 100;
+    const size_t iterations = 200;
+
+    std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "miru-param-path-benchmark";
+    auto [schema_path, instance_path] =
+        bench::generate_config(dir, num_groups, leaves_per_group);
+    miru::config::ConfigInstance config_instance =
+        miru::config::ConfigInstance::from_file(schema_path, instance_path);
+    std::cout << "config: " << num_groups * leaves_per_group << " leaves" << std::endl;
+
+    // warm up the name index so its construction isn't attributed to the first lookup
+    miru::query::has_param(config_instance, "bench"_mp);
+
+    const std::string hit_name = "bench.group_99.leaf_99";
+    const std::string miss_name = "bench.group_99.leaf_100";
+    const miru::query::ParamPath hit_path(hit_name);
+    const miru::query::ParamPath miss_path(miss_name);
+    // declared constexpr so the tokenizing and hashing is guaranteed to happen at
+    // compile time
+    constexpr miru::query::StaticParamPath hit_static = "bench.group_99.leaf_99"_mp;
+    constexpr miru::query::StaticParamPath miss_static = "bench.group_99.leaf_100"_mp;
+
+    // ---------------------------------- HITS ------------------------------------- //
+    bench::report(
+        "get_param(instance, std::string) [hit]",
+        bench::time_per_op_ns(iterations, [&](size_t) {
+            bench::do_not_optimize(miru::query::get_param(config_instance, hit_name));
+        })
+    );
+    bench::report(
+        "get_param(instance, ParamPath) [hit]",
+        bench::time_per_op_ns(iterations * 1000, [&](size_t) {
+            bench::do_not_optimize(miru::query::get_param(config_instance, hit_path));
+        })
+    );
+    bench::report(
+        "get_param(instance, _mp) [hit]",
+        bench::time_per_op_ns(iterations * 1000, [&](size_t) {
+            bench::do_not_optimize(miru::query::get_param(config_instance, hit_static));
+        })
+    );
+
+    // --------------------------------- MISSES ------------------------------------ //
+    bench::report(
+        "has_param(instance, std::string) [miss]",
+        bench::time_per_op_ns(iterations, [&](size_t) {
+            bench::do_not_optimize(miru::query::has_param(
+                config_instance,
+                miru::query::SearchParamFiltersBuilder()
+                    .with_param_name(miss_name)
+                    .build()
+            ));
+        })
+    );
+    bench::report(
+        "has_param(instance, ParamPath) [miss]",
+        bench::time_per_op_ns(iterations * 1000, [&](size_t) {
+            bench::do_not_optimize(miru::query::has_param(config_instance, miss_path));
+        })
+    );
+    bench::report(
+        "has_param(instance, _mp) [miss]",
+        bench::time_per_op_ns(iterations * 1000, [&](size_t) {
+            bench::do_not_optimize(
+                miru::query::has_param(config_instance, miss_static)
+            );
+        })
+    );
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
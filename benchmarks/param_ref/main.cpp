@@ -0,0 +1,63 @@
+// std
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// miru
+#include <miru/configs/instance.hpp>
+#include <miru/query/query.hpp>
+
+// benchmarks
+#include <bench.hpp>
+
+// Compares get_param, which copies the parameter (and for maps its entire subtree),
+// against get_param_ref, which returns a reference into the config instance.
+
+int main() {
+    const size_t num_groups = 100;
+    const size_t leaves_per_group = 100;
+    const size_t iterations = 200;
+
+    std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "miru-param-ref-benchmark";
+    auto [schema_path, instance_path] =
+        bench::generate_config(dir, num_groups, leaves_per_group);
+    miru::config::ConfigInstance config_instance =
+        miru::config::ConfigInstance::from_file(schema_path, instance_path);
+    std::cout << "config: " << num_groups * leaves_per_group << " leaves" << std::endl;
+
+    auto subtree = [](const std::string& name) {
+        return miru::query::SearchParamFiltersBuilder()
+            .with_param_name(name)
+            .with_leaves_only(false)
+            .build();
+    };
+    const miru::query::SearchParamFilters leaf = subtree("bench.group_0.leaf_0");
+    const miru::query::SearchParamFilters group = subtree("bench.group_0");
+    const miru::query::SearchParamFilters root = subtree("bench");
+
+    for (const auto& [label, filters] :
+         {std::make_pair("leaf", leaf),
+          std::make_pair("map (100 leaves)", group),
+          std::make_pair("root (10000 leaves)", root)}) {
+        bench::report(
+            std::string("get_param [") + label + "]",
+            bench::time_per_op_ns(iterations, [&](size_t) {
+                bench::do_not_optimize(
+                    miru::query::get_param(config_instance, filters)
+                );
+            })
+        );
+        bench::report(
+            std::string("get_param_ref [") + label + "]",
+            bench::time_per_op_ns(iterations, [&](size_t) {
+                bench::do_not_optimize(
+                    miru::query::get_param_ref(config_instance, filters)
+                );
+            })
+        );
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// std
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+// miru
+#include <miru/configs/instance.hpp>
+
+// benchmarks
+#include <bench.hpp>
+
+// Measures the time and peak memory of loading a multi megabyte yaml config instance.
+// Reading the file into a string is reported as a lower bound for both.
+
+int main() {
+    const size_t num_groups = 500;
+    const size_t leaves_per_group = 500;
+    const size_t iterations = 3;
+
+    std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "miru-yaml-parse-benchmark";
+    auto [schema_path, instance_path] =
+        bench::generate_yaml_config(dir, num_groups, leaves_per_group);
+    std::cout << "config: " << num_groups * leaves_per_group << " leaves, "
+              << std::filesystem::file_size(instance_path) / 1024 << " KB" << std::endl;
+
+    auto read_file = [&] {
+        std::ifstream stream(instance_path);
+        std::string contents(
+            (std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>()
+        );
+        bench::do_not_optimize(contents);
+    };
+    auto load_config = [&] {
+        bench::do_not_optimize(
+            miru::config::ConfigInstance::from_file(schema_path, instance_path)
+        );
+    };
+
+    // the children start with the memory of the parent so peak memory is measured
+    // before the timed runs grow the heap of the parent
+    bench::report_rss("baseline", bench::peak_rss_kb([] {}));
+    bench::report_rss("read file", bench::peak_rss_kb(read_file));
+    bench::report_rss("ConfigInstance::from_file", bench::peak_rss_kb(load_config));
+
+    bench::report(
+        "read file", bench::time_per_op_ns(iterations, [&](size_t) { read_file(); })
+    );
+    bench::report(
+        "ConfigInstance::from_file",
+        bench::time_per_op_ns(iterations, [&](size_t) { load_config(); })
+    );
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -3,10 +3,24 @@
 // std
 #include <chrono>
 #include <filesystem>
+#include <functional>
 #include <optional>
+#include <string>
+#include <vector>
 
 // internal
+#include <miru/configs/load_cache.hpp>
+#include <miru/params/parallel.hpp>
 #include <miru/params/parameter.hpp>
+#include <miru/query/cache.hpp>
+
+namespace miru::params {
+class LazyParameterTree;
+}  // namespace miru::params
+
+namespace miru::query {
+class ParamIndex;
+}  // namespace miru::query
 
 namespace miru::config {
 
@@ -16,31 +30,138 @@ enum class ConfigInstanceSource {
   FileSystem,
 };
 
+struct FromFileOptions {
+ public:
+  FromFileOptions() : lazy(false), parallel(), use_load_cache(false) {}
+
+  // Only index the structure of a json config instance and build its parameters the
+  // first time they are queried by name (see miru::params::LazyParameterTree). Yaml
+  // config instances are always loaded entirely.
+  bool lazy;
+
+  // Build the parameter tree concurrently (see miru::params::ParallelParseOptions).
+  // The file is parsed into a document before the tree is built so this only pays off
+  // for large config instances on multi-core machines. Ignored when loading lazily.
+  std::optional<miru::params::ParallelParseOptions> parallel;
+
+  // Reuse the config type slug of the schema file and the parameter tree of the
+  // config instance file from the process wide load cache while the files are
+  // unchanged, so loading the same files again only stats them (see
+  // miru::config::load_cache_stats()). The parameter tree is then shared with every
+  // other config instance loaded from the same file.
+  bool use_load_cache;
+};
+
+// how config instances persisted in FromAgentOptions::cache_dir are used
+enum class AgentCachePolicy {
+  // only when the agent can't be reached (before the default instance file)
+  Fallback,
+  // immediately, without waiting for the agent. The config instance is then fetched
+  // from the agent in the background, which updates the cache for the next load (and
+  // calls FromAgentOptions::on_refresh).
+  CachedThenRefresh,
+};
+
+class ConfigInstance;
+
 struct FromAgentOptions {
  public:
   FromAgentOptions()
     : num_retries(3),  // try to load from the agent 3 times
       retry_delay(std::chrono::milliseconds(500)),  // wait 500ms between retries
-      default_instance_file_path() {}
+      default_instance_file_path(),
+      lazy(false),
+      binary_encodings(true),
+      cache_dir(),
+      cache_policy(AgentCachePolicy::Fallback),
+      on_refresh(),
+      use_load_cache(false) {}
 
   uint32_t num_retries;
   std::chrono::milliseconds retry_delay;
   std::optional<std::filesystem::path> default_instance_file_path;
+  // see FromFileOptions::lazy
+  bool lazy;
+  // Ask the agent for the config instance as MessagePack / CBOR (falling back to json
+  // if the agent doesn't support them). Lazily loaded config instances are always
+  // requested as json.
+  bool binary_encodings;
+
+  // Persist every config instance fetched from the agent as a snapshot in this
+  // directory (keyed by the config type slug and a digest of the schema file) so it
+  // can be loaded without the agent. Failing to persist a config instance doesn't fail
+  // the load. Persisting a lazily loaded config instance builds its entire tree while
+  // lazily loaded cached config instances are mapped (see FromSnapshotOptions::mapped).
+  std::optional<std::filesystem::path> cache_dir;
+  AgentCachePolicy cache_policy;
+  // Called (on a background thread) with the config instance fetched from the agent
+  // after a cached config instance was served (see AgentCachePolicy::CachedThenRefresh)
+  std::function<void(ConfigInstance refreshed)> on_refresh;
+
+  // Reuse the config type slug and schema digest of the schema file from the process
+  // wide load cache while the file is unchanged (see FromFileOptions::use_load_cache),
+  // which saves reading the schema and asking the agent to hash it. The config
+  // instance itself is always fetched since it can be deployed again on the agent
+  // without any local file changing.
+  bool use_load_cache;
+};
+
+struct FromSnapshotOptions {
+ public:
+  FromSnapshotOptions() : mapped(false), verify_checksum(true) {}
+
+  // Memory map the snapshot instead of reading it (see miru::config::MappedSnapshot).
+  // Parameters are then built the first time they are queried by name and the pages
+  // of the snapshot are shared with every other process mapping it.
+  bool mapped;
+
+  // Verify the checksum of a mapped snapshot when it's opened (which reads the entire
+  // file). Snapshots which are read are always verified.
+  bool verify_checksum;
+};
+
+struct FromDirectoryOptions {
+ public:
+  FromDirectoryOptions() : file_options(), pool(nullptr), max_concurrency(0) {}
+
+  // how each config instance is loaded (see ConfigInstance::from_file())
+  FromFileOptions file_options;
+
+  // the config instances are loaded on this pool (defaults to
+  // miru::parallel::ThreadPool::shared() if null)
+  miru::parallel::ThreadPool* pool;
+
+  // the maximum number of config instances loaded at once (defaults to the number of
+  // threads of the pool if 0)
+  size_t max_concurrency;
 };
 
+// a schema or config instance file of a directory which couldn't be loaded
+struct FromDirectoryError {
+  std::optional<std::filesystem::path> schema_file;
+  std::optional<std::filesystem::path> instance_file;
+  std::string message;
+};
+
+struct FromDirectoryResult;
+
 // forward declare the implementation
 class ConfigInstanceImpl;
+class MappedSnapshot;
 
 class ConfigInstance {
  public:
   ConfigInstance(std::unique_ptr<ConfigInstanceImpl> impl);
+  ConfigInstance(ConfigInstance&& other) noexcept;
+  ConfigInstance& operator=(ConfigInstance&& other) noexcept;
   ~ConfigInstance();
 
   // Initialize the config instance from a file system source. The config instance and
   // its file will be read from the file system.
   static ConfigInstance from_file(
     const std::filesystem::path& schema_file_path,
-    const std::filesystem::path& instance_file_path
+    const std::filesystem::path& instance_file_path,
+    const FromFileOptions& options = FromFileOptions()
   );
 
   // Initialize the config instance from the on-device agent. The config instance will
@@ -50,14 +171,96 @@ class ConfigInstance {
     const FromAgentOptions& options = FromAgentOptions()
   );
 
+  // Load the config instance of every schema file in the schema directory
+  // concurrently. Schema files are paired with the config instance file with the same
+  // name in the instance directory, or otherwise with the only config instance file
+  // with the same stem (so 'motion-control.yaml' pairs with 'motion-control.json').
+  // Files which can't be paired or loaded are reported in the result instead of
+  // failing the whole load, files of unsupported types are ignored. Throws if either
+  // directory doesn't exist.
+  static FromDirectoryResult from_directory(
+    const std::filesystem::path& schema_dir_path,
+    const std::filesystem::path& instance_dir_path,
+    const FromDirectoryOptions& options = FromDirectoryOptions()
+  );
+
+  // Load a config instance previously saved with save_snapshot(). Snapshots load
+  // without parsing json / yaml or reading the schema file. Throws if the file isn't a
+  // valid snapshot (corrupted, truncated or written by another version).
+  static ConfigInstance from_snapshot(
+    const std::filesystem::path& snapshot_path,
+    const FromSnapshotOptions& options = FromSnapshotOptions()
+  );
+
+  // Save this config instance as a versioned, checksummed binary snapshot. The
+  // snapshot is written to a temporary file first and then renamed over the path.
+  void save_snapshot(const std::filesystem::path& snapshot_path) const;
+
   const ConfigInstanceSource get_source() const;
+
+  // Whether this config instance was loaded from the agent cache (see
+  // FromAgentOptions::cache_dir) rather than fetched from the agent.
+  bool from_agent_cache() const;
+
+  // Block until the background refresh of a config instance served from the agent
+  // cache finishes, rethrowing its error if it failed (see
+  // AgentCachePolicy::CachedThenRefresh). Returns immediately for other config
+  // instances (and when called from FromAgentOptions::on_refresh). The last copy of
+  // such a config instance stops the refresh between its attempts when it's destroyed
+  // and waits for the attempt in progress, unless it's destroyed by on_refresh (e.g.
+  // when replaced by the refreshed config instance).
+  void wait_for_refresh() const;
+  // for lazily loaded config instances the entire parameter tree is built the first
+  // time the root parameter (or the name index) is requested
   const miru::params::Parameter& root_parameter() const;
+  // the parameter tree is immutable and shared with anything that needs to outlive
+  // the config instance (name indexes, handles, shared parameters)
+  std::shared_ptr<const miru::params::Parameter> shared_root_parameter() const;
+  // Return a pointer to the given parameter of this config instance which shares
+  // ownership of the config instance's parameters.
+  std::shared_ptr<const miru::params::Parameter> shared_parameter(
+    const miru::params::Parameter& parameter
+  ) const;
+
+  // The lazily built parameters of this config instance (see FromFileOptions::lazy)
+  // or nullptr if the config instance was loaded entirely. Queries by parameter name
+  // are resolved against it without building the rest of the tree (and return their
+  // results in tree order, like queries against the entire tree).
+  std::shared_ptr<const miru::params::LazyParameterTree> lazy_parameters() const;
+
+  // The mapped snapshot of this config instance (see FromSnapshotOptions::mapped) or
+  // nullptr if it isn't backed by one. Its nodes can be read in place and queries by
+  // parameter name are resolved against it without building the rest of the tree.
+  std::shared_ptr<const MappedSnapshot> mapped_snapshot() const;
+
+  // The name index over the parameter tree of this config instance. It is built the
+  // first time it is requested and shares ownership of the parameter tree.
+  std::shared_ptr<const miru::query::ParamIndex> param_index() const;
+
+  // Cache the results of queries against this config instance. Since the config
+  // instance is immutable, cached results are only invalidated when the config
+  // instance itself is replaced (or the cache is disabled).
+  void enable_query_cache(
+    size_t capacity = miru::query::QueryCache::DEFAULT_CAPACITY
+  );
+  void disable_query_cache();
+  miru::query::QueryCacheStats query_cache_stats() const;
+
+  // returns nullptr if the query cache is disabled
+  miru::query::QueryCache* query_cache() const { return query_cache_.get(); }
 
  private:
   std::unique_ptr<ConfigInstanceImpl> impl_;
+  std::unique_ptr<miru::query::QueryCache> query_cache_;
 
   // friends
   friend class ConfigImpl;
 };
 
+struct FromDirectoryResult {
+  // in the order of the names of their schema files
+  std::vector<ConfigInstance> config_instances;
+  std::vector<FromDirectoryError> errors;
+};
+
 }  // namespace miru::config
\ No newline at end of file
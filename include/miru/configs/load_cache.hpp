@@ -0,0 +1,37 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace miru::config {
+
+// ================================== LOAD CACHE =================================== //
+struct LoadCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // the number of cached schemas and config instances
+  size_t schemas = 0;
+  size_t instances = 0;
+};
+
+std::string to_string(const LoadCacheStats& stats);
+
+/// The process wide cache of what loading config instances reads from the file system
+/// (see FromFileOptions::use_load_cache and FromAgentOptions::use_load_cache).
+/**
+ * Files are identified by their path, device, inode, modification time and size so
+ * an entry is only reused while its file is unchanged and looking one up costs a
+ * stat. Cached schemas hold their config type slug, a hash of their contents and the
+ * schema digest once the agent computed it. Cached config instances hold their
+ * (immutable) parameter tree, which is shared with every config instance loaded from
+ * them. There is one entry per file so the cache only grows with the number of files
+ * loaded. The cache is safe to use from multiple threads.
+ */
+LoadCacheStats load_cache_stats();
+
+/// Drop every entry of the load cache (config instances loaded from it are unaffected).
+void clear_load_cache();
+
+}  // namespace miru::config
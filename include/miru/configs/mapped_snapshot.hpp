@@ -0,0 +1,181 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// internal
+#include <miru/configs/instance.hpp>
+#include <miru/params/parameter.hpp>
+#include <miru/params/type.hpp>
+
+namespace miru::config {
+
+class SnapshotDecoder;
+struct SnapshotNode;
+struct SnapshotString;
+
+// ================================= ARRAY VIEWS =================================== //
+/// A read-only view of the elements of an array in a mapped snapshot.
+template <typename T>
+class ArrayView {
+ public:
+  ArrayView(const T* data, size_t size) : data_(data), size_(size) {}
+
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+  const T& operator[](size_t i) const { return data_[i]; }
+
+ private:
+  const T* data_;
+  size_t size_;
+};
+
+/// A read-only view of the strings of a string (or scalar) array in a mapped snapshot.
+class StringArrayView {
+ public:
+  StringArrayView(
+    const SnapshotDecoder* decoder,
+    const SnapshotString* refs,
+    size_t size
+  )
+    : decoder_(decoder), refs_(refs), size_(size) {}
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  std::string_view operator[](size_t i) const;
+
+ private:
+  const SnapshotDecoder* decoder_;
+  const SnapshotString* refs_;
+  size_t size_;
+};
+
+// ================================== NODE VIEWS =================================== //
+/// A read-only view of a parameter in a mapped snapshot.
+/**
+ * Values are read straight from the mapping: strings and arrays are views into it and
+ * remain valid for the lifetime of the snapshot. Reading a value as the wrong type
+ * throws miru::params::details::InvalidParameterTypeError.
+ */
+class SnapshotNodeView {
+ public:
+  SnapshotNodeView(const SnapshotDecoder* decoder, uint64_t index)
+    : decoder_(decoder), index_(index) {}
+
+  /// The index of the node in the node table of the snapshot.
+  uint64_t index() const { return index_; }
+  miru::params::ParameterType type() const;
+  std::string_view key() const;
+
+  bool as_bool() const;
+  int64_t as_int() const;
+  double as_double() const;
+  // strings and scalars
+  std::string_view as_string() const;
+  // the elements are 1 (true) or 0 (false)
+  ArrayView<uint8_t> as_bool_array() const;
+  ArrayView<int64_t> as_integer_array() const;
+  ArrayView<double> as_double_array() const;
+  // string and scalar arrays
+  StringArrayView as_string_array() const;
+
+  /// The number of children of a map, map array or nested array (0 otherwise).
+  size_t num_children() const;
+  /// The i-th child of a map (in key order), map array or nested array.
+  SnapshotNodeView child(size_t i) const;
+  /// The child with the given key (or array index) if there is one.
+  std::optional<SnapshotNodeView> find_child(std::string_view key) const;
+
+ private:
+  SnapshotNode node() const;
+  [[noreturn]] void throw_invalid_type(miru::params::ParameterType expected) const;
+
+  const SnapshotDecoder* decoder_;
+  uint64_t index_;
+};
+
+// =============================== MAPPED SNAPSHOT ================================= //
+/// A config instance snapshot (see ConfigInstance::save_snapshot()) which is memory
+/// mapped rather than read.
+/**
+ * Opening the snapshot only validates its header, its checksum (unless disabled) and
+ * the structure of its node table. The pages of the snapshot are loaded on demand and
+ * shared between every process mapping the same file, so processes reading the same
+ * config don't each hold a private copy of it.
+ *
+ * Nodes are read in place through views (see root_node() / find_node()). Parameters
+ * are built the first time they are looked up by name (like
+ * miru::params::LazyParameterTree) and remain valid for the lifetime of the snapshot.
+ *
+ * The snapshot file must not be modified in place while it is mapped (snapshots are
+ * always written to a temporary file which is renamed over the previous snapshot so
+ * saving a snapshot again is safe).
+ */
+class MappedSnapshot {
+ public:
+  explicit MappedSnapshot(
+    const std::filesystem::path& path,
+    bool verify_checksum = true
+  );
+  ~MappedSnapshot();
+
+  MappedSnapshot(const MappedSnapshot&) = delete;
+  MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+  const std::filesystem::path& path() const { return path_; }
+  size_t size() const { return size_; }
+  size_t num_nodes() const;
+
+  // metadata
+  std::string_view config_type_slug() const;
+  ConfigInstanceSource source() const;
+  std::string_view config_schema_file() const;
+  std::optional<std::string_view> config_schema_digest() const;
+  std::optional<std::string_view> config_instance_file() const;
+
+  /// The view of the root node (named after the config type slug).
+  SnapshotNodeView root_node() const;
+  /// The view of the node with the given parameter name if there is one.
+  std::optional<SnapshotNodeView> find_node(std::string_view name) const;
+
+  /// The number of parameters which have been looked up (and so built).
+  size_t num_materialized() const;
+
+  /// Return the parameter with the given name or nullptr if the snapshot has no such
+  /// parameter. The parameter is built on the first lookup.
+  const miru::params::Parameter* find(std::string_view name) const;
+
+  /// Return the root parameter, building the entire tree on the first call.
+  const miru::params::Parameter& root() const;
+
+ private:
+  struct Slot {
+    uint64_t index;
+    std::once_flag once;
+    std::optional<miru::params::Parameter> parameter;
+  };
+
+  const miru::params::Parameter& materialize(std::string_view name, uint64_t index)
+    const;
+
+  std::filesystem::path path_;
+  const char* data_;
+  size_t size_;
+  std::unique_ptr<SnapshotDecoder> decoder_;
+
+  mutable std::mutex mutex_;
+  mutable std::unordered_map<std::string, std::unique_ptr<Slot>> slots_;
+};
+
+}  // namespace miru::config
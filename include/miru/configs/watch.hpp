@@ -0,0 +1,96 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+// internal
+#include <miru/configs/instance.hpp>
+
+namespace miru::config {
+
+// ===================================== WATCH ===================================== //
+struct WatchOptions {
+ public:
+  WatchOptions()
+    : file_options(),
+      debounce(std::chrono::milliseconds(100)),  // reload 100ms after the last write
+      on_error() {}
+
+  // how the config instance is (re)loaded (see ConfigInstance::from_file())
+  FromFileOptions file_options;
+
+  // The files are only reloaded once they haven't changed for this long so a burst
+  // of writes (or an editor saving through a temporary file) causes a single reload.
+  std::chrono::milliseconds debounce;
+
+  // Called (on the watch thread) with the error of every reload which failed, e.g.
+  // because a file was saved while invalid. The current config instance is kept.
+  std::function<void(const std::string& error)> on_error;
+};
+
+class ConfigWatcherImpl;
+
+/// A config instance loaded from the file system which is reloaded when its files
+/// change.
+/**
+ * The directories of the schema and config instance files are watched with inotify
+ * (rather than the files themselves) so editors which save by writing a temporary
+ * file and renaming it over the original are followed. Changes are debounced (see
+ * WatchOptions::debounce) and the files are reparsed on a dedicated watch thread.
+ * The reloaded config instance then replaces the current one in a single step:
+ * current() returns either the old or the new config instance, never a mix of both,
+ * and config instances already returned stay valid for as long as they're held.
+ * Subscribers are called on the watch thread after every successful reload.
+ *
+ * Paths are watched as given, so changes to the target of a symlink are only seen
+ * if the target is in the same directory.
+ */
+class ConfigWatcher {
+ public:
+  using Subscriber = std::function<void(std::shared_ptr<const ConfigInstance>)>;
+  using SubscriptionId = uint64_t;
+
+  ConfigWatcher(ConfigWatcher&& other) noexcept;
+  ConfigWatcher& operator=(ConfigWatcher&& other) noexcept;
+  // stops watching (waiting for a reload in progress to finish), which means a
+  // subscriber mustn't destroy its watcher
+  ~ConfigWatcher();
+
+  // Load the config instance like ConfigInstance::from_file() and start watching its
+  // files. Throws if the initial load fails or the files can't be watched.
+  static ConfigWatcher from_file(
+    const std::filesystem::path& schema_file_path,
+    const std::filesystem::path& instance_file_path,
+    const WatchOptions& options = WatchOptions()
+  );
+
+  std::shared_ptr<const ConfigInstance> current() const;
+
+  // the number of successful reloads (0 for the initially loaded config instance)
+  uint64_t version() const;
+
+  // Block until at least the given number of reloads succeeded, returning false if the
+  // timeout expired first.
+  bool wait_for_version(uint64_t version, std::chrono::milliseconds timeout) const;
+
+  // the error of the last reload if it failed (cleared by the next successful one)
+  std::optional<std::string> last_error() const;
+
+  // Call the subscriber with every reloaded config instance. A subscriber which is
+  // being called while it's unsubscribed finishes its call.
+  SubscriptionId subscribe(Subscriber subscriber);
+  void unsubscribe(SubscriptionId id);
+
+ private:
+  explicit ConfigWatcher(std::unique_ptr<ConfigWatcherImpl> impl);
+
+  std::unique_ptr<ConfigWatcherImpl> impl_;
+};
+
+}  // namespace miru::config
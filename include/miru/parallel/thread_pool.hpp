@@ -0,0 +1,107 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace miru::parallel {
+
+// ================================= THREAD POOL =================================== //
+/// A work stealing thread pool.
+/**
+ * Each worker owns a task queue. Tasks submitted from a worker go to the back of its
+ * own queue and are run last in, first out (which keeps recursive splits cache
+ * friendly) while idle workers steal from the front of the other queues. Tasks
+ * submitted from outside the pool are distributed round robin.
+ *
+ * Most users don't need to create a pool; the parallel APIs default to shared().
+ */
+class ThreadPool {
+ public:
+  // defaults to the number of hardware threads (at least one)
+  explicit ThreadPool(size_t num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t num_threads() const { return threads_.size(); }
+
+  void submit(std::function<void()> task);
+
+  /// Run one pending task on the calling thread, returning false if there were none.
+  /// Used by threads waiting on tasks to help instead of blocking.
+  bool try_run_pending_task();
+
+  /// The process wide pool, created on first use.
+  static ThreadPool& shared();
+
+ private:
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  // Block a thread waiting on a task group until there is a task to run or the group
+  // is done (see notify_waiters()).
+  void wait_for_work(const std::function<bool()>& done);
+  // wakes the threads blocked in wait_for_work()
+  void notify_waiters();
+
+  bool pop_task(size_t queue_index, std::function<void()>& task);
+  bool steal_task(size_t thief_index, std::function<void()>& task);
+  void worker_loop(size_t index);
+
+  std::vector<std::unique_ptr<TaskQueue>> queues_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> num_pending_;
+  std::atomic<size_t> next_queue_;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stop_;
+  // the threads waiting on a task group, woken by new tasks and finished groups
+  std::condition_variable waiters_;
+  size_t num_waiters_;
+
+  // friends
+  friend class TaskGroup;
+};
+
+// ================================== TASK GROUP =================================== //
+/// A set of tasks run on a thread pool which can be waited on as a whole.
+/**
+ * wait() runs pending tasks on the calling thread while the group's tasks finish so
+ * task groups can be nested (a task may create and wait on its own group) without
+ * exhausting the pool, and blocks while there is nothing to run. The first exception
+ * thrown by a task is rethrown by wait().
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool& pool) : pool_(pool), num_pending_(0), error_() {}
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  void run(std::function<void()> task);
+  void wait();
+
+ private:
+  void wait_for_tasks();
+
+  ThreadPool& pool_;
+  std::atomic<size_t> num_pending_;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+};
+
+}  // namespace miru::parallel
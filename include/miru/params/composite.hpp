@@ -3,6 +3,7 @@
 // std
 #include <cstddef>
 #include <string>
+#include <vector>
 
 // internal
 #include <miru/params/iterator.hpp>
@@ -16,6 +17,7 @@ class Parameter;
 class Map {
  public:
   Map(const std::vector<Parameter> &fields);
+  Map(std::vector<Parameter> &&fields);
 
   bool operator==(const Map &other) const;
   bool operator!=(const Map &other) const;
@@ -39,6 +41,7 @@ std::ostream &operator<<(std::ostream &os, const Map &map);
 class MapArray {
  public:
   MapArray(const std::vector<Parameter> &maps);
+  MapArray(std::vector<Parameter> &&maps);
   MapArray(const std::vector<Map> &maps);
 
   // Iterator access methods
@@ -63,6 +66,7 @@ std::ostream &operator<<(std::ostream &os, const MapArray &map_array);
 class NestedArray {
  public:
   NestedArray(const std::vector<Parameter> &items);
+  NestedArray(std::vector<Parameter> &&items);
   NestedArray(const std::vector<NestedArray> &items);
 
   // Iterator access methods
@@ -41,6 +41,14 @@ class ParameterIterator {
 
   bool operator!=(const ParameterIterator& other) const { return it_ != other.it_; }
 
+  // parameters are stored contiguously so iterators can be offset in constant time
+  ParameterIterator operator+(difference_type n) const {
+    return ParameterIterator(it_ + n);
+  }
+  difference_type operator-(const ParameterIterator& other) const {
+    return it_ - other.it_;
+  }
+
  private:
   std::vector<Parameter>::const_iterator it_;
 };
@@ -55,6 +63,7 @@ class ParametersView {
   ParameterIterator begin() const { return begin_; }
   ParameterIterator end() const { return end_; }
   bool empty() const { return begin_ == end_; }
+  size_t size() const { return static_cast<size_t>(end_ - begin_); }
 
  private:
   ParameterIterator begin_;
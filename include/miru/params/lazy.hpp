@@ -0,0 +1,104 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// internal
+#include <miru/params/parameter.hpp>
+
+namespace miru::params {
+
+// ============================= LAZY PARAMETER TREE =============================== //
+/// A parameter tree which is built from a json document on demand.
+/**
+ * Constructing the tree only indexes the structure of the document (the byte range of
+ * every object and array). Parameters are built the first time they are looked up by
+ * name: the lookup walks the index down to the value and parses just that value's
+ * bytes. Each looked up parameter is built exactly once (even when looked up from
+ * multiple threads at the same time) and remains valid for the lifetime of the tree.
+ *
+ * The cost of loading a document is then proportional to what is read rather than to
+ * the size of the document. The trade offs are that
+ *  - errors in the document (other than unbalanced brackets / strings) are only
+ *    reported once the parameter containing them is looked up
+ *  - a parameter and its ancestors are built independently so looking up both holds
+ *    two copies of the parameter (looking up the root builds the entire tree)
+ *
+ * The built parameters are identical to those of parse_json_string() of the document.
+ */
+class LazyParameterTree {
+ public:
+  LazyParameterTree(const std::string& root_name, std::string json);
+  // the tree is the value of the given field of the top level json object
+  LazyParameterTree(
+    const std::string& root_name,
+    std::string json,
+    const std::string& field
+  );
+
+  LazyParameterTree(const LazyParameterTree&) = delete;
+  LazyParameterTree& operator=(const LazyParameterTree&) = delete;
+
+  const std::string& root_name() const { return root_name_; }
+
+  /// The number of objects and arrays in the structural index.
+  size_t num_containers() const { return containers_.size(); }
+
+  /// The number of parameters which have been looked up (and so built).
+  size_t num_materialized() const;
+
+  /// Return the parameter with the given name or nullptr if the document has no such
+  /// parameter. The parameter is built on the first lookup.
+  const Parameter* find(std::string_view name) const;
+
+  /// Return the root parameter, building the entire tree on the first call.
+  const Parameter& root() const;
+
+ private:
+  // the byte range of an object or array
+  struct Container {
+    size_t begin;
+    size_t end;
+  };
+
+  // the byte range of a value
+  struct Range {
+    size_t begin;
+    size_t end;
+  };
+
+  struct Slot {
+    Range range;
+    std::once_flag once;
+    std::optional<Parameter> parameter;
+  };
+
+  void index();
+  std::optional<Range> resolve(std::string_view name) const;
+  const Parameter& materialize(std::string_view name, Range range) const;
+
+  // scanning
+  size_t skip_whitespace(size_t pos) const;
+  size_t value_end(size_t pos) const;
+  std::string read_key(size_t& pos) const;
+  std::optional<Range> find_field(Range object, std::string_view key) const;
+  std::optional<Range> find_element(Range array, std::string_view index) const;
+
+  std::string root_name_;
+  std::string json_;
+  Range root_;
+  // sorted by the beginning of the container
+  std::vector<Container> containers_;
+
+  mutable std::mutex mutex_;
+  mutable std::unordered_map<std::string, std::unique_ptr<Slot>> slots_;
+};
+
+}  // namespace miru::params
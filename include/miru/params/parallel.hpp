@@ -0,0 +1,38 @@
+#pragma once
+
+// std
+#include <cstddef>
+
+// internal
+#include <miru/parallel/thread_pool.hpp>
+#include <miru/params/parameter.hpp>
+
+namespace miru::params {
+
+// ================================ PARALLEL PARSING =============================== //
+/// Opt-in parallel construction of parameter trees from parsed documents.
+/**
+ * The members of the top level map are built concurrently on the pool, as are the
+ * children of maps and arrays of maps / arrays with at least min_parallel_children
+ * children (split into chunks of chunk_size). Children are merged in document order
+ * so the tree is exactly the one the serial parse builds. Documents with more than
+ * max_depth nested maps / arrays are rejected.
+ */
+struct ParallelParseOptions {
+  static constexpr size_t DEFAULT_MIN_PARALLEL_CHILDREN = 256;
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 64;
+
+  ParallelParseOptions()
+    : pool(nullptr),
+      min_parallel_children(DEFAULT_MIN_PARALLEL_CHILDREN),
+      chunk_size(DEFAULT_CHUNK_SIZE),
+      max_depth(DEFAULT_MAX_DEPTH) {}
+
+  // defaults to miru::parallel::ThreadPool::shared() if null
+  miru::parallel::ThreadPool* pool;
+  size_t min_parallel_children;
+  size_t chunk_size;
+  size_t max_depth;
+};
+
+}  // namespace miru::params
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <utility>
 
 // internal
 #include <miru/params/details/errors.hpp>
@@ -16,6 +17,9 @@ namespace miru::params {
 
 const std::string DELIMITER = ".";
 
+// the default limit on the number of nested maps and arrays of a parsed document
+constexpr size_t DEFAULT_MAX_DEPTH = 512;
+
 class Parameter {
  public:
   // ============================== ROS2 INTERFACES ================================ //
@@ -40,12 +44,15 @@ class Parameter {
   /// Construct with given name and given parameter value.
   Parameter(const std::string &name, const ParameterValue &parameter_value);
 
+  /// Same as above but moves the value (and therefore any subtree) into the parameter.
+  Parameter(const std::string &name, ParameterValue &&parameter_value);
+
   // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/parameter.hpp#L67
 
   /// Construct with given name and given parameter value.
   template <typename ValueTypeT>
   Parameter(const std::string &name, ValueTypeT value)
-    : Parameter(name, ParameterValue(value)) {}
+    : Parameter(name, ParameterValue(std::move(value))) {}
 
   // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/parameter.hpp#L73
   // explicit Parameter(const rclcpp::node_interfaces::ParameterInfo &
@@ -231,10 +238,15 @@ class Parameter {
   bool is_map_array() const;
   bool is_array() const;
 
+  /// Get the set of types of this parameter and all of its descendants
+  ParameterTypeMask get_subtree_types() const { return subtree_types_; }
+
  private:
   ParameterType type_;
   std::string name_;
   ParameterValue value_;
+  // computed on construction (children are always constructed before their parent)
+  ParameterTypeMask subtree_types_;
 };
 
 std::ostream &operator<<(std::ostream &os, const Parameter &param);
@@ -1,6 +1,7 @@
 #pragma once
 
 // std
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -50,6 +51,31 @@ enum ParameterType : uint8_t {
   PARAMETER_MAP_ARRAY = 133,
 };
 
+// ============================== PARAMETER TYPE MASK ============================== //
+// A set of parameter types as a bitmask. The ros2 types (0-15) are assigned the low 16
+// bits and the miru types (128-143) the high 16 bits, leaving room for both to grow.
+using ParameterTypeMask = uint32_t;
+
+inline constexpr ParameterTypeMask EMPTY_TYPE_MASK = 0;
+inline constexpr ParameterTypeMask FULL_TYPE_MASK = ~ParameterTypeMask(0);
+inline constexpr size_t NUM_TYPE_MASK_BITS = 32;
+
+constexpr size_t type_mask_bit(ParameterType type) {
+  return type < 128 ? size_t(type) : 16 + size_t(type - 128);
+}
+
+constexpr ParameterType type_from_mask_bit(size_t bit) {
+  return bit < 16 ? ParameterType(bit) : ParameterType(128 + (bit - 16));
+}
+
+constexpr ParameterTypeMask type_mask(ParameterType type) {
+  return ParameterTypeMask(1) << type_mask_bit(type);
+}
+
+constexpr bool contains_type(ParameterTypeMask mask, ParameterType type) {
+  return (mask & type_mask(type)) != 0;
+}
+
 std::string to_string(ParameterType type);
 std::ostream &operator<<(std::ostream &os, const ParameterType &type);
 
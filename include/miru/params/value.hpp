@@ -344,6 +344,18 @@ class ParameterValue {
   /// Construct a parameter value with type PARAMETER_MAP_ARRAY.
   explicit ParameterValue(const MapArray &map_array_value);
 
+  // move overloads so that (potentially large) strings, arrays and subtrees are moved
+  // into the value instead of copied when building parameter trees
+  explicit ParameterValue(std::string &&string_value);
+  explicit ParameterValue(std::vector<bool> &&bool_array_value);
+  explicit ParameterValue(std::vector<int64_t> &&int_array_value);
+  explicit ParameterValue(std::vector<double> &&double_array_value);
+  explicit ParameterValue(std::vector<std::string> &&string_array_value);
+  explicit ParameterValue(std::vector<Scalar> &&scalar_array_value);
+  explicit ParameterValue(NestedArray &&nested_array_value);
+  explicit ParameterValue(Map &&map_value);
+  explicit ParameterValue(MapArray &&map_array_value);
+
   template <ParameterType type>
   constexpr typename std::
     enable_if<type == ParameterType::PARAMETER_NULL, const std::nullptr_t>::type
@@ -0,0 +1,77 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// internal
+#include <miru/params/parameter.hpp>
+#include <miru/query/filter.hpp>
+
+namespace miru::query {
+
+// ================================= QUERY CACHE ================================== //
+struct QueryCacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  size_t size = 0;
+  size_t capacity = 0;
+};
+
+std::string to_string(const QueryCacheStats& stats);
+
+/// Bounded (least recently used) cache of query results.
+/**
+ * Results are stored as pointers to the matched parameters so they are only valid for
+ * as long as the parameter tree they were computed against. The cache is owned by a
+ * ConfigInstance (which is immutable after it is loaded) and is dropped along with it.
+ * Filters are keyed by a canonical hash which ignores the order in which param names
+ * and prefixes were added. The cache is safe to use from multiple threads.
+ */
+class QueryCache {
+ public:
+  static constexpr size_t DEFAULT_CAPACITY = 128;
+
+  explicit QueryCache(size_t capacity = DEFAULT_CAPACITY);
+
+  /// Copy the cached results for the filters into 'result' and return true if they
+  /// were cached, otherwise return false and leave 'result' untouched.
+  bool get(const SearchParamFilters& filters, std::vector<const Parameter*>& result);
+
+  /// Cache the results for the filters, evicting the least recently used entry if the
+  /// cache is full.
+  void put(
+    const SearchParamFilters& filters,
+    const std::vector<const Parameter*>& result
+  );
+
+  void clear();
+  QueryCacheStats stats() const;
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Entry {
+    size_t hash;
+    SearchParamFilters filters;
+    std::vector<const Parameter*> result;
+  };
+  using EntryList = std::list<Entry>;
+
+  EntryList::iterator find(const SearchParamFilters& filters, size_t hash);
+
+  size_t capacity_;
+  mutable std::mutex mutex_;
+
+  // most recently used entries are at the front of the list
+  EntryList entries_;
+  std::unordered_multimap<size_t, EntryList::iterator> lookup_;
+
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace miru::query
@@ -5,6 +5,7 @@
 #include <miru/params/parameter.hpp>
 #include <miru/query/details/errors.hpp>
 #include <miru/query/filter.hpp>
+#include <miru/query/parallel.hpp>
 
 namespace miru::query::details {
 
@@ -33,7 +34,7 @@ inline constexpr bool is_parameter_root_v = is_parameter_root<T>::value;
 using ParameterPtr = const Parameter*;
 using ParameterPtrs = std::vector<ParameterPtr>;
 
-void find_all_recursive_helper(
+void find_all_helper(
   const Parameter& parameter,
   ParameterPtrs& result,
   const SearchParamFilters& filters
@@ -59,6 +60,49 @@ ParameterPtrs find_all(
   const SearchParamFilters& filters
 );
 
+// parallel traversals (see ParallelQueryOptions)
+ParameterPtrs find_all(
+  const Parameter& parameter,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+);
+
+ParameterPtrs find_all(
+  const miru::params::ParametersView& roots,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+);
+
+ParameterPtrs find_all(
+  const std::vector<Parameter>& roots,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+);
+
+ParameterPtrs find_all(
+  const Map& map,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+);
+
+ParameterPtrs find_all(
+  const NestedArray& nested_array,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+);
+
+ParameterPtrs find_all(
+  const MapArray& map_array,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+);
+
+ParameterPtrs find_all(
+  const miru::config::ConfigInstance& config_instance,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+);
+
 template <typename rootT>
 typename std::enable_if<is_parameter_root<rootT>::value, ParameterPtr>::type find_one(
   const rootT& root,
@@ -0,0 +1,29 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace miru::query::details {
+
+// 64-bit FNV-1a. Since FNV-1a is computed incrementally, the hash of a parameter name
+// can be continued from the hash of its parent's name (this is what allows segment
+// hashes to be computed once and reused for every prefix of a name).
+inline constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+inline constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+constexpr uint64_t fnv1a(std::string_view str, uint64_t hash = FNV_OFFSET_BASIS) {
+  for (char c : str) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+constexpr uint64_t fnv1a(char c, uint64_t hash) {
+  hash ^= static_cast<uint8_t>(c);
+  return hash * FNV_PRIME;
+}
+
+}  // namespace miru::query::details
@@ -2,6 +2,7 @@
 
 // internal
 #include <miru/params/parameter.hpp>
+#include <miru/query/predicate.hpp>
 
 namespace miru::query {
 
@@ -14,14 +15,29 @@ using MapArray = miru::params::MapArray;
 // ================================ SEARCH FILTERS ================================ //
 class SearchParamFilters {
  public:
-  SearchParamFilters() : param_names(), prefixes(), leaves_only(true) {}
+  SearchParamFilters()
+    : param_names(),
+      prefixes(),
+      types(miru::params::EMPTY_TYPE_MASK),
+      value_predicates(),
+      leaves_only(true) {}
 
   std::vector<std::string> param_names;
   std::vector<std::string> prefixes;
+  // an empty mask matches parameters of any type
+  miru::params::ParameterTypeMask types;
+  // every predicate must be satisfied
+  std::vector<ValuePredicate> value_predicates;
   bool leaves_only;
 
   bool has_param_name_filter() const { return !param_names.empty(); }
   bool has_prefix_filter() const { return !prefixes.empty(); }
+  bool has_type_filter() const { return types != miru::params::EMPTY_TYPE_MASK; }
+  bool has_value_filter() const { return !value_predicates.empty(); }
+
+  // the types a matching parameter could have given the type filter and the value
+  // predicates (FULL_TYPE_MASK if neither restricts the type)
+  miru::params::ParameterTypeMask candidate_types() const;
 
   bool matches(const Parameter& parameter) const;
   bool continue_search(const Parameter& parameter) const;
@@ -30,10 +46,18 @@ class SearchParamFilters {
   bool matches_param_name(const std::string_view& param_name) const;
   bool matches_prefix(const std::string_view& param_name) const;
   bool matches_leaves_only(const Parameter& parameter) const;
+  bool matches_type(const Parameter& parameter) const;
+  bool matches_value(const Parameter& parameter) const;
 
   // continue searching operations
   bool child_might_match_param_name(const std::string_view& param_name) const;
   bool child_might_match_prefix(const std::string_view& param_name) const;
+  bool child_might_match_type(const Parameter& parameter) const;
+
+  // canonical comparison operations (independent of the order in which param names
+  // and prefixes were added)
+  size_t canonical_hash() const;
+  bool equivalent(const SearchParamFilters& other) const;
 };
 
 std::string to_string(const SearchParamFilters& filters);
@@ -49,6 +73,14 @@ class SearchParamFiltersBuilder {
   SearchParamFiltersBuilder& with_prefix(const std::string& prefix);
   SearchParamFiltersBuilder& with_prefixes(const std::vector<std::string>& prefixes);
   SearchParamFiltersBuilder& with_leaves_only(bool leaves_only);
+  // note that maps, map arrays and nested arrays are only matched if leaves_only is
+  // disabled
+  SearchParamFiltersBuilder& with_type(ParameterType type);
+  SearchParamFiltersBuilder& with_types(const std::vector<ParameterType>& types);
+  SearchParamFiltersBuilder& with_value_predicate(const ValuePredicate& predicate);
+  SearchParamFiltersBuilder& with_value_predicates(
+    const std::vector<ValuePredicate>& predicates
+  );
 
   SearchParamFilters build() const { return filters; }
 
@@ -0,0 +1,97 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// internal
+#include <miru/params/parameter.hpp>
+#include <miru/params/type.hpp>
+
+namespace miru::query {
+
+using Parameter = miru::params::Parameter;
+
+// ================================= PARAM INDEX ================================== //
+/// Immutable name -> parameter index over a parameter tree.
+/**
+ * Every parameter in the tree (maps, arrays and leaves) is indexed by the hash of its
+ * full name so that a lookup is a single probe into an open addressing table. The
+ * index shares ownership of the tree it indexes so the parameters it returns stay
+ * valid for as long as the index (or a handle holding the index) is alive.
+ *
+ * The index also keeps a posting list per parameter type so that "all parameters of
+ * type X" is a walk over exactly those parameters instead of the whole tree, and the
+ * leaves sorted by name so that "all leaves under a.b" is a binary search followed by
+ * a scan over exactly those leaves.
+ */
+class ParamIndex {
+ public:
+  struct Leaf {
+    std::string_view name;
+    // the number of delimiters in the name ("a.b.c" -> 2)
+    size_t depth;
+    const Parameter* param;
+  };
+  using LeafIterator = std::vector<Leaf>::const_iterator;
+
+  explicit ParamIndex(std::shared_ptr<const Parameter> root);
+
+  // non-copyable since the table points into the shared tree
+  ParamIndex(const ParamIndex&) = delete;
+  ParamIndex& operator=(const ParamIndex&) = delete;
+
+  const Parameter& root() const { return *root_; }
+  const std::shared_ptr<const Parameter>& shared_root() const { return root_; }
+  size_t size() const { return size_; }
+
+  /// Return the parameter with the given name or nullptr if it doesn't exist.
+  const Parameter* find(std::string_view name) const;
+
+  /// Same as find(name) but uses a precomputed hash (details::fnv1a) of the name.
+  const Parameter* find(std::string_view name, uint64_t hash) const;
+
+  /// Return every parameter whose type is in the mask in tree (depth first) order.
+  std::vector<const Parameter*> find_by_types(miru::params::ParameterTypeMask types
+  ) const;
+
+  /// Return the number of parameters whose type is in the mask.
+  size_t count_by_types(miru::params::ParameterTypeMask types) const;
+
+  /// Return every leaf sorted by name.
+  const std::vector<Leaf>& sorted_leaves() const { return sorted_leaves_; }
+
+  /// Return the (sorted) range of leaves nested under the given parameter name, i.e.
+  /// whose names start with the prefix followed by a delimiter. An empty prefix
+  /// returns every leaf.
+  std::pair<LeafIterator, LeafIterator> leaves_under(std::string_view prefix) const;
+
+ private:
+  struct Slot {
+    uint64_t hash;
+    const Parameter* param;
+  };
+
+  void insert(const Parameter& param);
+  // indexes the tree iteratively in depth first order
+  void index_subtree(const Parameter& root);
+
+  std::shared_ptr<const Parameter> root_;
+  std::vector<Slot> slots_;
+  size_t mask_;
+  size_t size_;
+
+  // every parameter in depth first order and, per type mask bit, the (ascending)
+  // positions of the parameters of that type in it
+  std::vector<const Parameter*> preorder_;
+  std::array<std::vector<size_t>, miru::params::NUM_TYPE_MASK_BITS> postings_;
+
+  std::vector<Leaf> sorted_leaves_;
+};
+
+}  // namespace miru::query
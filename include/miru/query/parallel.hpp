@@ -0,0 +1,34 @@
+#pragma once
+
+// std
+#include <cstddef>
+
+// internal
+#include <miru/parallel/thread_pool.hpp>
+
+namespace miru::query {
+
+// =============================== PARALLEL QUERIES ================================ //
+/// Opt-in parallel traversal for queries over very wide maps and arrays.
+/**
+ * Maps and arrays with at least min_parallel_children children have their children
+ * split into chunks of chunk_size which are searched concurrently on the pool. Narrower
+ * nodes (and therefore small trees) stay on the serial path. Results are merged in
+ * tree order so a parallel query returns exactly what the serial query returns.
+ */
+struct ParallelQueryOptions {
+  static constexpr size_t DEFAULT_MIN_PARALLEL_CHILDREN = 4096;
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 1024;
+
+  ParallelQueryOptions()
+    : pool(nullptr),
+      min_parallel_children(DEFAULT_MIN_PARALLEL_CHILDREN),
+      chunk_size(DEFAULT_CHUNK_SIZE) {}
+
+  // defaults to miru::parallel::ThreadPool::shared() if null
+  miru::parallel::ThreadPool* pool;
+  size_t min_parallel_children;
+  size_t chunk_size;
+};
+
+}  // namespace miru::query
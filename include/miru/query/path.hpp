@@ -0,0 +1,216 @@
+#pragma once
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// internal
+#include <miru/configs/instance.hpp>
+#include <miru/params/parameter.hpp>
+#include <miru/query/details/hash.hpp>
+#include <miru/query/index.hpp>
+
+namespace miru::query {
+
+class ParamHandle;
+
+// =============================== STATIC PARAM PATH =============================== //
+inline constexpr size_t MAX_STATIC_PATH_SEGMENTS = 32;
+
+/// A parameter name which is tokenized and hashed at compile time.
+/**
+ * Usually created with the _mp literal from miru::query::literals. Declare it
+ * constexpr to guarantee the work is done at compile time:
+ *
+ *   using namespace miru::query::literals;
+ *   constexpr auto kp = "motion-control.motors.left.kp"_mp;
+ *
+ * The name must outlive the path, which is always the case for string literals.
+ */
+class StaticParamPath {
+ public:
+  constexpr StaticParamPath(const char* name, size_t size)
+    : name_(name, size),
+      hash_(details::FNV_OFFSET_BASIS),
+      num_segments_(0),
+      segment_ends_{},
+      segment_hashes_{} {
+    // the parameter delimiter is '.' (see miru::params::DELIMITER) and trailing
+    // delimiters are ignored
+    while (!name_.empty() && name_.back() == '.') {
+      name_.remove_suffix(1);
+    }
+    for (size_t i = 0; i < name_.size(); i++) {
+      if (name_[i] == '.') {
+        push_segment(i);
+      }
+      hash_ = details::fnv1a(name_[i], hash_);
+    }
+    push_segment(name_.size());
+  }
+
+  constexpr std::string_view name() const { return name_; }
+  constexpr uint64_t hash() const { return hash_; }
+
+  constexpr size_t num_segments() const { return num_segments_; }
+  constexpr std::string_view segment(size_t i) const {
+    size_t begin = i == 0 ? 0 : segment_ends_[i - 1] + 1;
+    return name_.substr(begin, segment_ends_[i] - begin);
+  }
+  constexpr size_t segment_length(size_t i) const { return segment(i).size(); }
+
+  // the hash of the name up to (and including) the i'th segment
+  constexpr uint64_t segment_hash(size_t i) const { return segment_hashes_[i]; }
+
+  /// Return the parameter from the index or nullptr if it doesn't exist.
+  const Parameter* find(const ParamIndex& index) const {
+    return index.find(name_, hash_);
+  }
+
+ private:
+  constexpr void push_segment(size_t end) {
+    if (num_segments_ == MAX_STATIC_PATH_SEGMENTS) {
+      throw std::length_error("too many segments in static parameter path");
+    }
+    segment_ends_[num_segments_] = end;
+    segment_hashes_[num_segments_] = hash_;
+    num_segments_++;
+  }
+
+  std::string_view name_;
+  uint64_t hash_;
+  size_t num_segments_;
+  std::array<size_t, MAX_STATIC_PATH_SEGMENTS> segment_ends_;
+  std::array<uint64_t, MAX_STATIC_PATH_SEGMENTS> segment_hashes_;
+};
+
+namespace literals {
+
+constexpr StaticParamPath operator""_mp(const char* name, size_t size) {
+  return StaticParamPath(name, size);
+}
+
+}  // namespace literals
+
+// ================================== PARAM PATH =================================== //
+/// A parameter name which has been tokenized and hashed once up front.
+/**
+ * Resolving a ParamPath against a config instance is a single probe into the config
+ * instance's name index instead of a search through the parameter tree. Construct the
+ * paths you read repeatedly once (e.g. as members) and reuse them.
+ */
+class ParamPath {
+ public:
+  explicit ParamPath(const std::string& name);
+  // reuses the segments and hashes computed at compile time
+  explicit ParamPath(const StaticParamPath& path);
+
+  const std::string& name() const { return name_; }
+  uint64_t hash() const { return hash_; }
+
+  // segments are the delimiter separated parts of the name ("a.b.c" -> a, b, c)
+  size_t num_segments() const { return segment_ends_.size(); }
+  std::string_view segment(size_t i) const;
+
+  // the hash of the name up to (and including) the i'th segment
+  uint64_t segment_hash(size_t i) const { return segment_hashes_[i]; }
+
+  /// Resolve the path against the config instance, throwing if it doesn't exist.
+  ParamHandle resolve(const miru::config::ConfigInstance& config_instance) const;
+
+  /// Return the parameter from the index or nullptr if it doesn't exist.
+  const Parameter* find(const ParamIndex& index) const {
+    return index.find(name_, hash_);
+  }
+
+ private:
+  std::string name_;
+  uint64_t hash_;
+  std::vector<size_t> segment_ends_;
+  std::vector<uint64_t> segment_hashes_;
+};
+
+// ================================= PARAM HANDLE ================================== //
+/// A resolved parameter.
+/**
+ * The handle shares ownership of the parameter tree it was resolved against so it
+ * stays valid even if the config instance it was resolved from is destroyed. Use
+ * rebind() after swapping in a new config instance; rebinding is a no-op when the new
+ * config instance shares the same tree and a single index probe otherwise.
+ */
+class ParamHandle {
+ public:
+  ParamHandle(
+    const ParamPath& path,
+    const miru::config::ConfigInstance& config_instance
+  );
+
+  const ParamPath& path() const { return path_; }
+  const Parameter& parameter() const { return *param_; }
+  const Parameter& operator*() const { return *param_; }
+  const Parameter* operator->() const { return param_; }
+
+  /// Get the value of the parameter using the given c++ type as a template argument
+  template <typename T>
+  decltype(auto) get() const {
+    return param_->as<T>();
+  }
+
+  /// Get the value of the parameter using the given ParameterType as a template
+  /// argument
+  template <miru::params::ParameterType ParamT>
+  decltype(auto) get() const {
+    return param_->as<ParamT>();
+  }
+
+  /// Re-resolve the handle against the (possibly new) config instance, throwing if
+  /// the parameter doesn't exist in it.
+  void rebind(const miru::config::ConfigInstance& config_instance);
+
+ private:
+  void resolve(std::shared_ptr<const ParamIndex> index);
+
+  ParamPath path_;
+  std::shared_ptr<const ParamIndex> index_;
+  const Parameter* param_;
+};
+
+// ================================ PATH QUERIES =================================== //
+// Unlike the filter based queries, path queries look up the parameter with exactly the
+// given name (maps and arrays included) with a single probe into the config instance's
+// name index.
+
+const Parameter* find_param(
+  const miru::config::ConfigInstance& config_instance,
+  const ParamPath& path
+);
+const Parameter* find_param(
+  const miru::config::ConfigInstance& config_instance,
+  const StaticParamPath& path
+);
+
+bool has_param(
+  const miru::config::ConfigInstance& config_instance,
+  const ParamPath& path
+);
+bool has_param(
+  const miru::config::ConfigInstance& config_instance,
+  const StaticParamPath& path
+);
+
+Parameter get_param(
+  const miru::config::ConfigInstance& config_instance,
+  const ParamPath& path
+);
+Parameter get_param(
+  const miru::config::ConfigInstance& config_instance,
+  const StaticParamPath& path
+);
+
+}  // namespace miru::query
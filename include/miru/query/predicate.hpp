@@ -0,0 +1,99 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// internal
+#include <miru/params/parameter.hpp>
+#include <miru/params/type.hpp>
+
+namespace miru::query {
+
+// =============================== VALUE PREDICATES ================================ //
+/// A condition on the value of a parameter.
+/**
+ * Numeric predicates apply to integer and double parameters (and yaml scalars which
+ * hold a number) while string predicates apply to string parameters (and yaml
+ * scalars). A parameter of any other type never satisfies a predicate.
+ *
+ * For arrays the quantifier decides whether all (the default) or any of the elements
+ * must satisfy the condition. An empty array satisfies an 'all' predicate and never an
+ * 'any' predicate. Numeric arrays are evaluated over their contiguous storage.
+ *
+ *   // every parameter holding a number (or numbers) outside of [0, 10]
+ *   ValuePredicate::not_in_range(0, 10).for_any()
+ */
+class ValuePredicate {
+ public:
+  enum class Op : uint8_t {
+    IN_RANGE,
+    NOT_IN_RANGE,
+    ONE_OF,
+  };
+
+  enum class Quantifier : uint8_t {
+    ALL,
+    ANY,
+  };
+
+  // numeric predicates (ranges are inclusive)
+  static ValuePredicate in_range(double min, double max);
+  static ValuePredicate not_in_range(double min, double max);
+  static ValuePredicate equal_to(double value);
+  static ValuePredicate one_of(const std::vector<double>& values);
+  // disambiguates one_of({1.0, 2.0}) from the string overload
+  static ValuePredicate one_of(std::initializer_list<double> values);
+
+  // string predicates
+  static ValuePredicate equal_to(const std::string& value);
+  static ValuePredicate equal_to(const char* value);
+  static ValuePredicate one_of(const std::vector<std::string>& values);
+  // disambiguates one_of({"a", "b"}) from the numeric overload
+  static ValuePredicate one_of(std::initializer_list<const char*> values);
+
+  // array quantifiers (ignored for non-array parameters)
+  ValuePredicate for_all() const;
+  ValuePredicate for_any() const;
+
+  Op op() const { return op_; }
+  Quantifier quantifier() const { return quantifier_; }
+  bool is_numeric() const { return numeric_; }
+  double min() const { return min_; }
+  double max() const { return max_; }
+
+  /// The parameter types which could possibly satisfy the predicate.
+  miru::params::ParameterTypeMask applicable_types() const;
+
+  bool matches(const miru::params::Parameter& parameter) const;
+
+  bool operator==(const ValuePredicate& other) const;
+  bool operator!=(const ValuePredicate& other) const { return !(*this == other); }
+  size_t hash() const;
+
+ private:
+  ValuePredicate(Op op, bool numeric);
+
+  template <typename T>
+  bool matches_numbers(const T* values, size_t size) const;
+  bool matches_number(double value) const;
+  bool matches_strings(const std::vector<std::string>& values) const;
+  bool matches_string(const std::string& value) const;
+  bool matches_scalar(const miru::params::Scalar& scalar) const;
+  bool matches_scalars(const std::vector<miru::params::Scalar>& scalars) const;
+
+  Op op_;
+  Quantifier quantifier_;
+  bool numeric_;
+  double min_;
+  double max_;
+  std::vector<double> numbers_;
+  std::vector<std::string> strings_;
+};
+
+std::string to_string(const ValuePredicate& predicate);
+
+}  // namespace miru::query
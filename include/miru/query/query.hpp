@@ -1,5 +1,10 @@
 #pragma once
 
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
 // internal
 #include <miru/configs/instance.hpp>
 #include <miru/params/iterator.hpp>
@@ -7,6 +12,7 @@
 #include <miru/query/details/errors.hpp>
 #include <miru/query/details/find.hpp>
 #include <miru/query/filter.hpp>
+#include <miru/query/ref.hpp>
 
 namespace miru::query {
 
@@ -137,4 +143,134 @@ try_get_param_or(
   return ptr_result != nullptr;
 }
 
+// ================================ PARAMETER REFS ================================= //
+// Same as the queries above but return references into the parameter tree instead of
+// copies. See ParameterRef for the lifetime rules. Querying a temporary root is
+// deleted since the references would dangle immediately.
+
+template <typename rootT>
+typename std::
+  enable_if<details::is_parameter_root_v<rootT>, std::vector<ParameterRef>>::type
+  get_param_refs(const rootT& root, const SearchParamFilters& filters) {
+  std::vector<ParameterRef> result;
+  for (const auto& param : details::find_all(root, filters)) {
+    result.emplace_back(*param);
+  }
+  return result;
+}
+
+template <typename rootT>
+typename std::
+  enable_if<details::is_parameter_root_v<rootT>, std::vector<ParameterRef>>::type
+  list_param_refs(const rootT& root) {
+  return get_param_refs(root, SearchParamFilters());
+}
+
+template <typename rootT>
+typename std::enable_if<details::is_parameter_root_v<rootT>, ParameterRef>::type
+get_param_ref(const rootT& root, const SearchParamFilters& filters) {
+  const Parameter* result = details::find_one(root, filters, true);
+  if (result == nullptr) {
+    THROW_PARAMETER_NOT_FOUND(filters);
+  }
+  return ParameterRef(*result);
+}
+
+template <typename rootT>
+typename std::enable_if<details::is_parameter_root_v<rootT>, ParameterRef>::type
+get_param_ref(const rootT& root, const std::string& param_name) {
+  return get_param_ref(
+    root, SearchParamFiltersBuilder().with_param_name(param_name).build()
+  );
+}
+
+template <typename rootT>
+void get_param_refs(const rootT&& root, const SearchParamFilters& filters) = delete;
+template <typename rootT>
+void list_param_refs(const rootT&& root) = delete;
+template <typename rootT>
+void get_param_ref(const rootT&& root, const SearchParamFilters& filters) = delete;
+template <typename rootT>
+void get_param_ref(const rootT&& root, const std::string& param_name) = delete;
+
+// ================================ SHARED PARAMS ================================== //
+/// Return a parameter of the config instance which shares ownership of the config
+/// instance's parameter tree and so remains valid after the config instance is gone.
+inline std::shared_ptr<const Parameter> get_shared_param(
+  const miru::config::ConfigInstance& config_instance,
+  const SearchParamFilters& filters
+) {
+  const Parameter* result = details::find_one(config_instance, filters, true);
+  if (result == nullptr) {
+    THROW_PARAMETER_NOT_FOUND(filters);
+  }
+  return config_instance.shared_parameter(*result);
+}
+
+inline std::shared_ptr<const Parameter> get_shared_param(
+  const miru::config::ConfigInstance& config_instance,
+  const std::string& param_name
+) {
+  return get_shared_param(
+    config_instance, SearchParamFiltersBuilder().with_param_name(param_name).build()
+  );
+}
+
+// =============================== PARALLEL QUERIES ================================ //
+// Same as the queries above but wide maps and arrays are searched in parallel (see
+// ParallelQueryOptions). The results are identical to the serial queries.
+
+template <typename rootT>
+typename std::enable_if<details::is_parameter_root_v<rootT>, std::vector<Parameter>>::
+  type
+  get_params(
+    const rootT& root,
+    const SearchParamFilters& filters,
+    const ParallelQueryOptions& options
+  ) {
+  std::vector<Parameter> result;
+  for (const auto& param : details::find_all(root, filters, options)) {
+    result.push_back(*param);
+  }
+  return result;
+}
+
+template <typename rootT>
+typename std::enable_if<details::is_parameter_root_v<rootT>, std::vector<Parameter>>::
+  type
+  list_params(const rootT& root, const ParallelQueryOptions& options) {
+  return get_params(root, SearchParamFilters(), options);
+}
+
+template <typename rootT>
+typename std::
+  enable_if<details::is_parameter_root_v<rootT>, std::vector<ParameterRef>>::type
+  get_param_refs(
+    const rootT& root,
+    const SearchParamFilters& filters,
+    const ParallelQueryOptions& options
+  ) {
+  std::vector<ParameterRef> result;
+  for (const auto& param : details::find_all(root, filters, options)) {
+    result.emplace_back(*param);
+  }
+  return result;
+}
+
+template <typename rootT>
+typename std::
+  enable_if<details::is_parameter_root_v<rootT>, std::vector<ParameterRef>>::type
+  list_param_refs(const rootT& root, const ParallelQueryOptions& options) {
+  return get_param_refs(root, SearchParamFilters(), options);
+}
+
+template <typename rootT>
+void get_param_refs(
+  const rootT&& root,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) = delete;
+template <typename rootT>
+void list_param_refs(const rootT&& root, const ParallelQueryOptions& options) = delete;
+
 }  // namespace miru::query
@@ -0,0 +1,52 @@
+#pragma once
+
+// internal
+#include <miru/params/parameter.hpp>
+#include <miru/params/type.hpp>
+
+namespace miru::query {
+
+// ================================ PARAMETER REF ================================== //
+/// A non-owning reference to a parameter in a parameter tree.
+/**
+ * Unlike the Parameter returned by get_param(), a ParameterRef doesn't copy the
+ * parameter (or, for maps and arrays, its entire subtree). Copying is opt-in with
+ * copy().
+ *
+ * Lifetime: a ParameterRef is valid for as long as the parameter tree it was queried
+ * from is alive. For a config instance that is the lifetime of the config instance
+ * (moving the config instance is fine) or of anything sharing its tree such as a
+ * ParamHandle. Use get_shared_param() when the parameter needs to outlive the config
+ * instance. Querying a temporary root for a reference is a compile error.
+ */
+class ParameterRef {
+ public:
+  explicit ParameterRef(const miru::params::Parameter& parameter)
+    : param_(&parameter) {}
+
+  const miru::params::Parameter& get() const { return *param_; }
+  const miru::params::Parameter& operator*() const { return *param_; }
+  const miru::params::Parameter* operator->() const { return param_; }
+  operator const miru::params::Parameter&() const { return *param_; }
+
+  /// Get the value of the parameter using the given c++ type as a template argument
+  template <typename T>
+  decltype(auto) as() const {
+    return param_->as<T>();
+  }
+
+  /// Get the value of the parameter using the given ParameterType as a template
+  /// argument
+  template <miru::params::ParameterType ParamT>
+  decltype(auto) as() const {
+    return param_->as<ParamT>();
+  }
+
+  /// Deep copy the referenced parameter
+  miru::params::Parameter copy() const { return *param_; }
+
+ private:
+  const miru::params::Parameter* param_;
+};
+
+}  // namespace miru::query
@@ -1,23 +1,75 @@
 #pragma once
 
 // std
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 // internal
 #include <miru/params/parameter.hpp>
+#include <miru/query/index.hpp>
 #include <miru/query/query.hpp>
 
 namespace miru::query {
 
 using Parameter = miru::params::Parameter;
 
+// mirrors rcl_interfaces::msg::ListParametersResult
+struct ListParametersResult {
+  // the names of the matching parameters (sorted)
+  std::vector<std::string> names;
+  // the unique parent names of the matching parameters
+  std::vector<std::string> prefixes;
+};
+
+// ============================== DECLARED PARAMETER =============================== //
+/// The converted value of a parameter declared with ROS2NodeI::declare_parameter().
+/**
+ * The parameter is looked up and converted to ParameterT once at declaration so
+ * reading the value is a plain member access. Copying the handle copies the value.
+ */
+template <typename ParameterT>
+class DeclaredParameter {
+ public:
+  DeclaredParameter(std::string name, ParameterT value, bool from_config)
+    : name_(std::move(name)), value_(std::move(value)), from_config_(from_config) {}
+
+  const std::string& name() const { return name_; }
+  const ParameterT& value() const { return value_; }
+  const ParameterT& operator*() const { return value_; }
+  const ParameterT* operator->() const { return &value_; }
+  operator const ParameterT&() const { return value_; }
+
+  /// Return false if the parameter doesn't exist and the default value was used.
+  bool from_config() const { return from_config_; }
+
+ private:
+  std::string name_;
+  ParameterT value_;
+  bool from_config_;
+};
+
+// ================================== ROS2 NODE ==================================== //
 // Config class
+/**
+ * Lookups are single probes into a name index (see ParamIndex) instead of searches
+ * through the parameter tree. Constructing the node from a config instance shares the
+ * config instance's tree and index so nothing is copied or re-indexed.
+ */
 class ROS2NodeI {
  public:
-  ROS2NodeI(const miru::params::Parameter& root) : root_(root) {}
+  // mirrors rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE
+  static constexpr uint64_t DEPTH_RECURSIVE = 0;
+
+  // copies the tree once and indexes the copy
+  ROS2NodeI(const miru::params::Parameter& root);
+
+  ROS2NodeI(std::shared_ptr<const miru::params::Parameter> root);
 
-  ROS2NodeI(const miru::config::ConfigInstance& config_instance)
-    : root_(config_instance.root_parameter()) {}
+  ROS2NodeI(const miru::config::ConfigInstance& config_instance);
 
   // ============================== ROS2 INTERFACES ============================== //
 
@@ -92,10 +144,11 @@ class ROS2NodeI {
    */
   template <typename ParameterT>
   bool get_parameter(const std::string& name, ParameterT& parameter) const {
-    SearchParamFiltersBuilder builder;
-    builder.with_param_name(name);
-    SearchParamFilters filters = builder.build();
-    return miru::query::try_get_param(root_, filters, parameter);
+    const Parameter* param = find_parameter(name);
+    if (param) {
+      parameter = param->as<ParameterT>();
+    }
+    return param != nullptr;
   }
 
   // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/node.hpp#L823
@@ -122,10 +175,9 @@ class ROS2NodeI {
     ParameterT& parameter,
     const ParameterT& alternative_value
   ) const {
-    SearchParamFiltersBuilder builder;
-    builder.with_param_name(name);
-    SearchParamFilters filters = builder.build();
-    return miru::query::try_get_param_or(root_, filters, parameter, alternative_value);
+    const Parameter* param = find_parameter(name);
+    parameter = param ? param->as<ParameterT>() : alternative_value;
+    return param != nullptr;
   }
 
   // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/node.hpp#L842
@@ -146,10 +198,8 @@ class ROS2NodeI {
   template <typename ParameterT>
   ParameterT
   get_parameter_or(const std::string& name, const ParameterT& alternative_value) const {
-    SearchParamFiltersBuilder builder;
-    builder.with_param_name(name);
-    SearchParamFilters filters = builder.build();
-    return miru::query::get_param_or(root_, filters, alternative_value);
+    const Parameter* param = find_parameter(name);
+    return param ? param->as<ParameterT>() : alternative_value;
   }
 
   // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/node.hpp#L868
@@ -177,8 +227,139 @@ class ROS2NodeI {
    */
   std::vector<Parameter> get_parameters(const std::vector<std::string>& names) const;
 
+  // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/node.hpp
+
+  /// Get the parameter values for all parameters that have a given prefix.
+  /**
+   * The names which are used as keys in the values map have the prefix removed.
+   * For example, if you use the prefix "foo" and the parameters "foo.ping" and
+   * "foo.pong" exist, then the returned map will have the keys "ping" and "pong".
+   *
+   * An empty string for the prefix will match all parameters.
+   *
+   * If no parameters with the prefix are found, then the output parameter "values"
+   * will be unchanged and false will be returned.
+   * Otherwise, the parameter names and values will be stored in the map and true will
+   * be returned to indicate "values" was mutated.
+   *
+   * \param[in] prefix The prefix of the parameters to get.
+   * \param[out] values The map used to store the parameter names and values,
+   *   respectively, with one entry per parameter matching prefix.
+   * \returns true if output "values" was changed, false otherwise.
+   * \throws rclcpp::ParameterTypeException if the requested type does not
+   *   match the value of the parameter which is stored.
+   */
+  template <typename ParameterT>
+  bool get_parameters(
+    const std::string& prefix,
+    std::map<std::string, ParameterT>& values
+  ) const {
+    auto [begin, end] = index_->leaves_under(prefix);
+    for (auto it = begin; it != end; ++it) {
+      values[strip_prefix(prefix, it->name)] = it->param->as<ParameterT>();
+    }
+    return begin != end;
+  }
+
+  // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/node_interfaces/node_parameters_interface.hpp
+
+  /// Get all parameters that have the specified prefix into the parameters map.
+  /**
+   * Same as get_parameters(const std::string &, std::map &) but returns the
+   * parameters themselves, keyed by their names with the prefix removed.
+   *
+   * \param[in] prefix The prefix of the parameters to get.
+   * \return The map of parameters with the prefix removed from their names.
+   */
+  std::map<std::string, Parameter> get_parameters_by_prefix(const std::string& prefix
+  ) const;
+
+  // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/node.hpp
+
+  /// Return a list of parameters with any of the given prefixes, up to the given
+  /// depth.
+  /**
+   * A parameter matches a prefix if its name is the prefix or it is nested under the
+   * prefix. With no prefixes every parameter matches while an empty prefix matches
+   * none, like in rclcpp.
+   *
+   * As in rclcpp, a parameter is within the depth if the part of its name below the
+   * prefix (or its whole name when no prefixes are given) has fewer delimiters than
+   * the depth. The delimiter following the prefix is counted, so a depth of 2 lists
+   * the direct children of each prefix while a depth of 1 lists the top level
+   * parameters when no prefixes are given. DEPTH_RECURSIVE lists every nested
+   * parameter.
+   *
+   * \param[in] prefixes The prefixes of the parameters to list.
+   * \param[in] depth The maximum depth below the prefixes to list.
+   * \return The sorted names of the matching parameters and their unique prefixes.
+   */
+  ListParametersResult
+  list_parameters(const std::vector<std::string>& prefixes, uint64_t depth) const;
+
+  // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/include/rclcpp/node.hpp
+
+  /// Declare and initialize a parameter with a type.
+  /**
+   * Unlike rclcpp, which returns the value, this returns a handle holding the value
+   * converted to ParameterT. The parameter is looked up and converted once so code
+   * which re-reads the parameter should keep the handle instead of calling
+   * get_parameter() again.
+   *
+   * If the parameter doesn't exist the handle holds the default value.
+   *
+   * \param[in] name The name of the parameter.
+   * \param[in] default_value An initial value to be used if the parameter doesn't
+   *   exist.
+   * \return A handle holding the value of the parameter.
+   * \throws rclcpp::exceptions::InvalidParameterTypeException if the parameter
+   *   can't be converted to ParameterT.
+   */
+  template <typename ParameterT>
+  DeclaredParameter<ParameterT>
+  declare_parameter(const std::string& name, const ParameterT& default_value) const {
+    const Parameter* param = find_parameter(name);
+    if (param == nullptr) {
+      return DeclaredParameter<ParameterT>(name, default_value, false);
+    }
+    return DeclaredParameter<ParameterT>(name, param->as<ParameterT>(), true);
+  }
+
+  /// Same as declare_parameter(const std::string &, const ParameterT &) but stores
+  /// string literal defaults as std::string.
+  DeclaredParameter<std::string>
+  declare_parameter(const std::string& name, const char* default_value) const {
+    return declare_parameter<std::string>(name, std::string(default_value));
+  }
+
+  /// Declare and initialize a parameter with a type but without a default value.
+  /**
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter
+   *   doesn't exist.
+   * \throws rclcpp::exceptions::InvalidParameterTypeException if the parameter
+   *   can't be converted to ParameterT.
+   */
+  template <typename ParameterT>
+  DeclaredParameter<ParameterT> declare_parameter(const std::string& name) const {
+    return DeclaredParameter<ParameterT>(
+      name, get_parameter_ref(name).as<ParameterT>(), true
+    );
+  }
+
+  // ============================== MIRU INTERFACES ============================== //
+
+  /// Same as get_parameter(const std::string &) but returns a reference instead of a
+  /// copy. The reference is valid for as long as this node is alive.
+  ParameterRef get_parameter_ref(const std::string& name) const;
+
  private:
-  miru::params::Parameter root_;
+  // return the leaf parameter with the given name or nullptr if it doesn't exist
+  const Parameter* find_parameter(const std::string& name) const;
+
+  // the name of a parameter nested under the prefix relative to the prefix
+  static std::string strip_prefix(const std::string& prefix, std::string_view name);
+
+  std::shared_ptr<const ParamIndex> index_;
 };
 
 }  // namespace miru::query
@@ -0,0 +1,66 @@
+// std
+#include <cctype>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// internal
+#include <configs/agent_cache.hpp>
+
+namespace miru::config {
+
+// ================================== AGENT CACHE ================================== //
+std::string cache_file_name(const std::string& config_type_slug, uint64_t schema_hash) {
+  std::string name;
+  for (char c : config_type_slug) {
+    bool safe = std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+    name += safe ? c : '_';
+  }
+  char hash[17];
+  std::snprintf(
+    hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(schema_hash)
+  );
+  return name + "." + hash + ".snapshot";
+}
+
+AgentCache::AgentCache(
+  const std::filesystem::path& dir,
+  const std::string& config_type_slug,
+  uint64_t schema_hash
+)
+  : config_type_slug_(config_type_slug) {
+  snapshot_path_ = dir / cache_file_name(config_type_slug_, schema_hash);
+}
+
+std::optional<ConfigInstanceImpl> AgentCache::load(bool lazy) const {
+  if (!std::filesystem::exists(snapshot_path_)) {
+    return std::nullopt;
+  }
+  // an invalid snapshot (e.g. written by another version) is a cache miss which the
+  // next fetch from the agent overwrites
+  try {
+    FromSnapshotOptions options;
+    options.mapped = lazy;
+    ConfigInstanceImpl config_instance =
+      ConfigInstanceImpl::from_snapshot(snapshot_path_, options);
+    if (config_instance.get_source() != ConfigInstanceSource::Agent) {
+      return std::nullopt;
+    }
+    return config_instance;
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+}
+
+void AgentCache::store(const ConfigInstanceImpl& config_instance) const noexcept {
+  try {
+    std::filesystem::create_directories(snapshot_path_.parent_path());
+    config_instance.save_snapshot(snapshot_path_);
+  } catch (const std::exception&) {
+    // the config instance is served from the agent regardless
+  }
+}
+
+}  // namespace miru::config
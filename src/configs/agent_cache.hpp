@@ -0,0 +1,43 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// internal
+#include <configs/instance_impl.hpp>
+#include <filesys/file.hpp>
+
+namespace miru::config {
+
+// ================================== AGENT CACHE ================================== //
+// The config instances fetched from the agent persisted as snapshots (see
+// FromAgentOptions::cache_dir). The agent is needed to compute the schema digest so
+// the snapshots are keyed by the config type slug and a digest of the schema file
+// computed locally instead (and record the agent's digest for the config instance).
+class AgentCache {
+ public:
+  // the schema hash is the fnv1a hash of the contents of the schema
+  AgentCache(
+    const std::filesystem::path& dir,
+    const std::string& config_type_slug,
+    uint64_t schema_hash
+  );
+
+  const std::string& config_type_slug() const { return config_type_slug_; }
+  const std::filesystem::path& snapshot_path() const { return snapshot_path_; }
+
+  // nullopt if there's no (valid) snapshot of the schema's config instance
+  std::optional<ConfigInstanceImpl> load(bool lazy) const;
+
+  // best effort: failing to persist the config instance is ignored
+  void store(const ConfigInstanceImpl& config_instance) const noexcept;
+
+ private:
+  std::string config_type_slug_;
+  std::filesystem::path snapshot_path_;
+};
+
+}  // namespace miru::config
@@ -0,0 +1,157 @@
+// std
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+// internal
+#include <configs/directory.hpp>
+#include <configs/instance_impl.hpp>
+#include <filesys/errors.hpp>
+#include <miru/parallel/thread_pool.hpp>
+
+namespace miru::config {
+
+// ================================== DIRECTORIES ================================== //
+std::vector<miru::filesys::File> supported_files(const miru::filesys::Dir& dir) {
+  std::vector<miru::filesys::File> files;
+  for (const miru::filesys::File& file : dir.files()) {
+    try {
+      file.file_type();
+      files.push_back(file);
+    } catch (const miru::filesys::InvalidFileTypeError&) {
+    }
+  }
+  return files;
+}
+
+DirectoryPairing pair_directory_files(
+  const miru::filesys::Dir& schema_dir,
+  const miru::filesys::Dir& instance_dir
+) {
+  std::vector<miru::filesys::File> schema_files = supported_files(schema_dir);
+  std::vector<miru::filesys::File> instance_files = supported_files(instance_dir);
+
+  // the config instance files by stem
+  std::map<std::string, std::vector<size_t>> stems;
+  for (size_t i = 0; i < instance_files.size(); i++) {
+    stems[instance_files[i].path().stem().string()].push_back(i);
+  }
+
+  DirectoryPairing pairing;
+  std::vector<bool> paired(instance_files.size(), false);
+  std::set<std::string> ambiguous_stems;
+  for (const miru::filesys::File& schema_file : schema_files) {
+    std::vector<size_t> candidates;
+    auto it = stems.find(schema_file.path().stem().string());
+    if (it != stems.end()) {
+      candidates = it->second;
+    }
+    // a config instance file with the same name wins over the other stem matches
+    for (size_t i : candidates) {
+      if (instance_files[i].name() == schema_file.name()) {
+        candidates = {i};
+        break;
+      }
+    }
+
+    if (candidates.size() == 1) {
+      paired[candidates[0]] = true;
+      pairing.pairs.push_back({schema_file, instance_files[candidates[0]]});
+      continue;
+    }
+    FromDirectoryError error;
+    error.schema_file = schema_file.path();
+    if (candidates.empty()) {
+      error.message = "No config instance file named after schema file '" +
+                      schema_file.name() + "' in '" + instance_dir.path().string() +
+                      "'";
+    } else {
+      ambiguous_stems.insert(it->first);
+      error.message = "Several config instance files named after schema file '" +
+                      schema_file.name() + "' in '" + instance_dir.path().string() +
+                      "'";
+    }
+    pairing.errors.push_back(std::move(error));
+  }
+
+  for (size_t i = 0; i < instance_files.size(); i++) {
+    if (paired[i]) {
+      continue;
+    }
+    // config instance files which were candidates of an ambiguous schema file are
+    // already reported with it
+    if (ambiguous_stems.count(instance_files[i].path().stem().string())) {
+      continue;
+    }
+    FromDirectoryError error;
+    error.instance_file = instance_files[i].path();
+    error.message = "No schema file named after config instance file '" +
+                    instance_files[i].name() + "' in '" +
+                    schema_dir.path().string() + "'";
+    pairing.errors.push_back(std::move(error));
+  }
+  return pairing;
+}
+
+FromDirectoryResult load_directory(
+  const std::filesystem::path& schema_dir_path,
+  const std::filesystem::path& instance_dir_path,
+  const FromDirectoryOptions& options
+) {
+  DirectoryPairing pairing = pair_directory_files(
+    miru::filesys::Dir(schema_dir_path), miru::filesys::Dir(instance_dir_path)
+  );
+  const std::vector<DirectoryPair>& pairs = pairing.pairs;
+
+  // a fixed number of tasks take the next pair until there are none left, which bounds
+  // the number of files read (and documents held) at once
+  std::vector<std::optional<ConfigInstanceImpl>> loaded(pairs.size());
+  std::vector<std::string> errors(pairs.size());
+  miru::parallel::ThreadPool& pool =
+    options.pool ? *options.pool : miru::parallel::ThreadPool::shared();
+  size_t num_tasks = options.max_concurrency ? options.max_concurrency
+                                             : std::max<size_t>(pool.num_threads(), 1);
+  num_tasks = std::min(num_tasks, pairs.size());
+  std::atomic<size_t> next = 0;
+  miru::parallel::TaskGroup group(pool);
+  for (size_t task = 0; task < num_tasks; task++) {
+    group.run([&]() {
+      for (size_t i = next++; i < pairs.size(); i = next++) {
+        try {
+          loaded[i].emplace(ConfigInstanceImpl::from_file(
+            pairs[i].schema_file.path(),
+            pairs[i].instance_file.path(),
+            options.file_options
+          ));
+        } catch (const std::exception& e) {
+          errors[i] = e.what();
+        }
+      }
+    });
+  }
+  group.wait();
+
+  FromDirectoryResult result;
+  result.errors = std::move(pairing.errors);
+  for (size_t i = 0; i < pairs.size(); i++) {
+    if (loaded[i]) {
+      result.config_instances.emplace_back(
+        std::make_unique<ConfigInstanceImpl>(std::move(*loaded[i]))
+      );
+      continue;
+    }
+    FromDirectoryError error;
+    error.schema_file = pairs[i].schema_file.path();
+    error.instance_file = pairs[i].instance_file.path();
+    error.message = std::move(errors[i]);
+    result.errors.push_back(std::move(error));
+  }
+  return result;
+}
+
+}  // namespace miru::config
@@ -0,0 +1,42 @@
+#pragma once
+
+// std
+#include <filesystem>
+#include <vector>
+
+// internal
+#include <filesys/dir.hpp>
+#include <filesys/file.hpp>
+#include <miru/configs/instance.hpp>
+
+namespace miru::config {
+
+// ================================== DIRECTORIES ================================== //
+struct DirectoryPair {
+  miru::filesys::File schema_file;
+  miru::filesys::File instance_file;
+};
+
+struct DirectoryPairing {
+  // in the order of the names of the schema files
+  std::vector<DirectoryPair> pairs;
+  // schema files without a config instance file (or with several) and config
+  // instance files without a schema file
+  std::vector<FromDirectoryError> errors;
+};
+
+// pairs the schema and config instance files of the directories (see
+// ConfigInstance::from_directory())
+DirectoryPairing pair_directory_files(
+  const miru::filesys::Dir& schema_dir,
+  const miru::filesys::Dir& instance_dir
+);
+
+// loads the paired files concurrently (see ConfigInstance::from_directory())
+FromDirectoryResult load_directory(
+  const std::filesystem::path& schema_dir_path,
+  const std::filesystem::path& instance_dir_path,
+  const FromDirectoryOptions& options
+);
+
+}  // namespace miru::config
@@ -116,4 +116,47 @@ class GetDeployedConfigInstanceError : public std::runtime_error {
 #define THROW_GET_DEPLOYED_CONFIG_INSTANCE_ERROR(from_agent_error, default_file, from_default_file_error) \
   throw GetDeployedConfigInstanceError(from_agent_error, default_file, from_default_file_error, ERROR_TRACE)
 
+class InvalidSnapshotError : public std::runtime_error {
+ public:
+  explicit InvalidSnapshotError(
+    const std::filesystem::path& snapshot_path,
+    const std::string& reason,
+    const miru::details::errors::ErrorTrace& trace
+  )
+    : std::runtime_error(format_message(snapshot_path, reason, trace)) {}
+
+  static std::string format_message(
+    const std::filesystem::path& snapshot_path,
+    const std::string& reason,
+    const miru::details::errors::ErrorTrace& trace
+  ) {
+    return "Invalid config instance snapshot '" + snapshot_path.string() +
+           "': " + reason + miru::details::errors::format_source_location(trace);
+  }
+};
+
+#define THROW_INVALID_SNAPSHOT(snapshot_path, reason) \
+  throw InvalidSnapshotError(snapshot_path, reason, ERROR_TRACE)
+
+class WatchError : public std::runtime_error {
+ public:
+  explicit WatchError(
+    const std::filesystem::path& path,
+    const std::string& reason,
+    const miru::details::errors::ErrorTrace& trace
+  )
+    : std::runtime_error(format_message(path, reason, trace)) {}
+
+  static std::string format_message(
+    const std::filesystem::path& path,
+    const std::string& reason,
+    const miru::details::errors::ErrorTrace& trace
+  ) {
+    return "Unable to watch '" + path.string() + "': " + reason +
+           miru::details::errors::format_source_location(trace);
+  }
+};
+
+#define THROW_WATCH_ERROR(path, reason) throw WatchError(path, reason, ERROR_TRACE)
+
 }  // namespace miru::config
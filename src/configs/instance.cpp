@@ -1,4 +1,5 @@
 // internal
+#include <configs/directory.hpp>
 #include <configs/instance_impl.hpp>
 #include <miru/configs/instance.hpp>
 
@@ -17,16 +18,19 @@ std::ostream& operator<<(std::ostream& os, const ConfigInstanceSource& source) {
 }
 
 ConfigInstance::~ConfigInstance() = default;
+ConfigInstance::ConfigInstance(ConfigInstance&& other) noexcept = default;
+ConfigInstance& ConfigInstance::operator=(ConfigInstance&& other) noexcept = default;
 
 ConfigInstance::ConfigInstance(std::unique_ptr<ConfigInstanceImpl> impl)
   : impl_(std::move(impl)) {}
 
 ConfigInstance ConfigInstance::from_file(
   const std::filesystem::path& schema_file_path,
-  const std::filesystem::path& instance_file_path
+  const std::filesystem::path& instance_file_path,
+  const FromFileOptions& options
 ) {
   ConfigInstanceImpl impl =
-    ConfigInstanceImpl::from_file(schema_file_path, instance_file_path);
+    ConfigInstanceImpl::from_file(schema_file_path, instance_file_path, options);
   return ConfigInstance(std::make_unique<ConfigInstanceImpl>(std::move(impl)));
 }
 
@@ -38,12 +42,73 @@ ConfigInstance ConfigInstance::from_agent(
   return ConfigInstance(std::make_unique<ConfigInstanceImpl>(std::move(impl)));
 }
 
+FromDirectoryResult ConfigInstance::from_directory(
+  const std::filesystem::path& schema_dir_path,
+  const std::filesystem::path& instance_dir_path,
+  const FromDirectoryOptions& options
+) {
+  return load_directory(schema_dir_path, instance_dir_path, options);
+}
+
+ConfigInstance ConfigInstance::from_snapshot(
+  const std::filesystem::path& snapshot_path,
+  const FromSnapshotOptions& options
+) {
+  ConfigInstanceImpl impl = ConfigInstanceImpl::from_snapshot(snapshot_path, options);
+  return ConfigInstance(std::make_unique<ConfigInstanceImpl>(std::move(impl)));
+}
+
+void ConfigInstance::save_snapshot(const std::filesystem::path& snapshot_path) const {
+  impl_->save_snapshot(snapshot_path);
+}
+
 const ConfigInstanceSource ConfigInstance::get_source() const {
   return impl_->get_source();
 }
 
+bool ConfigInstance::from_agent_cache() const { return impl_->from_agent_cache(); }
+
+void ConfigInstance::wait_for_refresh() const { impl_->wait_for_refresh(); }
+
 const miru::params::Parameter& ConfigInstance::root_parameter() const {
   return impl_->root_parameter();
 }
 
+std::shared_ptr<const miru::params::Parameter> ConfigInstance::shared_root_parameter(
+) const {
+  return impl_->shared_root_parameter();
+}
+
+std::shared_ptr<const miru::params::Parameter> ConfigInstance::shared_parameter(
+  const miru::params::Parameter& parameter
+) const {
+  return impl_->shared_parameter(parameter);
+}
+
+std::shared_ptr<const miru::params::LazyParameterTree> ConfigInstance::lazy_parameters(
+) const {
+  return impl_->lazy_parameters();
+}
+
+std::shared_ptr<const MappedSnapshot> ConfigInstance::mapped_snapshot() const {
+  return impl_->mapped_snapshot();
+}
+
+std::shared_ptr<const miru::query::ParamIndex> ConfigInstance::param_index() const {
+  return impl_->param_index();
+}
+
+void ConfigInstance::enable_query_cache(size_t capacity) {
+  query_cache_ = std::make_unique<miru::query::QueryCache>(capacity);
+}
+
+void ConfigInstance::disable_query_cache() { query_cache_.reset(); }
+
+miru::query::QueryCacheStats ConfigInstance::query_cache_stats() const {
+  if (!query_cache_) {
+    return miru::query::QueryCacheStats();
+  }
+  return query_cache_->stats();
+}
+
 }  // namespace miru::config
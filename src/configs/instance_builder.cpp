@@ -37,13 +37,53 @@ ConfigInstanceBuilder& ConfigInstanceBuilder::with_source(
 ConfigInstanceBuilder& ConfigInstanceBuilder::with_data(
   const miru::params::Parameter& data
 ) {
-  if (data_.has_value()) {
+  if (has_data()) {
     throw std::runtime_error("Data already set");
   }
   data_ = data;
   return *this;
 }
 
+ConfigInstanceBuilder& ConfigInstanceBuilder::with_data(
+  miru::params::Parameter&& data
+) {
+  if (has_data()) {
+    throw std::runtime_error("Data already set");
+  }
+  data_ = std::move(data);
+  return *this;
+}
+
+ConfigInstanceBuilder& ConfigInstanceBuilder::with_shared_data(
+  std::shared_ptr<const miru::params::Parameter> data
+) {
+  if (has_data()) {
+    throw std::runtime_error("Data already set");
+  }
+  shared_data_ = std::move(data);
+  return *this;
+}
+
+ConfigInstanceBuilder& ConfigInstanceBuilder::with_lazy_data(
+  std::shared_ptr<const miru::params::LazyParameterTree> lazy_data
+) {
+  if (has_data()) {
+    throw std::runtime_error("Data already set");
+  }
+  lazy_data_ = std::move(lazy_data);
+  return *this;
+}
+
+ConfigInstanceBuilder& ConfigInstanceBuilder::with_mapped_data(
+  std::shared_ptr<const miru::config::MappedSnapshot> mapped_data
+) {
+  if (has_data()) {
+    throw std::runtime_error("Data already set");
+  }
+  mapped_data_ = std::move(mapped_data);
+  return *this;
+}
+
 ConfigInstanceBuilder& ConfigInstanceBuilder::with_config_schema_digest(
   const std::string& config_schema_digest
 ) {
@@ -74,7 +114,7 @@ ConfigInstanceImpl ConfigInstanceBuilder::build() {
   if (!source_.has_value()) {
     throw std::runtime_error("Source not set");
   }
-  if (!data_.has_value()) {
+  if (!has_data()) {
     throw std::runtime_error("Data not set");
   }
   if (source_ == miru::config::ConfigInstanceSource::Agent &&
@@ -97,7 +137,11 @@ ConfigInstanceImpl ConfigInstanceBuilder::build() {
     config_schema_file_.value(),
     config_type_slug_.value(),
     source_.value(),
-    data_.value(),
+    data_.has_value()
+      ? std::make_shared<const miru::params::Parameter>(std::move(*data_))
+      : shared_data_,
+    lazy_data_,
+    mapped_data_,
     config_schema_digest_,
     config_instance_file_
   );
@@ -1,6 +1,7 @@
 #pragma once
 
 // std
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -8,6 +9,8 @@
 #include <configs/instance_impl.hpp>
 #include <filesys/file.hpp>
 #include <miru/configs/instance.hpp>
+#include <miru/configs/mapped_snapshot.hpp>
+#include <miru/params/lazy.hpp>
 #include <miru/params/parameter.hpp>
 
 namespace miru::config {
@@ -19,6 +22,17 @@ class ConfigInstanceBuilder {
   ConfigInstanceBuilder& with_config_type_slug(const std::string& config_type_slug);
   ConfigInstanceBuilder& with_source(miru::config::ConfigInstanceSource source);
   ConfigInstanceBuilder& with_data(const miru::params::Parameter& data);
+  ConfigInstanceBuilder& with_data(miru::params::Parameter&& data);
+  // shares a parameter tree with other config instances instead of copying it
+  ConfigInstanceBuilder& with_shared_data(
+    std::shared_ptr<const miru::params::Parameter> data
+  );
+  ConfigInstanceBuilder& with_lazy_data(
+    std::shared_ptr<const miru::params::LazyParameterTree> lazy_data
+  );
+  ConfigInstanceBuilder& with_mapped_data(
+    std::shared_ptr<const miru::config::MappedSnapshot> mapped_data
+  );
   ConfigInstanceBuilder& with_config_schema_digest(const std::string& schema_digest);
   ConfigInstanceBuilder& with_config_instance_file(
     const miru::filesys::File& config_instance_file
@@ -26,11 +40,19 @@ class ConfigInstanceBuilder {
   ConfigInstanceImpl build();
 
  private:
+  bool has_data() const {
+    return data_.has_value() || shared_data_ || lazy_data_ || mapped_data_;
+  }
+
   // required
   std::optional<miru::filesys::File> config_schema_file_;
   std::optional<std::string> config_type_slug_;
   std::optional<miru::config::ConfigInstanceSource> source_;
+  // the parameters, their lazily built tree or the mapped snapshot they're built from
   std::optional<miru::params::Parameter> data_;
+  std::shared_ptr<const miru::params::Parameter> shared_data_;
+  std::shared_ptr<const miru::params::LazyParameterTree> lazy_data_;
+  std::shared_ptr<const miru::config::MappedSnapshot> mapped_data_;
 
   // only needed if sourcing from the agent
   std::optional<std::string> config_schema_digest_;
@@ -1,81 +1,300 @@
 // std
+#include <atomic>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <streambuf>
+#include <string>
 #include <thread>
+#include <vector>
 
 // internal
 #include <http/models/HashSchemaSerializedRequest.h>
 #include <http/models/HashSerializedConfigSchemaFormat.h>
 
+#include <configs/agent_cache.hpp>
 #include <configs/errors.hpp>
 #include <configs/instance_builder.hpp>
+#include <configs/load_cache.hpp>
+#include <configs/snapshot.hpp>
+#include <http/encoding.hpp>
 #include <http/socket_client.hpp>
 #include <miru/configs/instance.hpp>
+#include <miru/query/details/hash.hpp>
 #include <params/parse.hpp>
 
 namespace miru::config {
 
 namespace openapi = org::openapitools::server::model;
 
+// ============================= CONFIG TYPE SLUG ================================== //
+using CharTraits = std::char_traits<char>;
+
+bool is_json_whitespace(int c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+int next_non_whitespace(std::streambuf& buf) {
+  int c = buf.sbumpc();
+  while (is_json_whitespace(c)) {
+    c = buf.sbumpc();
+  }
+  return c;
+}
+
+// reads the rest of the json string whose opening quote was just consumed and returns
+// it decoded
+std::optional<std::string> read_json_string(std::streambuf& buf) {
+  std::string raw = "\"";
+  bool escaped = false;
+  while (true) {
+    int c = buf.sbumpc();
+    if (c == CharTraits::eof()) {
+      return std::nullopt;
+    }
+    raw.push_back(static_cast<char>(c));
+    if (c == '\\') {
+      escaped = true;
+      raw.push_back(static_cast<char>(buf.sbumpc()));
+    } else if (c == '"') {
+      break;
+    }
+  }
+  if (!escaped) {
+    return raw.substr(1, raw.size() - 2);
+  }
+  return nlohmann::json::parse(raw).get<std::string>();
+}
+
+// skips over the json value whose first character c was just consumed and returns the
+// first non whitespace character after it
+int skip_json_value(std::streambuf& buf, int c) {
+  if (c == '"') {
+    return read_json_string(buf) ? next_non_whitespace(buf) : CharTraits::eof();
+  }
+  if (c == '{' || c == '[') {
+    size_t depth = 1;
+    while (depth > 0) {
+      c = buf.sbumpc();
+      if (c == CharTraits::eof()) {
+        return c;
+      } else if (c == '"') {
+        if (!read_json_string(buf)) {
+          return CharTraits::eof();
+        }
+      } else if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == '}' || c == ']') {
+        depth--;
+      }
+    }
+    return next_non_whitespace(buf);
+  }
+  // numbers and literals end at the next delimiter
+  while (c != CharTraits::eof() && c != ',' && c != '}' && c != ']' &&
+         !is_json_whitespace(c)) {
+    c = buf.sbumpc();
+  }
+  return is_json_whitespace(c) ? next_non_whitespace(buf) : c;
+}
+
+std::optional<std::string> scan_json_config_type_slug(std::istream& stream) {
+  std::streambuf& buf = *stream.rdbuf();
+  try {
+    if (next_non_whitespace(buf) != '{') {
+      return std::nullopt;
+    }
+    int c = next_non_whitespace(buf);
+    while (c == '"') {
+      std::optional<std::string> key = read_json_string(buf);
+      if (!key || next_non_whitespace(buf) != ':') {
+        return std::nullopt;
+      }
+      c = next_non_whitespace(buf);
+      if (*key == MIRU_CONFIG_TYPE_SLUG_FIELD) {
+        if (c != '"') {
+          return std::nullopt;
+        }
+        return read_json_string(buf);
+      }
+      c = skip_json_value(buf, c);
+      if (c != ',') {
+        return std::nullopt;
+      }
+      c = next_non_whitespace(buf);
+    }
+  } catch (const nlohmann::json::exception&) {
+  }
+  return std::nullopt;
+}
+
+bool starts_with(const std::string& str, const std::string& prefix) {
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+// the position after the key if the line is the (plain or quoted) slug field key
+size_t yaml_slug_key_end(const std::string& line) {
+  for (const std::string& key : {
+         MIRU_CONFIG_TYPE_SLUG_FIELD,
+         "\"" + MIRU_CONFIG_TYPE_SLUG_FIELD + "\"",
+         "'" + MIRU_CONFIG_TYPE_SLUG_FIELD + "'",
+       }) {
+    if (starts_with(line, key)) {
+      size_t end = line.find_first_not_of(" \t", key.size());
+      if (end != std::string::npos && line[end] == ':') {
+        return end + 1;
+      }
+    }
+  }
+  return std::string::npos;
+}
+
+std::optional<std::string> scan_yaml_config_type_slug(std::istream& stream) {
+  // top level keys of a block style mapping are the only unindented lines, so only
+  // those are looked at
+  std::string line;
+  bool started = false;
+  while (std::getline(stream, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() || line[0] == ' ' || line[0] == '\t' || line[0] == '#') {
+      continue;
+    }
+    if (!started && (line[0] == '%' || line == "---")) {
+      started = line == "---";
+      continue;
+    }
+    started = true;
+    size_t key_end = yaml_slug_key_end(line);
+    if (key_end == std::string::npos) {
+      // flow style documents, sequences, complex keys and further documents
+      if (std::string("{[-?").find(line[0]) != std::string::npos ||
+          starts_with(line, "...")) {
+        return std::nullopt;
+      }
+      continue;
+    }
+
+    // block scalars, empty values and plain scalars continued on the next lines are
+    // left to the full parse
+    size_t value_begin = line.find_first_not_of(" \t", key_end);
+    if (value_begin == std::string::npos || line[value_begin] == '|' ||
+        line[value_begin] == '>' || line[value_begin] == '#') {
+      return std::nullopt;
+    }
+    std::string next_line;
+    while (std::getline(stream, next_line) &&
+           next_line.find_first_not_of(" \t\r") == std::string::npos) {
+    }
+    if (!next_line.empty() && (next_line[0] == ' ' || next_line[0] == '\t')) {
+      return std::nullopt;
+    }
+    try {
+      YAML::Node slug = YAML::Load(line)[MIRU_CONFIG_TYPE_SLUG_FIELD];
+      if (!slug.IsScalar()) {
+        return std::nullopt;
+      }
+      return slug.as<std::string>();
+    } catch (const YAML::Exception&) {
+      return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
 std::string read_schema_config_type_slug(const miru::filesys::File& schema_file) {
+  return read_schema_config_type_slug(miru::filesys::LoadedFile(schema_file));
+}
+
+std::string read_schema_config_type_slug(const miru::filesys::LoadedFile& schema_file
+) {
+  // the slug is scanned for among the top level keys of the schema without parsing
+  // the rest of it, falling back to parsing the whole schema if it isn't found (or
+  // isn't laid out as expected)
+  std::optional<std::string> scanned_slug;
+  miru::filesys::FileType file_type = schema_file.file_type();
+  if (file_type == miru::filesys::FileType::JSON ||
+      file_type == miru::filesys::FileType::YAML) {
+    miru::filesys::ViewStreamBuf buf(schema_file.bytes());
+    std::istream stream(&buf);
+    scanned_slug = file_type == miru::filesys::FileType::JSON
+                     ? scan_json_config_type_slug(stream)
+                     : scan_yaml_config_type_slug(stream);
+  }
+
   std::string config_type_slug;
-  switch (schema_file.file_type()) {
-    case miru::filesys::FileType::JSON: {
-      nlohmann::json json_schema_content = schema_file.read_json();
-      if (!json_schema_content.contains(MIRU_CONFIG_TYPE_SLUG_FIELD)) {
-        THROW_CONFIG_TYPE_SLUG_NOT_FOUND(schema_file);
+  if (scanned_slug) {
+    config_type_slug = *scanned_slug;
+  } else {
+    switch (file_type) {
+      case miru::filesys::FileType::JSON: {
+        const nlohmann::json& json_schema_content =
+          std::get<nlohmann::json>(schema_file.document());
+        if (!json_schema_content.contains(MIRU_CONFIG_TYPE_SLUG_FIELD)) {
+          THROW_CONFIG_TYPE_SLUG_NOT_FOUND(schema_file.file());
+        }
+        config_type_slug = json_schema_content[MIRU_CONFIG_TYPE_SLUG_FIELD];
+        break;
       }
-      config_type_slug = json_schema_content[MIRU_CONFIG_TYPE_SLUG_FIELD];
-      break;
-    }
-    case miru::filesys::FileType::YAML: {
-      YAML::Node yaml_schema_content = schema_file.read_yaml();
-      if (!yaml_schema_content[MIRU_CONFIG_TYPE_SLUG_FIELD]) {
-        THROW_CONFIG_TYPE_SLUG_NOT_FOUND(schema_file);
+      case miru::filesys::FileType::YAML: {
+        const YAML::Node& yaml_schema_content =
+          std::get<YAML::Node>(schema_file.document());
+        if (!yaml_schema_content[MIRU_CONFIG_TYPE_SLUG_FIELD]) {
+          THROW_CONFIG_TYPE_SLUG_NOT_FOUND(schema_file.file());
+        }
+        config_type_slug =
+          yaml_schema_content[MIRU_CONFIG_TYPE_SLUG_FIELD].as<std::string>();
+        break;
       }
-      config_type_slug =
-        yaml_schema_content[MIRU_CONFIG_TYPE_SLUG_FIELD].as<std::string>();
-      break;
+      default:
+        throw std::runtime_error("Unsupported schema file type");
     }
-    default:
-      throw std::runtime_error("Unsupported schema file type");
   }
   if (config_type_slug.empty()) {
-    THROW_EMPTY_CONFIG_TYPE_SLUG(schema_file);
+    THROW_EMPTY_CONFIG_TYPE_SLUG(schema_file.file());
   }
   return config_type_slug;
 }
 
-// ================================= FROM FILE ===================================== //
-ConfigInstanceImpl ConfigInstanceImpl::from_file(
-  const std::filesystem::path& schema_file_path,
-  const std::filesystem::path& instance_file_path
-) {
-  ConfigInstanceBuilder builder;
-  builder.with_source(miru::config::ConfigInstanceSource::FileSystem);
-
-  // read the config type slug from the schema file
-  miru::filesys::File schema_file(schema_file_path);
-  builder.with_config_schema_file(schema_file);
-  std::string config_type_slug = read_schema_config_type_slug(schema_file);
-  builder.with_config_type_slug(config_type_slug);
+std::shared_ptr<const miru::query::ParamIndex> ConfigInstanceImpl::param_index(
+) const {
+  std::shared_ptr<const miru::query::ParamIndex> index = std::atomic_load(&param_index_);
+  if (index) {
+    return index;
+  }
 
-  // read the config instance file
-  miru::filesys::File config_instance_file(instance_file_path);
-  builder.with_config_instance_file(config_instance_file);
-  builder.with_data(miru::params::parse_file(config_type_slug, config_instance_file));
+  // if multiple threads race to build the index the first one to finish wins and the
+  // others adopt its index
+  std::shared_ptr<const miru::query::ParamIndex> built =
+    std::make_shared<const miru::query::ParamIndex>(shared_root_parameter());
+  if (std::atomic_compare_exchange_strong(&param_index_, &index, built)) {
+    return built;
+  }
+  return index;
+}
 
-  // build the config instance
-  ConfigInstanceImpl config_instance = builder.build();
-  return config_instance;
+std::shared_ptr<const miru::params::Parameter> ConfigInstanceImpl::shared_parameter(
+  const miru::params::Parameter& parameter
+) const {
+  // aliasing constructor: owns the parameters, points at the parameter
+  if (lazy_parameters_) {
+    return std::shared_ptr<const miru::params::Parameter>(lazy_parameters_, &parameter);
+  }
+  if (mapped_snapshot_) {
+    return std::shared_ptr<const miru::params::Parameter>(mapped_snapshot_, &parameter);
+  }
+  return std::shared_ptr<const miru::params::Parameter>(parameters_, &parameter);
 }
 
+// ================================== SCHEMAS ====================================== //
 std::string hash_schema(
   const miru::http::AgentClientI& client,
-  const miru::filesys::File& schema_file
+  const miru::filesys::LoadedFile& schema_file
 ) {
   // determine the schema file type
-  miru::filesys::FileType schema_file_type = schema_file.file_type();
   openapi::HashSerializedConfigSchemaFormat format;
-  switch (schema_file_type) {
+  switch (schema_file.file_type()) {
     case miru::filesys::FileType::JSON: {
       format.value = openapi::HashSerializedConfigSchemaFormat::
         eHashSerializedConfigSchemaFormat::HASH_SERIALIZED_CONFIG_SCHEMA_FORMAT_JSON;
@@ -88,88 +307,388 @@ std::string hash_schema(
     }
     default: {
       std::vector<std::string> expected_file_types = {"json", "yaml"};
-      THROW_INVALID_CONFIG_SCHEMA_FILE_TYPE(schema_file, expected_file_types);
+      THROW_INVALID_CONFIG_SCHEMA_FILE_TYPE(schema_file.file(), expected_file_types);
     }
   }
 
-  std::vector<uint8_t> contents = schema_file.read_bytes();
-  std::string base64_contents = miru::utils::base64_encode(contents);
+  std::string base64_contents = miru::utils::base64_encode(schema_file.bytes());
   openapi::HashSchemaSerializedRequest config_schema{format, base64_contents};
   return client.hash_schema(config_schema);
 }
 
-nlohmann::json get_deployed_config_instance(
-  const miru::http::AgentClientI& client,
-  const std::string& config_schema_digest,
-  const std::string& config_type_slug
+LoadSchema::LoadSchema(const std::filesystem::path& path, bool use_load_cache)
+  : file_(path), hash_(0) {
+  std::shared_ptr<const CachedSchema> cached;
+  if (use_load_cache) {
+    key_ = file_key(path);
+    if (key_) {
+      cached = LoadCache::shared().find_schema(*key_);
+    }
+  }
+  if (cached) {
+    config_type_slug_ = cached->config_type_slug;
+    hash_ = cached->hash;
+    config_schema_digest_ = cached->config_schema_digest;
+    return;
+  }
+  const miru::filesys::LoadedFile& schema_file = loaded();
+  config_type_slug_ = read_schema_config_type_slug(schema_file);
+  hash_ = miru::query::details::fnv1a(schema_file.bytes());
+  cache();
+}
+
+std::string LoadSchema::digest(const miru::http::AgentClientI& client) {
+  if (!config_schema_digest_) {
+    config_schema_digest_ = hash_schema(client, loaded());
+    cache();
+  }
+  return *config_schema_digest_;
+}
+
+const miru::filesys::LoadedFile& LoadSchema::loaded() {
+  if (!loaded_) {
+    loaded_ = std::make_unique<const miru::filesys::LoadedFile>(file_);
+  }
+  return *loaded_;
+}
+
+void LoadSchema::cache() const {
+  // not cached if the file changed while it was read
+  if (key_ && file_key(file_.path()) == key_) {
+    LoadCache::shared().put_schema(
+      *key_,
+      std::make_shared<const CachedSchema>(
+        CachedSchema{config_type_slug_, hash_, config_schema_digest_}
+      )
+    );
+  }
+}
+
+// ================================= FROM FILE ===================================== //
+ConfigInstanceImpl from_file_impl(
+  const miru::filesys::File& schema_file,
+  const std::string& config_type_slug,
+  const std::filesystem::path& instance_file_path,
+  const miru::config::FromFileOptions& options
+) {
+  ConfigInstanceBuilder builder;
+  builder.with_source(miru::config::ConfigInstanceSource::FileSystem);
+  builder.with_config_schema_file(schema_file);
+  builder.with_config_type_slug(config_type_slug);
+  miru::filesys::File instance_file(instance_file_path);
+  builder.with_config_instance_file(instance_file);
+  bool lazy =
+    options.lazy && instance_file.file_type() == miru::filesys::FileType::JSON;
+
+  // reuse the parameter tree of the config instance file if it's unchanged
+  std::optional<FileKey> key;
+  std::shared_ptr<const CachedInstance> cached;
+  if (options.use_load_cache) {
+    key = file_key(instance_file_path);
+    if (key) {
+      cached = LoadCache::shared().find_instance(*key, config_type_slug, lazy);
+    }
+  }
+
+  std::shared_ptr<const miru::params::Parameter> parameters;
+  std::shared_ptr<const miru::params::LazyParameterTree> lazy_parameters;
+  if (cached) {
+    parameters = cached->parameters;
+    lazy_parameters = cached->lazy_parameters;
+  } else {
+    // read the config instance file
+    miru::filesys::LoadedFile loaded_instance_file(instance_file);
+    if (lazy) {
+      lazy_parameters = std::make_shared<const miru::params::LazyParameterTree>(
+        config_type_slug, std::string(loaded_instance_file.bytes())
+      );
+    } else if (options.parallel) {
+      parameters = std::make_shared<const miru::params::Parameter>(
+        miru::params::parse_file(
+          config_type_slug, loaded_instance_file, *options.parallel
+        )
+      );
+    } else {
+      parameters = std::make_shared<const miru::params::Parameter>(
+        miru::params::parse_file(config_type_slug, loaded_instance_file)
+      );
+    }
+    // not cached if the file changed while it was read
+    if (key && file_key(instance_file_path) == key) {
+      LoadCache::shared().put_instance(
+        *key,
+        lazy,
+        std::make_shared<const CachedInstance>(
+          CachedInstance{config_type_slug, parameters, lazy_parameters}
+        )
+      );
+    }
+  }
+  if (lazy_parameters) {
+    builder.with_lazy_data(std::move(lazy_parameters));
+  } else {
+    builder.with_shared_data(std::move(parameters));
+  }
+
+  // build the config instance
+  ConfigInstanceImpl config_instance = builder.build();
+  return config_instance;
+}
+
+ConfigInstanceImpl ConfigInstanceImpl::from_file(
+  const std::filesystem::path& schema_file_path,
+  const std::filesystem::path& instance_file_path,
+  const miru::config::FromFileOptions& options
 ) {
-  openapi::ConfigInstance config_instance;
-  config_instance = client.get_deployed_config_instance(
-    config_schema_digest, config_type_slug
+  // read the config type slug from the schema file
+  LoadSchema schema(schema_file_path, options.use_load_cache);
+  return from_file_impl(
+    schema.file(), schema.config_type_slug(), instance_file_path, options
+  );
+}
+
+miru::params::Parameter parse_config_instance_content(
+  const std::string& config_type_slug,
+  const miru::http::EncodedBody& config_instance
+) {
+  switch (config_instance.encoding) {
+    case miru::http::BodyEncoding::MSGPACK:
+      return miru::params::parse_msgpack_string_field(
+        config_type_slug, config_instance.body, CONFIG_INSTANCE_CONTENT_FIELD
+      );
+    case miru::http::BodyEncoding::CBOR:
+      return miru::params::parse_cbor_string_field(
+        config_type_slug, config_instance.body, CONFIG_INSTANCE_CONTENT_FIELD
+      );
+    case miru::http::BodyEncoding::JSON:
+      break;
+  }
+  return miru::params::parse_json_string_field(
+    config_type_slug, config_instance.body, CONFIG_INSTANCE_CONTENT_FIELD
   );
-  return config_instance.content;
+}
+
+bool AgentRefresh::State::sleep_unless_stopped(std::chrono::milliseconds delay) {
+  std::unique_lock<std::mutex> lock(mutex);
+  return !stopped.wait_for(lock, delay, [this]() { return stop; });
+}
+
+bool AgentRefresh::State::is_stopped() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stop;
+}
+
+AgentRefresh::AgentRefresh(std::function<void(State& state)> refresh)
+  : state_(std::make_shared<State>()) {
+  thread_ = std::thread([state = state_, refresh = std::move(refresh)]() {
+    std::exception_ptr error;
+    try {
+      refresh(*state);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->done = true;
+    state->error = error;
+    state->finished.notify_all();
+  });
+}
+
+AgentRefresh::~AgentRefresh() {
+  // the refresh can't join its own thread
+  if (thread_.get_id() == std::this_thread::get_id()) {
+    thread_.detach();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stop = true;
+  }
+  state_->stopped.notify_all();
+  thread_.join();
+}
+
+void AgentRefresh::wait() const {
+  if (thread_.get_id() == std::this_thread::get_id()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->finished.wait(lock, [this]() { return state_->done; });
+  if (state_->error) {
+    std::rethrow_exception(state_->error);
+  }
 }
 
 ConfigInstanceImpl from_agent_impl(
   const miru::http::AgentClientI& client,
-  const std::filesystem::path& schema_file_path,
+  LoadSchema& schema,
   const miru::config::FromAgentOptions& options
 ) {
   ConfigInstanceBuilder builder;
   builder.with_source(miru::config::ConfigInstanceSource::Agent);
-
-  // read the config type slug
-  miru::filesys::File schema_file(schema_file_path);
-  builder.with_config_schema_file(schema_file);
-  std::string config_type_slug = read_schema_config_type_slug(schema_file);
+  builder.with_config_schema_file(schema.file());
+  const std::string& config_type_slug = schema.config_type_slug();
   builder.with_config_type_slug(config_type_slug);
 
   // hash the schema contents to retrieve the schema digest
-  std::string config_schema_digest = hash_schema(client, schema_file);
+  std::string config_schema_digest = schema.digest(client);
   builder.with_config_schema_digest(config_schema_digest);
 
-  // load the config instance from the agent
-  nlohmann::json config_instance_data =
-    get_deployed_config_instance(client, config_schema_digest, config_type_slug);
-  builder.with_data(
-    miru::params::parse_json_node(config_type_slug, config_instance_data)
-  );
+  // load the config instance from the agent, building the parameters straight from
+  // the content of the response
+  if (options.lazy) {
+    std::string config_instance_json = client.get_deployed_config_instance_json(
+      config_schema_digest, config_type_slug
+    );
+    builder.with_lazy_data(std::make_shared<const miru::params::LazyParameterTree>(
+      config_type_slug, std::move(config_instance_json), CONFIG_INSTANCE_CONTENT_FIELD
+    ));
+  } else {
+    std::vector<miru::http::BodyEncoding> encodings = {miru::http::BodyEncoding::JSON};
+    if (options.binary_encodings) {
+      encodings = {
+        miru::http::BodyEncoding::MSGPACK,
+        miru::http::BodyEncoding::CBOR,
+        miru::http::BodyEncoding::JSON,
+      };
+    }
+    miru::http::EncodedBody config_instance =
+      client.get_deployed_config_instance_encoded(
+        config_schema_digest, config_type_slug, encodings
+      );
+    builder.with_data(parse_config_instance_content(config_type_slug, config_instance));
+  }
 
   // build the config instance
   ConfigInstanceImpl config_instance = builder.build();
   return config_instance;
 }
 
+// fetch the config instance from the agent (trying num_retries times), persisting it
+// in the cache if there is one. A background refresh gives up between attempts once
+// it's stopped.
+ConfigInstanceImpl fetch_from_agent(
+  const miru::http::AgentClientI& client,
+  LoadSchema& schema,
+  const miru::config::FromAgentOptions& options,
+  const AgentCache* cache,
+  AgentRefresh::State* refresh = nullptr
+) {
+  std::exception_ptr last_from_agent_error;
+  for (uint32_t attempt = 1; attempt <= options.num_retries; attempt++) {
+    if (refresh && refresh->is_stopped()) {
+      break;
+    }
+    try {
+      ConfigInstanceImpl config_instance = from_agent_impl(client, schema, options);
+      if (cache) {
+        cache->store(config_instance);
+      }
+      return config_instance;
+    } catch (const std::exception&) {
+      last_from_agent_error = std::current_exception();
+    }
+    // sleep between retries
+    if (attempt < options.num_retries) {
+      if (refresh == nullptr) {
+        std::this_thread::sleep_for(options.retry_delay);
+      } else if (!refresh->sleep_unless_stopped(options.retry_delay)) {
+        break;
+      }
+    }
+  }
+  if (!last_from_agent_error) {
+    throw std::runtime_error("The refresh from the agent was stopped");
+  }
+  std::rethrow_exception(last_from_agent_error);
+}
+
 ConfigInstanceImpl ConfigInstanceImpl::from_agent(
   const miru::http::AgentClientI& client,
   const std::filesystem::path& schema_file_path,
   const miru::config::FromAgentOptions& options
+) {
+  // the config instance waits for its background refresh when it's destroyed so the
+  // client only needs to outlive the config instance
+  return from_agent(
+    std::shared_ptr<const miru::http::AgentClientI>(std::shared_ptr<void>(), &client),
+    schema_file_path,
+    options
+  );
+}
+
+ConfigInstanceImpl ConfigInstanceImpl::from_agent(
+  std::shared_ptr<const miru::http::AgentClientI> client,
+  const std::filesystem::path& schema_file_path,
+  const miru::config::FromAgentOptions& options
 ) {
   if (options.num_retries == 0) {
     THROW_FROM_AGENT_OPTIONS_ERROR("Number of retries must be greater than 0");
   }
+  // the schema is read (and its slug found) once for every attempt, the cache and the
+  // default config instance (shared with the background refresh if there is one)
+  auto schema = std::make_shared<LoadSchema>(schema_file_path, options.use_load_cache);
+
+  std::optional<AgentCache> cache;
+  if (options.cache_dir.has_value()) {
+    cache.emplace(
+      options.cache_dir.value(), schema->config_type_slug(), schema->hash()
+    );
+  }
+
+  // serve the cached config instance without waiting for the agent
+  if (cache && options.cache_policy == AgentCachePolicy::CachedThenRefresh) {
+    std::optional<ConfigInstanceImpl> cached = cache->load(options.lazy);
+    if (cached) {
+      // refreshed on a dedicated thread rather than the shared pool since it mostly
+      // waits on the agent (and sleeps between retries)
+      auto refresh = [=, cache = *cache](AgentRefresh::State& state) {
+        ConfigInstanceImpl refreshed =
+          fetch_from_agent(*client, *schema, options, &cache, &state);
+        if (options.on_refresh) {
+          options.on_refresh(
+            ConfigInstance(std::make_unique<ConfigInstanceImpl>(std::move(refreshed)))
+          );
+        }
+      };
+      cached->from_agent_cache_ = true;
+      cached->refresh_ = std::make_shared<const AgentRefresh>(std::move(refresh));
+      return std::move(*cached);
+    }
+  }
 
   // attempt to load the config instance from the agent for the number of retries
   std::exception_ptr last_from_agent_error;
   std::string last_from_agent_error_msg;
-  for (uint32_t attempt = 1; attempt <= options.num_retries; attempt++) {
-    try {
-      return from_agent_impl(client, schema_file_path, options);
-    } catch (const std::exception& from_agent_error) {
-      last_from_agent_error = std::current_exception();
-      last_from_agent_error_msg = from_agent_error.what();
-    }
-    // sleep between retries
-    if (attempt < options.num_retries) {
-      std::this_thread::sleep_for(options.retry_delay);
+  try {
+    const AgentCache* agent_cache = cache ? &cache.value() : nullptr;
+    return fetch_from_agent(*client, *schema, options, agent_cache);
+  } catch (const std::exception& from_agent_error) {
+    last_from_agent_error = std::current_exception();
+    last_from_agent_error_msg = from_agent_error.what();
+  }
+
+  // loading from the agent failed, try the config instance last fetched from the agent
+  if (cache) {
+    std::optional<ConfigInstanceImpl> cached = cache->load(options.lazy);
+    if (cached) {
+      cached->from_agent_cache_ = true;
+      return std::move(*cached);
     }
   }
 
-  // loading from the agent failed, try loading the default config instance from the
-  // file system
+  // then the default config instance from the file system
   if (options.default_instance_file_path.has_value()) {
     try {
-      return from_file(schema_file_path, options.default_instance_file_path.value());
+      miru::config::FromFileOptions file_options;
+      file_options.lazy = options.lazy;
+      file_options.use_load_cache = options.use_load_cache;
+      return from_file_impl(
+        schema->file(),
+        schema->config_type_slug(),
+        options.default_instance_file_path.value(),
+        file_options
+      );
     } catch (const std::exception& from_default_file_error) {
       THROW_GET_DEPLOYED_CONFIG_INSTANCE_ERROR(
         last_from_agent_error_msg,
@@ -189,8 +708,63 @@ ConfigInstanceImpl ConfigInstanceImpl::from_agent(
   const std::filesystem::path& schema_file_path,
   const miru::config::FromAgentOptions& options
 ) {
-  miru::http::UnixSocketClient client;
-  return from_agent_impl(client, schema_file_path, options);
+  // retried (and falling back) like any other client
+  return from_agent(
+    std::make_shared<const miru::http::UnixSocketClient>(), schema_file_path, options
+  );
+}
+
+// ================================== SNAPSHOTS ==================================== //
+void ConfigInstanceImpl::save_snapshot(const std::filesystem::path& path) const {
+  SnapshotMetadata metadata;
+  metadata.config_type_slug = config_type_slug_;
+  metadata.source = source_;
+  metadata.config_schema_file = config_schema_file_.path();
+  metadata.config_schema_digest = config_schema_digest_;
+  if (config_instance_file_) {
+    metadata.config_instance_file = config_instance_file_->path();
+  }
+  write_snapshot(path, metadata, root_parameter());
+}
+
+ConfigInstanceImpl ConfigInstanceImpl::from_snapshot(
+  const std::filesystem::path& path,
+  const miru::config::FromSnapshotOptions& options
+) {
+  ConfigInstanceBuilder builder;
+  SnapshotMetadata metadata;
+  if (options.mapped) {
+    auto mapped = std::make_shared<const MappedSnapshot>(path, options.verify_checksum);
+    metadata.config_type_slug = mapped->config_type_slug();
+    metadata.source = mapped->source();
+    metadata.config_schema_file = mapped->config_schema_file();
+    if (std::optional<std::string_view> digest = mapped->config_schema_digest()) {
+      metadata.config_schema_digest = std::string(*digest);
+    }
+    if (std::optional<std::string_view> file = mapped->config_instance_file()) {
+      metadata.config_instance_file = *file;
+    }
+    builder.with_mapped_data(std::move(mapped));
+  } else {
+    Snapshot snapshot = read_snapshot(path);
+    metadata = std::move(snapshot.metadata);
+    builder.with_data(std::move(snapshot.root));
+  }
+
+  // the config instance is rebuilt as it was saved without reading its schema (or
+  // config instance) file
+  builder.with_source(metadata.source);
+  builder.with_config_schema_file(miru::filesys::File(metadata.config_schema_file));
+  builder.with_config_type_slug(metadata.config_type_slug);
+  if (metadata.config_schema_digest) {
+    builder.with_config_schema_digest(*metadata.config_schema_digest);
+  }
+  if (metadata.config_instance_file) {
+    builder.with_config_instance_file(
+      miru::filesys::File(*metadata.config_instance_file)
+    );
+  }
+  return builder.build();
 }
 
-}  // namespace miru::config
\ No newline at end of file
+}  // namespace miru::config
@@ -1,21 +1,73 @@
 #pragma once
 
 // std
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 
 // internal
+#include <configs/load_cache.hpp>
 #include <filesys/file.hpp>
 #include <http/client.hpp>
 #include <miru/configs/instance.hpp>
+#include <miru/configs/mapped_snapshot.hpp>
+#include <miru/params/lazy.hpp>
 #include <miru/params/parameter.hpp>
+#include <miru/query/index.hpp>
 
 namespace miru::config {
 
 const std::string MIRU_CONFIG_TYPE_SLUG_FIELD = "$miru_config_type_slug";
+const std::string CONFIG_INSTANCE_CONTENT_FIELD = "content";
 
 std::ostream& operator<<(std::ostream& os, const ConfigInstanceSource& source);
 
+// The background refresh of a config instance served from the agent cache (see
+// AgentCachePolicy::CachedThenRefresh). The refresh runs on a dedicated thread which
+// owns everything it needs, so the refresh is only waited on from other threads: when
+// the last copy of the config instance is destroyed by the refresh itself (e.g. by an
+// on_refresh callback replacing it with the refreshed config instance) the thread is
+// detached instead of joined.
+// Destroying the config instance from another thread stops the refresh between its
+// attempts, so it doesn't wait out the retries of an unreachable agent.
+class AgentRefresh {
+ public:
+  // shared with the refresh thread, which may outlive the refresh
+  struct State {
+    // sleeps for the delay, returning false as soon as the refresh is stopped
+    bool sleep_unless_stopped(std::chrono::milliseconds delay);
+    bool is_stopped();
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::condition_variable stopped;
+    bool done = false;
+    bool stop = false;
+    std::exception_ptr error;
+  };
+
+  explicit AgentRefresh(std::function<void(State& state)> refresh);
+  ~AgentRefresh();
+
+  AgentRefresh(const AgentRefresh&) = delete;
+  AgentRefresh& operator=(const AgentRefresh&) = delete;
+
+  // blocks until the refresh finishes, rethrowing its error if it failed (returns
+  // immediately when called from the refresh itself)
+  void wait() const;
+
+ private:
+  std::shared_ptr<State> state_;
+  std::thread thread_;
+};
+
 // Config class
 class ConfigInstanceImpl {
  public:
@@ -23,7 +75,8 @@ class ConfigInstanceImpl {
   // its schema will be read from the file system.
   static ConfigInstanceImpl from_file(
     const std::filesystem::path& cfg_sch_file_path,
-    const std::filesystem::path& cfg_inst_file_path
+    const std::filesystem::path& cfg_inst_file_path,
+    const miru::config::FromFileOptions& options = miru::config::FromFileOptions()
   );
 
   static ConfigInstanceImpl from_agent(
@@ -32,6 +85,14 @@ class ConfigInstanceImpl {
     const miru::config::FromAgentOptions& options = miru::config::FromAgentOptions()
   );
 
+  // the client is shared with the background refresh of a config instance served from
+  // the agent cache (see AgentCachePolicy::CachedThenRefresh)
+  static ConfigInstanceImpl from_agent(
+    std::shared_ptr<const miru::http::AgentClientI> client,
+    const std::filesystem::path& schema_file_path,
+    const miru::config::FromAgentOptions& options = miru::config::FromAgentOptions()
+  );
+
   // Initialize the config instance from the on-device agent. The config instance will
   // be retrieve from the agent while the the schema file is read from the file system.
   static ConfigInstanceImpl from_agent(
@@ -39,30 +100,83 @@ class ConfigInstanceImpl {
     const miru::config::FromAgentOptions& options = miru::config::FromAgentOptions()
   );
 
+  // Load a config instance saved with save_snapshot() (decoded entirely or mapped).
+  // Its schema (and config instance) files aren't read.
+  static ConfigInstanceImpl from_snapshot(
+    const std::filesystem::path& path,
+    const miru::config::FromSnapshotOptions& options =
+      miru::config::FromSnapshotOptions()
+  );
+
+  // Save the parameter tree (built entirely if loaded lazily) and metadata of the
+  // config instance as a binary snapshot (see configs/snapshot.hpp).
+  void save_snapshot(const std::filesystem::path& path) const;
+
   const miru::config::ConfigInstanceSource get_source() const { return source_; }
-  const miru::params::Parameter& root_parameter() const { return parameters_; }
+  bool from_agent_cache() const { return from_agent_cache_; }
+  void wait_for_refresh() const {
+    if (refresh_) {
+      refresh_->wait();
+    }
+  }
+  const miru::params::Parameter& root_parameter() const {
+    if (lazy_parameters_) {
+      return lazy_parameters_->root();
+    }
+    return mapped_snapshot_ ? mapped_snapshot_->root() : *parameters_;
+  }
+  std::shared_ptr<const miru::params::Parameter> shared_root_parameter() const {
+    return shared_parameter(root_parameter());
+  }
+  std::shared_ptr<const miru::params::Parameter> shared_parameter(
+    const miru::params::Parameter& parameter
+  ) const;
+  const std::shared_ptr<const miru::params::LazyParameterTree>& lazy_parameters(
+  ) const {
+    return lazy_parameters_;
+  }
+  const std::shared_ptr<const miru::config::MappedSnapshot>& mapped_snapshot() const {
+    return mapped_snapshot_;
+  }
+  std::shared_ptr<const miru::query::ParamIndex> param_index() const;
 
  private:
+  // exactly one of parameters, lazy_parameters and mapped_snapshot is set
   ConfigInstanceImpl(
     const miru::filesys::File& config_schema_file,
     const std::string& config_type_slug,
     miru::config::ConfigInstanceSource source,
-    const miru::params::Parameter& parameters,
+    std::shared_ptr<const miru::params::Parameter> parameters,
+    std::shared_ptr<const miru::params::LazyParameterTree> lazy_parameters,
+    std::shared_ptr<const miru::config::MappedSnapshot> mapped_snapshot,
     const std::optional<std::string>& config_schema_digest,
     const std::optional<miru::filesys::File>& config_instance_file
   )
     : config_schema_file_(config_schema_file),
       config_type_slug_(config_type_slug),
       source_(source),
-      parameters_(parameters),
+      parameters_(std::move(parameters)),
+      lazy_parameters_(std::move(lazy_parameters)),
+      mapped_snapshot_(std::move(mapped_snapshot)),
       config_schema_digest_(config_schema_digest),
-      config_instance_file_(config_instance_file) {}
+      config_instance_file_(config_instance_file),
+      from_agent_cache_(false) {}
 
   // required
   miru::filesys::File config_schema_file_;
   std::string config_type_slug_;
   miru::config::ConfigInstanceSource source_;
-  miru::params::Parameter parameters_;
+  // the parameter tree is immutable so it is shared (not copied) between copies of the
+  // config instance and the indexes / handles built over it
+  std::shared_ptr<const miru::params::Parameter> parameters_;
+  // set instead of the parameters when loading lazily (see FromFileOptions::lazy)
+  std::shared_ptr<const miru::params::LazyParameterTree> lazy_parameters_;
+  // set instead of the parameters when a snapshot is mapped (see
+  // FromSnapshotOptions::mapped)
+  std::shared_ptr<const miru::config::MappedSnapshot> mapped_snapshot_;
+
+  // lazily built (see param_index())
+  mutable std::shared_ptr<const miru::query::ParamIndex> param_index_;
 
   // only needed if sourcing from the agent
   std::optional<std::string> config_schema_digest_;
@@ -70,10 +184,51 @@ class ConfigInstanceImpl {
   // only needed if sourcing from the file system
   std::optional<miru::filesys::File> config_instance_file_;
 
+  // set when served from the agent cache (see FromAgentOptions::cache_dir), along with
+  // the background refresh from the agent if there is one
+  bool from_agent_cache_;
+  std::shared_ptr<const AgentRefresh> refresh_;
+
   // friends
   friend class ConfigInstanceBuilder;
 };
 
+// scan the top level keys of a json / yaml schema for the config type slug, stopping
+// as soon as it's found (nullopt if it isn't found or the schema isn't laid out as
+// expected, in which case the whole schema must be parsed)
+std::optional<std::string> scan_json_config_type_slug(std::istream& stream);
+std::optional<std::string> scan_yaml_config_type_slug(std::istream& stream);
+
 std::string read_schema_config_type_slug(const miru::filesys::File& schema_file);
+// reuses the bytes of the loaded schema (and its document if it has to be parsed)
+std::string read_schema_config_type_slug(const miru::filesys::LoadedFile& schema_file);
+
+// The schema file of a load. It's read (and its slug found) at most once and not at
+// all if the load cache (see FromFileOptions::use_load_cache) has what the load needs.
+// Not thread safe: it's shared with the background refresh of a load, which never
+// runs at the same time as the load itself.
+class LoadSchema {
+ public:
+  LoadSchema(const std::filesystem::path& path, bool use_load_cache);
+
+  const miru::filesys::File& file() const { return file_; }
+  const std::string& config_type_slug() const { return config_type_slug_; }
+  // the fnv1a hash of the contents of the schema
+  uint64_t hash() const { return hash_; }
+  // the digest of the schema computed by the agent (once per load / cached schema)
+  std::string digest(const miru::http::AgentClientI& client);
+
+ private:
+  const miru::filesys::LoadedFile& loaded();
+  void cache() const;
+
+  miru::filesys::File file_;
+  // only set when using the load cache
+  std::optional<FileKey> key_;
+  std::unique_ptr<const miru::filesys::LoadedFile> loaded_;
+  std::string config_type_slug_;
+  uint64_t hash_;
+  std::optional<std::string> config_schema_digest_;
+};
 
 }  // namespace miru::config
\ No newline at end of file
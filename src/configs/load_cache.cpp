@@ -0,0 +1,117 @@
+// std
+#include <string>
+
+// unix
+#include <sys/stat.h>
+
+// internal
+#include <configs/load_cache.hpp>
+
+namespace miru::config {
+
+// ================================== LOAD CACHE =================================== //
+std::string to_string(const LoadCacheStats& stats) {
+  return "LoadCacheStats{hits: " + std::to_string(stats.hits) +
+         ", misses: " + std::to_string(stats.misses) +
+         ", schemas: " + std::to_string(stats.schemas) +
+         ", instances: " + std::to_string(stats.instances) + "}";
+}
+
+LoadCacheStats load_cache_stats() { return LoadCache::shared().stats(); }
+
+void clear_load_cache() { LoadCache::shared().clear(); }
+
+std::optional<FileKey> file_key(const std::filesystem::path& path) {
+  // the path is made absolute without resolving it (which would cost a syscall per
+  // component), the inode tells files reached through different paths apart
+  std::error_code error;
+  std::filesystem::path absolute = std::filesystem::absolute(path, error);
+  if (error) {
+    return std::nullopt;
+  }
+  struct stat stats;
+  if (::stat(absolute.c_str(), &stats) != 0 || !S_ISREG(stats.st_mode)) {
+    return std::nullopt;
+  }
+  return FileKey{
+    absolute.lexically_normal().string(),
+    static_cast<uint64_t>(stats.st_dev),
+    static_cast<uint64_t>(stats.st_ino),
+    static_cast<int64_t>(stats.st_mtim.tv_sec) * 1000000000 + stats.st_mtim.tv_nsec,
+    static_cast<int64_t>(stats.st_size),
+  };
+}
+
+LoadCache& LoadCache::shared() {
+  static LoadCache cache;
+  return cache;
+}
+
+std::shared_ptr<const CachedSchema> LoadCache::find_schema(const FileKey& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = schemas_.find(key.path);
+  if (it == schemas_.end() || it->second.key != key) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  return it->second.value;
+}
+
+void LoadCache::put_schema(
+  const FileKey& key,
+  std::shared_ptr<const CachedSchema> schema
+) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  schemas_[key.path] = Entry<CachedSchema>{key, std::move(schema)};
+}
+
+std::string instance_entry_name(const FileKey& key, bool lazy) {
+  return (lazy ? "lazy:" : "eager:") + key.path;
+}
+
+std::shared_ptr<const CachedInstance> LoadCache::find_instance(
+  const FileKey& key,
+  const std::string& config_type_slug,
+  bool lazy
+) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = instances_.find(instance_entry_name(key, lazy));
+  if (it == instances_.end() || it->second.key != key ||
+      it->second.value->config_type_slug != config_type_slug) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  return it->second.value;
+}
+
+void LoadCache::put_instance(
+  const FileKey& key,
+  bool lazy,
+  std::shared_ptr<const CachedInstance> instance
+) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  instances_[instance_entry_name(key, lazy)] =
+    Entry<CachedInstance>{key, std::move(instance)};
+}
+
+void LoadCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  schemas_.clear();
+  instances_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+LoadCacheStats LoadCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LoadCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.schemas = schemas_.size();
+  stats.instances = instances_.size();
+  return stats;
+}
+
+}  // namespace miru::config
@@ -0,0 +1,93 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// internal
+#include <miru/configs/load_cache.hpp>
+#include <miru/params/lazy.hpp>
+#include <miru/params/parameter.hpp>
+
+namespace miru::config {
+
+// ================================== LOAD CACHE =================================== //
+// the version of a file a cache entry was loaded from
+struct FileKey {
+  std::string path;
+  uint64_t device;
+  uint64_t inode;
+  int64_t mtime_ns;
+  int64_t size;
+
+  bool operator==(const FileKey& other) const {
+    return path == other.path && device == other.device && inode == other.inode &&
+           mtime_ns == other.mtime_ns && size == other.size;
+  }
+  bool operator!=(const FileKey& other) const { return !(*this == other); }
+};
+
+// nullopt if the file can't be stat'ed (the load then reports why)
+std::optional<FileKey> file_key(const std::filesystem::path& path);
+
+struct CachedSchema {
+  std::string config_type_slug;
+  // the fnv1a hash of the contents of the schema
+  uint64_t hash;
+  // set once the agent has hashed the schema
+  std::optional<std::string> config_schema_digest;
+};
+
+// exactly one of the parameters and the lazy parameters is set
+struct CachedInstance {
+  std::string config_type_slug;
+  std::shared_ptr<const miru::params::Parameter> parameters;
+  std::shared_ptr<const miru::params::LazyParameterTree> lazy_parameters;
+};
+
+// Entries are immutable and replaced (rather than updated) so they can be handed out
+// without holding the lock. Callers key entries with the file key taken before reading
+// the file and only insert them if the file is unchanged after reading it.
+class LoadCache {
+ public:
+  static LoadCache& shared();
+
+  std::shared_ptr<const CachedSchema> find_schema(const FileKey& key);
+  void put_schema(const FileKey& key, std::shared_ptr<const CachedSchema> schema);
+
+  // config instances are parsed for a config type slug, either lazily or not
+  std::shared_ptr<const CachedInstance> find_instance(
+    const FileKey& key,
+    const std::string& config_type_slug,
+    bool lazy
+  );
+  void put_instance(
+    const FileKey& key,
+    bool lazy,
+    std::shared_ptr<const CachedInstance> instance
+  );
+
+  void clear();
+  LoadCacheStats stats() const;
+
+ private:
+  template <typename T>
+  struct Entry {
+    FileKey key;
+    std::shared_ptr<const T> value;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry<CachedSchema>> schemas_;
+  // keyed by the path and whether the config instance is lazily loaded
+  std::unordered_map<std::string, Entry<CachedInstance>> instances_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace miru::config
@@ -0,0 +1,332 @@
+// std
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// unix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// internal
+#include <configs/errors.hpp>
+#include <configs/snapshot.hpp>
+#include <filesys/file.hpp>
+#include <miru/configs/mapped_snapshot.hpp>
+#include <miru/params/details/errors.hpp>
+
+namespace miru::config {
+
+// ================================== NODE VIEWS =================================== //
+std::string_view StringArrayView::operator[](size_t i) const {
+  return decoder_->string(refs_[i]);
+}
+
+SnapshotNode SnapshotNodeView::node() const { return decoder_->node(index_); }
+
+void SnapshotNodeView::throw_invalid_type(miru::params::ParameterType expected) const {
+  THROW_INVALID_PARAMETER_TYPE(
+    std::string(key()),
+    "Expected a parameter of type '" + miru::params::to_string(expected) +
+      "' but the parameter is of type '" + miru::params::to_string(type()) + "'"
+  );
+}
+
+miru::params::ParameterType SnapshotNodeView::type() const {
+  return miru::params::ParameterType(node().type);
+}
+
+std::string_view SnapshotNodeView::key() const { return decoder_->string(node().key); }
+
+bool SnapshotNodeView::as_bool() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_BOOL) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_BOOL);
+  }
+  return node.a != 0;
+}
+
+int64_t SnapshotNodeView::as_int() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_INTEGER) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_INTEGER);
+  }
+  int64_t value;
+  std::memcpy(&value, &node.a, sizeof(value));
+  return value;
+}
+
+double SnapshotNodeView::as_double() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_DOUBLE) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_DOUBLE);
+  }
+  double value;
+  std::memcpy(&value, &node.a, sizeof(value));
+  return value;
+}
+
+std::string_view SnapshotNodeView::as_string() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_STRING &&
+      node.type != miru::params::ParameterType::PARAMETER_SCALAR) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_STRING);
+  }
+  return decoder_->string(SnapshotString{node.a, node.b});
+}
+
+ArrayView<uint8_t> SnapshotNodeView::as_bool_array() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_BOOL_ARRAY) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_BOOL_ARRAY);
+  }
+  return ArrayView<uint8_t>(decoder_->array_data<uint8_t>(node), node.b);
+}
+
+ArrayView<int64_t> SnapshotNodeView::as_integer_array() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_INTEGER_ARRAY) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_INTEGER_ARRAY);
+  }
+  return ArrayView<int64_t>(decoder_->array_data<int64_t>(node), node.b);
+}
+
+ArrayView<double> SnapshotNodeView::as_double_array() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_DOUBLE_ARRAY) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_DOUBLE_ARRAY);
+  }
+  return ArrayView<double>(decoder_->array_data<double>(node), node.b);
+}
+
+StringArrayView SnapshotNodeView::as_string_array() const {
+  SnapshotNode node = this->node();
+  if (node.type != miru::params::ParameterType::PARAMETER_STRING_ARRAY &&
+      node.type != miru::params::ParameterType::PARAMETER_SCALAR_ARRAY) {
+    throw_invalid_type(miru::params::ParameterType::PARAMETER_STRING_ARRAY);
+  }
+  return StringArrayView(decoder_, decoder_->array_data<SnapshotString>(node), node.b);
+}
+
+size_t SnapshotNodeView::num_children() const {
+  SnapshotNode node = this->node();
+  return is_container(miru::params::ParameterType(node.type)) ? node.b : 0;
+}
+
+SnapshotNodeView SnapshotNodeView::child(size_t i) const {
+  SnapshotNode node = this->node();
+  if (!is_container(miru::params::ParameterType(node.type)) || i >= node.b) {
+    throw std::out_of_range(
+      "Parameter '" + std::string(key()) + "' has no child " + std::to_string(i)
+    );
+  }
+  return SnapshotNodeView(decoder_, node.a + i);
+}
+
+std::optional<SnapshotNodeView> SnapshotNodeView::find_child(std::string_view key
+) const {
+  SnapshotNode node = this->node();
+  switch (node.type) {
+    case miru::params::ParameterType::PARAMETER_MAP: {
+      // the fields of maps are sorted by key
+      uint64_t first = node.a;
+      uint64_t last = node.a + node.b;
+      while (first < last) {
+        uint64_t mid = first + (last - first) / 2;
+        std::string_view mid_key = decoder_->string(decoder_->node(mid).key);
+        if (mid_key == key) {
+          return SnapshotNodeView(decoder_, mid);
+        }
+        if (mid_key < key) {
+          first = mid + 1;
+        } else {
+          last = mid;
+        }
+      }
+      return std::nullopt;
+    }
+    case miru::params::ParameterType::PARAMETER_MAP_ARRAY:
+    case miru::params::ParameterType::PARAMETER_NESTED_ARRAY: {
+      if (key.empty() || (key.size() > 1 && key[0] == '0')) {
+        return std::nullopt;
+      }
+      uint64_t index = 0;
+      for (char c : key) {
+        if (c < '0' || c > '9' || index > node.b) {
+          return std::nullopt;
+        }
+        index = index * 10 + (c - '0');
+      }
+      if (index >= node.b) {
+        return std::nullopt;
+      }
+      // the items of arrays are stored in index order
+      return SnapshotNodeView(decoder_, node.a + index);
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+// =============================== MAPPED SNAPSHOT ================================= //
+MappedSnapshot::MappedSnapshot(const std::filesystem::path& path, bool verify_checksum)
+  : path_(path), data_(nullptr), size_(0) {
+  miru::filesys::File(path).assert_exists();
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error(
+      "Failed to open snapshot '" + path.string() + "': " + std::strerror(errno)
+    );
+  }
+  struct stat stats;
+  if (::fstat(fd, &stats) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::runtime_error(
+      "Failed to stat snapshot '" + path.string() + "': " + std::strerror(error)
+    );
+  }
+  size_ = static_cast<size_t>(stats.st_size);
+  if (size_ < sizeof(SnapshotHeader)) {
+    ::close(fd);
+    THROW_INVALID_SNAPSHOT(path, "the file is too small");
+  }
+  // shared so every process mapping the snapshot shares its pages (the mapping stays
+  // valid once the file is closed)
+  void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  int error = errno;
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error(
+      "Failed to map snapshot '" + path.string() + "': " + std::strerror(error)
+    );
+  }
+  data_ = static_cast<const char*>(data);
+
+  try {
+    decoder_ = std::make_unique<SnapshotDecoder>(
+      path, std::string_view(data_, size_), verify_checksum
+    );
+  } catch (...) {
+    ::munmap(const_cast<char*>(data_), size_);
+    throw;
+  }
+}
+
+MappedSnapshot::~MappedSnapshot() {
+  // the parameters are built from copies so they don't need the mapping
+  ::munmap(const_cast<char*>(data_), size_);
+}
+
+size_t MappedSnapshot::num_nodes() const { return decoder_->header().num_nodes; }
+
+std::string_view MappedSnapshot::config_type_slug() const {
+  return decoder_->string(decoder_->header().config_type_slug);
+}
+
+ConfigInstanceSource MappedSnapshot::source() const {
+  return static_cast<ConfigInstanceSource>(decoder_->header().source);
+}
+
+std::string_view MappedSnapshot::config_schema_file() const {
+  return decoder_->string(decoder_->header().config_schema_file);
+}
+
+std::optional<std::string_view> MappedSnapshot::config_schema_digest() const {
+  if (!decoder_->header().has_config_schema_digest) {
+    return std::nullopt;
+  }
+  return decoder_->string(decoder_->header().config_schema_digest);
+}
+
+std::optional<std::string_view> MappedSnapshot::config_instance_file() const {
+  if (!decoder_->header().has_config_instance_file) {
+    return std::nullopt;
+  }
+  return decoder_->string(decoder_->header().config_instance_file);
+}
+
+SnapshotNodeView MappedSnapshot::root_node() const {
+  return SnapshotNodeView(decoder_.get(), 0);
+}
+
+std::optional<SnapshotNodeView> MappedSnapshot::find_node(std::string_view name) const {
+  SnapshotNodeView node = root_node();
+  std::string_view root_name = node.key();
+  if (name == root_name) {
+    return node;
+  }
+  size_t prefix_size = root_name.size() + miru::params::DELIMITER.size();
+  if (name.size() <= prefix_size || name.substr(0, root_name.size()) != root_name ||
+      name.substr(root_name.size(), miru::params::DELIMITER.size()) !=
+        miru::params::DELIMITER) {
+    return std::nullopt;
+  }
+
+  // walk down the node table one name segment at a time
+  size_t pos = prefix_size;
+  while (true) {
+    size_t next = name.find(miru::params::DELIMITER, pos);
+    std::string_view segment =
+      name.substr(pos, next == std::string_view::npos ? next : next - pos);
+    std::optional<SnapshotNodeView> child = node.find_child(segment);
+    if (!child || next == std::string_view::npos) {
+      return child;
+    }
+    node = *child;
+    pos = next + miru::params::DELIMITER.size();
+  }
+}
+
+size_t MappedSnapshot::num_materialized() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return slots_.size();
+}
+
+const miru::params::Parameter* MappedSnapshot::find(std::string_view name) const {
+  std::optional<uint64_t> index;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slots_.find(std::string(name));
+    if (it != slots_.end()) {
+      index = it->second->index;
+    }
+  }
+  if (!index) {
+    std::optional<SnapshotNodeView> node = find_node(name);
+    if (!node) {
+      return nullptr;
+    }
+    index = node->index();
+  }
+  return &materialize(name, *index);
+}
+
+const miru::params::Parameter& MappedSnapshot::root() const {
+  return materialize(root_node().key(), 0);
+}
+
+const miru::params::Parameter& MappedSnapshot::materialize(
+  std::string_view name,
+  uint64_t index
+) const {
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Slot>& entry = slots_[std::string(name)];
+    if (!entry) {
+      entry = std::make_unique<Slot>();
+      entry->index = index;
+    }
+    slot = entry.get();
+  }
+  // the parameter is built outside of the lock so lookups of other parameters aren't
+  // blocked while it's being built
+  std::call_once(slot->once, [&]() {
+    slot->parameter.emplace(decoder_->parameter(slot->index, std::string(name)));
+  });
+  return *slot->parameter;
+}
+
+}  // namespace miru::config
@@ -0,0 +1,531 @@
+// std
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// unix
+#include <sys/stat.h>
+#include <unistd.h>
+
+// internal
+#include <configs/errors.hpp>
+#include <configs/snapshot.hpp>
+#include <filesys/file.hpp>
+#include <miru/params/composite.hpp>
+#include <miru/query/details/hash.hpp>
+
+namespace miru::config {
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0);
+static_assert(sizeof(SnapshotNode) % 8 == 0);
+static_assert(
+  offsetof(SnapshotHeader, checksum) + 8 == offsetof(SnapshotHeader, file_size)
+);
+
+size_t align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+uint64_t snapshot_checksum(std::string_view bytes) {
+  return miru::query::details::fnv1a(bytes.substr(offsetof(SnapshotHeader, file_size)));
+}
+
+bool is_container(miru::params::ParameterType type) {
+  return type == miru::params::ParameterType::PARAMETER_MAP ||
+         type == miru::params::ParameterType::PARAMETER_MAP_ARRAY ||
+         type == miru::params::ParameterType::PARAMETER_NESTED_ARRAY;
+}
+
+// ================================== WRITING ====================================== //
+class SnapshotEncoder {
+ public:
+  // strings are deduplicated since the same keys repeat throughout most trees
+  SnapshotString string(const std::string& str) {
+    auto [it, inserted] = string_offsets_.try_emplace(str, strings_.size());
+    if (inserted) {
+      strings_ += str;
+    }
+    return SnapshotString{it->second, str.size()};
+  }
+
+  template <typename T>
+  uint64_t array(const T* elements, size_t count) {
+    uint64_t offset = arrays_.size();
+    arrays_.append(reinterpret_cast<const char*>(elements), count * sizeof(T));
+    arrays_.resize(align8(arrays_.size()), '\0');
+    return offset;
+  }
+
+  // adds the node of the parameter, queueing its children to be added after it
+  void node(
+    const miru::params::Parameter& param,
+    SnapshotString key,
+    std::vector<const miru::params::Parameter*>& queue
+  ) {
+    SnapshotNode node{};
+    node.type = param.get_type();
+    node.key = key;
+    switch (param.get_type()) {
+      case miru::params::ParameterType::PARAMETER_BOOL:
+        node.a = param.as_bool();
+        break;
+      case miru::params::ParameterType::PARAMETER_INTEGER: {
+        int64_t value = param.as_int();
+        std::memcpy(&node.a, &value, sizeof(value));
+        break;
+      }
+      case miru::params::ParameterType::PARAMETER_DOUBLE: {
+        double value = param.as_double();
+        std::memcpy(&node.a, &value, sizeof(value));
+        break;
+      }
+      case miru::params::ParameterType::PARAMETER_STRING:
+        set_string(node, string(param.as_string()));
+        break;
+      case miru::params::ParameterType::PARAMETER_SCALAR:
+        set_string(node, string(param.as_scalar().as_string()));
+        break;
+      case miru::params::ParameterType::PARAMETER_BOOL_ARRAY: {
+        const std::vector<bool>& values = param.as_bool_array();
+        std::vector<uint8_t> bytes(values.begin(), values.end());
+        node.a = array(bytes.data(), bytes.size());
+        node.b = bytes.size();
+        break;
+      }
+      case miru::params::ParameterType::PARAMETER_INTEGER_ARRAY: {
+        const std::vector<int64_t>& values = param.as_integer_array();
+        node.a = array(values.data(), values.size());
+        node.b = values.size();
+        break;
+      }
+      case miru::params::ParameterType::PARAMETER_DOUBLE_ARRAY: {
+        const std::vector<double>& values = param.as_double_array();
+        node.a = array(values.data(), values.size());
+        node.b = values.size();
+        break;
+      }
+      case miru::params::ParameterType::PARAMETER_STRING_ARRAY:
+        set_string_array(node, param.as_string_array());
+        break;
+      case miru::params::ParameterType::PARAMETER_SCALAR_ARRAY:
+        set_string_array(node, param.as_scalar_array());
+        break;
+      case miru::params::ParameterType::PARAMETER_MAP:
+        set_children(node, param.as_map(), queue);
+        break;
+      case miru::params::ParameterType::PARAMETER_MAP_ARRAY:
+        set_array_children(node, param.as_map_array(), queue);
+        break;
+      case miru::params::ParameterType::PARAMETER_NESTED_ARRAY:
+        set_array_children(node, param.as_nested_array(), queue);
+        break;
+      default:
+        break;
+    }
+    nodes_.push_back(node);
+  }
+
+  const std::vector<SnapshotNode>& nodes() const { return nodes_; }
+  const std::string& strings() const { return strings_; }
+  const std::string& arrays() const { return arrays_; }
+
+ private:
+  static void set_string(SnapshotNode& node, SnapshotString str) {
+    node.a = str.offset;
+    node.b = str.size;
+  }
+
+  template <typename StringT>
+  void set_string_array(SnapshotNode& node, const std::vector<StringT>& values) {
+    std::vector<SnapshotString> refs;
+    refs.reserve(values.size());
+    for (const StringT& value : values) {
+      if constexpr (std::is_same_v<StringT, miru::params::Scalar>) {
+        refs.push_back(string(value.as_string()));
+      } else {
+        refs.push_back(string(value));
+      }
+    }
+    node.a = array(refs.data(), refs.size());
+    node.b = refs.size();
+  }
+
+  // breadth first order places the children of a node right after the children of
+  // the nodes before it
+  template <typename ContainerT>
+  void set_children(
+    SnapshotNode& node,
+    const ContainerT& container,
+    std::vector<const miru::params::Parameter*>& queue
+  ) {
+    node.a = queue.size();
+    node.b = container.size();
+    for (const miru::params::Parameter& child : container) {
+      queue.push_back(&child);
+    }
+  }
+
+  // arrays iterate their items by name ("10" before "2") but the items are stored in
+  // index order so they can be found by index and rebuilt into their arrays
+  template <typename ArrayT>
+  void set_array_children(
+    SnapshotNode& node,
+    const ArrayT& array,
+    std::vector<const miru::params::Parameter*>& queue
+  ) {
+    node.a = queue.size();
+    node.b = array.size();
+    queue.resize(queue.size() + array.size());
+    for (const miru::params::Parameter& item : array) {
+      queue[node.a + std::stoull(item.get_key())] = &item;
+    }
+  }
+
+  std::vector<SnapshotNode> nodes_;
+  std::string strings_;
+  std::unordered_map<std::string, uint64_t> string_offsets_;
+  std::string arrays_;
+};
+
+// The bytes are written to a uniquely named temporary file next to the path (so
+// concurrent writers never share one) and flushed to disk before the file is renamed
+// over the path. The temporary file is removed if anything fails.
+void write_file_atomically(const std::filesystem::path& path, std::string_view bytes) {
+  std::string tmp_path = path.string() + ".tmp.XXXXXX";
+  int fd = ::mkstemp(tmp_path.data());
+  if (fd < 0) {
+    throw std::runtime_error(
+      "Failed to create snapshot '" + tmp_path + "': " + std::strerror(errno)
+    );
+  }
+  // mkstemp only lets the owner read the file but snapshots are mapped by other
+  // processes too
+  int error = ::fchmod(fd, 0644) == 0 ? 0 : errno;
+  size_t written = 0;
+  while (error == 0 && written < bytes.size()) {
+    ssize_t size = ::write(fd, bytes.data() + written, bytes.size() - written);
+    if (size < 0) {
+      if (errno != EINTR) {
+        error = errno;
+      }
+      continue;
+    }
+    written += size;
+  }
+  if (error == 0 && ::fsync(fd) != 0) {
+    error = errno;
+  }
+  if (::close(fd) != 0 && error == 0) {
+    error = errno;
+  }
+  if (error == 0 && ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    error = errno;
+  }
+  if (error != 0) {
+    ::unlink(tmp_path.c_str());
+    throw std::runtime_error(
+      "Failed to write snapshot '" + path.string() + "': " + std::strerror(error)
+    );
+  }
+}
+
+void write_snapshot(
+  const std::filesystem::path& path,
+  const SnapshotMetadata& metadata,
+  const miru::params::Parameter& root
+) {
+  SnapshotEncoder encoder;
+  std::vector<const miru::params::Parameter*> queue = {&root};
+  // the root is named after the config type slug rather than keyed by its parent
+  encoder.node(root, encoder.string(root.get_name()), queue);
+  for (size_t i = 1; i < queue.size(); i++) {
+    encoder.node(*queue[i], encoder.string(queue[i]->get_key()), queue);
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.byte_order = SNAPSHOT_BYTE_ORDER;
+  header.source = static_cast<uint8_t>(metadata.source);
+  header.config_type_slug = encoder.string(metadata.config_type_slug);
+  header.config_schema_file = encoder.string(metadata.config_schema_file.string());
+  if (metadata.config_schema_digest) {
+    header.has_config_schema_digest = 1;
+    header.config_schema_digest = encoder.string(*metadata.config_schema_digest);
+  }
+  if (metadata.config_instance_file) {
+    header.has_config_instance_file = 1;
+    header.config_instance_file =
+      encoder.string(metadata.config_instance_file->string());
+  }
+  header.num_nodes = encoder.nodes().size();
+  header.nodes_offset = sizeof(SnapshotHeader);
+  header.strings_offset = header.nodes_offset + header.num_nodes * sizeof(SnapshotNode);
+  header.strings_size = encoder.strings().size();
+  header.arrays_offset = header.strings_offset + align8(header.strings_size);
+  header.arrays_size = encoder.arrays().size();
+  header.file_size = header.arrays_offset + header.arrays_size;
+
+  std::string bytes(header.file_size, '\0');
+  std::memcpy(
+    bytes.data() + header.nodes_offset,
+    encoder.nodes().data(),
+    header.num_nodes * sizeof(SnapshotNode)
+  );
+  std::memcpy(
+    bytes.data() + header.strings_offset, encoder.strings().data(), header.strings_size
+  );
+  std::memcpy(
+    bytes.data() + header.arrays_offset, encoder.arrays().data(), header.arrays_size
+  );
+  std::memcpy(bytes.data(), &header, sizeof(header));
+  header.checksum = snapshot_checksum(bytes);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+
+  write_file_atomically(path, bytes);
+}
+
+// ================================== READING ====================================== //
+SnapshotDecoder::SnapshotDecoder(
+  const std::filesystem::path& path,
+  std::string_view bytes,
+  bool verify_checksum
+)
+  : path_(path), bytes_(bytes) {
+  validate_header(verify_checksum);
+  validate_tree();
+}
+
+void SnapshotDecoder::invalid(const std::string& reason) const {
+  THROW_INVALID_SNAPSHOT(path_, reason);
+}
+
+void SnapshotDecoder::validate_header(bool verify_checksum) {
+  if (bytes_.size() < sizeof(SnapshotHeader)) {
+    invalid("the file is too small");
+  }
+  std::memcpy(&header_, bytes_.data(), sizeof(header_));
+  if (std::memcmp(header_.magic, SNAPSHOT_MAGIC, sizeof(header_.magic)) != 0) {
+    invalid("the file isn't a snapshot");
+  }
+  if (header_.version != SNAPSHOT_VERSION) {
+    invalid(
+      "unsupported version " + std::to_string(header_.version) + " (expected " +
+      std::to_string(SNAPSHOT_VERSION) + ")"
+    );
+  }
+  if (header_.byte_order != SNAPSHOT_BYTE_ORDER) {
+    invalid("the snapshot was written on a machine with a different byte order");
+  }
+  if (header_.file_size != bytes_.size()) {
+    invalid("the file is truncated");
+  }
+  if (verify_checksum && header_.checksum != snapshot_checksum(bytes_)) {
+    invalid("checksum mismatch");
+  }
+  size_t max_nodes = (bytes_.size() - sizeof(SnapshotHeader)) / sizeof(SnapshotNode);
+  if (header_.nodes_offset != sizeof(SnapshotHeader) || header_.num_nodes == 0 ||
+      header_.num_nodes > max_nodes ||
+      header_.strings_offset !=
+        header_.nodes_offset + header_.num_nodes * sizeof(SnapshotNode) ||
+      header_.strings_size > bytes_.size() - header_.strings_offset ||
+      header_.arrays_offset !=
+        header_.strings_offset + align8(header_.strings_size) ||
+      header_.arrays_offset > bytes_.size() ||
+      header_.arrays_size != bytes_.size() - header_.arrays_offset) {
+    invalid("the sections are out of bounds");
+  }
+  if (header_.source > static_cast<uint8_t>(ConfigInstanceSource::FileSystem)) {
+    invalid("unknown config instance source");
+  }
+}
+
+// the children of the containers must be the consecutive ranges of nodes following
+// the root (in breadth first order) so every node is reached exactly once
+void SnapshotDecoder::validate_tree() const {
+  uint64_t num_nodes = header_.num_nodes;
+  uint64_t next_child = 1;
+  for (uint64_t i = 0; i < num_nodes; i++) {
+    SnapshotNode parent = node(i);
+    if (!is_container(miru::params::ParameterType(parent.type))) {
+      continue;
+    }
+    if (parent.a != next_child || parent.b > num_nodes - next_child) {
+      invalid("the node table isn't a tree");
+    }
+    next_child += parent.b;
+  }
+  if (next_child != num_nodes) {
+    invalid("the node table isn't a tree");
+  }
+}
+
+SnapshotMetadata SnapshotDecoder::metadata() const {
+  SnapshotMetadata metadata;
+  metadata.config_type_slug = string(header_.config_type_slug);
+  metadata.source = static_cast<ConfigInstanceSource>(header_.source);
+  metadata.config_schema_file = string(header_.config_schema_file);
+  if (header_.has_config_schema_digest) {
+    metadata.config_schema_digest = string(header_.config_schema_digest);
+  }
+  if (header_.has_config_instance_file) {
+    metadata.config_instance_file = string(header_.config_instance_file);
+  }
+  return metadata;
+}
+
+std::string_view SnapshotDecoder::string(SnapshotString str) const {
+  if (str.offset > header_.strings_size ||
+      str.size > header_.strings_size - str.offset) {
+    invalid("a string is out of bounds");
+  }
+  return bytes_.substr(header_.strings_offset + str.offset, str.size);
+}
+
+SnapshotNode SnapshotDecoder::node(uint64_t index) const {
+  SnapshotNode node;
+  std::memcpy(
+    &node,
+    bytes_.data() + header_.nodes_offset + index * sizeof(SnapshotNode),
+    sizeof(node)
+  );
+  return node;
+}
+
+miru::params::Parameter SnapshotDecoder::root() const {
+  return parameter(0, std::string(string(node(0).key)));
+}
+
+miru::params::Parameter SnapshotDecoder::parameter(uint64_t index, std::string name)
+  const {
+  // the nodes of the subtree in breadth first order (which for the root is the node
+  // table itself) with their names built top down
+  std::vector<uint64_t> order = {index};
+  std::vector<std::string> names;
+  names.push_back(std::move(name));
+  std::vector<size_t> first_child = {0};
+  for (size_t i = 0; i < order.size(); i++) {
+    SnapshotNode parent = node(order[i]);
+    if (!is_container(miru::params::ParameterType(parent.type))) {
+      continue;
+    }
+    first_child[i] = order.size();
+    for (uint64_t child = parent.a; child < parent.a + parent.b; child++) {
+      std::string_view key = string(node(child).key);
+      std::string child_name;
+      child_name.reserve(names[i].size() + miru::params::DELIMITER.size() + key.size());
+      child_name.append(names[i]).append(miru::params::DELIMITER).append(key);
+      order.push_back(child);
+      names.push_back(std::move(child_name));
+      first_child.push_back(0);
+    }
+  }
+
+  // and the parameters bottom up (children always come after their parent)
+  std::vector<miru::params::Parameter> params(order.size());
+  for (size_t i = order.size(); i-- > 0;) {
+    params[i] = value(node(order[i]), names[i], params, first_child[i]);
+  }
+  return std::move(params[0]);
+}
+
+std::vector<miru::params::Parameter> take_children(
+  std::vector<miru::params::Parameter>& params,
+  size_t first_child,
+  size_t num_children
+) {
+  auto first = params.begin() + first_child;
+  return std::vector<miru::params::Parameter>(
+    std::make_move_iterator(first), std::make_move_iterator(first + num_children)
+  );
+}
+
+miru::params::Parameter SnapshotDecoder::value(
+  const SnapshotNode& node,
+  const std::string& name,
+  std::vector<miru::params::Parameter>& params,
+  size_t first_child
+) const {
+  using ParameterType = miru::params::ParameterType;
+  using ParameterValue = miru::params::ParameterValue;
+  switch (node.type) {
+    case ParameterType::PARAMETER_NOT_SET:
+      return miru::params::Parameter(name);
+    case ParameterType::PARAMETER_NULL:
+      return miru::params::Parameter(name, nullptr);
+    case ParameterType::PARAMETER_BOOL:
+      return miru::params::Parameter(name, ParameterValue(node.a != 0));
+    case ParameterType::PARAMETER_INTEGER: {
+      int64_t value;
+      std::memcpy(&value, &node.a, sizeof(value));
+      return miru::params::Parameter(name, ParameterValue(value));
+    }
+    case ParameterType::PARAMETER_DOUBLE: {
+      double value;
+      std::memcpy(&value, &node.a, sizeof(value));
+      return miru::params::Parameter(name, ParameterValue(value));
+    }
+    case ParameterType::PARAMETER_STRING:
+      return miru::params::Parameter(
+        name, ParameterValue(std::string(string(SnapshotString{node.a, node.b})))
+      );
+    case ParameterType::PARAMETER_SCALAR:
+      return miru::params::Parameter(
+        name, miru::params::Scalar(std::string(string(SnapshotString{node.a, node.b})))
+      );
+    case ParameterType::PARAMETER_BOOL_ARRAY: {
+      const uint8_t* data = array_data<uint8_t>(node);
+      return miru::params::Parameter(
+        name, ParameterValue(std::vector<bool>(data, data + node.b))
+      );
+    }
+    case ParameterType::PARAMETER_INTEGER_ARRAY:
+      return miru::params::Parameter(name, ParameterValue(array<int64_t>(node)));
+    case ParameterType::PARAMETER_DOUBLE_ARRAY:
+      return miru::params::Parameter(name, ParameterValue(array<double>(node)));
+    case ParameterType::PARAMETER_STRING_ARRAY: {
+      std::vector<std::string> values;
+      values.reserve(node.b);
+      const SnapshotString* strings = array_data<SnapshotString>(node);
+      for (uint64_t i = 0; i < node.b; i++) {
+        values.emplace_back(string(strings[i]));
+      }
+      return miru::params::Parameter(name, ParameterValue(std::move(values)));
+    }
+    case ParameterType::PARAMETER_SCALAR_ARRAY: {
+      std::vector<miru::params::Scalar> values;
+      values.reserve(node.b);
+      const SnapshotString* strings = array_data<SnapshotString>(node);
+      for (uint64_t i = 0; i < node.b; i++) {
+        values.emplace_back(std::string(string(strings[i])));
+      }
+      return miru::params::Parameter(name, ParameterValue(std::move(values)));
+    }
+    case ParameterType::PARAMETER_MAP:
+      return miru::params::Parameter(
+        name, miru::params::Map(take_children(params, first_child, node.b))
+      );
+    case ParameterType::PARAMETER_MAP_ARRAY:
+      return miru::params::Parameter(
+        name, miru::params::MapArray(take_children(params, first_child, node.b))
+      );
+    case ParameterType::PARAMETER_NESTED_ARRAY:
+      return miru::params::Parameter(
+        name, miru::params::NestedArray(take_children(params, first_child, node.b))
+      );
+  }
+  invalid("unknown parameter type " + std::to_string(node.type));
+}
+
+Snapshot read_snapshot(const std::filesystem::path& path) {
+  // snapshots are only ever replaced by renaming a new snapshot over them
+  miru::filesys::FileContents contents = miru::filesys::File(path).map_contents();
+  SnapshotDecoder decoder(path, contents.view());
+  return Snapshot{decoder.metadata(), decoder.root()};
+}
+
+}  // namespace miru::config
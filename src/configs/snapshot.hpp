@@ -0,0 +1,168 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// internal
+#include <miru/configs/instance.hpp>
+#include <miru/params/parameter.hpp>
+
+namespace miru::config {
+
+// ================================== SNAPSHOTS ==================================== //
+// A snapshot is the parsed parameter tree of a config instance (and what's needed to
+// rebuild the config instance around it) in a versioned, checksummed binary layout
+// which is loaded without parsing any json / yaml.
+//
+// Layout (native byte order, every section 8 byte aligned):
+//   header        SnapshotHeader (magic, version, byte order, checksum, offsets and
+//                 the metadata strings)
+//   node table    SnapshotNode[num_nodes] in breadth first order starting with the
+//                 root so the children of every map / array are a contiguous range
+//                 of nodes after their parent
+//   string arena  the (deduplicated) keys, string values and metadata strings
+//   array payload the elements of the bool (1 byte each), integer and double arrays
+//                 and the SnapshotStrings of the string / scalar arrays
+//
+// Nodes only hold their key, their names are rebuilt from the names of their parents.
+// The checksum is the fnv1a hash of everything after the checksum field.
+
+constexpr char SNAPSHOT_MAGIC[8] = {'M', 'I', 'R', 'U', 'S', 'N', 'A', 'P'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// a string in the string arena
+struct SnapshotString {
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t checksum;
+  uint64_t file_size;
+  uint64_t num_nodes;
+  uint64_t nodes_offset;
+  uint64_t strings_offset;
+  uint64_t strings_size;
+  uint64_t arrays_offset;
+  uint64_t arrays_size;
+  // metadata
+  uint8_t source;
+  uint8_t has_config_schema_digest;
+  uint8_t has_config_instance_file;
+  uint8_t reserved[5];
+  SnapshotString config_type_slug;
+  SnapshotString config_schema_digest;
+  SnapshotString config_schema_file;
+  SnapshotString config_instance_file;
+};
+
+// the value of a node depends on its type:
+//  - bool / integer / double: the bits of the value in `a`
+//  - string / scalar: a SnapshotString {a, b}
+//  - arrays of scalars: the offset of the elements in the array payload (a) and
+//    their number (b)
+//  - maps / map arrays / nested arrays: the index of the first child (a) and the
+//    number of children (b)
+struct SnapshotNode {
+  uint8_t type;
+  uint8_t reserved[7];
+  SnapshotString key;
+  uint64_t a;
+  uint64_t b;
+};
+
+struct SnapshotMetadata {
+  std::string config_type_slug;
+  ConfigInstanceSource source;
+  std::filesystem::path config_schema_file;
+  std::optional<std::string> config_schema_digest;
+  std::optional<std::filesystem::path> config_instance_file;
+};
+
+struct Snapshot {
+  SnapshotMetadata metadata;
+  miru::params::Parameter root;
+};
+
+// Writes the snapshot to a uniquely named temporary file next to the path which is
+// flushed to disk and then renamed over the path, so readers never see a partially
+// written snapshot and concurrent writers don't interfere.
+void write_snapshot(
+  const std::filesystem::path& path,
+  const SnapshotMetadata& metadata,
+  const miru::params::Parameter& root
+);
+
+bool is_container(miru::params::ParameterType type);
+
+// Validates and decodes the bytes of a snapshot (which must outlive the decoder). The
+// header, sections and the structure of the node table are validated up front, the
+// strings and arrays of nodes as they're read. Throws InvalidSnapshotError.
+class SnapshotDecoder {
+ public:
+  SnapshotDecoder(
+    const std::filesystem::path& path,
+    std::string_view bytes,
+    bool verify_checksum = true
+  );
+
+  const SnapshotHeader& header() const { return header_; }
+  SnapshotMetadata metadata() const;
+
+  std::string_view string(SnapshotString str) const;
+  // the index must be less than the number of nodes
+  SnapshotNode node(uint64_t index) const;
+
+  // a pointer to the elements of the array of the node (checked to be in bounds)
+  template <typename T>
+  const T* array_data(const SnapshotNode& node) const {
+    if (node.a > header_.arrays_size ||
+        node.b > (header_.arrays_size - node.a) / sizeof(T)) {
+      invalid("an array is out of bounds");
+    }
+    const char* data = bytes_.data() + header_.arrays_offset + node.a;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+      invalid("an array is misaligned");
+    }
+    return reinterpret_cast<const T*>(data);
+  }
+  template <typename T>
+  std::vector<T> array(const SnapshotNode& node) const {
+    const T* data = array_data<T>(node);
+    return std::vector<T>(data, data + node.b);
+  }
+
+  // builds the parameter of the node (and its entire subtree) with the given name
+  miru::params::Parameter parameter(uint64_t index, std::string name) const;
+  miru::params::Parameter root() const;
+
+  [[noreturn]] void invalid(const std::string& reason) const;
+
+ private:
+  void validate_header(bool verify_checksum);
+  void validate_tree() const;
+  miru::params::Parameter value(
+    const SnapshotNode& node,
+    const std::string& name,
+    std::vector<miru::params::Parameter>& params,
+    size_t first_child
+  ) const;
+
+  std::filesystem::path path_;
+  std::string_view bytes_;
+  SnapshotHeader header_;
+};
+
+// throws InvalidSnapshotError if the file isn't a valid snapshot of this version
+Snapshot read_snapshot(const std::filesystem::path& path);
+
+}  // namespace miru::config
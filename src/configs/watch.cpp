@@ -0,0 +1,299 @@
+// std
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+// unix
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// internal
+#include <configs/errors.hpp>
+#include <configs/watch.hpp>
+
+namespace miru::config {
+
+// ===================================== WATCH ===================================== //
+// the events of a watched directory which can change one of its files, including
+// the rename of a temporary file over it
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+ConfigWatcherImpl::ConfigWatcherImpl(
+  const std::filesystem::path& schema_file_path,
+  const std::filesystem::path& instance_file_path,
+  const WatchOptions& options
+)
+  : schema_file_path_(std::filesystem::absolute(schema_file_path).lexically_normal()),
+    instance_file_path_(
+      std::filesystem::absolute(instance_file_path).lexically_normal()
+    ),
+    options_(options),
+    inotify_fd_(-1),
+    stop_fd_(-1),
+    version_(0),
+    next_subscription_id_(0) {
+  try {
+    inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+      THROW_WATCH_ERROR(
+        instance_file_path_,
+        std::string("Failed to initialize inotify: ") + std::strerror(errno)
+      );
+    }
+    stop_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+      THROW_WATCH_ERROR(
+        instance_file_path_,
+        std::string("Failed to create eventfd: ") + std::strerror(errno)
+      );
+    }
+    // watched before the initial load so changes made while loading aren't missed
+    add_watch(schema_file_path_);
+    add_watch(instance_file_path_);
+    current_ = std::make_shared<const ConfigInstance>(ConfigInstance::from_file(
+      schema_file_path_, instance_file_path_, options_.file_options
+    ));
+  } catch (...) {
+    if (stop_fd_ >= 0) {
+      ::close(stop_fd_);
+    }
+    if (inotify_fd_ >= 0) {
+      ::close(inotify_fd_);
+    }
+    throw;
+  }
+  thread_ = std::thread([this]() { watch_loop(); });
+}
+
+ConfigWatcherImpl::~ConfigWatcherImpl() {
+  uint64_t stop = 1;
+  while (::write(stop_fd_, &stop, sizeof(stop)) < 0 && errno == EINTR) {
+  }
+  thread_.join();
+  ::close(stop_fd_);
+  ::close(inotify_fd_);
+}
+
+void ConfigWatcherImpl::add_watch(const std::filesystem::path& file_path) {
+  std::filesystem::path dir = file_path.parent_path();
+  int watch = ::inotify_add_watch(inotify_fd_, dir.c_str(), WATCH_MASK);
+  if (watch < 0) {
+    THROW_WATCH_ERROR(
+      file_path,
+      "Failed to watch directory '" + dir.string() + "': " + std::strerror(errno)
+    );
+  }
+  // both files may be in the same directory, which is then watched once
+  watches_[watch] = dir;
+}
+
+ConfigWatcherImpl::Wake ConfigWatcherImpl::wait_for_change(
+  std::optional<std::chrono::steady_clock::time_point> deadline
+) {
+  while (true) {
+    int timeout = -1;
+    if (deadline) {
+      auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        *deadline - std::chrono::steady_clock::now()
+      );
+      if (remaining.count() <= 0) {
+        return Wake::Quiet;
+      }
+      timeout = static_cast<int>(remaining.count());
+    }
+
+    pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {inotify_fd_, POLLIN, 0}};
+    int ready = ::poll(fds, 2, timeout);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // nothing sensible is left to do on the watch thread, stop watching
+      report_error(
+        std::string("Failed to poll for file changes: ") + std::strerror(errno)
+      );
+      return Wake::Stopped;
+    }
+    if (fds[0].revents) {
+      return Wake::Stopped;
+    }
+    // events of other files in the watched directories don't end the wait
+    if (fds[1].revents && read_events()) {
+      return Wake::Changed;
+    }
+  }
+}
+
+bool ConfigWatcherImpl::read_events() {
+  alignas(inotify_event) char buffer[4096];
+  bool changed = false;
+  while (true) {
+    ssize_t size = ::read(inotify_fd_, buffer, sizeof(buffer));
+    if (size <= 0) {
+      // EAGAIN once every pending event was read
+      return changed;
+    }
+    for (ssize_t offset = 0; offset < size;) {
+      const inotify_event* event =
+        reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += sizeof(inotify_event) + event->len;
+
+      // events were dropped, any of them may have concerned the files
+      if (event->mask & IN_Q_OVERFLOW) {
+        changed = true;
+        continue;
+      }
+      auto watch = watches_.find(event->wd);
+      if (watch == watches_.end() || event->len == 0) {
+        continue;
+      }
+      std::filesystem::path path = watch->second / event->name;
+      if (path == schema_file_path_ || path == instance_file_path_) {
+        changed = true;
+      }
+    }
+  }
+}
+
+void ConfigWatcherImpl::watch_loop() {
+  while (true) {
+    if (wait_for_change(std::nullopt) == Wake::Stopped) {
+      return;
+    }
+    // wait until the files stop changing
+    Wake wake = Wake::Changed;
+    while (wake == Wake::Changed) {
+      wake = wait_for_change(std::chrono::steady_clock::now() + options_.debounce);
+    }
+    if (wake == Wake::Stopped) {
+      return;
+    }
+    reload();
+  }
+}
+
+void ConfigWatcherImpl::reload() {
+  std::shared_ptr<const ConfigInstance> reloaded;
+  try {
+    reloaded = std::make_shared<const ConfigInstance>(ConfigInstance::from_file(
+      schema_file_path_, instance_file_path_, options_.file_options
+    ));
+  } catch (const std::exception& e) {
+    report_error(e.what());
+    return;
+  }
+
+  std::vector<ConfigWatcher::Subscriber> subscribers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_ = reloaded;
+    version_++;
+    last_error_.reset();
+    for (const auto& [id, subscriber] : subscribers_) {
+      subscribers.push_back(subscriber);
+    }
+  }
+  reloaded_.notify_all();
+
+  // called without the lock so subscribers can use the watcher
+  for (const ConfigWatcher::Subscriber& subscriber : subscribers) {
+    try {
+      subscriber(reloaded);
+    } catch (const std::exception& e) {
+      report_error(e.what());
+    }
+  }
+}
+
+void ConfigWatcherImpl::report_error(const std::string& error) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_error_ = error;
+  }
+  if (options_.on_error) {
+    options_.on_error(error);
+  }
+}
+
+std::shared_ptr<const ConfigInstance> ConfigWatcherImpl::current() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return current_;
+}
+
+uint64_t ConfigWatcherImpl::version() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return version_;
+}
+
+bool ConfigWatcherImpl::wait_for_version(
+  uint64_t version,
+  std::chrono::milliseconds timeout
+) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return reloaded_.wait_for(lock, timeout, [&]() { return version_ >= version; });
+}
+
+std::optional<std::string> ConfigWatcherImpl::last_error() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return last_error_;
+}
+
+ConfigWatcher::SubscriptionId ConfigWatcherImpl::subscribe(
+  ConfigWatcher::Subscriber subscriber
+) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ConfigWatcher::SubscriptionId id = next_subscription_id_++;
+  subscribers_.emplace(id, std::move(subscriber));
+  return id;
+}
+
+void ConfigWatcherImpl::unsubscribe(ConfigWatcher::SubscriptionId id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  subscribers_.erase(id);
+}
+
+// ================================= CONFIG WATCHER ================================ //
+ConfigWatcher::ConfigWatcher(std::unique_ptr<ConfigWatcherImpl> impl)
+  : impl_(std::move(impl)) {}
+ConfigWatcher::ConfigWatcher(ConfigWatcher&& other) noexcept = default;
+ConfigWatcher& ConfigWatcher::operator=(ConfigWatcher&& other) noexcept = default;
+ConfigWatcher::~ConfigWatcher() = default;
+
+ConfigWatcher ConfigWatcher::from_file(
+  const std::filesystem::path& schema_file_path,
+  const std::filesystem::path& instance_file_path,
+  const WatchOptions& options
+) {
+  return ConfigWatcher(
+    std::make_unique<ConfigWatcherImpl>(schema_file_path, instance_file_path, options)
+  );
+}
+
+std::shared_ptr<const ConfigInstance> ConfigWatcher::current() const {
+  return impl_->current();
+}
+
+uint64_t ConfigWatcher::version() const { return impl_->version(); }
+
+bool ConfigWatcher::wait_for_version(
+  uint64_t version,
+  std::chrono::milliseconds timeout
+) const {
+  return impl_->wait_for_version(version, timeout);
+}
+
+std::optional<std::string> ConfigWatcher::last_error() const {
+  return impl_->last_error();
+}
+
+ConfigWatcher::SubscriptionId ConfigWatcher::subscribe(Subscriber subscriber) {
+  return impl_->subscribe(std::move(subscriber));
+}
+
+void ConfigWatcher::unsubscribe(SubscriptionId id) { impl_->unsubscribe(id); }
+
+}  // namespace miru::config
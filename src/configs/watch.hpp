@@ -0,0 +1,81 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+// internal
+#include <miru/configs/watch.hpp>
+
+namespace miru::config {
+
+// ===================================== WATCH ===================================== //
+class ConfigWatcherImpl {
+ public:
+  // loads the config instance and starts the watch thread
+  ConfigWatcherImpl(
+    const std::filesystem::path& schema_file_path,
+    const std::filesystem::path& instance_file_path,
+    const WatchOptions& options
+  );
+  ~ConfigWatcherImpl();
+
+  ConfigWatcherImpl(const ConfigWatcherImpl&) = delete;
+  ConfigWatcherImpl& operator=(const ConfigWatcherImpl&) = delete;
+
+  std::shared_ptr<const ConfigInstance> current() const;
+  uint64_t version() const;
+  bool wait_for_version(uint64_t version, std::chrono::milliseconds timeout) const;
+  std::optional<std::string> last_error() const;
+
+  ConfigWatcher::SubscriptionId subscribe(ConfigWatcher::Subscriber subscriber);
+  void unsubscribe(ConfigWatcher::SubscriptionId id);
+
+ private:
+  enum class Wake {
+    Changed,
+    Quiet,
+    Stopped,
+  };
+
+  void add_watch(const std::filesystem::path& file_path);
+  // waits for a change to either file until the deadline (forever if there is none)
+  Wake wait_for_change(
+    std::optional<std::chrono::steady_clock::time_point> deadline
+  );
+  // reads the pending events, returning whether any of them concerns either file
+  bool read_events();
+  void watch_loop();
+  void reload();
+  void report_error(const std::string& error);
+
+  std::filesystem::path schema_file_path_;
+  std::filesystem::path instance_file_path_;
+  WatchOptions options_;
+
+  int inotify_fd_;
+  // written to stop the watch thread
+  int stop_fd_;
+  // the watched directories by watch descriptor
+  std::map<int, std::filesystem::path> watches_;
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable reloaded_;
+  std::shared_ptr<const ConfigInstance> current_;
+  uint64_t version_;
+  std::optional<std::string> last_error_;
+  std::map<ConfigWatcher::SubscriptionId, ConfigWatcher::Subscriber> subscribers_;
+  ConfigWatcher::SubscriptionId next_subscription_id_;
+
+  std::thread thread_;
+};
+
+}  // namespace miru::config
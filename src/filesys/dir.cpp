@@ -1,3 +1,6 @@
+// std
+#include <algorithm>
+
 // internal
 #include <filesys/dir.hpp>
 #include <filesys/errors.hpp>
@@ -30,6 +33,24 @@ void Dir::assert_exists() const {
   }
 }
 
+std::vector<miru::filesys::File> Dir::files() const {
+  assert_exists();
+  std::vector<std::filesystem::path> paths;
+  for (const auto& entry : std::filesystem::directory_iterator(path_)) {
+    if (entry.is_regular_file()) {
+      paths.push_back(entry.path());
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+
+  std::vector<miru::filesys::File> files;
+  files.reserve(paths.size());
+  for (const std::filesystem::path& path : paths) {
+    files.emplace_back(path);
+  }
+  return files;
+}
+
 bool Dir::exists() const {
   return std::filesystem::exists(path_) && std::filesystem::is_directory(path_);
 }
@@ -2,6 +2,7 @@
 
 // std
 #include <filesystem>
+#include <vector>
 
 // internal
 #include <filesys/file.hpp>
@@ -24,6 +25,9 @@ class Dir : public Path {
     return miru::filesys::File(path_ / path);
   }
 
+  // the regular files in the directory (not its subdirectories) sorted by name
+  std::vector<miru::filesys::File> files() const;
+
   Dir git_root() const;
 };
 
@@ -1,5 +1,16 @@
 // std
-#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <stdexcept>
+
+// unix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // internal
 #include <filesys/errors.hpp>
@@ -16,6 +27,8 @@ std::vector<FileType> supported_file_types() {
   return {
     FileType::JSON,
     FileType::YAML,
+    FileType::MSGPACK,
+    FileType::CBOR,
   };
 }
 
@@ -25,6 +38,10 @@ std::string file_type_to_string(FileType file_type) {
       return "JSON";
     case FileType::YAML:
       return "YAML";
+    case FileType::MSGPACK:
+      return "MSGPACK";
+    case FileType::CBOR:
+      return "CBOR";
   }
   return "unknown";
 }
@@ -43,6 +60,8 @@ FileType string_to_file_type(std::string str) {
   if (str == "json") return FileType::JSON;
   if (str == "yaml") return FileType::YAML;
   if (str == "yml") return FileType::YAML;
+  if (str == "msgpack") return FileType::MSGPACK;
+  if (str == "cbor") return FileType::CBOR;
   THROW_INVALID_FILE_TYPE(str, file_types_to_strings(supported_file_types()));
 }
 
@@ -51,6 +70,8 @@ FileType File::file_type() const {
   if (extension() == ".json") return FileType::JSON;
   if (extension() == ".yaml") return FileType::YAML;
   if (extension() == ".yml") return FileType::YAML;
+  if (extension() == ".msgpack") return FileType::MSGPACK;
+  if (extension() == ".cbor") return FileType::CBOR;
   THROW_INVALID_FILE_TYPE(
     path_.string(), file_types_to_strings(supported_file_types())
   );
@@ -65,65 +86,244 @@ void File::assert_exists() const {
   }
 }
 
+// ================================= FILE CONTENTS ================================= //
+// small files are read into buffers reused across reads instead of allocating a
+// fresh buffer for every read
+constexpr size_t MAX_POOLED_BUFFERS = 8;
+
+std::mutex& buffer_pool_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::vector<std::string>& buffer_pool() {
+  static std::vector<std::string> pool;
+  return pool;
+}
+
+std::string acquire_buffer() {
+  std::lock_guard<std::mutex> lock(buffer_pool_mutex());
+  std::vector<std::string>& pool = buffer_pool();
+  if (pool.empty()) {
+    return std::string();
+  }
+  std::string buffer = std::move(pool.back());
+  pool.pop_back();
+  return buffer;
+}
+
+void release_buffer(std::string&& buffer) noexcept {
+  // buffers never grow past the mmap threshold so the pool stays small
+  if (buffer.capacity() == 0 || buffer.capacity() > FileContents::MMAP_THRESHOLD) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(buffer_pool_mutex());
+  std::vector<std::string>& pool = buffer_pool();
+  if (pool.size() < MAX_POOLED_BUFFERS) {
+    buffer.clear();
+    pool.push_back(std::move(buffer));
+  }
+}
+
+FileContents::FileContents(FileContents&& other) noexcept
+  : mapping_(other.mapping_), size_(other.size_), buffer_(std::move(other.buffer_)) {
+  other.mapping_ = nullptr;
+  other.size_ = 0;
+}
+
+FileContents& FileContents::operator=(FileContents&& other) noexcept {
+  if (this != &other) {
+    release();
+    mapping_ = other.mapping_;
+    size_ = other.size_;
+    buffer_ = std::move(other.buffer_);
+    other.mapping_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+FileContents::~FileContents() { release(); }
+
+void FileContents::release() noexcept {
+  if (mapping_) {
+    ::munmap(const_cast<char*>(mapping_), size_);
+    mapping_ = nullptr;
+  } else {
+    release_buffer(std::move(buffer_));
+  }
+  buffer_ = std::string();
+  size_ = 0;
+}
+
 // ================================= READING FILES ================================= //
-std::vector<std::uint8_t> File::read_bytes() const {
-  assert_exists();
-  std::ifstream file(path_, std::ios::binary | std::ios::ate);
-  if (!file) {
-    throw std::runtime_error("Failed to open file: " + path_.string());
+FileContents File::read_contents() const { return read_contents(false); }
+
+FileContents File::map_contents() const { return read_contents(true); }
+
+FileContents File::read_contents(bool map) const {
+  // the file is opened and stat'ed once rather than checking it exists first
+  int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (errno == ENOENT || errno == ENOTDIR) {
+      THROW_FILE_NOT_FOUND(path_.string(), abs_path().string());
+    }
+    throw std::runtime_error(
+      "Failed to open file '" + path_.string() + "': " + std::strerror(errno)
+    );
+  }
+  struct stat stats;
+  if (::fstat(fd, &stats) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::runtime_error(
+      "Failed to stat file '" + path_.string() + "': " + std::strerror(error)
+    );
+  }
+  if (!S_ISREG(stats.st_mode)) {
+    ::close(fd);
+    THROW_NOT_A_FILE(path_.string());
   }
 
-  auto size = file.tellg();
-  std::vector<std::uint8_t> bytes(size);
-  file.seekg(0);
-  file.read(reinterpret_cast<char*>(bytes.data()), size);
+  FileContents contents;
+  size_t size = static_cast<size_t>(stats.st_size);
+  if (map && size >= FileContents::MMAP_THRESHOLD) {
+    // private and read only: the parsers only ever see the bytes of the file without
+    // them being copied
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      ::madvise(data, size, MADV_SEQUENTIAL);
+      ::close(fd);
+      contents.mapping_ = static_cast<const char*>(data);
+      contents.size_ = size;
+      return contents;
+    }
+    // fall back to reading the file (e.g. file systems which can't be mapped)
+  }
 
-  return bytes;
+  contents.buffer_ = acquire_buffer();
+  contents.buffer_.resize(size);
+  size_t offset = 0;
+  while (true) {
+    if (offset == contents.buffer_.size()) {
+      // the file may have grown since it was stat'ed
+      contents.buffer_.resize(std::max<size_t>(2 * offset, 4096));
+    }
+    ssize_t n = ::read(
+      fd, contents.buffer_.data() + offset, contents.buffer_.size() - offset
+    );
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int error = errno;
+      ::close(fd);
+      throw std::runtime_error(
+        "Failed to read file '" + path_.string() + "': " + std::strerror(error)
+      );
+    }
+    if (n == 0) {
+      break;
+    }
+    offset += static_cast<size_t>(n);
+  }
+  ::close(fd);
+  contents.buffer_.resize(offset);
+  contents.size_ = offset;
+  return contents;
+}
+
+std::vector<std::uint8_t> File::read_bytes() const {
+  FileContents contents = read_contents();
+  std::string_view view = contents.view();
+  return std::vector<std::uint8_t>(view.begin(), view.end());
 }
 
 std::string File::read_string() const {
-  assert_exists();
-  std::ifstream file(path_, std::ios::binary | std::ios::ate);
-  if (!file) {
-    throw std::runtime_error("Failed to open file: " + path_.string());
-  }
+  FileContents contents = read_contents();
+  return std::string(contents.view());
+}
 
-  auto size = file.tellg();
-  std::string content(size, '\0');
-  file.seekg(0);
-  file.read(content.data(), size);
+// json is read from json, msgpack and cbor files
+bool is_json_file_type(FileType file_type) {
+  return file_type == FileType::JSON || file_type == FileType::MSGPACK ||
+         file_type == FileType::CBOR;
+}
 
-  return content;
+// the yaml-cpp parser can actually parse json files as well (since json is a subset of
+// yaml) however if we want to read strict yaml then we should use the dedicated yaml
+// parser
+bool is_yaml_file_type(FileType file_type) {
+  return file_type == FileType::YAML || file_type == FileType::JSON;
 }
 
-nlohmann::json File::read_json() const {
-  assert_exists();
+void assert_json_file_type(const std::filesystem::path& path, FileType file_type) {
+  if (!is_json_file_type(file_type)) {
+    THROW_INVALID_FILE_TYPE(
+      path.string(),
+      file_types_to_strings({FileType::JSON, FileType::MSGPACK, FileType::CBOR})
+    );
+  }
+}
 
-  if (file_type() != FileType::JSON) {
-    THROW_INVALID_FILE_TYPE(path_.string(), file_types_to_strings({FileType::JSON}));
+void assert_yaml_file_type(const std::filesystem::path& path, FileType file_type) {
+  if (!is_yaml_file_type(file_type)) {
+    THROW_INVALID_FILE_TYPE(path.string(), file_types_to_strings({FileType::YAML}));
   }
+}
 
-  std::ifstream file(path_);
-  return nlohmann::json::parse(file);
+nlohmann::json parse_json_document(
+  const std::filesystem::path& path,
+  FileType file_type,
+  std::string_view bytes
+) {
+  assert_json_file_type(path, file_type);
+  switch (file_type) {
+    case FileType::MSGPACK:
+      return nlohmann::json::from_msgpack(bytes.begin(), bytes.end());
+    case FileType::CBOR:
+      return nlohmann::json::from_cbor(bytes.begin(), bytes.end());
+    default:
+      return nlohmann::json::parse(bytes.begin(), bytes.end());
+  }
 }
 
-YAML::Node File::read_yaml() const {
-  assert_exists();
+YAML::Node parse_yaml_document(
+  const std::filesystem::path& path,
+  FileType file_type,
+  std::string_view bytes
+) {
+  assert_yaml_file_type(path, file_type);
+  ViewStreamBuf buf(bytes);
+  std::istream stream(&buf);
+  return YAML::Load(stream);
+}
 
-  // the yaml-cpp parser can actually parse json files as well (since json is a subset
-  // of yaml) however if we want to read strict yaml then we should use the dedicated
-  // yaml parser
-  if (file_type() != FileType::YAML && file_type() != FileType::JSON) {
-    THROW_INVALID_FILE_TYPE(path_.string(), file_types_to_strings({FileType::YAML}));
+nlohmann::json File::read_json() const {
+  // files of other types are rejected before they're read (a missing file is still
+  // reported as missing)
+  if (!is_json_file_type(file_type())) {
+    assert_exists();
+    assert_json_file_type(path_, file_type());
   }
+  FileContents contents = read_contents();
+  return parse_json_document(path_, file_type(), contents.view());
+}
 
-  std::ifstream file(path_);
-  return YAML::Load(file);
+YAML::Node File::read_yaml() const {
+  if (!is_yaml_file_type(file_type())) {
+    assert_exists();
+    assert_yaml_file_type(path_, file_type());
+  }
+  FileContents contents = read_contents();
+  return parse_yaml_document(path_, file_type(), contents.view());
 }
 
 std::variant<nlohmann::json, YAML::Node> File::read_structured_data() const {
   switch (file_type()) {
     case FileType::JSON:
+    case FileType::MSGPACK:
+    case FileType::CBOR:
       return read_json();
     case FileType::YAML:
       return read_yaml();
@@ -133,4 +333,19 @@ std::variant<nlohmann::json, YAML::Node> File::read_structured_data() const {
   );
 }
 
+// ================================== LOADED FILES ================================= //
+LoadedFile::LoadedFile(const File& file)
+  : file_(file), contents_(file.read_contents()), file_type_(file.file_type()) {}
+
+const std::variant<nlohmann::json, YAML::Node>& LoadedFile::document() const {
+  if (!document_) {
+    if (file_type_ == FileType::YAML) {
+      document_ = parse_yaml_document(file_.path(), file_type_, bytes());
+    } else {
+      document_ = parse_json_document(file_.path(), file_type_, bytes());
+    }
+  }
+  return *document_;
+}
+
 }  // namespace miru::filesys
\ No newline at end of file
@@ -1,8 +1,12 @@
 #pragma once
 
 // std
+#include <cstddef>
 #include <filesystem>
+#include <optional>
+#include <streambuf>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -20,6 +24,9 @@ namespace miru::filesys {
 enum class FileType {
   JSON,
   YAML,
+  // binary encodings of json documents
+  MSGPACK,
+  CBOR,
 };
 
 std::vector<FileType> supported_file_types();
@@ -27,6 +34,47 @@ std::string file_type_to_string(FileType file_type);
 std::vector<std::string> file_types_to_strings(const std::vector<FileType>& file_types);
 FileType string_to_file_type(std::string str);
 
+// The contents of a file read by File::read_contents() or File::map_contents(). Files
+// are read into a buffer (borrowed from a process wide pool for files smaller than
+// MMAP_THRESHOLD bytes, which the buffer is returned to when the contents are
+// destroyed) unless they're mapped. Either way the view over the bytes is only valid
+// for the lifetime of the contents.
+class FileContents {
+ public:
+  static constexpr size_t MMAP_THRESHOLD = 64 * 1024;
+
+  FileContents(FileContents&& other) noexcept;
+  FileContents& operator=(FileContents&& other) noexcept;
+  FileContents(const FileContents&) = delete;
+  FileContents& operator=(const FileContents&) = delete;
+  ~FileContents();
+
+  std::string_view view() const {
+    return mapping_ ? std::string_view(mapping_, size_) : std::string_view(buffer_);
+  }
+  size_t size() const { return size_; }
+  bool mapped() const { return mapping_ != nullptr; }
+
+ private:
+  friend class File;
+  FileContents() = default;
+  void release() noexcept;
+
+  const char* mapping_ = nullptr;
+  size_t size_ = 0;
+  std::string buffer_;
+};
+
+// A read-only stream buffer over a view of bytes for the parsers which only read from
+// streams. The bytes must outlive the buffer.
+class ViewStreamBuf : public std::streambuf {
+ public:
+  explicit ViewStreamBuf(std::string_view view) {
+    char* data = const_cast<char*>(view.data());
+    setg(data, data, data + view.size());
+  }
+};
+
 class File : public Path {
  public:
   explicit File(const std::filesystem::path& path) : Path(path) {}
@@ -35,11 +83,44 @@ class File : public Path {
   FileType file_type() const;
   void assert_exists() const;
 
+  // throws FileNotFoundError / NotAFileError like assert_exists()
+  FileContents read_contents() const;
+  // Like read_contents() but files of at least MMAP_THRESHOLD bytes are memory mapped
+  // (with a sequential access hint). Only for files which are replaced by renaming a
+  // new file over them (like snapshots) since truncating a mapped file raises SIGBUS
+  // in the process reading it.
+  FileContents map_contents() const;
   std::vector<std::uint8_t> read_bytes() const;
   std::string read_string() const;
+  // json, MessagePack and CBOR files are all read into a json document
   nlohmann::json read_json() const;
   YAML::Node read_yaml() const;
   std::variant<nlohmann::json, YAML::Node> read_structured_data() const;
+
+ private:
+  FileContents read_contents(bool map) const;
+};
+
+// A file read once and passed through every step of loading it (reading the config
+// type slug, hashing, parsing) so no step reopens the file, recomputes its type or
+// parses it again. The document is parsed the first time it's needed. Not thread safe.
+class LoadedFile {
+ public:
+  // throws like File::read_contents() and File::file_type()
+  explicit LoadedFile(const File& file);
+
+  const File& file() const { return file_; }
+  FileType file_type() const { return file_type_; }
+  std::string_view bytes() const { return contents_.view(); }
+
+  // json, MessagePack and CBOR files are parsed into a json document
+  const std::variant<nlohmann::json, YAML::Node>& document() const;
+
+ private:
+  File file_;
+  FileContents contents_;
+  FileType file_type_;
+  mutable std::optional<std::variant<nlohmann::json, YAML::Node>> document_;
 };
 
 }  // namespace miru::filesys
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <http/models/ConfigInstance.h>
 #include <http/models/HashSchemaSerializedRequest.h>
 
+#include <http/encoding.hpp>
 #include <http/socket_session.hpp>
 
 namespace miru::http {
@@ -22,6 +23,30 @@ class AgentClientI {
     const std::string& config_schema_digest,
     const std::string& config_type_slug
   ) const = 0;
+
+  // the raw json of the deployed config instance so that its (potentially large)
+  // content can be parsed without first building a json document for it
+  virtual std::string get_deployed_config_instance_json(
+    const std::string& config_schema_digest,
+    const std::string& config_type_slug
+  ) const {
+    return get_deployed_config_instance(config_schema_digest, config_type_slug)
+      .to_json()
+      .dump();
+  }
+
+  // the deployed config instance in the first of the given encodings the agent
+  // supports (json if it doesn't negotiate encodings)
+  virtual EncodedBody get_deployed_config_instance_encoded(
+    const std::string& config_schema_digest,
+    const std::string& config_type_slug,
+    const std::vector<BodyEncoding>& /*encodings*/
+  ) const {
+    return EncodedBody{
+      get_deployed_config_instance_json(config_schema_digest, config_type_slug),
+      BodyEncoding::JSON
+    };
+  }
 };
 
 }  // namespace miru::http
\ No newline at end of file
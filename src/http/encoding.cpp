@@ -0,0 +1,58 @@
+// std
+#include <algorithm>
+#include <cctype>
+
+// internal
+#include <http/encoding.hpp>
+
+namespace miru::http {
+
+// ================================ BODY ENCODINGS ================================= //
+std::string media_type(BodyEncoding encoding) {
+  switch (encoding) {
+    case BodyEncoding::JSON:
+      return "application/json";
+    case BodyEncoding::MSGPACK:
+      return "application/msgpack";
+    case BodyEncoding::CBOR:
+      return "application/cbor";
+  }
+  return "application/json";
+}
+
+std::string accept_header(const std::vector<BodyEncoding>& encodings) {
+  // each encoding is given a lower quality than the previous one
+  std::string header;
+  for (size_t i = 0; i < encodings.size(); i++) {
+    if (i > 0) {
+      header += ", ";
+    }
+    header += media_type(encodings[i]);
+    if (i > 0) {
+      header += ";q=0." + std::to_string(std::max<size_t>(1, 10 - i));
+    }
+  }
+  return header;
+}
+
+BodyEncoding content_type_to_body_encoding(std::string_view content_type) {
+  // ignore any parameters (e.g. "; charset=utf-8") and the case of the media type
+  std::string type(content_type.substr(0, content_type.find(';')));
+  type.erase(
+    std::remove_if(
+      type.begin(), type.end(), [](unsigned char c) { return std::isspace(c); }
+    ),
+    type.end()
+  );
+  std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+  if (type == "application/msgpack" || type == "application/x-msgpack" ||
+      type == "application/vnd.msgpack") {
+    return BodyEncoding::MSGPACK;
+  }
+  if (type == "application/cbor") {
+    return BodyEncoding::CBOR;
+  }
+  return BodyEncoding::JSON;
+}
+
+}  // namespace miru::http
@@ -0,0 +1,33 @@
+#pragma once
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace miru::http {
+
+// ================================ BODY ENCODINGS ================================= //
+// The encodings of json documents the agent can respond with. The binary encodings
+// are smaller on the socket and much faster to decode for large numeric configs.
+enum class BodyEncoding {
+  JSON,
+  MSGPACK,
+  CBOR,
+};
+
+struct EncodedBody {
+  std::string body;
+  BodyEncoding encoding;
+};
+
+std::string media_type(BodyEncoding encoding);
+
+// the value of an Accept header which prefers the encodings in the given order
+std::string accept_header(const std::vector<BodyEncoding>& encodings);
+
+// the encoding of a response with the given Content-Type header (responses without
+// a recognized binary media type are json)
+BodyEncoding content_type_to_body_encoding(std::string_view content_type);
+
+}  // namespace miru::http
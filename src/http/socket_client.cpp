@@ -7,6 +7,7 @@
 #include <http/models/ConfigInstance.h>
 #include <http/models/HashSchemaSerializedRequest.h>
 
+#include <http/encoding.hpp>
 #include <http/socket_client.hpp>
 #include <http/socket_session.hpp>
 #include <http/utils.hpp>
@@ -51,15 +52,45 @@ std::string UnixSocketClient::hash_schema(
 openapi::ConfigInstance UnixSocketClient::get_deployed_config_instance(
   const std::string& config_schema_digest,
   const std::string& config_type_slug
+) const {
+  return openapi::ConfigInstance::from_json(nlohmann::json::parse(
+    get_deployed_config_instance_json(config_schema_digest, config_type_slug)
+  ));
+}
+
+std::string UnixSocketClient::get_deployed_config_instance_json(
+  const std::string& config_schema_digest,
+  const std::string& config_type_slug
+) const {
+  EncodedBody response = get_deployed_config_instance_encoded(
+    config_schema_digest, config_type_slug, {BodyEncoding::JSON}
+  );
+  // agents may ignore the Accept header
+  switch (response.encoding) {
+    case BodyEncoding::MSGPACK:
+      return nlohmann::json::from_msgpack(response.body).dump();
+    case BodyEncoding::CBOR:
+      return nlohmann::json::from_cbor(response.body).dump();
+    default:
+      return std::move(response.body);
+  }
+}
+
+EncodedBody UnixSocketClient::get_deployed_config_instance_encoded(
+  const std::string& config_schema_digest,
+  const std::string& config_type_slug,
+  const std::vector<BodyEncoding>& encodings
 ) const {
   std::string path = base_path() + "/config_instances/deployed?config_schema_digest=" +
                      config_schema_digest + "&config_type_slug=" + config_type_slug;
   auto req = build_get_request(host(), path);
+  req.set(http::field::accept, accept_header(encodings));
   std::chrono::milliseconds timeout = std::chrono::seconds(10);
   auto res = execute(req, timeout);
-  return openapi::ConfigInstance::from_json(
-    handle_json_response(res.first, res.second)
-  );
+  handle_response(res.first, res.second);
+  BodyEncoding encoding =
+    content_type_to_body_encoding(std::string(res.first[http::field::content_type]));
+  return EncodedBody{std::move(res.first.body()), encoding};
 }
 
 }  // namespace miru::http
\ No newline at end of file
@@ -35,6 +35,16 @@ class UnixSocketClient : public AgentClientI {
     const std::string& config_schema_digest,
     const std::string& config_type_slug
   ) const;
+  std::string get_deployed_config_instance_json(
+    const std::string& config_schema_digest,
+    const std::string& config_type_slug
+  ) const override;
+  // negotiates the encoding with the agent through the Accept header
+  EncodedBody get_deployed_config_instance_encoded(
+    const std::string& config_schema_digest,
+    const std::string& config_type_slug,
+    const std::vector<BodyEncoding>& encodings
+  ) const override;
 
  private:
   std::string socket_path_;
@@ -52,7 +52,7 @@ http::request<http::string_body> build_post_request(
   return build_request(http::verb::post, host, path, body);
 }
 
-nlohmann::json handle_json_response(
+const std::string& handle_response(
   const http::response<http::string_body>& res,
   const RequestDetails& details
 ) {
@@ -67,8 +67,14 @@ nlohmann::json handle_json_response(
     }
     THROW_REQUEST_FAILED(res.result_int(), details, error_response);
   }
+  return res.body();
+}
 
-  return nlohmann::json::parse(res.body());
+nlohmann::json handle_json_response(
+  const http::response<http::string_body>& res,
+  const RequestDetails& details
+) {
+  return nlohmann::json::parse(handle_response(res, details));
 }
 
 }  // namespace miru::http
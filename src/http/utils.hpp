@@ -35,6 +35,12 @@ http::request<http::string_body> build_post_request(
   const std::string& body
 );
 
+// throws if the response is an error and returns the body otherwise
+const std::string& handle_response(
+  const http::response<http::string_body>& res,
+  const RequestDetails& details
+);
+
 nlohmann::json handle_json_response(
   const http::response<http::string_body>& res,
   const RequestDetails& details
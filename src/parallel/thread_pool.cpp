@@ -0,0 +1,181 @@
+// std
+#include <algorithm>
+
+// internal
+#include <miru/parallel/thread_pool.hpp>
+
+namespace miru::parallel {
+
+// the pool (and queue) the current thread works for, if any
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+// ================================= THREAD POOL =================================== //
+ThreadPool::ThreadPool(size_t num_threads)
+  : num_pending_(0), next_queue_(0), stop_(false), num_waiters_(0) {
+  if (num_threads == 0) {
+    num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    queues_.push_back(std::make_unique<TaskQueue>());
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this, i]() { worker_loop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+ThreadPool& ThreadPool::shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  size_t queue_index = current_pool == this
+                         ? current_queue
+                         : next_queue_.fetch_add(1) % queues_.size();
+  // counted before it's queued so taking the task can't decrement the count first
+  num_pending_.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue_index]->mutex);
+    queues_[queue_index]->tasks.push_back(std::move(task));
+  }
+  bool has_waiters;
+  {
+    // taking the lock orders the notification after a sleeping worker's check of
+    // num_pending_ so the wake up can't be lost
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    has_waiters = num_waiters_ > 0;
+  }
+  wake_.notify_one();
+  if (has_waiters) {
+    waiters_.notify_all();
+  }
+}
+
+void ThreadPool::wait_for_work(const std::function<bool()>& done) {
+  std::unique_lock<std::mutex> lock(sleep_mutex_);
+  num_waiters_++;
+  waiters_.wait(lock, [&]() { return done() || num_pending_.load() > 0; });
+  num_waiters_--;
+}
+
+void ThreadPool::notify_waiters() {
+  {
+    // see submit()
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  waiters_.notify_all();
+}
+
+bool ThreadPool::pop_task(size_t queue_index, std::function<void()>& task) {
+  TaskQueue& queue = *queues_[queue_index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::steal_task(size_t thief_index, std::function<void()>& task) {
+  for (size_t i = 1; i <= queues_.size(); i++) {
+    TaskQueue& queue = *queues_[(thief_index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::try_run_pending_task() {
+  std::function<void()> task;
+  bool found = current_pool == this
+                 ? pop_task(current_queue, task) || steal_task(current_queue, task)
+                 : steal_task(0, task);
+  if (!found) {
+    return false;
+  }
+  num_pending_.fetch_sub(1);
+  task();
+  return true;
+}
+
+void ThreadPool::worker_loop(size_t index) {
+  current_pool = this;
+  current_queue = index;
+  while (true) {
+    std::function<void()> task;
+    if (pop_task(index, task) || steal_task(index, task)) {
+      num_pending_.fetch_sub(1);
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this]() { return stop_ || num_pending_.load() > 0; });
+    if (stop_ && num_pending_.load() == 0) {
+      return;
+    }
+  }
+}
+
+// ================================== TASK GROUP =================================== //
+TaskGroup::~TaskGroup() {
+  // tasks reference the group so they must finish before it is destroyed even if the
+  // owner never called wait() (e.g. because an exception is unwinding the stack)
+  wait_for_tasks();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+  num_pending_.fetch_add(1);
+  // the group may be destroyed as soon as its last task is done so the pool is
+  // captured rather than reached through the group
+  pool_.submit([this, &pool = pool_, task = std::move(task)]() {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+    if (num_pending_.fetch_sub(1) == 1) {
+      pool.notify_waiters();
+    }
+  });
+}
+
+void TaskGroup::wait_for_tasks() {
+  while (num_pending_.load() > 0) {
+    if (!pool_.try_run_pending_task()) {
+      // nothing to help with, block until there is or the group is done
+      pool_.wait_for_work([this]() { return num_pending_.load() == 0; });
+    }
+  }
+}
+
+void TaskGroup::wait() {
+  wait_for_tasks();
+  std::lock_guard<std::mutex> lock(error_mutex_);
+  if (error_) {
+    std::exception_ptr error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace miru::parallel
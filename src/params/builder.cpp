@@ -0,0 +1,248 @@
+// std
+#include <algorithm>
+#include <stdexcept>
+
+// internal
+#include <miru/params/composite.hpp>
+#include <params/builder.hpp>
+#include <params/errors.hpp>
+
+namespace miru::params {
+
+// ============================== PARAM TREE BUILDER =============================== //
+[[noreturn]] void throw_heterogeneous_array() {
+  throw std::runtime_error(
+    "Heterogeneous array types are not supported. Please contact Ben at "
+    "ben@miruml.com if you need this feature."
+  );
+}
+
+size_t ParamTreeBuilder::Frame::size() const {
+  return children.size() + bools.size() + integers.size() + doubles.size() +
+         strings.size() + scalars.size();
+}
+
+ParamTreeBuilder::ParamTreeBuilder(
+  const std::string& root_name,
+  DuplicateKeys duplicate_keys,
+  size_t max_depth
+)
+  : root_name_(root_name), duplicate_keys_(duplicate_keys), max_depth_(max_depth) {}
+
+ParamTreeBuilder::Frame* ParamTreeBuilder::parent_array() {
+  if (stack_.empty() || stack_.back().is_map) {
+    return nullptr;
+  }
+  return &stack_.back();
+}
+
+ParamTreeBuilder::ElementKind ParamTreeBuilder::element_kind(
+  Frame& array,
+  ElementKind kind
+) {
+  if (array.element_kind == ElementKind::NONE) {
+    array.element_kind = kind;
+  }
+  return array.element_kind;
+}
+
+std::string ParamTreeBuilder::child_name() const {
+  if (stack_.empty()) {
+    return root_name_;
+  }
+  const Frame& parent = stack_.back();
+  if (parent.is_map) {
+    return parent.name + DELIMITER + parent.key;
+  }
+  return parent.name + DELIMITER + std::to_string(parent.size());
+}
+
+void ParamTreeBuilder::add(Parameter param) {
+  if (stack_.empty()) {
+    root_ = std::move(param);
+    return;
+  }
+  stack_.back().children.push_back(std::move(param));
+}
+
+// containers
+void ParamTreeBuilder::start(bool is_map) {
+  std::string name = child_name();
+  if (stack_.size() >= max_depth_) {
+    THROW_MAX_DEPTH_EXCEEDED(name, max_depth_);
+  }
+  stack_.emplace_back(is_map, std::move(name));
+}
+
+void ParamTreeBuilder::start_map() {
+  Frame* array = parent_array();
+  if (array && element_kind(*array, ElementKind::MAP) != ElementKind::MAP) {
+    throw_heterogeneous_array();
+  }
+  start(true);
+}
+
+void ParamTreeBuilder::key(std::string key) { stack_.back().key = std::move(key); }
+
+// a repeated json key overrides the previous value (as it does when parsing a json
+// document) so of each run of fields with the same name only the last is kept
+void keep_last_duplicate_fields(std::vector<Parameter>& fields) {
+  std::stable_sort(fields.begin(), fields.end(), [](const auto& a, const auto& b) {
+    return a.get_name() < b.get_name();
+  });
+  auto out = fields.begin();
+  for (auto it = fields.begin(); it != fields.end(); ++it) {
+    auto next = it + 1;
+    if (next != fields.end() && next->get_name() == it->get_name()) {
+      continue;
+    }
+    if (out != it) {
+      *out = std::move(*it);
+    }
+    ++out;
+  }
+  fields.erase(out, fields.end());
+}
+
+void ParamTreeBuilder::end_map() {
+  Frame frame = std::move(stack_.back());
+  stack_.pop_back();
+  if (duplicate_keys_ == DuplicateKeys::KEEP_LAST) {
+    keep_last_duplicate_fields(frame.children);
+  }
+  add(Parameter(frame.name, Map(std::move(frame.children))));
+}
+
+void ParamTreeBuilder::start_array() {
+  Frame* array = parent_array();
+  if (array && element_kind(*array, ElementKind::ARRAY) != ElementKind::ARRAY) {
+    throw_heterogeneous_array();
+  }
+  start(false);
+}
+
+void ParamTreeBuilder::end_array() {
+  Frame frame = std::move(stack_.back());
+  stack_.pop_back();
+  switch (frame.element_kind) {
+    case ElementKind::NONE:
+      add(Parameter(frame.name, ParameterValue(std::vector<Scalar>())));
+      return;
+    case ElementKind::BOOL:
+      add(Parameter(frame.name, ParameterValue(std::move(frame.bools))));
+      return;
+    case ElementKind::INTEGER:
+      add(Parameter(frame.name, ParameterValue(std::move(frame.integers))));
+      return;
+    case ElementKind::DOUBLE:
+      add(Parameter(frame.name, ParameterValue(std::move(frame.doubles))));
+      return;
+    case ElementKind::STRING:
+      add(Parameter(frame.name, ParameterValue(std::move(frame.strings))));
+      return;
+    case ElementKind::SCALAR:
+      add(Parameter(frame.name, ParameterValue(std::move(frame.scalars))));
+      return;
+    case ElementKind::ARRAY:
+      add(Parameter(frame.name, NestedArray(std::move(frame.children))));
+      return;
+    case ElementKind::MAP:
+      add(Parameter(frame.name, MapArray(std::move(frame.children))));
+      return;
+  }
+}
+
+// values
+void ParamTreeBuilder::null_value() {
+  if (parent_array()) {
+    throw std::runtime_error(
+      "Null values are not supported in arrays. Please contact Ben at "
+      "ben@miruml.com if you need this feature."
+    );
+  }
+  add(Parameter(child_name(), nullptr));
+}
+
+void ParamTreeBuilder::bool_value(bool value) {
+  Frame* array = parent_array();
+  if (!array) {
+    add(Parameter(child_name(), value));
+    return;
+  }
+  if (element_kind(*array, ElementKind::BOOL) != ElementKind::BOOL) {
+    throw_heterogeneous_array();
+  }
+  array->bools.push_back(value);
+}
+
+void ParamTreeBuilder::integer_value(int64_t value) {
+  Frame* array = parent_array();
+  if (!array) {
+    add(Parameter(child_name(), value));
+    return;
+  }
+  switch (element_kind(*array, ElementKind::INTEGER)) {
+    case ElementKind::INTEGER:
+      array->integers.push_back(value);
+      return;
+    case ElementKind::DOUBLE:
+      array->doubles.push_back(static_cast<double>(value));
+      return;
+    default:
+      throw_heterogeneous_array();
+  }
+}
+
+void ParamTreeBuilder::double_value(double value) {
+  Frame* array = parent_array();
+  if (!array) {
+    add(Parameter(child_name(), value));
+    return;
+  }
+  switch (element_kind(*array, ElementKind::DOUBLE)) {
+    case ElementKind::DOUBLE:
+      array->doubles.push_back(value);
+      return;
+    case ElementKind::INTEGER:
+      // the type of an array is decided by its first element
+      array->integers.push_back(static_cast<int64_t>(value));
+      return;
+    default:
+      throw_heterogeneous_array();
+  }
+}
+
+void ParamTreeBuilder::string_value(std::string value) {
+  Frame* array = parent_array();
+  if (!array) {
+    add(Parameter(child_name(), std::move(value)));
+    return;
+  }
+  if (element_kind(*array, ElementKind::STRING) != ElementKind::STRING) {
+    throw_heterogeneous_array();
+  }
+  array->strings.push_back(std::move(value));
+}
+
+void ParamTreeBuilder::scalar_value(std::string value) {
+  Frame* array = parent_array();
+  if (!array) {
+    add(Parameter(child_name(), Scalar(value)));
+    return;
+  }
+  if (element_kind(*array, ElementKind::SCALAR) != ElementKind::SCALAR) {
+    throw_heterogeneous_array();
+  }
+  array->scalars.emplace_back(value);
+}
+
+Parameter ParamTreeBuilder::result() {
+  if (!stack_.empty() || !root_.has_value()) {
+    throw std::runtime_error("Incomplete parameter tree for '" + root_name_ + "'");
+  }
+  Parameter root = std::move(*root_);
+  root_.reset();
+  return root;
+}
+
+}  // namespace miru::params
@@ -0,0 +1,115 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// internal
+#include <miru/params/parameter.hpp>
+
+namespace miru::params {
+
+// the error for arrays of maps / arrays which mix in other element types
+[[noreturn]] void throw_heterogeneous_array();
+
+// ============================== PARAM TREE BUILDER =============================== //
+/// Builds a parameter tree from a stream of parse events.
+/**
+ * Parsers which emit events (a json SAX parser, a yaml event handler, ...) drive the
+ * builder directly so the parameter tree is constructed without first materializing
+ * a document. Only the containers on the path to the value being parsed are kept on
+ * the stack and completed subtrees are moved (never copied) into their parents.
+ *
+ * The resulting tree is identical to the one built by parsing the corresponding
+ * document (see parse_json_node() and parse_yaml_node()): arrays take the type of
+ * their first element and arrays of maps / arrays must not mix in other element types.
+ * Documents with more than max_depth nested maps / arrays are rejected.
+ */
+class ParamTreeBuilder {
+ public:
+  // json documents keep the last value of a repeated key while yaml documents reject
+  // them (the Map constructor throws)
+  enum class DuplicateKeys : uint8_t {
+    KEEP_LAST,
+    REJECT,
+  };
+
+  explicit ParamTreeBuilder(
+    const std::string& root_name,
+    DuplicateKeys duplicate_keys = DuplicateKeys::KEEP_LAST,
+    size_t max_depth = DEFAULT_MAX_DEPTH
+  );
+
+  // containers
+  void start_map();
+  void key(std::string key);
+  void end_map();
+  void start_array();
+  void end_array();
+
+  // values
+  void null_value();
+  void bool_value(bool value);
+  void integer_value(int64_t value);
+  void double_value(double value);
+  void string_value(std::string value);
+  void scalar_value(std::string value);
+
+  /// Return the built tree, throwing if the events did not describe a complete value.
+  Parameter result();
+
+ private:
+  enum class ElementKind : uint8_t {
+    NONE,
+    BOOL,
+    INTEGER,
+    DOUBLE,
+    STRING,
+    SCALAR,
+    ARRAY,
+    MAP,
+  };
+
+  struct Frame {
+    Frame(bool is_map, std::string name)
+      : is_map(is_map), name(std::move(name)), element_kind(ElementKind::NONE) {}
+
+    bool is_map;
+    std::string name;
+
+    // maps: the key of the value being parsed
+    std::string key;
+
+    // map fields and arrays of maps / arrays
+    std::vector<Parameter> children;
+
+    // arrays: the type of the first element decides the type of the array
+    ElementKind element_kind;
+    std::vector<bool> bools;
+    std::vector<int64_t> integers;
+    std::vector<double> doubles;
+    std::vector<std::string> strings;
+    std::vector<Scalar> scalars;
+
+    size_t size() const;
+  };
+
+  // the array being built if the next value is an array element, nullptr otherwise
+  Frame* parent_array();
+  // the element kind of the parent array, initialized to kind by its first element
+  ElementKind element_kind(Frame& array, ElementKind kind);
+  std::string child_name() const;
+  void start(bool is_map);
+  void add(Parameter param);
+
+  std::string root_name_;
+  DuplicateKeys duplicate_keys_;
+  size_t max_depth_;
+  std::vector<Frame> stack_;
+  std::optional<Parameter> root_;
+};
+
+}  // namespace miru::params
@@ -72,14 +72,16 @@ void assert_ascending_integer_keys(const std::vector<Parameter>& items) {
 }
 
 // =================================== MAP ======================================== //
-Map::Map(const std::vector<Parameter>& fields) : sorted_fields_(fields) {
-  if (fields.empty()) {
+Map::Map(const std::vector<Parameter>& fields) : Map(std::vector<Parameter>(fields)) {}
+
+Map::Map(std::vector<Parameter>&& fields) : sorted_fields_(std::move(fields)) {
+  if (sorted_fields_.empty()) {
     THROW_EMPTY_INITIALIZATION("Map");
   }
 
   // name uniqueness and parent name consistency
-  assert_unique_field_names("Map", fields);
-  assert_identical_parent_names(fields);
+  assert_unique_field_names("Map", sorted_fields_);
+  assert_identical_parent_names(sorted_fields_);
 
   // store the fields by name for comparison / access purposes in the future
   std::sort(
@@ -125,27 +127,30 @@ std::ostream& operator<<(std::ostream& os, const Map& map) {
 }
 
 // ================================= MAP ARRAY ===================================== //
-MapArray::MapArray(const std::vector<Parameter>& items) : items_(items) {
-  if (items.empty()) {
+MapArray::MapArray(const std::vector<Parameter>& items)
+  : MapArray(std::vector<Parameter>(items)) {}
+
+MapArray::MapArray(std::vector<Parameter>&& items) : items_(std::move(items)) {
+  if (items_.empty()) {
     THROW_EMPTY_INITIALIZATION("MapArray");
   }
 
   // ensure the items are maps
   assert_valid_array_element_types(
-    "MapArray", items, [](const Parameter& item) { return item.is_map(); }, "Map"
+    "MapArray", items_, [](const Parameter& item) { return item.is_map(); }, "Map"
   );
 
   // name uniqueness and parent name consistency
-  assert_unique_field_names("MapArray", items);
-  assert_identical_parent_names(items);
+  assert_unique_field_names("MapArray", items_);
+  assert_identical_parent_names(items_);
+
+  // ensure the items keys are integers in ascending order (before sorting them)
+  assert_ascending_integer_keys(items_);
 
   // sort the items by name for comparison / access purposes in the future
   std::sort(items_.begin(), items_.end(), [](const Parameter& a, const Parameter& b) {
     return a.get_name() < b.get_name();
   });
-
-  // ensure the items keys are integers in ascending order
-  assert_ascending_integer_keys(items);
 }
 
 MapArray::MapArray(const std::vector<Map>& items) {
@@ -179,30 +184,33 @@ std::ostream& operator<<(std::ostream& os, const MapArray& map_array) {
 }
 
 // ================================= NESTED ARRAY ================================== //
-NestedArray::NestedArray(const std::vector<Parameter>& items) : items_(items) {
-  if (items.empty()) {
+NestedArray::NestedArray(const std::vector<Parameter>& items)
+  : NestedArray(std::vector<Parameter>(items)) {}
+
+NestedArray::NestedArray(std::vector<Parameter>&& items) : items_(std::move(items)) {
+  if (items_.empty()) {
     THROW_EMPTY_INITIALIZATION("NestedArray");
   }
 
   // ensure the items are arrays
   assert_valid_array_element_types(
     "NestedArray",
-    items,
+    items_,
     [](const Parameter& item) { return item.is_array(); },
     "NestedArray"
   );
 
   // name uniqueness and parent name consistency
-  assert_unique_field_names("MapArray", items);
-  assert_identical_parent_names(items);
+  assert_unique_field_names("MapArray", items_);
+  assert_identical_parent_names(items_);
+
+  // ensure the items keys are integers in ascending order (before sorting them)
+  assert_ascending_integer_keys(items_);
 
   // store the items by name for comparison / access purposes in the future
   std::sort(items_.begin(), items_.end(), [](const Parameter& a, const Parameter& b) {
     return a.get_name() < b.get_name();
   });
-
-  // ensure the items keys are integers in ascending order
-  assert_ascending_integer_keys(items);
 }
 
 NestedArray::NestedArray(const std::vector<NestedArray>& items) {
@@ -203,4 +203,28 @@ class ChildParentNameMismatchError : public std::invalid_argument {
     object_to_initialize, child_name, child_parent_name, parent_name, ERROR_TRACE \
   )
 
+class MaxDepthExceededError : public std::runtime_error {
+ public:
+  MaxDepthExceededError(
+    const std::string& param_name,
+    size_t max_depth,
+    const miru::details::errors::ErrorTrace& trace
+  )
+    : std::runtime_error(format_message(param_name, max_depth, trace)) {}
+
+  static std::string format_message(
+    const std::string& param_name,
+    size_t max_depth,
+    const miru::details::errors::ErrorTrace& trace
+  ) {
+    return "parameter '" + param_name +
+           "' is nested deeper than the maximum depth of " +
+           std::to_string(max_depth) + " maps / arrays" +
+           miru::details::errors::format_source_location(trace);
+  }
+};
+
+#define THROW_MAX_DEPTH_EXCEEDED(param_name, max_depth) \
+  throw MaxDepthExceededError(param_name, max_depth, ERROR_TRACE)
+
 }  // namespace miru::params
\ No newline at end of file
@@ -0,0 +1,275 @@
+// std
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// internal
+#include <params/builder.hpp>
+#include <params/parse.hpp>
+
+// external
+#include <nlohmann/json.hpp>
+
+namespace miru::params {
+
+// ================================= JSON SAX ====================================== //
+// Forwards the events of nlohmann's SAX parser to a ParamTreeBuilder. If a field is
+// given only the value of that field of the top level object is built and the rest
+// of the document is skipped.
+class JsonSax {
+ public:
+  using number_integer_t = nlohmann::json::number_integer_t;
+  using number_unsigned_t = nlohmann::json::number_unsigned_t;
+  using number_float_t = nlohmann::json::number_float_t;
+  using string_t = nlohmann::json::string_t;
+  using binary_t = nlohmann::json::binary_t;
+
+  JsonSax(ParamTreeBuilder& builder, const std::string* field)
+    : builder_(builder), field_(field), depth_(0), in_field_(false), found_(false) {}
+
+  bool found_field() const { return found_; }
+
+  bool null() {
+    if (forward_value()) {
+      builder_.null_value();
+    }
+    return true;
+  }
+
+  bool boolean(bool value) {
+    if (forward_value()) {
+      builder_.bool_value(value);
+    }
+    return true;
+  }
+
+  bool number_integer(number_integer_t value) {
+    if (forward_value()) {
+      builder_.integer_value(value);
+    }
+    return true;
+  }
+
+  bool number_unsigned(number_unsigned_t value) {
+    if (!forward_value()) {
+      return true;
+    }
+    if (value > static_cast<number_unsigned_t>(std::numeric_limits<int64_t>::max())) {
+      throw std::overflow_error("Unsigned integer value too large for Parameter");
+    }
+    builder_.integer_value(static_cast<int64_t>(value));
+    return true;
+  }
+
+  bool number_float(number_float_t value, const string_t& /*unused*/) {
+    if (forward_value()) {
+      builder_.double_value(value);
+    }
+    return true;
+  }
+
+  bool string(string_t& value) {
+    if (forward_value()) {
+      builder_.string_value(std::move(value));
+    }
+    return true;
+  }
+
+  bool binary(binary_t& /*unused*/) {
+    throw std::runtime_error(
+      "Binary values are not supported. Please contact Ben at ben@miruml.com if "
+      "you need this feature."
+    );
+  }
+
+  bool start_object(std::size_t /*unused*/) {
+    if (forward_start(true)) {
+      builder_.start_map();
+    }
+    return true;
+  }
+
+  bool key(string_t& key) {
+    if (field_ && depth_ == 1) {
+      in_field_ = key == *field_;
+      found_ = found_ || in_field_;
+      return true;
+    }
+    if (forward_value()) {
+      builder_.key(std::move(key));
+    }
+    return true;
+  }
+
+  bool end_object() {
+    if (forward_end()) {
+      builder_.end_map();
+    }
+    return true;
+  }
+
+  bool start_array(std::size_t /*unused*/) {
+    if (forward_start(false)) {
+      builder_.start_array();
+    }
+    return true;
+  }
+
+  bool end_array() {
+    if (forward_end()) {
+      builder_.end_array();
+    }
+    return true;
+  }
+
+  bool parse_error(
+    std::size_t /*unused*/,
+    const std::string& /*unused*/,
+    const nlohmann::detail::exception& error
+  ) {
+    // rethrow with the same type the document parser would have thrown
+    const auto* parse_error = dynamic_cast<const nlohmann::json::parse_error*>(&error);
+    if (parse_error) {
+      throw *parse_error;
+    }
+    throw error;
+  }
+
+ private:
+  bool forward_value() {
+    if (!field_) {
+      return true;
+    }
+    if (depth_ == 0) {
+      throw_not_an_object();
+    }
+    return in_field_;
+  }
+
+  bool forward_start(bool is_object) {
+    if (!field_) {
+      return true;
+    }
+    if (depth_++ == 0) {
+      if (!is_object) {
+        throw_not_an_object();
+      }
+      return false;
+    }
+    return in_field_;
+  }
+
+  bool forward_end() {
+    if (!field_) {
+      return true;
+    }
+    return --depth_ != 0 && in_field_;
+  }
+
+  [[noreturn]] void throw_not_an_object() const {
+    throw std::runtime_error(
+      "Unable to read field '" + *field_ + "' since the json is not an object"
+    );
+  }
+
+  ParamTreeBuilder& builder_;
+  const std::string* field_;
+  size_t depth_;
+  bool in_field_;
+  bool found_;
+};
+
+template <typename InputT>
+Parameter parse_json_sax(
+  const std::string& name,
+  InputT&& input,
+  const std::string* field,
+  size_t max_depth,
+  nlohmann::json::input_format_t format = nlohmann::json::input_format_t::json
+) {
+  ParamTreeBuilder builder(name, ParamTreeBuilder::DuplicateKeys::KEEP_LAST, max_depth);
+  JsonSax sax(builder, field);
+  nlohmann::json::sax_parse(std::forward<InputT>(input), &sax, format);
+  if (field && !sax.found_field()) {
+    throw std::runtime_error("Unable to find field '" + *field + "' in the json");
+  }
+  return builder.result();
+}
+
+Parameter
+parse_json_stream(const std::string& name, std::istream& stream, size_t max_depth) {
+  return parse_json_sax(name, stream, nullptr, max_depth);
+}
+
+Parameter
+parse_json_string(const std::string& name, std::string_view json, size_t max_depth) {
+  return parse_json_sax(name, json, nullptr, max_depth);
+}
+
+Parameter parse_json_string_field(
+  const std::string& name,
+  std::string_view json,
+  const std::string& field,
+  size_t max_depth
+) {
+  return parse_json_sax(name, json, &field, max_depth);
+}
+
+// ============================ MESSAGEPACK / CBOR SAX ============================= //
+// nlohmann's binary readers emit the same SAX events as its json parser so the binary
+// encodings of a document build the same tree as its json text
+Parameter
+parse_msgpack_stream(const std::string& name, std::istream& stream, size_t max_depth) {
+  return parse_json_sax(
+    name, stream, nullptr, max_depth, nlohmann::json::input_format_t::msgpack
+  );
+}
+
+Parameter parse_msgpack_string(
+  const std::string& name,
+  std::string_view msgpack,
+  size_t max_depth
+) {
+  return parse_json_sax(
+    name, msgpack, nullptr, max_depth, nlohmann::json::input_format_t::msgpack
+  );
+}
+
+Parameter parse_msgpack_string_field(
+  const std::string& name,
+  std::string_view msgpack,
+  const std::string& field,
+  size_t max_depth
+) {
+  return parse_json_sax(
+    name, msgpack, &field, max_depth, nlohmann::json::input_format_t::msgpack
+  );
+}
+
+Parameter
+parse_cbor_stream(const std::string& name, std::istream& stream, size_t max_depth) {
+  return parse_json_sax(
+    name, stream, nullptr, max_depth, nlohmann::json::input_format_t::cbor
+  );
+}
+
+Parameter
+parse_cbor_string(const std::string& name, std::string_view cbor, size_t max_depth) {
+  return parse_json_sax(
+    name, cbor, nullptr, max_depth, nlohmann::json::input_format_t::cbor
+  );
+}
+
+Parameter parse_cbor_string_field(
+  const std::string& name,
+  std::string_view cbor,
+  const std::string& field,
+  size_t max_depth
+) {
+  return parse_json_sax(
+    name, cbor, &field, max_depth, nlohmann::json::input_format_t::cbor
+  );
+}
+
+}  // namespace miru::params
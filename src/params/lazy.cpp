@@ -0,0 +1,297 @@
+// std
+#include <algorithm>
+#include <stdexcept>
+
+// internal
+#include <miru/params/lazy.hpp>
+#include <params/parse.hpp>
+
+// external
+#include <nlohmann/json.hpp>
+
+namespace miru::params {
+
+// ============================= LAZY PARAMETER TREE =============================== //
+[[noreturn]] void throw_malformed_json(const std::string& reason) {
+  throw std::runtime_error("Malformed json: " + reason);
+}
+
+bool is_json_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// returns the position after the closing quote of the string starting at pos
+size_t string_end(const std::string& json, size_t pos) {
+  pos++;
+  while (true) {
+    pos = json.find_first_of("\"\\", pos);
+    if (pos == std::string::npos) {
+      throw_malformed_json("unterminated string");
+    }
+    if (json[pos] == '"') {
+      return pos + 1;
+    }
+    // skip the escaped character
+    pos += 2;
+  }
+}
+
+LazyParameterTree::LazyParameterTree(const std::string& root_name, std::string json)
+  : root_name_(root_name), json_(std::move(json)), root_{0, 0} {
+  index();
+  size_t begin = skip_whitespace(0);
+  if (begin == json_.size()) {
+    throw_malformed_json("the document is empty");
+  }
+  root_ = Range{begin, value_end(begin)};
+  if (skip_whitespace(root_.end) != json_.size()) {
+    throw_malformed_json("unexpected characters after the document");
+  }
+}
+
+LazyParameterTree::LazyParameterTree(
+  const std::string& root_name,
+  std::string json,
+  const std::string& field
+)
+  : LazyParameterTree(root_name, std::move(json)) {
+  if (json_[root_.begin] != '{') {
+    throw std::runtime_error(
+      "Unable to read field '" + field + "' since the json is not an object"
+    );
+  }
+  std::optional<Range> value = find_field(root_, field);
+  if (!value) {
+    throw std::runtime_error("Unable to find field '" + field + "' in the json");
+  }
+  root_ = *value;
+}
+
+// a single pass over the document which records the byte range of every object and
+// array (skipping over strings so brackets inside of them are ignored)
+void LazyParameterTree::index() {
+  std::vector<size_t> open;
+  size_t pos = 0;
+  while ((pos = json_.find_first_of("\"{}[]", pos)) != std::string::npos) {
+    char c = json_[pos];
+    if (c == '"') {
+      pos = string_end(json_, pos);
+      continue;
+    }
+    if (c == '{' || c == '[') {
+      open.push_back(containers_.size());
+      containers_.push_back(Container{pos, std::string::npos});
+    } else {
+      char opening = c == '}' ? '{' : '[';
+      if (open.empty() || json_[containers_[open.back()].begin] != opening) {
+        throw_malformed_json("unbalanced brackets");
+      }
+      containers_[open.back()].end = pos + 1;
+      open.pop_back();
+    }
+    pos++;
+  }
+  if (!open.empty()) {
+    throw_malformed_json("unbalanced brackets");
+  }
+}
+
+size_t LazyParameterTree::num_materialized() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return slots_.size();
+}
+
+const Parameter* LazyParameterTree::find(std::string_view name) const {
+  std::optional<Range> range;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slots_.find(std::string(name));
+    if (it != slots_.end()) {
+      range = it->second->range;
+    }
+  }
+  if (!range) {
+    range = resolve(name);
+  }
+  if (!range) {
+    return nullptr;
+  }
+  return &materialize(name, *range);
+}
+
+const Parameter& LazyParameterTree::root() const {
+  return materialize(root_name_, root_);
+}
+
+std::optional<LazyParameterTree::Range> LazyParameterTree::resolve(std::string_view name
+) const {
+  if (name == root_name_) {
+    return root_;
+  }
+  size_t prefix_size = root_name_.size() + DELIMITER.size();
+  if (name.size() <= prefix_size || name.substr(0, root_name_.size()) != root_name_ ||
+      name.substr(root_name_.size(), DELIMITER.size()) != DELIMITER) {
+    return std::nullopt;
+  }
+
+  // walk down the document one name segment at a time
+  Range range = root_;
+  size_t pos = prefix_size;
+  while (true) {
+    size_t next = name.find(DELIMITER, pos);
+    std::string_view segment =
+      name.substr(pos, next == std::string_view::npos ? next : next - pos);
+    std::optional<Range> child;
+    if (json_[range.begin] == '{') {
+      child = find_field(range, segment);
+    } else if (json_[range.begin] == '[') {
+      child = find_element(range, segment);
+    }
+    if (!child || next == std::string_view::npos) {
+      return child;
+    }
+    range = *child;
+    pos = next + DELIMITER.size();
+  }
+}
+
+const Parameter& LazyParameterTree::materialize(std::string_view name, Range range)
+  const {
+  Slot* slot = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Slot>& entry = slots_[std::string(name)];
+    if (!entry) {
+      entry = std::make_unique<Slot>();
+      entry->range = range;
+    }
+    slot = entry.get();
+  }
+  // the parameter is built outside of the lock so lookups of other parameters aren't
+  // blocked while it's being built
+  std::call_once(slot->once, [&]() {
+    const Range& bytes_range = slot->range;
+    std::string_view bytes = std::string_view(json_).substr(
+      bytes_range.begin, bytes_range.end - bytes_range.begin
+    );
+    slot->parameter.emplace(parse_json_string(std::string(name), bytes));
+  });
+  return *slot->parameter;
+}
+
+// ================================== SCANNING ===================================== //
+size_t LazyParameterTree::skip_whitespace(size_t pos) const {
+  while (pos < json_.size() && is_json_whitespace(json_[pos])) {
+    pos++;
+  }
+  return pos;
+}
+
+size_t LazyParameterTree::value_end(size_t pos) const {
+  char c = json_[pos];
+  if (c == '{' || c == '[') {
+    auto it = std::lower_bound(
+      containers_.begin(),
+      containers_.end(),
+      pos,
+      [](const Container& container, size_t begin) { return container.begin < begin; }
+    );
+    return it->end;
+  }
+  if (c == '"') {
+    return string_end(json_, pos);
+  }
+  // numbers and literals end at the next delimiter
+  size_t end = json_.find_first_of(",}] \t\n\r", pos);
+  return end == std::string::npos ? json_.size() : end;
+}
+
+std::string LazyParameterTree::read_key(size_t& pos) const {
+  if (json_[pos] != '"') {
+    throw_malformed_json("expected an object key");
+  }
+  size_t end = string_end(json_, pos);
+  std::string key = json_.substr(pos + 1, end - pos - 2);
+  if (key.find('\\') != std::string::npos) {
+    key = nlohmann::json::parse(json_.substr(pos, end - pos)).get<std::string>();
+  }
+  pos = end;
+  return key;
+}
+
+std::optional<LazyParameterTree::Range> LazyParameterTree::find_field(
+  Range object,
+  std::string_view key
+) const {
+  std::optional<Range> result;
+  size_t pos = skip_whitespace(object.begin + 1);
+  if (json_[pos] == '}') {
+    return result;
+  }
+  while (true) {
+    std::string field = read_key(pos);
+    pos = skip_whitespace(pos);
+    if (json_[pos] != ':') {
+      throw_malformed_json("expected ':' after an object key");
+    }
+    pos = skip_whitespace(pos + 1);
+    size_t end = value_end(pos);
+    // a repeated key overrides the previous value (as it does when parsing)
+    if (field == key) {
+      result = Range{pos, end};
+    }
+    pos = skip_whitespace(end);
+    if (json_[pos] == '}') {
+      return result;
+    }
+    if (json_[pos] != ',') {
+      throw_malformed_json("expected ',' or '}' after an object value");
+    }
+    pos = skip_whitespace(pos + 1);
+  }
+}
+
+std::optional<LazyParameterTree::Range> LazyParameterTree::find_element(
+  Range array,
+  std::string_view index
+) const {
+  size_t target = 0;
+  if (index.empty() || (index.size() > 1 && index[0] == '0')) {
+    return std::nullopt;
+  }
+  for (char c : index) {
+    if (c < '0' || c > '9') {
+      return std::nullopt;
+    }
+    target = target * 10 + (c - '0');
+  }
+
+  // only arrays of objects or arrays have child parameters
+  size_t pos = skip_whitespace(array.begin + 1);
+  char first = json_[pos];
+  if (first != '{' && first != '[') {
+    return std::nullopt;
+  }
+  for (size_t i = 0;; i++) {
+    size_t end = value_end(pos);
+    if (i == target) {
+      if (json_[pos] != first) {
+        throw std::runtime_error(
+          "Heterogeneous array types are not supported. Please contact Ben at "
+          "ben@miruml.com if you need this feature."
+        );
+      }
+      return Range{pos, end};
+    }
+    pos = skip_whitespace(end);
+    if (json_[pos] == ']') {
+      return std::nullopt;
+    }
+    if (json_[pos] != ',') {
+      throw_malformed_json("expected ',' or ']' after an array element");
+    }
+    pos = skip_whitespace(pos + 1);
+  }
+}
+
+}  // namespace miru::params
@@ -12,9 +12,11 @@ namespace miru::params {
 // The majority of the following code is take from ros2 rclcpp:
 // https://github.com/ros2/rclcpp/blob/a0a2a067d84fd6a38ab4f71b691d51ca5aa97ba5/rclcpp/src/rclcpp/parameter.cpp
 
-Parameter::Parameter() : name_("") {}
+Parameter::Parameter()
+  : name_(""), subtree_types_(type_mask(ParameterType::PARAMETER_NOT_SET)) {}
 
-Parameter::Parameter(const std::string& name) : name_(name) {
+Parameter::Parameter(const std::string& name)
+  : name_(name), subtree_types_(type_mask(ParameterType::PARAMETER_NOT_SET)) {
   // remove any trailing slashes from the name
   name_ = miru::utils::remove_trailing(name_, DELIMITER);
 }
@@ -32,26 +34,34 @@ void validate_child_parent_name_consistency(
 }
 
 Parameter::Parameter(const std::string& name, const ParameterValue& value)
-  : name_(name), value_(value) {
+  : Parameter(name, ParameterValue(value)) {}
+
+Parameter::Parameter(const std::string& name, ParameterValue&& value)
+  : name_(name),
+    value_(std::move(value)),
+    subtree_types_(type_mask(value_.get_type())) {
   // remove any trailing slashes from the name
   name_ = miru::utils::remove_trailing(name_, DELIMITER);
 
-  // check that the key doesn't have any slashes
+  // check that the key doesn't have any slashes and collect the types of the subtree
   std::vector<std::string> child_names;
   switch (value_.get_type()) {
     case ParameterType::PARAMETER_MAP:
       for (const auto& param : value_.get<ParameterType::PARAMETER_MAP>()) {
         validate_child_parent_name_consistency(name_, param);
+        subtree_types_ |= param.get_subtree_types();
       }
       break;
     case ParameterType::PARAMETER_MAP_ARRAY:
       for (const auto& item : value_.get<ParameterType::PARAMETER_MAP_ARRAY>()) {
         validate_child_parent_name_consistency(name_, item);
+        subtree_types_ |= item.get_subtree_types();
       }
       break;
     case ParameterType::PARAMETER_NESTED_ARRAY:
       for (const auto& item : value_.get<ParameterType::PARAMETER_NESTED_ARRAY>()) {
         validate_child_parent_name_consistency(name_, item);
+        subtree_types_ |= item.get_subtree_types();
       }
       break;
     default:
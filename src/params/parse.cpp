@@ -1,6 +1,19 @@
+// std
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 // internal
+#include <filesys/errors.hpp>
 #include <filesys/file.hpp>
+#include <miru/params/composite.hpp>
 #include <miru/params/parameter.hpp>
+#include <params/builder.hpp>
+#include <params/errors.hpp>
 #include <params/parse.hpp>
 
 // external
@@ -10,49 +23,20 @@
 
 namespace miru::params {
 
-miru::params::Parameter
-parse_json_node(const std::string& name, const nlohmann::json& node) {
-  switch (node.type()) {
-    case nlohmann::json::value_t::discarded:
-      throw std::runtime_error("Discarded node");
-    case nlohmann::json::value_t::null:
-      return miru::params::Parameter(name, nullptr);
-    case nlohmann::json::value_t::boolean:
-      return miru::params::Parameter(name, node.get<bool>());
-    case nlohmann::json::value_t::number_integer:
-      return miru::params::Parameter(name, node.get<int>());
-    case nlohmann::json::value_t::number_unsigned:
-      return miru::params::Parameter(name, node.get<unsigned int>());
-    case nlohmann::json::value_t::number_float:
-      return miru::params::Parameter(name, node.get<double>());
-    case nlohmann::json::value_t::binary:
-      throw std::runtime_error(
-        "Binary values are not supported. Please contact Ben at ben@miruml.com if "
-        "you need this feature."
-      );
-    case nlohmann::json::value_t::string:
-      return miru::params::Parameter(name, node.get<std::string>());
-    case nlohmann::json::value_t::array:
-      return parse_json_array(name, node);
-    case nlohmann::json::value_t::object: {
-      std::vector<miru::params::Parameter> entries;
-      for (const auto& entry : node.items()) {
-        std::string entry_name = name + DELIMITER + entry.key();
-        entries.push_back(parse_json_node(entry_name, entry.value()));
-      }
-      return miru::params::Parameter(name, miru::params::Map(entries));
-    }
+// ===================================== JSON ====================================== //
+// parameters hold signed 64 bit integers, unsigned integers which don't fit are
+// rejected (like the SAX parser does)
+int64_t parse_json_integer(const nlohmann::json& node) {
+  if (node.is_number_unsigned() &&
+      node.get<uint64_t>() >
+        static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    throw std::overflow_error("Unsigned integer value too large for Parameter");
   }
-  throw std::runtime_error("Unsupported node type");
+  return node.get<int64_t>();
 }
 
 miru::params::Parameter
-parse_json_array(const std::string& name, const nlohmann::json& node) {
-  // double check the node is an array
-  if (!node.is_array()) {
-    throw std::runtime_error("Node is not an array");
-  }
-
+parse_json_scalar_array(const std::string& name, const nlohmann::json& node) {
   // if it's empty then just return an empty scalar array
   if (node.empty()) {
     return miru::params::Parameter(
@@ -61,7 +45,7 @@ parse_json_array(const std::string& name, const nlohmann::json& node) {
   }
 
   // create an array of the correct type
-  nlohmann::json first_entry = node[0];
+  const nlohmann::json& first_entry = node[0];
   switch (first_entry.type()) {
     case nlohmann::json::value_t::discarded: {
       throw std::runtime_error("Discarded node");
@@ -76,13 +60,13 @@ parse_json_array(const std::string& name, const nlohmann::json& node) {
       std::vector<bool> array = node.get<std::vector<bool>>();
       return miru::params::Parameter(name, miru::params::ParameterValue(array));
     }
-    case nlohmann::json::value_t::number_integer: {
-      std::vector<int64_t> array = node.get<std::vector<int64_t>>();
-      return miru::params::Parameter(name, miru::params::ParameterValue(array));
-    }
+    case nlohmann::json::value_t::number_integer:
     case nlohmann::json::value_t::number_unsigned: {
-      // this is lossy ??
-      std::vector<int64_t> array = node.get<std::vector<int64_t>>();
+      std::vector<int64_t> array;
+      array.reserve(node.size());
+      for (const nlohmann::json& item : node) {
+        array.push_back(parse_json_integer(item));
+      }
       return miru::params::Parameter(name, miru::params::ParameterValue(array));
     }
     case nlohmann::json::value_t::number_float: {
@@ -99,49 +83,142 @@ parse_json_array(const std::string& name, const nlohmann::json& node) {
       std::vector<std::string> array = node.get<std::vector<std::string>>();
       return miru::params::Parameter(name, miru::params::ParameterValue(array));
     }
-    case nlohmann::json::value_t::array: {
-      std::vector<miru::params::Parameter> entries;
-      int i = 0;
-      for (const auto& entry : node.items()) {
-        if (entry.value().type() != nlohmann::json::value_t::array) {
-          throw std::runtime_error(
-            "Heterogeneous array types are not supported. Please contact Ben at "
-            "ben@miruml.com if you need this feature."
-          );
-        }
-        std::string entry_name = name + DELIMITER + std::to_string(i);
-        entries.push_back(parse_json_array(entry_name, entry.value()));
-        i++;
+    // arrays of arrays / objects have children
+    case nlohmann::json::value_t::array:
+    case nlohmann::json::value_t::object:
+      break;
+  }
+  throw std::runtime_error("Unsupported node type");
+}
+
+// builds the nodes without child parameters (scalars and arrays of scalars)
+miru::params::Parameter
+parse_json_leaf(const std::string& name, const nlohmann::json& node) {
+  switch (node.type()) {
+    case nlohmann::json::value_t::discarded:
+      throw std::runtime_error("Discarded node");
+    case nlohmann::json::value_t::null:
+      return miru::params::Parameter(name, nullptr);
+    case nlohmann::json::value_t::boolean:
+      return miru::params::Parameter(name, node.get<bool>());
+    case nlohmann::json::value_t::number_integer:
+    case nlohmann::json::value_t::number_unsigned:
+      return miru::params::Parameter(name, parse_json_integer(node));
+    case nlohmann::json::value_t::number_float:
+      return miru::params::Parameter(name, node.get<double>());
+    case nlohmann::json::value_t::binary:
+      throw std::runtime_error(
+        "Binary values are not supported. Please contact Ben at ben@miruml.com if "
+        "you need this feature."
+      );
+    case nlohmann::json::value_t::string:
+      return miru::params::Parameter(name, node.get<std::string>());
+    case nlohmann::json::value_t::array:
+      return parse_json_scalar_array(name, node);
+    case nlohmann::json::value_t::object:
+      break;
+  }
+  throw std::runtime_error("Unsupported node type");
+}
+
+bool has_json_children(const nlohmann::json& node) {
+  return node.is_object() || (node.is_array() && !node.empty() &&
+                              (node[0].is_object() || node[0].is_array()));
+}
+
+// an object or array of objects / arrays whose children are being built
+struct JsonFrame {
+  const nlohmann::json* node;
+  std::string name;
+  nlohmann::json::const_iterator next;
+  std::vector<miru::params::Parameter> children;
+};
+
+miru::params::Parameter finish_json_frame(JsonFrame& frame) {
+  if (frame.node->is_object()) {
+    return miru::params::Parameter(
+      frame.name, miru::params::Map(std::move(frame.children))
+    );
+  }
+  if (frame.node->front().is_object()) {
+    return miru::params::Parameter(
+      frame.name, miru::params::MapArray(std::move(frame.children))
+    );
+  }
+  return miru::params::Parameter(
+    frame.name, miru::params::NestedArray(std::move(frame.children))
+  );
+}
+
+miru::params::Parameter parse_json_node(
+  const std::string& name,
+  const nlohmann::json& node,
+  size_t max_depth
+) {
+  std::vector<JsonFrame> stack;
+  auto check_depth = [&](const std::string& value_name, const nlohmann::json& value) {
+    if ((value.is_object() || value.is_array()) && stack.size() >= max_depth) {
+      THROW_MAX_DEPTH_EXCEEDED(value_name, max_depth);
+    }
+  };
+
+  check_depth(name, node);
+  if (!has_json_children(node)) {
+    return parse_json_leaf(name, node);
+  }
+  stack.push_back(JsonFrame{&node, name, node.begin(), {}});
+  stack.back().children.reserve(node.size());
+
+  while (true) {
+    JsonFrame& frame = stack.back();
+    if (frame.next == frame.node->end()) {
+      miru::params::Parameter param = finish_json_frame(frame);
+      stack.pop_back();
+      if (stack.empty()) {
+        return param;
       }
-      return miru::params::Parameter(name, miru::params::NestedArray(entries));
-    }
-    case nlohmann::json::value_t::object: {
-      std::vector<miru::params::Parameter> entries;
-      int i = 0;
-      for (const auto& entry : node.items()) {
-        if (entry.value().type() != nlohmann::json::value_t::object) {
-          throw std::runtime_error(
-            "Heterogeneous array types are not supported. Please contact Ben at "
-            "ben@miruml.com if you need this feature."
-          );
-        }
-        std::string entry_name = name + DELIMITER + std::to_string(i);
-        entries.push_back(parse_json_node(entry_name, entry.value()));
-        i++;
+      stack.back().children.push_back(std::move(param));
+      continue;
+    }
+
+    const nlohmann::json& child = *frame.next;
+    std::string child_name;
+    if (frame.node->is_object()) {
+      child_name = frame.name + DELIMITER + frame.next.key();
+    } else {
+      if (child.type() != frame.node->front().type()) {
+        throw_heterogeneous_array();
       }
-      return miru::params::Parameter(name, miru::params::MapArray(entries));
+      child_name = frame.name + DELIMITER + std::to_string(frame.children.size());
+    }
+    ++frame.next;
+
+    check_depth(child_name, child);
+    if (!has_json_children(child)) {
+      frame.children.push_back(parse_json_leaf(child_name, child));
+      continue;
     }
+    // (invalidates the frame reference)
+    stack.push_back(JsonFrame{&child, std::move(child_name), child.begin(), {}});
+    stack.back().children.reserve(child.size());
   }
-  throw std::runtime_error("Unsupported node type");
 }
 
-miru::params::Parameter
-parse_yaml_array(const std::string& name, const YAML::Node& node) {
+miru::params::Parameter parse_json_array(
+  const std::string& name,
+  const nlohmann::json& node,
+  size_t max_depth
+) {
   // double check the node is an array
-  if (!node.IsSequence()) {
+  if (!node.is_array()) {
     throw std::runtime_error("Node is not an array");
   }
+  return parse_json_node(name, node, max_depth);
+}
 
+// ===================================== YAML ====================================== //
+miru::params::Parameter
+parse_yaml_scalar_array(const std::string& name, const YAML::Node& node) {
   // if it's empty than just return an empty scalar array
   if (node.size() == 0) {
     return miru::params::Parameter(
@@ -164,49 +241,25 @@ parse_yaml_array(const std::string& name, const YAML::Node& node) {
     case YAML::NodeType::Scalar: {
       std::vector<std::string> array = node.as<std::vector<std::string>>();
       std::vector<Scalar> scalar_array;
-      for (const auto& scalar : array) {
-        scalar_array.push_back(Scalar(scalar));
-      }
-      return miru::params::Parameter(name, miru::params::ParameterValue(scalar_array));
-    }
-    case YAML::NodeType::Sequence: {
-      std::vector<miru::params::Parameter> entries;
-      int i = 0;
-      for (const auto& entry : node) {
-        if (entry.Type() != YAML::NodeType::Sequence) {
-          throw std::runtime_error(
-            "Heterogeneous array types are not supported. Please contact Ben at "
-            "ben@miruml.com if you need this feature."
-          );
-        }
-        std::string entry_name = name + DELIMITER + std::to_string(i);
-        entries.push_back(parse_yaml_array(entry_name, entry));
-        i++;
+      scalar_array.reserve(array.size());
+      for (auto& scalar : array) {
+        scalar_array.push_back(Scalar(std::move(scalar)));
       }
-      return miru::params::Parameter(name, miru::params::NestedArray(entries));
-    }
-    case YAML::NodeType::Map: {
-      std::vector<miru::params::Parameter> entries;
-      int i = 0;
-      for (const auto& entry : node) {
-        if (entry.Type() != YAML::NodeType::Map) {
-          throw std::runtime_error(
-            "Heterogeneous array types are not supported. Please contact Ben at "
-            "ben@miruml.com if you need this feature."
-          );
-        }
-        std::string entry_name = name + DELIMITER + std::to_string(i);
-        entries.push_back(parse_yaml_node(entry_name, entry));
-        i++;
-      }
-      return miru::params::Parameter(name, miru::params::MapArray(entries));
+      return miru::params::Parameter(
+        name, miru::params::ParameterValue(std::move(scalar_array))
+      );
     }
+    // sequences of sequences / maps have children
+    case YAML::NodeType::Sequence:
+    case YAML::NodeType::Map:
+      break;
   }
   throw std::runtime_error("Unsupported node type");
 }
 
+// builds the nodes without child parameters (scalars and sequences of scalars)
 miru::params::Parameter
-parse_yaml_node(const std::string& name, const YAML::Node& node) {
+parse_yaml_leaf(const std::string& name, const YAML::Node& node) {
   switch (node.Type()) {
     case YAML::NodeType::Undefined:
       throw std::runtime_error("Undefined node");
@@ -215,17 +268,131 @@ parse_yaml_node(const std::string& name, const YAML::Node& node) {
     case YAML::NodeType::Scalar:
       return miru::params::Parameter(name, Scalar(node.as<std::string>()));
     case YAML::NodeType::Sequence:
-      return parse_yaml_array(name, node);
-    case YAML::NodeType::Map: {
-      std::vector<miru::params::Parameter> entries;
-      for (const auto& it : node) {
-        std::string entry_name = name + DELIMITER + it.first.as<std::string>();
-        entries.push_back(parse_yaml_node(entry_name, it.second));
+      return parse_yaml_scalar_array(name, node);
+    case YAML::NodeType::Map:
+      break;
+  }
+  throw std::runtime_error("Unsupported node type");
+}
+
+YAML::NodeType::value yaml_children_type(const YAML::Node& node) {
+  if (node.IsMap()) {
+    return YAML::NodeType::Map;
+  }
+  if (!node.IsSequence() || node.size() == 0) {
+    return YAML::NodeType::Undefined;
+  }
+  YAML::NodeType::value type = node.begin()->Type();
+  if (type == YAML::NodeType::Map || type == YAML::NodeType::Sequence) {
+    return type;
+  }
+  return YAML::NodeType::Undefined;
+}
+
+// a map or sequence of maps / sequences whose children are being built
+struct YamlFrame {
+  YAML::Node node;
+  std::string name;
+  // the type of the elements of sequences
+  YAML::NodeType::value element_type;
+  YAML::const_iterator next;
+  YAML::const_iterator end;
+  std::vector<miru::params::Parameter> children;
+};
+
+miru::params::Parameter finish_yaml_frame(YamlFrame& frame) {
+  if (frame.node.IsMap()) {
+    return miru::params::Parameter(
+      frame.name, miru::params::Map(std::move(frame.children))
+    );
+  }
+  if (frame.element_type == YAML::NodeType::Map) {
+    return miru::params::Parameter(
+      frame.name, miru::params::MapArray(std::move(frame.children))
+    );
+  }
+  return miru::params::Parameter(
+    frame.name, miru::params::NestedArray(std::move(frame.children))
+  );
+}
+
+miru::params::Parameter parse_yaml_node(
+  const std::string& name,
+  const YAML::Node& node,
+  size_t max_depth
+) {
+  std::vector<YamlFrame> stack;
+  auto check_depth = [&](const std::string& value_name, const YAML::Node& value) {
+    if ((value.IsMap() || value.IsSequence()) && stack.size() >= max_depth) {
+      THROW_MAX_DEPTH_EXCEEDED(value_name, max_depth);
+    }
+  };
+  auto push = [&](
+                std::string frame_name,
+                const YAML::Node& value,
+                YAML::NodeType::value children_type
+              ) {
+    stack.push_back(YamlFrame{
+      value, std::move(frame_name), children_type, value.begin(), value.end(), {}
+    });
+    stack.back().children.reserve(value.size());
+  };
+
+  check_depth(name, node);
+  YAML::NodeType::value children_type = yaml_children_type(node);
+  if (children_type == YAML::NodeType::Undefined) {
+    return parse_yaml_leaf(name, node);
+  }
+  push(name, node, children_type);
+
+  while (true) {
+    YamlFrame& frame = stack.back();
+    if (frame.next == frame.end) {
+      miru::params::Parameter param = finish_yaml_frame(frame);
+      stack.pop_back();
+      if (stack.empty()) {
+        return param;
+      }
+      stack.back().children.push_back(std::move(param));
+      continue;
+    }
+
+    // (reset() refers to the child instead of assigning to the node)
+    std::string child_name;
+    YAML::Node child;
+    if (frame.node.IsMap()) {
+      child_name = frame.name + DELIMITER + frame.next->first.as<std::string>();
+      child.reset(frame.next->second);
+    } else {
+      child.reset(*frame.next);
+      if (child.Type() != frame.element_type) {
+        throw_heterogeneous_array();
       }
-      return miru::params::Parameter(name, miru::params::Map(entries));
+      child_name = frame.name + DELIMITER + std::to_string(frame.children.size());
+    }
+    ++frame.next;
+
+    check_depth(child_name, child);
+    children_type = yaml_children_type(child);
+    if (children_type == YAML::NodeType::Undefined) {
+      frame.children.push_back(parse_yaml_leaf(child_name, child));
+      continue;
     }
+    // (invalidates the frame reference)
+    push(std::move(child_name), child, children_type);
   }
-  throw std::runtime_error("Unsupported node type");
+}
+
+miru::params::Parameter parse_yaml_array(
+  const std::string& name,
+  const YAML::Node& node,
+  size_t max_depth
+) {
+  // double check the node is an array
+  if (!node.IsSequence()) {
+    throw std::runtime_error("Node is not an array");
+  }
+  return parse_yaml_node(name, node, max_depth);
 }
 
 miru::params::Parameter parse_structured_data(
@@ -242,8 +409,30 @@ miru::params::Parameter parse_structured_data(
 
 miru::params::Parameter
 parse_file(const std::string& name, const miru::filesys::File& file) {
-  std::variant<nlohmann::json, YAML::Node> data = file.read_structured_data();
-  return parse_structured_data(name, data);
+  return parse_file(name, miru::filesys::LoadedFile(file));
+}
+
+miru::params::Parameter
+parse_file(const std::string& name, const miru::filesys::LoadedFile& file) {
+  // files are parsed straight into the parameter tree (without a document) from a
+  // view over their bytes
+  switch (file.file_type()) {
+    case miru::filesys::FileType::JSON:
+      return parse_json_string(name, file.bytes());
+    case miru::filesys::FileType::YAML: {
+      miru::filesys::ViewStreamBuf buf(file.bytes());
+      std::istream stream(&buf);
+      return parse_yaml_stream(name, stream);
+    }
+    case miru::filesys::FileType::MSGPACK:
+      return parse_msgpack_string(name, file.bytes());
+    case miru::filesys::FileType::CBOR:
+      return parse_cbor_string(name, file.bytes());
+  }
+  THROW_INVALID_FILE_TYPE(
+    file.file().path().string(),
+    miru::filesys::file_types_to_strings(miru::filesys::supported_file_types())
+  );
 }
 
 }  // namespace miru::params
\ No newline at end of file
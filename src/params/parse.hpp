@@ -1,7 +1,14 @@
 #pragma once
 
+// std
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+
 // internal
 #include <filesys/file.hpp>
+#include <miru/params/parallel.hpp>
 #include <miru/params/parameter.hpp>
 
 // external
@@ -11,17 +18,119 @@
 
 namespace miru::params {
 
-miru::params::Parameter
-parse_yaml_node(const std::string& name, const YAML::Node& node);
+// The document parsers below build the tree with an explicit stack (rather than by
+// recursion) and throw MaxDepthExceededError for documents with more than max_depth
+// nested maps / arrays.
+miru::params::Parameter parse_yaml_node(
+  const std::string& name,
+  const YAML::Node& node,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
 
-miru::params::Parameter
-parse_yaml_array(const std::string& name, const YAML::Node& node);
+miru::params::Parameter parse_yaml_array(
+  const std::string& name,
+  const YAML::Node& node,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
 
-miru::params::Parameter
-parse_json_node(const std::string& name, const nlohmann::json& node);
+miru::params::Parameter parse_json_node(
+  const std::string& name,
+  const nlohmann::json& node,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
 
-miru::params::Parameter
-parse_json_array(const std::string& name, const nlohmann::json& node);
+miru::params::Parameter parse_json_array(
+  const std::string& name,
+  const nlohmann::json& node,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+// whether the node has child parameters (maps and arrays of maps / arrays do)
+bool has_json_children(const nlohmann::json& node);
+
+// the type of the children of the node (maps have map children) or Undefined if it
+// has no child parameters
+YAML::NodeType::value yaml_children_type(const YAML::Node& node);
+
+// Build the parameter tree straight from json text (see ParamTreeBuilder) instead of
+// parsing it into a nlohmann::json document first. The resulting tree is the same as
+// parse_json_node() returns for the document.
+miru::params::Parameter parse_json_stream(
+  const std::string& name,
+  std::istream& stream,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+miru::params::Parameter parse_json_string(
+  const std::string& name,
+  std::string_view json,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+// only builds the tree for the value of the given field of the top level json object
+// and skips the rest of the document
+miru::params::Parameter parse_json_string_field(
+  const std::string& name,
+  std::string_view json,
+  const std::string& field,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+// Build the parameter tree straight from MessagePack / CBOR encoded documents. The
+// resulting tree is the same as parse_json_string() returns for the json text of the
+// document.
+miru::params::Parameter parse_msgpack_stream(
+  const std::string& name,
+  std::istream& stream,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+miru::params::Parameter parse_msgpack_string(
+  const std::string& name,
+  std::string_view msgpack,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+miru::params::Parameter parse_msgpack_string_field(
+  const std::string& name,
+  std::string_view msgpack,
+  const std::string& field,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+miru::params::Parameter parse_cbor_stream(
+  const std::string& name,
+  std::istream& stream,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+miru::params::Parameter parse_cbor_string(
+  const std::string& name,
+  std::string_view cbor,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+miru::params::Parameter parse_cbor_string_field(
+  const std::string& name,
+  std::string_view cbor,
+  const std::string& field,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+// Build the parameter tree straight from the events of the yaml parser instead of
+// loading a YAML::Node graph first. The resulting tree is the same as
+// parse_yaml_node() returns for the loaded node.
+miru::params::Parameter parse_yaml_stream(
+  const std::string& name,
+  std::istream& stream,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+miru::params::Parameter parse_yaml_string(
+  const std::string& name,
+  const std::string& yaml,
+  size_t max_depth = DEFAULT_MAX_DEPTH
+);
 
 miru::params::Parameter parse_structured_data(
   const std::variant<nlohmann::json, YAML::Node>& node
@@ -29,5 +138,34 @@ miru::params::Parameter parse_structured_data(
 
 miru::params::Parameter
 parse_file(const std::string& name, const miru::filesys::File& file);
+miru::params::Parameter
+parse_file(const std::string& name, const miru::filesys::LoadedFile& file);
+
+// Build the children of the tree concurrently (see ParallelParseOptions). The
+// resulting tree is the same as the serial overload returns. If several subtrees are
+// invalid, which of their errors is thrown is unspecified.
+miru::params::Parameter parse_json_node(
+  const std::string& name,
+  const nlohmann::json& node,
+  const ParallelParseOptions& options
+);
+
+miru::params::Parameter parse_yaml_node(
+  const std::string& name,
+  const YAML::Node& node,
+  const ParallelParseOptions& options
+);
+
+// reads the entire document before building the tree (unlike the serial overload)
+miru::params::Parameter parse_file(
+  const std::string& name,
+  const miru::filesys::File& file,
+  const ParallelParseOptions& options
+);
+miru::params::Parameter parse_file(
+  const std::string& name,
+  const miru::filesys::LoadedFile& file,
+  const ParallelParseOptions& options
+);
 
 }  // namespace miru::params
\ No newline at end of file
@@ -0,0 +1,208 @@
+// std
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <variant>
+
+// internal
+#include <filesys/file.hpp>
+#include <miru/parallel/thread_pool.hpp>
+#include <miru/params/composite.hpp>
+#include <miru/params/parallel.hpp>
+#include <params/builder.hpp>
+#include <params/errors.hpp>
+#include <params/parse.hpp>
+
+// external
+#include <yaml-cpp/yaml.h>
+
+#include <nlohmann/json.hpp>
+
+namespace miru::params {
+
+// ================================ PARALLEL PARSING =============================== //
+miru::parallel::ThreadPool& pool_of(const ParallelParseOptions& options) {
+  return options.pool ? *options.pool : miru::parallel::ThreadPool::shared();
+}
+
+// whether the children of a node at the given depth are built concurrently
+bool split_children(
+  size_t num_children,
+  size_t depth,
+  const ParallelParseOptions& options
+) {
+  if (depth == 0) {
+    return num_children >= 2;
+  }
+  return num_children >= std::max<size_t>(2, options.min_parallel_children);
+}
+
+// builds the children of a node concurrently with build(i) and returns them in
+// document order
+template <typename BuildT>
+std::vector<Parameter> build_children(
+  size_t num_children,
+  size_t depth,
+  const ParallelParseOptions& options,
+  miru::parallel::ThreadPool& pool,
+  const BuildT& build
+) {
+  size_t chunk_size = std::max<size_t>(1, options.chunk_size);
+  if (depth == 0) {
+    // the top level members may be few but large so they are split into a few chunks
+    // per thread which idle workers can steal
+    size_t num_root_chunks = 4 * pool.num_threads();
+    chunk_size =
+      std::min(chunk_size, (num_children + num_root_chunks - 1) / num_root_chunks);
+  }
+  size_t num_chunks = (num_children + chunk_size - 1) / chunk_size;
+  std::vector<Parameter> children(num_children);
+  miru::parallel::TaskGroup group(pool);
+  for (size_t i = 0; i < num_chunks; i++) {
+    group.run([&, i]() {
+      size_t end = std::min(num_children, (i + 1) * chunk_size);
+      for (size_t j = i * chunk_size; j < end; j++) {
+        children[j] = build(j);
+      }
+    });
+  }
+  group.wait();
+  return children;
+}
+
+// ===================================== JSON ====================================== //
+Parameter parse_json_node_parallel(
+  const std::string& name,
+  const nlohmann::json& node,
+  size_t depth,
+  const ParallelParseOptions& options,
+  miru::parallel::ThreadPool& pool
+) {
+  // subtrees which aren't split are built by the serial parse
+  if (!has_json_children(node) || !split_children(node.size(), depth, options)) {
+    return parse_json_node(name, node, options.max_depth - depth);
+  }
+  if (depth >= options.max_depth) {
+    THROW_MAX_DEPTH_EXCEEDED(name, options.max_depth);
+  }
+
+  if (node.is_object()) {
+    std::vector<std::pair<std::string, const nlohmann::json*>> members;
+    members.reserve(node.size());
+    for (const auto& entry : node.items()) {
+      members.emplace_back(name + DELIMITER + entry.key(), &entry.value());
+    }
+    std::vector<Parameter> entries =
+      build_children(members.size(), depth, options, pool, [&](size_t i) {
+        return parse_json_node_parallel(
+          members[i].first, *members[i].second, depth + 1, options, pool
+        );
+      });
+    return Parameter(name, Map(std::move(entries)));
+  }
+
+  for (const auto& entry : node) {
+    if (entry.type() != node[0].type()) {
+      throw_heterogeneous_array();
+    }
+  }
+  std::vector<Parameter> entries =
+    build_children(node.size(), depth, options, pool, [&](size_t i) {
+      std::string entry_name = name + DELIMITER + std::to_string(i);
+      return parse_json_node_parallel(entry_name, node[i], depth + 1, options, pool);
+    });
+  if (node[0].is_object()) {
+    return Parameter(name, MapArray(std::move(entries)));
+  }
+  return Parameter(name, NestedArray(std::move(entries)));
+}
+
+Parameter parse_json_node(
+  const std::string& name,
+  const nlohmann::json& node,
+  const ParallelParseOptions& options
+) {
+  return parse_json_node_parallel(name, node, 0, options, pool_of(options));
+}
+
+// ===================================== YAML ====================================== //
+Parameter parse_yaml_node_parallel(
+  const std::string& name,
+  const YAML::Node& node,
+  size_t depth,
+  const ParallelParseOptions& options,
+  miru::parallel::ThreadPool& pool
+) {
+  // subtrees which aren't split are built by the serial parse
+  YAML::NodeType::value children_type = yaml_children_type(node);
+  if (children_type == YAML::NodeType::Undefined ||
+      !split_children(node.size(), depth, options)) {
+    return parse_yaml_node(name, node, options.max_depth - depth);
+  }
+  if (depth >= options.max_depth) {
+    THROW_MAX_DEPTH_EXCEEDED(name, options.max_depth);
+  }
+
+  // the nodes are collected up front since yaml nodes don't support random access
+  // (this also keeps the conversion of keys on the calling thread)
+  std::vector<std::pair<std::string, YAML::Node>> children;
+  children.reserve(node.size());
+  if (node.IsMap()) {
+    for (const auto& it : node) {
+      children.emplace_back(name + DELIMITER + it.first.as<std::string>(), it.second);
+    }
+  } else {
+    for (const auto& entry : node) {
+      if (entry.Type() != children_type) {
+        throw_heterogeneous_array();
+      }
+      children.emplace_back(name + DELIMITER + std::to_string(children.size()), entry);
+    }
+  }
+  std::vector<Parameter> entries =
+    build_children(children.size(), depth, options, pool, [&](size_t i) {
+      return parse_yaml_node_parallel(
+        children[i].first, children[i].second, depth + 1, options, pool
+      );
+    });
+  if (node.IsMap()) {
+    return Parameter(name, Map(std::move(entries)));
+  }
+  if (children_type == YAML::NodeType::Map) {
+    return Parameter(name, MapArray(std::move(entries)));
+  }
+  return Parameter(name, NestedArray(std::move(entries)));
+}
+
+Parameter parse_yaml_node(
+  const std::string& name,
+  const YAML::Node& node,
+  const ParallelParseOptions& options
+) {
+  return parse_yaml_node_parallel(name, node, 0, options, pool_of(options));
+}
+
+// ===================================== FILES ===================================== //
+Parameter parse_file(
+  const std::string& name,
+  const miru::filesys::File& file,
+  const ParallelParseOptions& options
+) {
+  return parse_file(name, miru::filesys::LoadedFile(file), options);
+}
+
+Parameter parse_file(
+  const std::string& name,
+  const miru::filesys::LoadedFile& file,
+  const ParallelParseOptions& options
+) {
+  // the children can only be built concurrently once the whole document is parsed
+  const std::variant<nlohmann::json, YAML::Node>& document = file.document();
+  if (std::holds_alternative<YAML::Node>(document)) {
+    return parse_yaml_node(name, std::get<YAML::Node>(document), options);
+  }
+  return parse_json_node(name, std::get<nlohmann::json>(document), options);
+}
+
+}  // namespace miru::params
@@ -300,6 +300,51 @@ ParameterValue::ParameterValue(const MapArray& map_array_value) {
   type_ = ParameterType::PARAMETER_MAP_ARRAY;
 }
 
+ParameterValue::ParameterValue(std::string&& string_value) {
+  value_ = std::move(string_value);
+  type_ = ParameterType::PARAMETER_STRING;
+}
+
+ParameterValue::ParameterValue(std::vector<bool>&& bool_array_value) {
+  value_ = std::move(bool_array_value);
+  type_ = ParameterType::PARAMETER_BOOL_ARRAY;
+}
+
+ParameterValue::ParameterValue(std::vector<int64_t>&& int_array_value) {
+  value_ = std::move(int_array_value);
+  type_ = ParameterType::PARAMETER_INTEGER_ARRAY;
+}
+
+ParameterValue::ParameterValue(std::vector<double>&& double_array_value) {
+  value_ = std::move(double_array_value);
+  type_ = ParameterType::PARAMETER_DOUBLE_ARRAY;
+}
+
+ParameterValue::ParameterValue(std::vector<std::string>&& string_array_value) {
+  value_ = std::move(string_array_value);
+  type_ = ParameterType::PARAMETER_STRING_ARRAY;
+}
+
+ParameterValue::ParameterValue(std::vector<Scalar>&& scalar_array_value) {
+  value_ = std::move(scalar_array_value);
+  type_ = ParameterType::PARAMETER_SCALAR_ARRAY;
+}
+
+ParameterValue::ParameterValue(NestedArray&& nested_array_value) {
+  value_ = std::move(nested_array_value);
+  type_ = ParameterType::PARAMETER_NESTED_ARRAY;
+}
+
+ParameterValue::ParameterValue(Map&& map_value) {
+  value_ = std::move(map_value);
+  type_ = ParameterType::PARAMETER_MAP;
+}
+
+ParameterValue::ParameterValue(MapArray&& map_array_value) {
+  value_ = std::move(map_array_value);
+  type_ = ParameterType::PARAMETER_MAP_ARRAY;
+}
+
 bool ParameterValue::is_null() const { return type_ == ParameterType::PARAMETER_NULL; }
 
 bool ParameterValue::is_scalar() const {
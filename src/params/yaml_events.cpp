@@ -0,0 +1,248 @@
+// std
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// internal
+#include <params/builder.hpp>
+#include <params/parse.hpp>
+
+// external
+#include <yaml-cpp/anchor.h>
+#include <yaml-cpp/eventhandler.h>
+#include <yaml-cpp/mark.h>
+#include <yaml-cpp/parser.h>
+
+namespace miru::params {
+
+// ================================= YAML EVENTS =================================== //
+// Forwards the events of yaml-cpp's parser to a ParamTreeBuilder. The events of
+// anchored nodes are recorded so that aliases can be replayed as copies of the node
+// (as YAML::Load resolves them).
+class YamlEvents : public YAML::EventHandler {
+ public:
+  explicit YamlEvents(ParamTreeBuilder& builder) : builder_(builder) {}
+
+  void OnDocumentStart(const YAML::Mark& /*unused*/) override {}
+  void OnDocumentEnd() override {}
+
+  void OnNull(const YAML::Mark& /*unused*/, YAML::anchor_t anchor) override {
+    handle(Event{EventKind::NULL_VALUE, ""}, anchor);
+  }
+
+  void OnAlias(const YAML::Mark& /*unused*/, YAML::anchor_t anchor) override {
+    auto it = anchors_.find(anchor);
+    if (it == anchors_.end()) {
+      throw std::runtime_error("Aliases of a node inside the node are not supported");
+    }
+    for (const Event& event : it->second) {
+      handle(event, YAML::NullAnchor);
+    }
+  }
+
+  void OnScalar(
+    const YAML::Mark& /*unused*/,
+    const std::string& /*unused*/,
+    YAML::anchor_t anchor,
+    const std::string& value
+  ) override {
+    handle(Event{EventKind::SCALAR, value}, anchor);
+  }
+
+  void OnSequenceStart(
+    const YAML::Mark& /*unused*/,
+    const std::string& /*unused*/,
+    YAML::anchor_t anchor,
+    YAML::EmitterStyle::value /*unused*/
+  ) override {
+    handle(Event{EventKind::SEQUENCE_START, ""}, anchor);
+  }
+
+  void OnSequenceEnd() override {
+    handle(Event{EventKind::SEQUENCE_END, ""}, YAML::NullAnchor);
+  }
+
+  void OnMapStart(
+    const YAML::Mark& /*unused*/,
+    const std::string& /*unused*/,
+    YAML::anchor_t anchor,
+    YAML::EmitterStyle::value /*unused*/
+  ) override {
+    handle(Event{EventKind::MAP_START, ""}, anchor);
+  }
+
+  void OnMapEnd() override { handle(Event{EventKind::MAP_END, ""}, YAML::NullAnchor); }
+
+ private:
+  enum class EventKind : uint8_t {
+    NULL_VALUE,
+    SCALAR,
+    SEQUENCE_START,
+    SEQUENCE_END,
+    MAP_START,
+    MAP_END,
+  };
+
+  struct Event {
+    EventKind kind;
+    std::string value;
+  };
+
+  // an anchored node which is still being parsed
+  struct Recording {
+    YAML::anchor_t anchor;
+    size_t depth;
+    std::vector<Event> events;
+  };
+
+  struct Frame {
+    bool is_map;
+    // maps: whether the next node is a key
+    bool expect_key;
+    // sequences: the number of elements and whether the first was a scalar
+    size_t size;
+    bool scalar_array;
+  };
+
+  void handle(const Event& event, YAML::anchor_t anchor) {
+    record(event, anchor);
+    switch (event.kind) {
+      case EventKind::NULL_VALUE:
+        return null_value();
+      case EventKind::SCALAR:
+        return scalar(event.value);
+      case EventKind::SEQUENCE_START:
+        return start(false);
+      case EventKind::MAP_START:
+        return start(true);
+      case EventKind::SEQUENCE_END:
+      case EventKind::MAP_END:
+        return end();
+    }
+  }
+
+  void record(const Event& event, YAML::anchor_t anchor) {
+    if (anchor != YAML::NullAnchor) {
+      recordings_.push_back(Recording{anchor, 0, {}});
+    }
+    if (recordings_.empty()) {
+      return;
+    }
+    bool starts = event.kind == EventKind::SEQUENCE_START ||
+                  event.kind == EventKind::MAP_START;
+    bool ends =
+      event.kind == EventKind::SEQUENCE_END || event.kind == EventKind::MAP_END;
+    for (Recording& recording : recordings_) {
+      recording.events.push_back(event);
+      if (starts) {
+        recording.depth++;
+      } else if (ends) {
+        recording.depth--;
+      }
+    }
+    // anchored nodes are nested so the innermost ones complete first
+    while (!recordings_.empty() && recordings_.back().depth == 0) {
+      anchors_[recordings_.back().anchor] = std::move(recordings_.back().events);
+      recordings_.pop_back();
+    }
+  }
+
+  bool expect_key() const {
+    return !stack_.empty() && stack_.back().is_map && stack_.back().expect_key;
+  }
+
+  void null_value() {
+    // a null key is read as "null" (as YAML::Node::as<std::string>() does)
+    if (expect_key()) {
+      builder_.key("null");
+      stack_.back().expect_key = false;
+      return;
+    }
+    // as are null elements of scalar arrays
+    if (!stack_.empty() && !stack_.back().is_map && stack_.back().scalar_array) {
+      builder_.scalar_value("null");
+    } else {
+      builder_.null_value();
+    }
+    value_done();
+  }
+
+  void scalar(const std::string& value) {
+    if (expect_key()) {
+      builder_.key(value);
+      stack_.back().expect_key = false;
+      return;
+    }
+    if (!stack_.empty() && !stack_.back().is_map && stack_.back().size == 0) {
+      stack_.back().scalar_array = true;
+    }
+    builder_.scalar_value(value);
+    value_done();
+  }
+
+  void start(bool is_map) {
+    if (expect_key()) {
+      throw std::runtime_error("Only scalar map keys are supported");
+    }
+    if (is_map) {
+      builder_.start_map();
+    } else {
+      builder_.start_array();
+    }
+    stack_.push_back(Frame{is_map, is_map, 0, false});
+  }
+
+  void end() {
+    bool is_map = stack_.back().is_map;
+    stack_.pop_back();
+    if (is_map) {
+      builder_.end_map();
+    } else {
+      builder_.end_array();
+    }
+    value_done();
+  }
+
+  void value_done() {
+    if (stack_.empty()) {
+      return;
+    }
+    Frame& parent = stack_.back();
+    if (parent.is_map) {
+      parent.expect_key = true;
+    } else {
+      parent.size++;
+    }
+  }
+
+  ParamTreeBuilder& builder_;
+  std::vector<Frame> stack_;
+  std::vector<Recording> recordings_;
+  std::unordered_map<YAML::anchor_t, std::vector<Event>> anchors_;
+};
+
+Parameter
+parse_yaml_stream(const std::string& name, std::istream& stream, size_t max_depth) {
+  ParamTreeBuilder builder(name, ParamTreeBuilder::DuplicateKeys::REJECT, max_depth);
+  YamlEvents events(builder);
+  YAML::Parser parser(stream);
+  // like YAML::Load only the first document is read and an empty stream is null
+  if (!parser.HandleNextDocument(events)) {
+    return Parameter(name, nullptr);
+  }
+  return builder.result();
+}
+
+Parameter parse_yaml_string(
+  const std::string& name,
+  const std::string& yaml,
+  size_t max_depth
+) {
+  std::istringstream stream(yaml);
+  return parse_yaml_stream(name, stream, max_depth);
+}
+
+}  // namespace miru::params
@@ -0,0 +1,105 @@
+// std
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+// internal
+#include <miru/query/cache.hpp>
+
+namespace miru::query {
+
+// ================================= QUERY CACHE ================================== //
+std::string to_string(const QueryCacheStats& stats) {
+  std::stringstream ss;
+  ss << "QueryCacheStats(hits: " << stats.hits << ", misses: " << stats.misses
+     << ", size: " << stats.size << ", capacity: " << stats.capacity << ")";
+  return ss.str();
+}
+
+QueryCache::QueryCache(size_t capacity) : capacity_(capacity) {
+  if (capacity_ == 0) {
+    throw std::invalid_argument("Query cache capacity must be greater than 0");
+  }
+}
+
+QueryCache::EntryList::iterator QueryCache::find(
+  const SearchParamFilters& filters,
+  size_t hash
+) {
+  auto range = lookup_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second->filters.equivalent(filters)) {
+      return it->second;
+    }
+  }
+  return entries_.end();
+}
+
+bool QueryCache::get(
+  const SearchParamFilters& filters,
+  std::vector<const Parameter*>& result
+) {
+  size_t hash = filters.canonical_hash();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = find(filters, hash);
+  if (entry == entries_.end()) {
+    misses_++;
+    return false;
+  }
+
+  // mark the entry as the most recently used
+  entries_.splice(entries_.begin(), entries_, entry);
+  hits_++;
+  result = entry->result;
+  return true;
+}
+
+void QueryCache::put(
+  const SearchParamFilters& filters,
+  const std::vector<const Parameter*>& result
+) {
+  size_t hash = filters.canonical_hash();
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // another thread may have cached the same filters in the meantime
+  auto entry = find(filters, hash);
+  if (entry != entries_.end()) {
+    entries_.splice(entries_.begin(), entries_, entry);
+    entry->result = result;
+    return;
+  }
+
+  // evict the least recently used entry
+  if (entries_.size() >= capacity_) {
+    auto lru = std::prev(entries_.end());
+    auto range = lookup_.equal_range(lru->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == lru) {
+        lookup_.erase(it);
+        break;
+      }
+    }
+    entries_.pop_back();
+  }
+
+  entries_.push_front(Entry{hash, filters, result});
+  lookup_.emplace(hash, entries_.begin());
+}
+
+void QueryCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  lookup_.clear();
+}
+
+QueryCacheStats QueryCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  QueryCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.size = entries_.size();
+  stats.capacity = capacity_;
+  return stats;
+}
+
+}  // namespace miru::query
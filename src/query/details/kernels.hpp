@@ -0,0 +1,44 @@
+#pragma once
+
+// std
+#include <cstddef>
+
+namespace miru::query::details {
+
+// Kernels over contiguous numeric storage. Each kernel counts the elements satisfying
+// its condition with a branch-free loop body and no early exit so that the compiler
+// can vectorize it; callers derive 'any' (count > 0) and 'all' (count == size) from
+// the count and exit early between blocks instead (see KERNEL_BLOCK_SIZE).
+
+inline constexpr size_t KERNEL_BLOCK_SIZE = 1024;
+
+template <typename T>
+size_t count_in_range(const T* values, size_t size, double min, double max) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; i++) {
+    double value = static_cast<double>(values[i]);
+    count += static_cast<size_t>((value >= min) & (value <= max));
+  }
+  return count;
+}
+
+template <typename T>
+size_t count_one_of(
+  const T* values,
+  size_t size,
+  const double* candidates,
+  size_t num_candidates
+) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; i++) {
+    double value = static_cast<double>(values[i]);
+    bool found = false;
+    for (size_t j = 0; j < num_candidates; j++) {
+      found |= value == candidates[j];
+    }
+    count += static_cast<size_t>(found);
+  }
+  return count;
+}
+
+}  // namespace miru::query::details
@@ -1,16 +1,25 @@
 // std
+#include <algorithm>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 // internal
 #include <configs/instance_impl.hpp>
+#include <miru/configs/mapped_snapshot.hpp>
 #include <miru/params/iterator.hpp>
+#include <miru/params/lazy.hpp>
 #include <miru/params/parameter.hpp>
+#include <miru/parallel/thread_pool.hpp>
+#include <miru/query/index.hpp>
 #include <miru/query/query.hpp>
 #include <params/utils.hpp>
 
 namespace miru::query::details {
 
-void find_all_recursive_helper(
+// a depth first (pre-order) search which keeps the children left to visit at each
+// level on an explicit stack so deep trees can't overflow the call stack
+void find_all_helper(
   const Parameter& parameter,
   std::vector<const Parameter*>& result,
   const SearchParamFilters& filters
@@ -25,16 +34,42 @@ void find_all_recursive_helper(
     return;
   }
 
-  // find recursively
-  for (const auto& item : miru::params::get_children_view(parameter)) {
-    find_all_recursive_helper(item, result, filters);
+  // the level being searched is kept in locals and the rest of a level is only
+  // pushed when descending into one of its children
+  using ParameterIterator = miru::params::ParameterIterator;
+  ParametersView children = miru::params::get_children_view(parameter);
+  ParameterIterator next = children.begin();
+  ParameterIterator end = children.end();
+  std::vector<std::pair<ParameterIterator, ParameterIterator>> stack;
+  while (true) {
+    while (next != end) {
+      const Parameter& child = *next;
+      ++next;
+      if (filters.matches(child)) {
+        result.push_back(&child);
+      }
+      if (filters.continue_search(child)) {
+        if (next != end) {
+          stack.push_back(std::make_pair(next, end));
+        }
+        ParametersView grandchildren = miru::params::get_children_view(child);
+        next = grandchildren.begin();
+        end = grandchildren.end();
+      }
+    }
+    if (stack.empty()) {
+      return;
+    }
+    next = stack.back().first;
+    end = stack.back().second;
+    stack.pop_back();
   }
 }
 
 std::vector<const Parameter*>
 find_all(const Parameter& root, const SearchParamFilters& filters) {
   std::vector<const Parameter*> result;
-  find_all_recursive_helper(root, result, filters);
+  find_all_helper(root, result, filters);
   return result;
 }
 
@@ -42,9 +77,7 @@ std::vector<const Parameter*>
 find_all(const ParametersView& roots, const SearchParamFilters& filters) {
   std::vector<const Parameter*> result;
   for (const auto& root : roots) {
-    result.insert(
-      result.end(), find_all(root, filters).begin(), find_all(root, filters).end()
-    );
+    find_all_helper(root, result, filters);
   }
   return result;
 }
@@ -69,11 +102,246 @@ find_all(const MapArray& map_array, const SearchParamFilters& filters) {
   return find_all(ParametersView(map_array.begin(), map_array.end()), filters);
 }
 
+// whether the parameter named a is visited before the parameter named b by a depth
+// first search, which visits parameters before their children and siblings in the
+// order of their keys (so "a.b.x" comes before "a.b-c" even though '.' > '-')
+bool precedes_in_tree(std::string_view a, std::string_view b) {
+  while (true) {
+    size_t a_end = a.find('.');
+    size_t b_end = b.find('.');
+    std::string_view a_key = a.substr(0, a_end);
+    std::string_view b_key = b.substr(0, b_end);
+    if (a_key != b_key) {
+      return a_key < b_key;
+    }
+    if (a_end == std::string_view::npos || b_end == std::string_view::npos) {
+      // ancestors come first
+      return a_end == std::string_view::npos && b_end != std::string_view::npos;
+    }
+    a.remove_prefix(a_end + 1);
+    b.remove_prefix(b_end + 1);
+  }
+}
+
+// the results are sorted into tree order so they match the results of a search of
+// the entire tree (which share query cache entries since their key ignores the order
+// of the names)
+template <typename LazyTreeT>
+std::vector<const Parameter*> find_all_lazy(
+  const LazyTreeT& lazy_parameters,
+  const SearchParamFilters& filters
+) {
+  std::vector<const Parameter*> result;
+  for (const std::string& param_name : filters.param_names) {
+    const Parameter* param = lazy_parameters.find(param_name);
+    if (param && filters.matches(*param) &&
+        std::find(result.begin(), result.end(), param) == result.end()) {
+      result.push_back(param);
+    }
+  }
+  std::sort(result.begin(), result.end(), [](const Parameter* a, const Parameter* b) {
+    return precedes_in_tree(a->get_name(), b->get_name());
+  });
+  return result;
+}
+
+std::vector<const Parameter*> find_all_uncached(
+  const miru::config::ConfigInstance& config_instance,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions* options
+) {
+  // lazily loaded config instances look the names up without building the rest of
+  // the tree
+  std::shared_ptr<const miru::params::LazyParameterTree> lazy_parameters =
+    config_instance.lazy_parameters();
+  if (lazy_parameters && filters.has_param_name_filter()) {
+    return find_all_lazy(*lazy_parameters, filters);
+  }
+  // as do config instances backed by a mapped snapshot
+  std::shared_ptr<const miru::config::MappedSnapshot> mapped_snapshot =
+    config_instance.mapped_snapshot();
+  if (mapped_snapshot && filters.has_param_name_filter()) {
+    return find_all_lazy(*mapped_snapshot, filters);
+  }
+
+  // name filters already prune the traversal down to a handful of paths but type
+  // restricted queries (type filters or value predicates) are otherwise served
+  // straight from the index's type posting lists
+  miru::params::ParameterTypeMask candidates = filters.candidate_types();
+  if (candidates == miru::params::FULL_TYPE_MASK || filters.has_param_name_filter()) {
+    return options ? find_all(config_instance.root_parameter(), filters, *options)
+                   : find_all(config_instance.root_parameter(), filters);
+  }
+  std::vector<const Parameter*> result;
+  for (const Parameter* param :
+       config_instance.param_index()->find_by_types(candidates)) {
+    if (filters.matches(*param)) {
+      result.push_back(param);
+    }
+  }
+  return result;
+}
+
+std::vector<const Parameter*> find_all_cached(
+  const miru::config::ConfigInstance& config_instance,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions* options
+) {
+  miru::query::QueryCache* cache = config_instance.query_cache();
+  if (cache == nullptr) {
+    return find_all_uncached(config_instance, filters, options);
+  }
+
+  std::vector<const Parameter*> result;
+  if (cache->get(filters, result)) {
+    return result;
+  }
+  result = find_all_uncached(config_instance, filters, options);
+  cache->put(filters, result);
+  return result;
+}
+
 std::vector<const Parameter*> find_all(
   const miru::config::ConfigInstance& config_instance,
   const SearchParamFilters& filters
 ) {
-  return find_all(config_instance.root_parameter(), filters);
+  return find_all_cached(config_instance, filters, nullptr);
+}
+
+// ============================== PARALLEL TRAVERSAL =============================== //
+void find_all_parallel_helper(
+  const Parameter& parameter,
+  std::vector<const Parameter*>& result,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options,
+  miru::parallel::ThreadPool& pool
+);
+
+void find_all_parallel_range(
+  const ParametersView& params,
+  std::vector<const Parameter*>& result,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options,
+  miru::parallel::ThreadPool& pool
+) {
+  size_t num_params = params.size();
+  if (num_params < options.min_parallel_children) {
+    for (const auto& param : params) {
+      find_all_parallel_helper(param, result, filters, options, pool);
+    }
+    return;
+  }
+
+  // each chunk collects its own results which are concatenated in chunk order so the
+  // result is in the same (tree) order as a serial traversal
+  size_t chunk_size = std::max<size_t>(1, options.chunk_size);
+  size_t num_chunks = (num_params + chunk_size - 1) / chunk_size;
+  std::vector<std::vector<const Parameter*>> chunk_results(num_chunks);
+  miru::parallel::TaskGroup group(pool);
+  for (size_t i = 0; i < num_chunks; i++) {
+    group.run([&, i]() {
+      miru::params::ParameterIterator it = params.begin() + i * chunk_size;
+      miru::params::ParameterIterator end =
+        params.begin() + std::min(num_params, (i + 1) * chunk_size);
+      for (; it != end; ++it) {
+        find_all_parallel_helper(*it, chunk_results[i], filters, options, pool);
+      }
+    });
+  }
+  group.wait();
+
+  size_t num_results = result.size();
+  for (const auto& chunk_result : chunk_results) {
+    num_results += chunk_result.size();
+  }
+  result.reserve(num_results);
+  for (const auto& chunk_result : chunk_results) {
+    result.insert(result.end(), chunk_result.begin(), chunk_result.end());
+  }
+}
+
+void find_all_parallel_helper(
+  const Parameter& parameter,
+  std::vector<const Parameter*>& result,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options,
+  miru::parallel::ThreadPool& pool
+) {
+  if (filters.matches(parameter)) {
+    result.push_back(&parameter);
+  }
+  if (!filters.continue_search(parameter)) {
+    return;
+  }
+  find_all_parallel_range(
+    miru::params::get_children_view(parameter), result, filters, options, pool
+  );
+}
+
+miru::parallel::ThreadPool& pool_of(const ParallelQueryOptions& options) {
+  return options.pool ? *options.pool : miru::parallel::ThreadPool::shared();
+}
+
+std::vector<const Parameter*> find_all(
+  const Parameter& root,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) {
+  std::vector<const Parameter*> result;
+  find_all_parallel_helper(root, result, filters, options, pool_of(options));
+  return result;
+}
+
+std::vector<const Parameter*> find_all(
+  const ParametersView& roots,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) {
+  std::vector<const Parameter*> result;
+  find_all_parallel_range(roots, result, filters, options, pool_of(options));
+  return result;
+}
+
+std::vector<const Parameter*> find_all(
+  const std::vector<Parameter>& roots,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) {
+  return find_all(ParametersView(roots.begin(), roots.end()), filters, options);
+}
+
+std::vector<const Parameter*> find_all(
+  const Map& map,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) {
+  return find_all(ParametersView(map.begin(), map.end()), filters, options);
+}
+
+std::vector<const Parameter*> find_all(
+  const NestedArray& nested_array,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) {
+  return find_all(
+    ParametersView(nested_array.begin(), nested_array.end()), filters, options
+  );
+}
+
+std::vector<const Parameter*> find_all(
+  const MapArray& map_array,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) {
+  return find_all(ParametersView(map_array.begin(), map_array.end()), filters, options);
+}
+
+std::vector<const Parameter*> find_all(
+  const miru::config::ConfigInstance& config_instance,
+  const SearchParamFilters& filters,
+  const ParallelQueryOptions& options
+) {
+  return find_all_cached(config_instance, filters, &options);
 }
 
 }  // namespace miru::query::details
@@ -1,3 +1,7 @@
+// std
+#include <algorithm>
+#include <functional>
+
 // internal
 #include <miru/params/parameter.hpp>
 #include <miru/query/filter.hpp>
@@ -9,7 +13,8 @@ namespace miru::query {
 bool SearchParamFilters::matches(const Parameter& parameter) const {
   return (
     matches_param_name(parameter.get_name()) && matches_prefix(parameter.get_name()) &&
-    matches_leaves_only(parameter)
+    matches_leaves_only(parameter) && matches_type(parameter) &&
+    matches_value(parameter)
   );
 }
 
@@ -17,7 +22,7 @@ bool SearchParamFilters::continue_search(const Parameter& parameter) const {
   return (
     !miru::params::is_leaf(parameter) &&
     child_might_match_param_name(parameter.get_name()) &&
-    child_might_match_prefix(parameter.get_name())
+    child_might_match_prefix(parameter.get_name()) && child_might_match_type(parameter)
   );
 }
 
@@ -46,6 +51,28 @@ bool SearchParamFilters::matches_leaves_only(const Parameter& parameter) const {
   return !leaves_only || miru::params::is_leaf(parameter);
 }
 
+bool SearchParamFilters::matches_type(const Parameter& parameter) const {
+  return !has_type_filter() || miru::params::contains_type(types, parameter.get_type());
+}
+
+bool SearchParamFilters::matches_value(const Parameter& parameter) const {
+  for (const auto& predicate : value_predicates) {
+    if (!predicate.matches(parameter)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+miru::params::ParameterTypeMask SearchParamFilters::candidate_types() const {
+  miru::params::ParameterTypeMask candidates =
+    has_type_filter() ? types : miru::params::FULL_TYPE_MASK;
+  for (const auto& predicate : value_predicates) {
+    candidates &= predicate.applicable_types();
+  }
+  return candidates;
+}
+
 // continue searching operations
 bool SearchParamFilters::child_might_match_param_name(const std::string_view& param_name
 ) const {
@@ -76,6 +103,66 @@ bool SearchParamFilters::child_might_match_prefix(const std::string_view& param_
   return false;
 }
 
+bool SearchParamFilters::child_might_match_type(const Parameter& parameter) const {
+  // the subtree summary includes the parameter itself so this is conservative by one
+  // level, which is fine since the parameter has already been checked for a match
+  miru::params::ParameterTypeMask candidates = candidate_types();
+  return candidates == miru::params::FULL_TYPE_MASK ||
+         (parameter.get_subtree_types() & candidates) != 0;
+}
+
+// canonical comparison operations
+size_t mix_hash(size_t hash) {
+  // splitmix64 finalizer so that summing the hashes of individual strings (to be
+  // independent of their order) doesn't cluster
+  uint64_t x = static_cast<uint64_t>(hash);
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return static_cast<size_t>(x);
+}
+
+size_t unordered_hash(const std::vector<std::string>& strings, size_t seed) {
+  size_t hash = seed;
+  for (const auto& str : strings) {
+    hash += mix_hash(std::hash<std::string>()(str));
+  }
+  return mix_hash(hash);
+}
+
+size_t SearchParamFilters::canonical_hash() const {
+  size_t hash = unordered_hash(param_names, 0x9e3779b97f4a7c15ULL);
+  hash ^= unordered_hash(prefixes, 0xc2b2ae3d27d4eb4fULL) + (hash << 6) + (hash >> 2);
+  hash ^= mix_hash(types + 0x27d4eb2f165667c5ULL) + (hash << 6) + (hash >> 2);
+  size_t predicates_hash = 0x85ebca6b2f1a3d79ULL;
+  for (const auto& predicate : value_predicates) {
+    predicates_hash += mix_hash(predicate.hash());
+  }
+  hash ^= mix_hash(predicates_hash) + (hash << 6) + (hash >> 2);
+  hash ^= leaves_only ? 0x165667b19e3779f9ULL : 0;
+  return hash;
+}
+
+bool SearchParamFilters::equivalent(const SearchParamFilters& other) const {
+  return leaves_only == other.leaves_only && types == other.types &&
+         param_names.size() == other.param_names.size() &&
+         prefixes.size() == other.prefixes.size() &&
+         value_predicates.size() == other.value_predicates.size() &&
+         std::is_permutation(
+           param_names.begin(), param_names.end(), other.param_names.begin()
+         ) &&
+         std::is_permutation(
+           prefixes.begin(), prefixes.end(), other.prefixes.begin()
+         ) &&
+         std::is_permutation(
+           value_predicates.begin(),
+           value_predicates.end(),
+           other.value_predicates.begin()
+         );
+}
+
 std::string to_string(const SearchParamFilters& filters) {
   std::stringstream ss;
   ss << "SearchParamFilters(";
@@ -85,6 +172,22 @@ std::string to_string(const SearchParamFilters& filters) {
   if (filters.has_prefix_filter()) {
     ss << "prefixes: " << miru::utils::to_string(filters.prefixes) << ", ";
   }
+  if (filters.has_type_filter()) {
+    std::vector<std::string> types;
+    for (size_t bit = 0; bit < miru::params::NUM_TYPE_MASK_BITS; bit++) {
+      if (filters.types & (miru::params::ParameterTypeMask(1) << bit)) {
+        types.push_back(miru::params::to_string(miru::params::type_from_mask_bit(bit)));
+      }
+    }
+    ss << "types: " << miru::utils::to_string(types) << ", ";
+  }
+  if (filters.has_value_filter()) {
+    std::vector<std::string> predicates;
+    for (const auto& predicate : filters.value_predicates) {
+      predicates.push_back(to_string(predicate));
+    }
+    ss << "value predicates: " << miru::utils::to_string(predicates) << ", ";
+  }
   return ss.str();
 }
 
@@ -124,4 +227,34 @@ SearchParamFiltersBuilder& SearchParamFiltersBuilder::with_leaves_only(bool leav
   return *this;
 }
 
+SearchParamFiltersBuilder& SearchParamFiltersBuilder::with_type(ParameterType type) {
+  filters.types |= miru::params::type_mask(type);
+  return *this;
+}
+
+SearchParamFiltersBuilder& SearchParamFiltersBuilder::with_types(
+  const std::vector<ParameterType>& types
+) {
+  for (ParameterType type : types) {
+    filters.types |= miru::params::type_mask(type);
+  }
+  return *this;
+}
+
+SearchParamFiltersBuilder& SearchParamFiltersBuilder::with_value_predicate(
+  const ValuePredicate& predicate
+) {
+  filters.value_predicates.push_back(predicate);
+  return *this;
+}
+
+SearchParamFiltersBuilder& SearchParamFiltersBuilder::with_value_predicates(
+  const std::vector<ValuePredicate>& predicates
+) {
+  filters.value_predicates.insert(
+    filters.value_predicates.end(), predicates.begin(), predicates.end()
+  );
+  return *this;
+}
+
 }  // namespace miru::query
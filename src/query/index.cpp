@@ -0,0 +1,171 @@
+// std
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// internal
+#include <miru/query/details/hash.hpp>
+#include <miru/query/index.hpp>
+#include <params/utils.hpp>
+
+namespace miru::query {
+
+// ================================= PARAM INDEX ================================== //
+// pushes the children of the parameter onto the stack so that they're popped in order
+void push_children(const Parameter& param, std::vector<const Parameter*>& stack) {
+  miru::params::ParametersView children = miru::params::get_children_view(param);
+  for (size_t i = children.size(); i > 0; i--) {
+    stack.push_back(&*(children.begin() + (i - 1)));
+  }
+}
+
+// the tree is walked with an explicit stack (as is indexing it) so deep trees can't
+// overflow the call stack
+size_t count_params(const Parameter& root) {
+  size_t count = 0;
+  std::vector<const Parameter*> stack = {&root};
+  while (!stack.empty()) {
+    const Parameter* param = stack.back();
+    stack.pop_back();
+    count++;
+    push_children(*param, stack);
+  }
+  return count;
+}
+
+ParamIndex::ParamIndex(std::shared_ptr<const Parameter> root)
+  : root_(std::move(root)), mask_(0), size_(0) {
+  if (!root_) {
+    throw std::invalid_argument("Unable to index a null parameter tree");
+  }
+
+  // keep the load factor at or below 50% so probe sequences stay short
+  size_t capacity = 2;
+  size_t num_params = count_params(*root_);
+  while (capacity < 2 * num_params) {
+    capacity <<= 1;
+  }
+  slots_.assign(capacity, Slot{0, nullptr});
+  mask_ = capacity - 1;
+  preorder_.reserve(num_params);
+
+  index_subtree(*root_);
+
+  std::sort(
+    sorted_leaves_.begin(),
+    sorted_leaves_.end(),
+    [](const Leaf& lhs, const Leaf& rhs) { return lhs.name < rhs.name; }
+  );
+}
+
+void ParamIndex::index_subtree(const Parameter& root) {
+  std::vector<const Parameter*> stack = {&root};
+  while (!stack.empty()) {
+    const Parameter& param = *stack.back();
+    stack.pop_back();
+    insert(param);
+    postings_[miru::params::type_mask_bit(param.get_type())].push_back(
+      preorder_.size()
+    );
+    preorder_.push_back(&param);
+    if (miru::params::is_leaf(param)) {
+      const std::string& name = param.get_name();
+      size_t depth = std::count(name.begin(), name.end(), miru::params::DELIMITER[0]);
+      sorted_leaves_.push_back(Leaf{name, depth, &param});
+    }
+    // popped before the siblings of the parameter, keeping the depth first order
+    push_children(param, stack);
+  }
+}
+
+void ParamIndex::insert(const Parameter& param) {
+  const std::string& name = param.get_name();
+  uint64_t hash = details::fnv1a(name);
+  size_t i = hash & mask_;
+  while (slots_[i].param != nullptr) {
+    // names are unique within a tree but keep the first occurrence just in case
+    if (slots_[i].hash == hash && slots_[i].param->get_name() == name) {
+      return;
+    }
+    i = (i + 1) & mask_;
+  }
+  slots_[i] = Slot{hash, &param};
+  size_++;
+}
+
+const Parameter* ParamIndex::find(std::string_view name) const {
+  return find(name, details::fnv1a(name));
+}
+
+const Parameter* ParamIndex::find(std::string_view name, uint64_t hash) const {
+  size_t i = hash & mask_;
+  while (slots_[i].param != nullptr) {
+    if (slots_[i].hash == hash && slots_[i].param->get_name() == name) {
+      return slots_[i].param;
+    }
+    i = (i + 1) & mask_;
+  }
+  return nullptr;
+}
+
+std::vector<const Parameter*> ParamIndex::find_by_types(
+  miru::params::ParameterTypeMask types
+) const {
+  std::vector<size_t> positions;
+  positions.reserve(count_by_types(types));
+  size_t num_lists = 0;
+  for (size_t bit = 0; bit < postings_.size(); bit++) {
+    const std::vector<size_t>& posting = postings_[bit];
+    if (types & (miru::params::ParameterTypeMask(1) << bit) && !posting.empty()) {
+      positions.insert(positions.end(), posting.begin(), posting.end());
+      num_lists++;
+    }
+  }
+  // each posting list is already sorted so only the concatenation of several lists
+  // needs to be put back into tree order
+  if (num_lists > 1) {
+    std::sort(positions.begin(), positions.end());
+  }
+
+  std::vector<const Parameter*> result;
+  result.reserve(positions.size());
+  for (size_t position : positions) {
+    result.push_back(preorder_[position]);
+  }
+  return result;
+}
+
+size_t ParamIndex::count_by_types(miru::params::ParameterTypeMask types) const {
+  size_t count = 0;
+  for (size_t bit = 0; bit < postings_.size(); bit++) {
+    if (types & (miru::params::ParameterTypeMask(1) << bit)) {
+      count += postings_[bit].size();
+    }
+  }
+  return count;
+}
+
+std::pair<ParamIndex::LeafIterator, ParamIndex::LeafIterator> ParamIndex::leaves_under(
+  std::string_view prefix
+) const {
+  if (prefix.empty()) {
+    return {sorted_leaves_.begin(), sorted_leaves_.end()};
+  }
+
+  // every name starting with the prefix and a delimiter sorts at or after that string
+  // and before the prefix followed by the character after the delimiter
+  std::string lower(prefix);
+  lower += miru::params::DELIMITER[0];
+  std::string upper(prefix);
+  upper += static_cast<char>(miru::params::DELIMITER[0] + 1);
+
+  auto by_name = [](const Leaf& leaf, std::string_view name) {
+    return leaf.name < name;
+  };
+  LeafIterator begin =
+    std::lower_bound(sorted_leaves_.begin(), sorted_leaves_.end(), lower, by_name);
+  LeafIterator end = std::lower_bound(begin, sorted_leaves_.end(), upper, by_name);
+  return {begin, end};
+}
+
+}  // namespace miru::query
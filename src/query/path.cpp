@@ -0,0 +1,131 @@
+// internal
+#include <miru/query/details/errors.hpp>
+#include <miru/query/details/hash.hpp>
+#include <miru/query/filter.hpp>
+#include <miru/query/path.hpp>
+#include <utils.hpp>
+
+namespace miru::query {
+
+// ================================== PARAM PATH =================================== //
+ParamPath::ParamPath(const std::string& name)
+  : name_(miru::utils::remove_trailing(name, miru::params::DELIMITER)),
+    hash_(details::FNV_OFFSET_BASIS) {
+  for (size_t i = 0; i < name_.size(); i++) {
+    if (name_[i] == miru::params::DELIMITER[0]) {
+      segment_ends_.push_back(i);
+      segment_hashes_.push_back(hash_);
+    }
+    hash_ = details::fnv1a(name_[i], hash_);
+  }
+  segment_ends_.push_back(name_.size());
+  segment_hashes_.push_back(hash_);
+}
+
+ParamPath::ParamPath(const StaticParamPath& path)
+  : name_(path.name()), hash_(path.hash()) {
+  segment_ends_.reserve(path.num_segments());
+  segment_hashes_.reserve(path.num_segments());
+  for (size_t i = 0; i < path.num_segments(); i++) {
+    segment_ends_.push_back(
+      static_cast<size_t>(path.segment(i).data() - path.name().data()) +
+      path.segment_length(i)
+    );
+    segment_hashes_.push_back(path.segment_hash(i));
+  }
+}
+
+std::string_view ParamPath::segment(size_t i) const {
+  size_t begin = i == 0 ? 0 : segment_ends_[i - 1] + 1;
+  return std::string_view(name_).substr(begin, segment_ends_[i] - begin);
+}
+
+ParamHandle ParamPath::resolve(const miru::config::ConfigInstance& config_instance
+) const {
+  return ParamHandle(*this, config_instance);
+}
+
+// ================================= PARAM HANDLE ================================== //
+ParamHandle::ParamHandle(
+  const ParamPath& path,
+  const miru::config::ConfigInstance& config_instance
+)
+  : path_(path), index_(), param_(nullptr) {
+  resolve(config_instance.param_index());
+}
+
+void ParamHandle::rebind(const miru::config::ConfigInstance& config_instance) {
+  std::shared_ptr<const ParamIndex> index = config_instance.param_index();
+  if (index == index_) {
+    return;
+  }
+  resolve(std::move(index));
+}
+
+void ParamHandle::resolve(std::shared_ptr<const ParamIndex> index) {
+  const Parameter* param = path_.find(*index);
+  if (param == nullptr) {
+    THROW_PARAMETER_NOT_FOUND(
+      SearchParamFiltersBuilder().with_param_name(path_.name()).build()
+    );
+  }
+  index_ = std::move(index);
+  param_ = param;
+}
+
+// ================================ PATH QUERIES =================================== //
+const Parameter* find_param(
+  const miru::config::ConfigInstance& config_instance,
+  const ParamPath& path
+) {
+  return path.find(*config_instance.param_index());
+}
+
+const Parameter* find_param(
+  const miru::config::ConfigInstance& config_instance,
+  const StaticParamPath& path
+) {
+  return path.find(*config_instance.param_index());
+}
+
+bool has_param(
+  const miru::config::ConfigInstance& config_instance,
+  const ParamPath& path
+) {
+  return find_param(config_instance, path) != nullptr;
+}
+
+bool has_param(
+  const miru::config::ConfigInstance& config_instance,
+  const StaticParamPath& path
+) {
+  return find_param(config_instance, path) != nullptr;
+}
+
+Parameter get_param(
+  const miru::config::ConfigInstance& config_instance,
+  const ParamPath& path
+) {
+  const Parameter* param = find_param(config_instance, path);
+  if (param == nullptr) {
+    THROW_PARAMETER_NOT_FOUND(
+      SearchParamFiltersBuilder().with_param_name(path.name()).build()
+    );
+  }
+  return *param;
+}
+
+Parameter get_param(
+  const miru::config::ConfigInstance& config_instance,
+  const StaticParamPath& path
+) {
+  const Parameter* param = find_param(config_instance, path);
+  if (param == nullptr) {
+    THROW_PARAMETER_NOT_FOUND(
+      SearchParamFiltersBuilder().with_param_name(std::string(path.name())).build()
+    );
+  }
+  return *param;
+}
+
+}  // namespace miru::query
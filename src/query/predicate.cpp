@@ -0,0 +1,272 @@
+// std
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+// internal
+#include <miru/query/predicate.hpp>
+#include <query/details/kernels.hpp>
+
+namespace miru::query {
+
+using Parameter = miru::params::Parameter;
+using ParameterType = miru::params::ParameterType;
+
+// =============================== VALUE PREDICATES ================================ //
+ValuePredicate::ValuePredicate(Op op, bool numeric)
+  : op_(op),
+    quantifier_(Quantifier::ALL),
+    numeric_(numeric),
+    min_(0),
+    max_(0),
+    numbers_(),
+    strings_() {}
+
+ValuePredicate ValuePredicate::in_range(double min, double max) {
+  if (min > max) {
+    throw std::invalid_argument("Value predicate range minimum exceeds its maximum");
+  }
+  ValuePredicate predicate(Op::IN_RANGE, true);
+  predicate.min_ = min;
+  predicate.max_ = max;
+  return predicate;
+}
+
+ValuePredicate ValuePredicate::not_in_range(double min, double max) {
+  ValuePredicate predicate = in_range(min, max);
+  predicate.op_ = Op::NOT_IN_RANGE;
+  return predicate;
+}
+
+ValuePredicate ValuePredicate::equal_to(double value) {
+  return one_of(std::vector<double>{value});
+}
+
+ValuePredicate ValuePredicate::one_of(const std::vector<double>& values) {
+  ValuePredicate predicate(Op::ONE_OF, true);
+  predicate.numbers_ = values;
+  return predicate;
+}
+
+ValuePredicate ValuePredicate::one_of(std::initializer_list<double> values) {
+  return one_of(std::vector<double>(values));
+}
+
+ValuePredicate ValuePredicate::equal_to(const std::string& value) {
+  return one_of(std::vector<std::string>{value});
+}
+
+ValuePredicate ValuePredicate::equal_to(const char* value) {
+  return equal_to(std::string(value));
+}
+
+ValuePredicate ValuePredicate::one_of(const std::vector<std::string>& values) {
+  ValuePredicate predicate(Op::ONE_OF, false);
+  predicate.strings_ = values;
+  return predicate;
+}
+
+ValuePredicate ValuePredicate::one_of(std::initializer_list<const char*> values) {
+  return one_of(std::vector<std::string>(values.begin(), values.end()));
+}
+
+ValuePredicate ValuePredicate::for_all() const {
+  ValuePredicate predicate = *this;
+  predicate.quantifier_ = Quantifier::ALL;
+  return predicate;
+}
+
+ValuePredicate ValuePredicate::for_any() const {
+  ValuePredicate predicate = *this;
+  predicate.quantifier_ = Quantifier::ANY;
+  return predicate;
+}
+
+miru::params::ParameterTypeMask ValuePredicate::applicable_types() const {
+  using miru::params::type_mask;
+  miru::params::ParameterTypeMask scalars =
+    type_mask(ParameterType::PARAMETER_SCALAR) |
+    type_mask(ParameterType::PARAMETER_SCALAR_ARRAY);
+  if (numeric_) {
+    return scalars | type_mask(ParameterType::PARAMETER_INTEGER) |
+           type_mask(ParameterType::PARAMETER_DOUBLE) |
+           type_mask(ParameterType::PARAMETER_INTEGER_ARRAY) |
+           type_mask(ParameterType::PARAMETER_DOUBLE_ARRAY);
+  }
+  return scalars | type_mask(ParameterType::PARAMETER_STRING) |
+         type_mask(ParameterType::PARAMETER_STRING_ARRAY);
+}
+
+// yaml scalars are only numeric if the entire string is a finite decimal number.
+// Unlike Scalar::as_double() this doesn't throw so that scanning a config for out of
+// range values doesn't turn into exception handling.
+bool parse_double(const std::string& str, double& result) {
+  // strtod skips leading whitespace and parses hex values, neither of which are
+  // numbers here
+  if (str.empty() || std::isspace(static_cast<unsigned char>(str[0]))) {
+    return false;
+  }
+  size_t sign = str[0] == '-' || str[0] == '+' ? 1 : 0;
+  if (str.compare(sign, 2, "0x") == 0 || str.compare(sign, 2, "0X") == 0) {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  double value = std::strtod(str.c_str(), &end);
+  if (end != str.c_str() + str.size() || errno == ERANGE || !std::isfinite(value)) {
+    return false;
+  }
+  result = value;
+  return true;
+}
+
+bool ValuePredicate::matches(const Parameter& parameter) const {
+  if (!miru::params::contains_type(applicable_types(), parameter.get_type())) {
+    return false;
+  }
+
+  switch (parameter.get_type()) {
+    case ParameterType::PARAMETER_INTEGER: {
+      int64_t value = parameter.as_int();
+      return matches_numbers(&value, 1);
+    }
+    case ParameterType::PARAMETER_DOUBLE: {
+      double value = parameter.as_double();
+      return matches_numbers(&value, 1);
+    }
+    case ParameterType::PARAMETER_INTEGER_ARRAY: {
+      const std::vector<int64_t>& values = parameter.as_integer_array();
+      return matches_numbers(values.data(), values.size());
+    }
+    case ParameterType::PARAMETER_DOUBLE_ARRAY: {
+      const std::vector<double>& values = parameter.as_double_array();
+      return matches_numbers(values.data(), values.size());
+    }
+    case ParameterType::PARAMETER_STRING:
+      return matches_string(parameter.as_string());
+    case ParameterType::PARAMETER_STRING_ARRAY:
+      return matches_strings(parameter.as_string_array());
+    case ParameterType::PARAMETER_SCALAR:
+      return matches_scalar(parameter.as_scalar());
+    case ParameterType::PARAMETER_SCALAR_ARRAY:
+      return matches_scalars(parameter.as_scalar_array());
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+bool ValuePredicate::matches_numbers(const T* values, size_t size) const {
+  bool any = quantifier_ == Quantifier::ANY;
+  for (size_t begin = 0; begin < size; begin += details::KERNEL_BLOCK_SIZE) {
+    size_t block_size = std::min(details::KERNEL_BLOCK_SIZE, size - begin);
+    size_t count = 0;
+    switch (op_) {
+      case Op::IN_RANGE:
+        count = details::count_in_range(values + begin, block_size, min_, max_);
+        break;
+      case Op::NOT_IN_RANGE:
+        count = block_size -
+                details::count_in_range(values + begin, block_size, min_, max_);
+        break;
+      case Op::ONE_OF:
+        count = details::count_one_of(
+          values + begin, block_size, numbers_.data(), numbers_.size()
+        );
+        break;
+    }
+    if (any && count > 0) {
+      return true;
+    }
+    if (!any && count < block_size) {
+      return false;
+    }
+  }
+  return !any;
+}
+
+bool ValuePredicate::matches_number(double value) const {
+  return matches_numbers(&value, 1);
+}
+
+bool ValuePredicate::matches_string(const std::string& value) const {
+  return std::find(strings_.begin(), strings_.end(), value) != strings_.end();
+}
+
+bool ValuePredicate::matches_strings(const std::vector<std::string>& values) const {
+  auto pred = [this](const std::string& value) { return matches_string(value); };
+  if (quantifier_ == Quantifier::ANY) {
+    return std::any_of(values.begin(), values.end(), pred);
+  }
+  return std::all_of(values.begin(), values.end(), pred);
+}
+
+bool ValuePredicate::matches_scalar(const miru::params::Scalar& scalar) const {
+  if (!numeric_) {
+    return matches_string(scalar.as_string());
+  }
+  double value = 0;
+  return parse_double(scalar.as_string(), value) && matches_number(value);
+}
+
+bool ValuePredicate::matches_scalars(const std::vector<miru::params::Scalar>& scalars
+) const {
+  auto pred = [this](const miru::params::Scalar& scalar) {
+    return matches_scalar(scalar);
+  };
+  if (quantifier_ == Quantifier::ANY) {
+    return std::any_of(scalars.begin(), scalars.end(), pred);
+  }
+  return std::all_of(scalars.begin(), scalars.end(), pred);
+}
+
+bool ValuePredicate::operator==(const ValuePredicate& other) const {
+  return op_ == other.op_ && quantifier_ == other.quantifier_ &&
+         numeric_ == other.numeric_ && min_ == other.min_ && max_ == other.max_ &&
+         numbers_ == other.numbers_ && strings_ == other.strings_;
+}
+
+size_t hash_combine(size_t hash, size_t value) {
+  return hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+}
+
+size_t ValuePredicate::hash() const {
+  size_t hash = static_cast<size_t>(op_);
+  hash = hash_combine(hash, static_cast<size_t>(quantifier_));
+  hash = hash_combine(hash, numeric_);
+  hash = hash_combine(hash, std::hash<double>()(min_));
+  hash = hash_combine(hash, std::hash<double>()(max_));
+  for (double number : numbers_) {
+    hash = hash_combine(hash, std::hash<double>()(number));
+  }
+  for (const auto& str : strings_) {
+    hash = hash_combine(hash, std::hash<std::string>()(str));
+  }
+  return hash;
+}
+
+std::string to_string(const ValuePredicate& predicate) {
+  std::stringstream ss;
+  switch (predicate.op()) {
+    case ValuePredicate::Op::IN_RANGE:
+      ss << "in_range[" << predicate.min() << ", " << predicate.max() << "]";
+      break;
+    case ValuePredicate::Op::NOT_IN_RANGE:
+      ss << "not_in_range[" << predicate.min() << ", " << predicate.max() << "]";
+      break;
+    case ValuePredicate::Op::ONE_OF:
+      ss << "one_of";
+      break;
+  }
+  ss << (predicate.is_numeric() ? "(numeric" : "(string");
+  ss << (predicate.quantifier() == ValuePredicate::Quantifier::ANY ? ", any)"
+                                                                   : ", all)");
+  return ss.str();
+}
+
+}  // namespace miru::query
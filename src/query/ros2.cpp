@@ -1,35 +1,150 @@
+// std
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+
 // internal
 #include <configs/instance_impl.hpp>
 #include <miru/params/parameter.hpp>
+#include <miru/query/details/errors.hpp>
 #include <miru/query/query.hpp>
 #include <miru/query/ros2.hpp>
+#include <params/utils.hpp>
 
 namespace miru::query {
 
+ROS2NodeI::ROS2NodeI(const miru::params::Parameter& root)
+  : ROS2NodeI(std::make_shared<const miru::params::Parameter>(root)) {}
+
+ROS2NodeI::ROS2NodeI(std::shared_ptr<const miru::params::Parameter> root)
+  : index_(std::make_shared<const ParamIndex>(std::move(root))) {}
+
+ROS2NodeI::ROS2NodeI(const miru::config::ConfigInstance& config_instance)
+  : index_(config_instance.param_index()) {}
+
+const Parameter* ROS2NodeI::find_parameter(const std::string& name) const {
+  // the index holds every parameter but only leaves are ros2 parameters
+  const Parameter* param = index_->find(name);
+  if (param == nullptr || !miru::params::is_leaf(*param)) {
+    return nullptr;
+  }
+  return param;
+}
+
 bool ROS2NodeI::has_parameter(const std::string& parameter_name) {
-  SearchParamFiltersBuilder builder;
-  builder.with_param_name(parameter_name);
-  SearchParamFilters filters = builder.build();
-  return has_param(root_, filters);
+  return find_parameter(parameter_name) != nullptr;
 }
 
 Parameter ROS2NodeI::get_parameter(const std::string& name) const {
-  SearchParamFiltersBuilder builder;
-  builder.with_param_name(name);
-  SearchParamFilters filters = builder.build();
-  return get_param(root_, filters);
+  return *get_parameter_ref(name);
 }
 
 bool ROS2NodeI::get_parameter(const std::string& name, Parameter& parameter) const {
-  SearchParamFiltersBuilder builder;
-  builder.with_param_name(name);
-  SearchParamFilters filters = builder.build();
-  return try_get_param(root_, filters, parameter);
+  const Parameter* param = find_parameter(name);
+  if (param) {
+    parameter = *param;
+  }
+  return param != nullptr;
+}
+
+ParameterRef ROS2NodeI::get_parameter_ref(const std::string& name) const {
+  const Parameter* param = find_parameter(name);
+  if (param == nullptr) {
+    THROW_PARAMETER_NOT_FOUND(
+      SearchParamFiltersBuilder().with_param_name(name).build()
+    );
+  }
+  return ParameterRef(*param);
 }
 
 std::vector<Parameter> ROS2NodeI::get_parameters(const std::vector<std::string>& names
 ) const {
-  return get_params(root_, names);
+  std::vector<Parameter> result;
+  result.reserve(names.size());
+  for (const auto& name : names) {
+    result.push_back(get_parameter(name));
+  }
+  return result;
+}
+
+std::string ROS2NodeI::strip_prefix(const std::string& prefix, std::string_view name) {
+  if (prefix.empty()) {
+    return std::string(name);
+  }
+  return std::string(name.substr(prefix.size() + miru::params::DELIMITER.size()));
+}
+
+std::map<std::string, Parameter> ROS2NodeI::get_parameters_by_prefix(
+  const std::string& prefix
+) const {
+  // the leaves are sorted by name and stripping a common prefix preserves the order
+  // so every insert goes at the end of the map
+  std::map<std::string, Parameter> result;
+  auto [begin, end] = index_->leaves_under(prefix);
+  for (auto it = begin; it != end; ++it) {
+    result.emplace_hint(result.end(), strip_prefix(prefix, it->name), *it->param);
+  }
+  return result;
+}
+
+ListParametersResult ROS2NodeI::list_parameters(
+  const std::vector<std::string>& prefixes,
+  uint64_t depth
+) const {
+  // like rclcpp, a name is within the depth if it has fewer delimiters than the depth,
+  // where the name below a prefix starts with (and counts) the delimiter after it
+  auto within_depth = [depth](size_t num_delimiters) {
+    return depth == DEPTH_RECURSIVE || num_delimiters < depth;
+  };
+
+  std::vector<std::string_view> names;
+  if (prefixes.empty()) {
+    for (const auto& leaf : index_->sorted_leaves()) {
+      if (within_depth(leaf.depth)) {
+        names.push_back(leaf.name);
+      }
+    }
+  }
+  for (const auto& prefix : prefixes) {
+    // no name is empty or starts with a delimiter so nothing matches an empty prefix
+    if (prefix.empty()) {
+      continue;
+    }
+    const Parameter* param = find_parameter(prefix);
+    if (param) {
+      names.push_back(param->get_name());
+    }
+    size_t prefix_depth =
+      std::count(prefix.begin(), prefix.end(), miru::params::DELIMITER[0]);
+    auto [begin, end] = index_->leaves_under(prefix);
+    for (auto it = begin; it != end; ++it) {
+      if (within_depth(it->depth - prefix_depth)) {
+        names.push_back(it->name);
+      }
+    }
+  }
+  // the names for a single prefix are already sorted (the prefix itself sorts before
+  // everything nested under it) but several prefixes may overlap
+  if (prefixes.size() > 1) {
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+  }
+
+  ListParametersResult result;
+  result.names.reserve(names.size());
+  std::unordered_set<std::string_view> seen_prefixes;
+  for (const auto& name : names) {
+    result.names.emplace_back(name);
+    size_t last_delimiter = name.find_last_of(miru::params::DELIMITER);
+    if (last_delimiter == std::string_view::npos) {
+      continue;
+    }
+    std::string_view name_prefix = name.substr(0, last_delimiter);
+    if (seen_prefixes.insert(name_prefix).second) {
+      result.prefixes.emplace_back(name_prefix);
+    }
+  }
+  return result;
 }
 
-}  // namespace miru::query
\ No newline at end of file
+}  // namespace miru::query
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -68,6 +69,12 @@ std::string to_string(const std::string& value) { return value; }
 std::string to_string(const std::string_view& value) { return std::string(value); }
 
 std::string base64_encode(const std::vector<uint8_t>& bytes) {
+  return base64_encode(
+    std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size())
+  );
+}
+
+std::string base64_encode(std::string_view bytes) {
   // while this is technically a private implementation detail of boost, it is commonly
   // used in practice, stable, and avoids importing a new dependency
   std::size_t encoded_size = boost::beast::detail::base64::encoded_size(bytes.size());
@@ -3,6 +3,7 @@
 // std
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace miru::utils {
@@ -55,5 +56,6 @@ std::string to_string(const std::vector<std::pair<std::string, T>> &values) {
 // ================================ BASE64 ENCODING ==================================
 // //
 std::string base64_encode(const std::vector<uint8_t> &bytes);
+std::string base64_encode(std::string_view bytes);
 
 }  // namespace miru::utils
\ No newline at end of file
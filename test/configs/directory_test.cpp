@@ -0,0 +1,160 @@
+// std
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// internal
+#include <configs/directory.hpp>
+#include <filesys/errors.hpp>
+#include <miru/configs/instance.hpp>
+#include <miru/parallel/thread_pool.hpp>
+#include <miru/query/query.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::config {
+
+// ================================= FROM DIRECTORY ================================ //
+class FromDirectory : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(schema_dir);
+    std::filesystem::create_directories(instance_dir);
+  }
+  void TearDown() override { std::filesystem::remove_all(dir); }
+
+  void write(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream(path) << content;
+  }
+
+  void write_pair(const std::string& slug, int speed) {
+    write(
+      schema_dir / (slug + ".json"), "{\"$miru_config_type_slug\": \"" + slug + "\"}"
+    );
+    write(instance_dir / (slug + ".yaml"), "speed: " + std::to_string(speed) + "\n");
+  }
+
+  static std::string slug_of(const miru::config::ConfigInstance& config_instance) {
+    return config_instance.root_parameter().get_name();
+  }
+
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-from-directory-test";
+  std::filesystem::path schema_dir = dir / "schemas";
+  std::filesystem::path instance_dir = dir / "instances";
+};
+
+TEST_F(FromDirectory, Testdata) {
+  miru::config::FromDirectoryResult result =
+    miru::config::ConfigInstance::from_directory(
+      miru::test_utils::config_schemas_testdata_dir().path(),
+      miru::test_utils::config_instances_testdata_dir().path()
+    );
+
+  // motion-control.json and motion-control.yaml pair with the files of the same name
+  ASSERT_EQ(result.config_instances.size(), 2);
+  for (const miru::config::ConfigInstance& config_instance : result.config_instances) {
+    EXPECT_EQ(
+      miru::query::get_param(config_instance, "motion-control.speed").as<int>(), 15
+    );
+  }
+
+  // the schemas without a config type slug have no config instance
+  ASSERT_EQ(result.errors.size(), 4);
+  for (const miru::config::FromDirectoryError& error : result.errors) {
+    ASSERT_TRUE(error.schema_file.has_value());
+    std::string name = error.schema_file->filename().string();
+    EXPECT_NE(name.find("config-type-slug"), std::string::npos);
+    EXPECT_FALSE(error.instance_file.has_value());
+  }
+}
+
+TEST_F(FromDirectory, Concurrent) {
+  for (int i = 0; i < 64; i++) {
+    write_pair("config-" + std::to_string(100 + i), i);
+  }
+  miru::parallel::ThreadPool pool(4);
+  miru::config::FromDirectoryOptions options;
+  options.pool = &pool;
+  options.max_concurrency = 3;
+  options.file_options.lazy = true;
+
+  miru::config::FromDirectoryResult result =
+    miru::config::ConfigInstance::from_directory(schema_dir, instance_dir, options);
+  EXPECT_TRUE(result.errors.empty());
+  ASSERT_EQ(result.config_instances.size(), 64);
+  for (int i = 0; i < 64; i++) {
+    const miru::config::ConfigInstance& config_instance = result.config_instances[i];
+    std::string slug = "config-" + std::to_string(100 + i);
+    EXPECT_EQ(slug_of(config_instance), slug);
+    EXPECT_EQ(
+      miru::query::get_param(config_instance, slug + ".speed").as<int>(), i
+    );
+  }
+}
+
+TEST_F(FromDirectory, Errors) {
+  write_pair("a", 1);
+  // invalid config instance
+  write(schema_dir / "b.json", "{\"$miru_config_type_slug\": \"b\"}");
+  write(instance_dir / "b.json", "{\"speed\": ");
+  // several config instances (neither named like the schema)
+  write(schema_dir / "c.json", "{\"$miru_config_type_slug\": \"c\"}");
+  write(instance_dir / "c.yaml", "speed: 1\n");
+  write(instance_dir / "c.yml", "speed: 2\n");
+  // no schema
+  write(instance_dir / "d.json", "{\"speed\": 4}");
+  // unsupported files are ignored
+  write(schema_dir / "README.md", "schemas");
+  write(instance_dir / "README.md", "instances");
+
+  miru::config::FromDirectoryResult result =
+    miru::config::ConfigInstance::from_directory(schema_dir, instance_dir);
+  ASSERT_EQ(result.config_instances.size(), 1);
+  EXPECT_EQ(slug_of(result.config_instances[0]), "a");
+
+  ASSERT_EQ(result.errors.size(), 3);
+  // the pairing errors come first
+  EXPECT_EQ(result.errors[0].schema_file, schema_dir / "c.json");
+  EXPECT_FALSE(result.errors[0].instance_file.has_value());
+  EXPECT_NE(result.errors[0].message.find("Several"), std::string::npos);
+  EXPECT_FALSE(result.errors[1].schema_file.has_value());
+  EXPECT_EQ(result.errors[1].instance_file, instance_dir / "d.json");
+  EXPECT_EQ(result.errors[2].schema_file, schema_dir / "b.json");
+  EXPECT_EQ(result.errors[2].instance_file, instance_dir / "b.json");
+  EXPECT_FALSE(result.errors[2].message.empty());
+}
+
+TEST_F(FromDirectory, Pairing) {
+  // a config instance of the same name wins over the other stem matches
+  write(schema_dir / "a.json", "{}");
+  write(schema_dir / "a.yaml", "{}");
+  write(instance_dir / "a.json", "{}");
+  write(instance_dir / "a.cbor", "");
+  miru::config::DirectoryPairing pairing = miru::config::pair_directory_files(
+    miru::filesys::Dir(schema_dir), miru::filesys::Dir(instance_dir)
+  );
+  ASSERT_EQ(pairing.pairs.size(), 1);
+  EXPECT_EQ(pairing.pairs[0].schema_file.name(), "a.json");
+  EXPECT_EQ(pairing.pairs[0].instance_file.name(), "a.json");
+  // a.yaml has two candidates which are then not reported again
+  ASSERT_EQ(pairing.errors.size(), 1);
+  EXPECT_EQ(pairing.errors[0].schema_file, schema_dir / "a.yaml");
+}
+
+TEST_F(FromDirectory, DirNotFound) {
+  EXPECT_THROW(
+    miru::config::ConfigInstance::from_directory(dir / "doesnt-exist", instance_dir),
+    miru::filesys::DirNotFoundError
+  );
+  EXPECT_THROW(
+    miru::config::ConfigInstance::from_directory(schema_dir, dir / "doesnt-exist"),
+    miru::filesys::DirNotFoundError
+  );
+}
+
+}  // namespace test::config
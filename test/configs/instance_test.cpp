@@ -1,10 +1,25 @@
+// std
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
 // internal
 #include <http/models/ConfigInstance.h>
 #include <configs/errors.hpp>
 #include <configs/instance_impl.hpp>
+#include <miru/parallel/thread_pool.hpp>
 #include <miru/query/query.hpp>
 #include <miru/query/ros2.hpp>
+#include <http/socket_client.hpp>
 #include <test/http/mock.hpp>
+#include <test/http/stand_in_agent.hpp>
 #include <test/test_utils/testdata.hpp>
 
 // external
@@ -83,6 +98,134 @@ TEST(ConfigInstance, FromFileSystemYamlRos2) {
   EXPECT_EQ(speed.as<int>(), 15);
 }
 
+TEST(ConfigInstance, FromFileSystemJsonLazy) {
+  miru::filesys::File schema_file(
+    miru::test_utils::config_schemas_testdata_dir().file("motion-control.json")
+  );
+  miru::filesys::File instance_file(
+    miru::test_utils::config_instances_testdata_dir().file("motion-control.json")
+  );
+  miru::config::FromFileOptions options;
+  options.lazy = true;
+  std::shared_ptr<const miru::params::Parameter> speed_ptr;
+  {
+    miru::config::ConfigInstance config_instance =
+      miru::config::ConfigInstance::from_file(
+        schema_file.abs_path().string(), instance_file.abs_path().string(), options
+      );
+    ASSERT_NE(config_instance.lazy_parameters(), nullptr);
+    EXPECT_EQ(config_instance.lazy_parameters()->num_materialized(), 0);
+
+    // queries by name only build the parameters they return
+    auto speed = miru::query::get_param(config_instance, "motion-control.speed");
+    EXPECT_EQ(speed.as<int>(), 15);
+    auto offsets = miru::query::get_params(
+      config_instance,
+      {
+        "motion-control.accelerometer.offsets.y",
+        "motion-control.accelerometer.offsets.x",
+      }
+    );
+    ASSERT_EQ(offsets.size(), 2);
+    // in tree order, like the results of queries against the entire tree
+    EXPECT_EQ(offsets[0].get_name(), "motion-control.accelerometer.offsets.x");
+    EXPECT_EQ(config_instance.lazy_parameters()->num_materialized(), 3);
+    speed_ptr = miru::query::get_shared_param(config_instance, "motion-control.speed");
+    EXPECT_EQ(config_instance.lazy_parameters()->num_materialized(), 3);
+
+    // other queries build the entire tree
+    miru::config::ConfigInstance eager = miru::config::ConfigInstance::from_file(
+      schema_file.abs_path().string(), instance_file.abs_path().string()
+    );
+    EXPECT_EQ(eager.lazy_parameters(), nullptr);
+    EXPECT_EQ(config_instance.root_parameter(), eager.root_parameter());
+    EXPECT_EQ(miru::query::list_params(config_instance).size(), 11);
+  }
+  // shared parameters outlive the config instance
+  EXPECT_EQ(speed_ptr->as<int>(), 15);
+}
+
+TEST(ConfigInstance, FromFileSystemYamlLazy) {
+  miru::filesys::File schema_file(
+    miru::test_utils::config_schemas_testdata_dir().file("motion-control.yaml")
+  );
+  miru::filesys::File instance_file(
+    miru::test_utils::config_instances_testdata_dir().file("motion-control.yaml")
+  );
+  miru::config::FromFileOptions options;
+  options.lazy = true;
+  miru::config::ConfigInstance config_instance =
+    miru::config::ConfigInstance::from_file(
+      schema_file.abs_path().string(), instance_file.abs_path().string(), options
+    );
+
+  // yaml config instances are always loaded entirely
+  EXPECT_EQ(config_instance.lazy_parameters(), nullptr);
+  auto speed = miru::query::get_param(config_instance, "motion-control.speed");
+  EXPECT_EQ(speed.as<int>(), 15);
+}
+
+TEST(ConfigInstance, FromFileSystemParallel) {
+  miru::parallel::ThreadPool pool(2);
+  miru::config::FromFileOptions options;
+  options.parallel = miru::params::ParallelParseOptions();
+  options.parallel->pool = &pool;
+  for (const std::string& file_name : {"motion-control.json", "motion-control.yaml"}) {
+    std::string schema_file_path =
+      miru::test_utils::config_schemas_testdata_dir().file(file_name).abs_path();
+    std::string instance_file_path =
+      miru::test_utils::config_instances_testdata_dir().file(file_name).abs_path();
+    miru::config::ConfigInstance parallel = miru::config::ConfigInstance::from_file(
+      schema_file_path, instance_file_path, options
+    );
+    miru::config::ConfigInstance serial =
+      miru::config::ConfigInstance::from_file(schema_file_path, instance_file_path);
+    EXPECT_EQ(parallel.root_parameter(), serial.root_parameter()) << file_name;
+  }
+}
+
+TEST(ConfigInstance, FromFileSystemBinaryEncodings) {
+  std::string schema_file_path = miru::test_utils::config_schemas_testdata_dir()
+                                   .file("motion-control.json")
+                                   .abs_path();
+  std::string json_file_path = miru::test_utils::config_instances_testdata_dir()
+                                 .file("motion-control.json")
+                                 .abs_path();
+  miru::config::ConfigInstance expected =
+    miru::config::ConfigInstance::from_file(schema_file_path, json_file_path);
+
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-binary-instance-test";
+  std::filesystem::create_directories(dir);
+  nlohmann::json instance = miru::filesys::File(json_file_path).read_json();
+  std::vector<uint8_t> msgpack = nlohmann::json::to_msgpack(instance);
+  std::ofstream(dir / "motion-control.msgpack", std::ios::binary)
+    .write(reinterpret_cast<const char*>(msgpack.data()), msgpack.size());
+  std::vector<uint8_t> cbor = nlohmann::json::to_cbor(instance);
+  std::ofstream(dir / "motion-control.cbor", std::ios::binary)
+    .write(reinterpret_cast<const char*>(cbor.data()), cbor.size());
+
+  miru::config::FromFileOptions parallel_options;
+  parallel_options.parallel = miru::params::ParallelParseOptions();
+  for (const std::string& extension : {".msgpack", ".cbor"}) {
+    std::string file_name = "motion-control" + extension;
+    std::string instance_file_path = (dir / file_name).string();
+    EXPECT_EQ(
+      miru::config::ConfigInstance::from_file(schema_file_path, instance_file_path)
+        .root_parameter(),
+      expected.root_parameter()
+    ) << file_name;
+    EXPECT_EQ(
+      miru::config::ConfigInstance::from_file(
+        schema_file_path, instance_file_path, parallel_options
+      )
+        .root_parameter(),
+      expected.root_parameter()
+    ) << file_name;
+  }
+  std::filesystem::remove_all(dir);
+}
+
 // =================================== FROM AGENT ================================== //
 TEST(ConfigInstance, FromAgentSuccess_NoDefaultInstanceFile) {
   // set the response from the mock client
@@ -222,6 +365,220 @@ TEST(ConfigInstance, FromAgentFailure_DefaultFileSuccess) {
   EXPECT_EQ(speed.as<int>(), 15);
 }
 
+TEST(ConfigInstance, FromAgentSuccessLazy) {
+  test::http::MockAgentClient mock_client;
+  mock_client.hash_schema_func = []() { return "sha256:a1b2c3d4e5f6g7h8i9j0k1l2"; };
+  mock_client.get_deployed_config_instance_func = []() {
+    nlohmann::json content = {{"speed", 89}, {"features", {{"spin", true}}}};
+    return openapi::ConfigInstance{
+      "config_instance",
+      "cfg_inst_123",
+      openapi::ConfigInstanceTargetStatus::eConfigInstanceTargetStatus::CONFIG_INSTANCE_TARGET_STATUS_DEPLOYED,
+      openapi::ConfigInstanceStatus::eConfigInstanceStatus::CONFIG_INSTANCE_STATUS_DEPLOYED,
+      openapi::ConfigInstanceActivityStatus::eConfigInstanceActivityStatus::CONFIG_INSTANCE_ACTIVITY_STATUS_REMOVED,
+      openapi::ConfigInstanceErrorStatus::eConfigInstanceErrorStatus::CONFIG_INSTANCE_ERROR_STATUS_NONE,
+      "relative_filepath",
+      "2021-01-01T00:00:00Z",
+      "2021-01-01T00:00:00Z",
+      "dvc_123",
+      "cfg_sch_123",
+      "cfg_type_123",
+      content,
+    };
+  };
+
+  miru::filesys::File schema_file(
+    miru::test_utils::config_schemas_testdata_dir().file("motion-control.yaml")
+  );
+  miru::config::FromAgentOptions options;
+  options.lazy = true;
+  miru::config::ConfigInstanceImpl config_impl =
+    miru::config::ConfigInstanceImpl::from_agent(
+      mock_client, schema_file.abs_path().string(), options
+    );
+  miru::config::ConfigInstance config_instance = miru::config::ConfigInstance(
+    std::make_unique<miru::config::ConfigInstanceImpl>(config_impl)
+  );
+
+  ASSERT_NE(config_instance.lazy_parameters(), nullptr);
+  auto speed = miru::query::get_param(config_instance, "motion-control.speed");
+  EXPECT_EQ(speed.as<int>(), 89);
+  EXPECT_EQ(config_instance.lazy_parameters()->num_materialized(), 1);
+}
+
+// ================================== AGENT CACHE ================================== //
+class AgentCache : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::filesystem::remove_all(cache_dir);
+    mock_client.hash_schema_func = []() { return "sha256:a1b2c3d4e5f6g7h8i9j0k1l2"; };
+    // called from the background refresh too
+    mock_client.get_deployed_config_instance_func = [this]() {
+      if (!agent_up) {
+        throw std::runtime_error("the agent is down");
+      }
+      openapi::ConfigInstance config_instance;
+      config_instance.content = {{"speed", speed.load()}};
+      return config_instance;
+    };
+    options.cache_dir = cache_dir;
+    options.retry_delay = std::chrono::milliseconds(1);
+    options.default_instance_file_path =
+      miru::test_utils::config_instances_testdata_dir()
+        .file("motion-control.yaml")
+        .abs_path();
+  }
+  void TearDown() override { std::filesystem::remove_all(cache_dir); }
+
+  miru::config::ConfigInstance load(const std::string& schema_file_name) {
+    std::string schema_file_path =
+      miru::test_utils::config_schemas_testdata_dir().file(schema_file_name).abs_path();
+    return miru::config::ConfigInstance(
+      std::make_unique<miru::config::ConfigInstanceImpl>(
+        miru::config::ConfigInstanceImpl::from_agent(
+          mock_client, schema_file_path, options
+        )
+      )
+    );
+  }
+
+  static int speed_of(const miru::config::ConfigInstance& config_instance) {
+    return miru::query::get_param(config_instance, "motion-control.speed").as<int>();
+  }
+
+  std::filesystem::path cache_dir =
+    std::filesystem::temp_directory_path() / "miru-agent-cache-test";
+  std::atomic<bool> agent_up = true;
+  std::atomic<int> speed = 89;
+  test::http::MockAgentClient mock_client;
+  miru::config::FromAgentOptions options;
+};
+
+TEST_F(AgentCache, Fallback) {
+  // fetched from the agent and persisted
+  miru::config::ConfigInstance fetched = load("motion-control.yaml");
+  EXPECT_FALSE(fetched.from_agent_cache());
+  EXPECT_EQ(speed_of(fetched), 89);
+  EXPECT_EQ(
+    std::distance(
+      std::filesystem::directory_iterator(cache_dir),
+      std::filesystem::directory_iterator()
+    ),
+    1
+  );
+
+  // served from the cache (rather than the default file) when the agent is down
+  agent_up = false;
+  miru::config::ConfigInstance cached = load("motion-control.yaml");
+  EXPECT_TRUE(cached.from_agent_cache());
+  EXPECT_EQ(cached.get_source(), miru::config::ConfigInstanceSource::Agent);
+  EXPECT_EQ(cached.root_parameter(), fetched.root_parameter());
+  EXPECT_NO_THROW(cached.wait_for_refresh());
+
+  options.lazy = true;
+  miru::config::ConfigInstance mapped = load("motion-control.yaml");
+  EXPECT_TRUE(mapped.from_agent_cache());
+  EXPECT_NE(mapped.mapped_snapshot(), nullptr);
+  EXPECT_EQ(speed_of(mapped), 89);
+  options.lazy = false;
+
+  // the cache is keyed by the schema
+  miru::config::ConfigInstance other_schema = load("motion-control.json");
+  EXPECT_FALSE(other_schema.from_agent_cache());
+  EXPECT_EQ(
+    other_schema.get_source(), miru::config::ConfigInstanceSource::FileSystem
+  );
+
+  // invalid snapshots are cache misses
+  for (const auto& entry : std::filesystem::directory_iterator(cache_dir)) {
+    std::ofstream(entry.path(), std::ios::trunc) << "not a snapshot";
+  }
+  miru::config::ConfigInstance corrupted = load("motion-control.yaml");
+  EXPECT_FALSE(corrupted.from_agent_cache());
+  EXPECT_EQ(speed_of(corrupted), 15);
+
+  // and without a default file the agent's error is rethrown
+  options.default_instance_file_path = std::nullopt;
+  EXPECT_THROW(load("motion-control.yaml"), std::runtime_error);
+}
+
+TEST_F(AgentCache, CachedThenRefresh) {
+  options.cache_policy = miru::config::AgentCachePolicy::CachedThenRefresh;
+  std::atomic<int> refreshed_speed = 0;
+  options.on_refresh = [&](miru::config::ConfigInstance refreshed) {
+    refreshed_speed = speed_of(refreshed);
+  };
+
+  // nothing is cached yet so the config instance is fetched from the agent
+  miru::config::ConfigInstance fetched = load("motion-control.yaml");
+  EXPECT_FALSE(fetched.from_agent_cache());
+  EXPECT_EQ(speed_of(fetched), 89);
+  EXPECT_EQ(refreshed_speed, 0);
+
+  // the cached config instance is served while the refresh fetches the new one
+  speed = 90;
+  miru::config::ConfigInstance cached = load("motion-control.yaml");
+  EXPECT_TRUE(cached.from_agent_cache());
+  EXPECT_EQ(speed_of(cached), 89);
+  cached.wait_for_refresh();
+  EXPECT_EQ(refreshed_speed, 90);
+
+  // which is served by the next load
+  agent_up = false;
+  miru::config::ConfigInstance next = load("motion-control.yaml");
+  EXPECT_TRUE(next.from_agent_cache());
+  EXPECT_EQ(speed_of(next), 90);
+  EXPECT_THROW(next.wait_for_refresh(), std::runtime_error);
+}
+
+TEST_F(AgentCache, CachedThenRefreshSwap) {
+  speed = 90;
+  load("motion-control.yaml");
+
+  // the refreshed config instance replaces the cached one from on_refresh, which
+  // destroys the cached config instance on the refresh thread
+  options.cache_policy = miru::config::AgentCachePolicy::CachedThenRefresh;
+  std::mutex mutex;
+  std::condition_variable swapped;
+  std::optional<miru::config::ConfigInstance> current;
+  options.on_refresh = [&](miru::config::ConfigInstance refreshed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    current = std::move(refreshed);
+    swapped.notify_all();
+  };
+  speed = 91;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    current = load("motion-control.yaml");
+    EXPECT_TRUE(current->from_agent_cache());
+    EXPECT_EQ(speed_of(*current), 90);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  ASSERT_TRUE(swapped.wait_for(lock, std::chrono::seconds(5), [&]() {
+    return !current->from_agent_cache();
+  }));
+  EXPECT_EQ(speed_of(*current), 91);
+}
+
+TEST_F(AgentCache, CachedThenRefreshStopped) {
+  load("motion-control.yaml");
+
+  // destroying the cached config instance stops the refresh instead of waiting out
+  // the retries of an agent which is down
+  agent_up = false;
+  options.cache_policy = miru::config::AgentCachePolicy::CachedThenRefresh;
+  options.num_retries = 3;
+  options.retry_delay = std::chrono::seconds(10);
+  auto start = std::chrono::steady_clock::now();
+  {
+    miru::config::ConfigInstance cached = load("motion-control.yaml");
+    EXPECT_TRUE(cached.from_agent_cache());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
 TEST(ConfigInstance, FromAgentFailure_DefaultFileFailure) {
   // set the response from the mock client
   test::http::MockAgentClient mock_client;
@@ -256,4 +613,59 @@ TEST(ConfigInstance, FromAgentFailure_DefaultFileFailure) {
   );
 }
 
+TEST(ConfigInstance, FromAgentBinaryEncodings) {
+  // a stand-in agent which serves the config instance in the preferred encoding it
+  // was asked for
+  std::vector<std::string> accept_headers;
+  nlohmann::json instance = {
+    {"id", "cfg_inst_123"},
+    {"content", {{"speed", 89}, {"features", {{"spin", true}}}}},
+  };
+  auto respond = [&](const boost::beast::http::request<boost::beast::http::string_body>&
+                       req) {
+    if (req.target().find("/config_schemas/hash/serialized") !=
+        boost::beast::string_view::npos) {
+      return test::http::make_response(
+        req, R"({"digest": "sha256:abc"})", "application/json"
+      );
+    }
+    std::string accept(req[boost::beast::http::field::accept]);
+    accept_headers.push_back(accept);
+    if (accept.rfind("application/msgpack", 0) == 0) {
+      std::vector<uint8_t> body = nlohmann::json::to_msgpack(instance);
+      return test::http::make_response(
+        req, std::string(body.begin(), body.end()), "application/msgpack"
+      );
+    }
+    return test::http::make_response(req, instance.dump(), "application/json");
+  };
+  test::http::StandInAgent agent(
+    std::filesystem::temp_directory_path() / "miru-from-agent-test.sock", respond
+  );
+  miru::http::UnixSocketClient client(agent.socket_path());
+  std::string schema_file_path = miru::test_utils::config_schemas_testdata_dir()
+                                   .file("motion-control.yaml")
+                                   .abs_path();
+
+  miru::config::FromAgentOptions options;
+  for (bool binary_encodings : {true, false}) {
+    options.binary_encodings = binary_encodings;
+    miru::config::ConfigInstance config_instance(
+      std::make_unique<miru::config::ConfigInstanceImpl>(
+        miru::config::ConfigInstanceImpl::from_agent(client, schema_file_path, options)
+      )
+    );
+    EXPECT_EQ(config_instance.get_source(), miru::config::ConfigInstanceSource::Agent);
+    EXPECT_EQ(
+      miru::query::get_param(config_instance, "motion-control.speed").as<int>(), 89
+    );
+  }
+  ASSERT_EQ(accept_headers.size(), 2);
+  EXPECT_EQ(
+    accept_headers[0],
+    "application/msgpack, application/cbor;q=0.9, application/json;q=0.8"
+  );
+  EXPECT_EQ(accept_headers[1], "application/json");
+}
+
 }  // namespace test::config
\ No newline at end of file
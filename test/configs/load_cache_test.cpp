@@ -0,0 +1,180 @@
+// std
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// internal
+#include <http/models/ConfigInstance.h>
+#include <configs/instance_impl.hpp>
+#include <miru/configs/load_cache.hpp>
+#include <miru/query/query.hpp>
+#include <test/http/mock.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::config {
+
+namespace openapi = org::openapitools::server::model;
+
+// ================================== LOAD CACHE =================================== //
+class LoadCache : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    miru::config::clear_load_cache();
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    miru::filesys::File schema_file =
+      miru::test_utils::config_schemas_testdata_dir().file("motion-control.json");
+    std::filesystem::copy_file(schema_file.path(), schema_path);
+    write_instance(15);
+
+    mock_client.hash_schema_func = [this]() {
+      num_hashes++;
+      return "sha256:a1b2c3d4e5f6g7h8i9j0k1l2";
+    };
+    mock_client.get_deployed_config_instance_func = [this]() {
+      num_fetches++;
+      openapi::ConfigInstance config_instance;
+      config_instance.content = {{"speed", 89}};
+      return config_instance;
+    };
+    options.use_load_cache = true;
+    agent_options.use_load_cache = true;
+    agent_options.retry_delay = std::chrono::milliseconds(1);
+  }
+  void TearDown() override {
+    std::filesystem::remove_all(dir);
+    miru::config::clear_load_cache();
+  }
+
+  void write_instance(int speed) {
+    std::ofstream(instance_path) << "{\"speed\": " << speed << "}";
+  }
+
+  miru::config::ConfigInstance load() {
+    return miru::config::ConfigInstance::from_file(schema_path, instance_path, options);
+  }
+
+  miru::config::ConfigInstance load_from_agent() {
+    return miru::config::ConfigInstance(
+      std::make_unique<miru::config::ConfigInstanceImpl>(
+        miru::config::ConfigInstanceImpl::from_agent(
+          mock_client, schema_path, agent_options
+        )
+      )
+    );
+  }
+
+  static int speed_of(const miru::config::ConfigInstance& config_instance) {
+    return miru::query::get_param(config_instance, "motion-control.speed").as<int>();
+  }
+
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-load-cache-test";
+  std::filesystem::path schema_path = dir / "motion-control.schema.json";
+  std::filesystem::path instance_path = dir / "motion-control.json";
+  miru::config::FromFileOptions options;
+  miru::config::FromAgentOptions agent_options;
+  std::atomic<int> num_hashes = 0;
+  std::atomic<int> num_fetches = 0;
+  test::http::MockAgentClient mock_client;
+};
+
+TEST_F(LoadCache, DisabledByDefault) {
+  options.use_load_cache = false;
+  miru::config::ConfigInstance first = load();
+  miru::config::ConfigInstance second = load();
+  EXPECT_NE(&first.root_parameter(), &second.root_parameter());
+
+  miru::config::LoadCacheStats stats = miru::config::load_cache_stats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.schemas, 0);
+  EXPECT_EQ(stats.instances, 0);
+}
+
+TEST_F(LoadCache, FromFile) {
+  miru::config::ConfigInstance first = load();
+  miru::config::LoadCacheStats stats = miru::config::load_cache_stats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.schemas, 1);
+  EXPECT_EQ(stats.instances, 1);
+
+  // the parameter tree is shared rather than parsed again
+  miru::config::ConfigInstance second = load();
+  EXPECT_EQ(&first.root_parameter(), &second.root_parameter());
+  EXPECT_EQ(speed_of(second), 15);
+  stats = miru::config::load_cache_stats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(miru::config::to_string(stats).rfind("LoadCacheStats{hits: 2", 0), 0);
+}
+
+TEST_F(LoadCache, Modified) {
+  miru::config::ConfigInstance first = load();
+  EXPECT_EQ(speed_of(first), 15);
+
+  // replaced by the new version of the file (the old one is still loaded)
+  write_instance(150);
+  miru::config::ConfigInstance second = load();
+  EXPECT_EQ(speed_of(second), 150);
+  EXPECT_EQ(speed_of(first), 15);
+  miru::config::LoadCacheStats stats = miru::config::load_cache_stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 3);
+  EXPECT_EQ(stats.instances, 1);
+
+  miru::config::ConfigInstance third = load();
+  EXPECT_EQ(&second.root_parameter(), &third.root_parameter());
+}
+
+TEST_F(LoadCache, Lazy) {
+  options.lazy = true;
+  miru::config::ConfigInstance first = load();
+  miru::config::ConfigInstance second = load();
+  ASSERT_NE(first.lazy_parameters(), nullptr);
+  EXPECT_EQ(first.lazy_parameters(), second.lazy_parameters());
+  EXPECT_EQ(speed_of(second), 15);
+
+  // lazily and entirely loaded config instances are cached separately
+  options.lazy = false;
+  miru::config::ConfigInstance eager = load();
+  EXPECT_EQ(eager.lazy_parameters(), nullptr);
+  EXPECT_EQ(speed_of(eager), 15);
+  EXPECT_EQ(miru::config::load_cache_stats().instances, 2);
+}
+
+TEST_F(LoadCache, FromAgent) {
+  // the schema is only hashed by the agent once but the config instance is always
+  // fetched
+  EXPECT_EQ(speed_of(load_from_agent()), 89);
+  EXPECT_EQ(speed_of(load_from_agent()), 89);
+  EXPECT_EQ(num_hashes, 1);
+  EXPECT_EQ(num_fetches, 2);
+
+  // hashed again once the schema changes
+  std::ofstream(schema_path, std::ios::app) << "\n";
+  EXPECT_EQ(speed_of(load_from_agent()), 89);
+  EXPECT_EQ(num_hashes, 2);
+  EXPECT_EQ(num_fetches, 3);
+}
+
+TEST_F(LoadCache, Clear) {
+  miru::config::ConfigInstance first = load();
+  miru::config::clear_load_cache();
+  miru::config::LoadCacheStats stats = miru::config::load_cache_stats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+  EXPECT_EQ(stats.schemas, 0);
+  EXPECT_EQ(stats.instances, 0);
+
+  miru::config::ConfigInstance second = load();
+  EXPECT_NE(&first.root_parameter(), &second.root_parameter());
+  EXPECT_EQ(speed_of(first), 15);
+}
+
+}  // namespace test::config
@@ -0,0 +1,577 @@
+// std
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// internal
+#include <configs/errors.hpp>
+#include <configs/instance_impl.hpp>
+#include <configs/snapshot.hpp>
+#include <miru/configs/mapped_snapshot.hpp>
+#include <filesys/file.hpp>
+#include <miru/params/details/errors.hpp>
+#include <miru/query/query.hpp>
+#include <params/parse.hpp>
+#include <test/http/mock.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+#include <yaml-cpp/yaml.h>
+
+#include <nlohmann/json.hpp>
+
+namespace test::config {
+
+namespace openapi = org::openapitools::server::model;
+
+using Parameter = miru::params::Parameter;
+using SnapshotMetadata = miru::config::SnapshotMetadata;
+
+class Snapshot : public ::testing::Test {
+ protected:
+  void SetUp() override { std::filesystem::create_directories(dir); }
+  void TearDown() override { std::filesystem::remove_all(dir); }
+
+  // round trips the parameter through a snapshot
+  Parameter round_trip(const Parameter& root) {
+    miru::config::write_snapshot(path, metadata(), root);
+    return miru::config::read_snapshot(path).root;
+  }
+
+  static SnapshotMetadata metadata() {
+    SnapshotMetadata metadata;
+    metadata.config_type_slug = "motion-control";
+    metadata.source = miru::config::ConfigInstanceSource::FileSystem;
+    metadata.config_schema_file = "schemas/motion-control.json";
+    metadata.config_instance_file = "instances/motion-control.json";
+    return metadata;
+  }
+
+  std::string read_bytes() { return miru::filesys::File(path).read_string(); }
+
+  void write_bytes(const std::string& bytes) {
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+      .write(bytes.data(), bytes.size());
+  }
+
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-snapshot-test";
+  std::filesystem::path path = dir / "motion-control.snapshot";
+};
+
+// ================================== ROUND TRIPS ================================== //
+TEST_F(Snapshot, EveryJsonType) {
+  nlohmann::json json = {
+    {"null", nullptr},
+    {"bool", true},
+    {"integer", -42},
+    {"big_integer", 9007199254740993},
+    {"double", 3.25},
+    {"string", "speed"},
+    {"empty_string", ""},
+    {"unicode", "vitesse élevée"},
+    {"bools", {true, false, true}},
+    {"integers", {1, -2, 3}},
+    {"doubles", {0.5, -1.5}},
+    {"strings", {"a", "b", "a"}},
+    {"nested", {{"a", {{"b", {{"c", 1}}}}}}},
+    {"maps", {{{"x", 1}, {"y", {1, 2}}}, {{"x", 2}, {"y", {3}}}}},
+    {"grid", {{1, 2}, {3}, nlohmann::json::array()}},
+  };
+  json["string_with_nul"] = std::string("a\0b", 3);
+  Parameter root = miru::params::parse_json_node("motion-control", json);
+  EXPECT_EQ(round_trip(root), root);
+}
+
+TEST_F(Snapshot, EveryYamlType) {
+  YAML::Node yaml = YAML::Load(
+    "speed: 15\n"
+    "gain: 0.5\n"
+    "label: fast\n"
+    "empty: ~\n"
+    "tags: [a, 1, true]\n"
+    "waypoints: [{x: 1, y: [1, 2]}, {x: 2, y: [3]}]\n"
+    "grid: [[1, 2], [3]]\n"
+  );
+  Parameter root = miru::params::parse_yaml_node("motion-control", yaml);
+  EXPECT_EQ(round_trip(root), root);
+}
+
+TEST_F(Snapshot, LongArrays) {
+  // the items of arrays of more than 10 items sort differently by name and index
+  nlohmann::json json = {
+    {"waypoints", nlohmann::json::array()}, {"grid", nlohmann::json::array()}
+  };
+  for (int i = 0; i < 12; i++) {
+    json["waypoints"].push_back({{"x", i}});
+    json["grid"].push_back({i, i + 1});
+  }
+  Parameter root = miru::params::parse_json_node("motion-control", json);
+  Parameter read = round_trip(root);
+  EXPECT_EQ(read, root);
+  EXPECT_EQ(miru::query::get_param(read, "motion-control.waypoints.2.x").as<int>(), 2);
+}
+
+TEST_F(Snapshot, Scalars) {
+  for (const auto& json : {
+         nlohmann::json(nullptr),
+         nlohmann::json(false),
+         nlohmann::json(-1),
+         nlohmann::json(1e300),
+         nlohmann::json("str"),
+         nlohmann::json::array({1, 2}),
+       }) {
+    Parameter root = miru::params::parse_json_node("motion-control", json);
+    EXPECT_EQ(round_trip(root), root);
+  }
+}
+
+TEST_F(Snapshot, TestdataFiles) {
+  for (const std::string& file_name : {"load.json", "load.yaml"}) {
+    miru::filesys::File file = miru::test_utils::params_testdata_dir().file(file_name);
+    Parameter root = miru::params::parse_file("motion-control", file);
+    EXPECT_EQ(round_trip(root), root);
+  }
+}
+
+TEST_F(Snapshot, Metadata) {
+  SnapshotMetadata expected = metadata();
+  expected.source = miru::config::ConfigInstanceSource::Agent;
+  expected.config_schema_digest = "sha256:a1b2c3d4";
+  expected.config_instance_file = std::nullopt;
+  miru::config::write_snapshot(
+    path, expected, miru::params::parse_json_node("motion-control", {{"speed", 1}})
+  );
+
+  SnapshotMetadata metadata = miru::config::read_snapshot(path).metadata;
+  EXPECT_EQ(metadata.config_type_slug, expected.config_type_slug);
+  EXPECT_EQ(metadata.source, expected.source);
+  EXPECT_EQ(metadata.config_schema_file, expected.config_schema_file);
+  EXPECT_EQ(metadata.config_schema_digest, expected.config_schema_digest);
+  EXPECT_EQ(metadata.config_instance_file, std::nullopt);
+}
+
+TEST_F(Snapshot, OverwritesTheSnapshot) {
+  Parameter first = miru::params::parse_json_node("motion-control", {{"speed", 1}});
+  Parameter second = miru::params::parse_json_node("motion-control", {{"speed", 2}});
+  EXPECT_EQ(round_trip(first), first);
+  EXPECT_EQ(round_trip(second), second);
+  // the temporary file is renamed over the snapshot
+  EXPECT_EQ(
+    std::distance(
+      std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()
+    ),
+    1
+  );
+}
+
+TEST_F(Snapshot, ConcurrentWriters) {
+  // every writer has its own temporary file so the snapshot is always one of theirs
+  std::vector<std::thread> writers;
+  for (int i = 0; i < 8; i++) {
+    writers.emplace_back([this, i]() {
+      Parameter root = miru::params::parse_json_node("motion-control", {{"speed", i}});
+      for (int j = 0; j < 10; j++) {
+        miru::config::write_snapshot(path, metadata(), root);
+      }
+    });
+  }
+  for (std::thread& writer : writers) {
+    writer.join();
+  }
+  Parameter read = miru::config::read_snapshot(path).root;
+  int speed = miru::query::get_param(read, "motion-control.speed").as<int>();
+  EXPECT_GE(speed, 0);
+  EXPECT_LT(speed, 8);
+  EXPECT_EQ(
+    std::distance(
+      std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()
+    ),
+    1
+  );
+}
+
+TEST_F(Snapshot, FailedWrite) {
+  // the rename over a directory fails, which removes the temporary file
+  std::filesystem::create_directories(path);
+  Parameter root = miru::params::parse_json_node("motion-control", {{"speed", 1}});
+  EXPECT_THROW(
+    miru::config::write_snapshot(path, metadata(), root), std::runtime_error
+  );
+  EXPECT_EQ(
+    std::distance(
+      std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()
+    ),
+    1
+  );
+}
+
+// ================================ INVALID SNAPSHOTS ============================== //
+TEST_F(Snapshot, DoesntExist) {
+  EXPECT_ANY_THROW(miru::config::read_snapshot(dir / "doesnt-exist.snapshot"));
+}
+
+TEST_F(Snapshot, Corrupted) {
+  miru::filesys::File file = miru::test_utils::params_testdata_dir().file("load.json");
+  round_trip(miru::params::parse_file("motion-control", file));
+  std::string bytes = read_bytes();
+
+  // flipping any byte after the checksum is detected
+  std::vector<size_t> offsets = {
+    offsetof(miru::config::SnapshotHeader, num_nodes),
+    sizeof(miru::config::SnapshotHeader),
+    bytes.size() / 2,
+    bytes.size() - 1,
+  };
+  for (size_t i : offsets) {
+    std::string corrupted = bytes;
+    corrupted[i] ^= 0x20;
+    write_bytes(corrupted);
+    EXPECT_THROW(miru::config::read_snapshot(path), miru::config::InvalidSnapshotError);
+  }
+}
+
+TEST_F(Snapshot, Truncated) {
+  round_trip(miru::params::parse_json_node("motion-control", {{"speed", 1}}));
+  std::string bytes = read_bytes();
+  std::vector<size_t> sizes = {
+    0, 7, sizeof(miru::config::SnapshotHeader), bytes.size() - 1
+  };
+  for (size_t size : sizes) {
+    write_bytes(bytes.substr(0, size));
+    EXPECT_THROW(miru::config::read_snapshot(path), miru::config::InvalidSnapshotError);
+  }
+}
+
+TEST_F(Snapshot, NotASnapshot) {
+  write_bytes(miru::test_utils::params_testdata_dir().file("load.json").read_string());
+  EXPECT_THROW(miru::config::read_snapshot(path), miru::config::InvalidSnapshotError);
+}
+
+TEST_F(Snapshot, OtherVersion) {
+  round_trip(miru::params::parse_json_node("motion-control", {{"speed", 1}}));
+  std::string bytes = read_bytes();
+  uint32_t version = miru::config::SNAPSHOT_VERSION + 1;
+  bytes.replace(
+    offsetof(miru::config::SnapshotHeader, version),
+    sizeof(version),
+    reinterpret_cast<const char*>(&version),
+    sizeof(version)
+  );
+  write_bytes(bytes);
+  EXPECT_THROW(miru::config::read_snapshot(path), miru::config::InvalidSnapshotError);
+}
+
+// ================================ CONFIG INSTANCES =============================== //
+TEST_F(Snapshot, FromFileSystem) {
+  for (const std::string& file_name : {"motion-control.json", "motion-control.yaml"}) {
+    std::string schema_file_path =
+      miru::test_utils::config_schemas_testdata_dir().file(file_name).abs_path();
+    std::string instance_file_path =
+      miru::test_utils::config_instances_testdata_dir().file(file_name).abs_path();
+    miru::config::ConfigInstance expected =
+      miru::config::ConfigInstance::from_file(schema_file_path, instance_file_path);
+    expected.save_snapshot(path);
+
+    miru::config::ConfigInstance config_instance =
+      miru::config::ConfigInstance::from_snapshot(path);
+    EXPECT_EQ(
+      config_instance.get_source(), miru::config::ConfigInstanceSource::FileSystem
+    );
+    EXPECT_EQ(config_instance.root_parameter(), expected.root_parameter());
+    auto speed = miru::query::get_param(config_instance, "motion-control.speed");
+    EXPECT_EQ(speed.as<int>(), 15);
+
+    SnapshotMetadata metadata = miru::config::read_snapshot(path).metadata;
+    EXPECT_EQ(metadata.config_type_slug, "motion-control");
+    EXPECT_EQ(metadata.config_schema_file, schema_file_path);
+    EXPECT_EQ(metadata.config_instance_file, instance_file_path);
+  }
+}
+
+TEST_F(Snapshot, FromFileSystemLazy) {
+  std::string schema_file_path = miru::test_utils::config_schemas_testdata_dir()
+                                   .file("motion-control.json")
+                                   .abs_path();
+  std::string instance_file_path = miru::test_utils::config_instances_testdata_dir()
+                                     .file("motion-control.json")
+                                     .abs_path();
+  miru::config::FromFileOptions options;
+  options.lazy = true;
+  miru::config::ConfigInstance lazy = miru::config::ConfigInstance::from_file(
+    schema_file_path, instance_file_path, options
+  );
+  lazy.save_snapshot(path);
+
+  miru::config::ConfigInstance config_instance =
+    miru::config::ConfigInstance::from_snapshot(path);
+  EXPECT_EQ(config_instance.lazy_parameters(), nullptr);
+  EXPECT_EQ(
+    config_instance.root_parameter(),
+    miru::config::ConfigInstance::from_file(schema_file_path, instance_file_path)
+      .root_parameter()
+  );
+}
+
+TEST_F(Snapshot, FromAgent) {
+  test::http::MockAgentClient mock_client;
+  mock_client.hash_schema_func = []() { return "sha256:a1b2c3d4e5f6g7h8i9j0k1l2"; };
+  mock_client.get_deployed_config_instance_func = []() {
+    openapi::ConfigInstance config_instance;
+    config_instance.content = {{"speed", 89}, {"features", {{"spin", true}}}};
+    return config_instance;
+  };
+  std::string schema_file_path = miru::test_utils::config_schemas_testdata_dir()
+                                   .file("motion-control.yaml")
+                                   .abs_path();
+  miru::config::ConfigInstance expected(
+    std::make_unique<miru::config::ConfigInstanceImpl>(
+      miru::config::ConfigInstanceImpl::from_agent(mock_client, schema_file_path)
+    )
+  );
+  expected.save_snapshot(path);
+
+  miru::config::ConfigInstance config_instance =
+    miru::config::ConfigInstance::from_snapshot(path);
+  EXPECT_EQ(config_instance.get_source(), miru::config::ConfigInstanceSource::Agent);
+  EXPECT_EQ(config_instance.root_parameter(), expected.root_parameter());
+  auto speed = miru::query::get_param(config_instance, "motion-control.speed");
+  EXPECT_EQ(speed.as<int>(), 89);
+
+  SnapshotMetadata metadata = miru::config::read_snapshot(path).metadata;
+  EXPECT_EQ(metadata.config_schema_digest, "sha256:a1b2c3d4e5f6g7h8i9j0k1l2");
+  EXPECT_EQ(metadata.config_instance_file, std::nullopt);
+}
+
+TEST_F(Snapshot, InvalidConfigInstanceSnapshot) {
+  write_bytes("not a snapshot");
+  EXPECT_THROW(
+    miru::config::ConfigInstance::from_snapshot(path),
+    miru::config::InvalidSnapshotError
+  );
+}
+
+// ================================ MAPPED SNAPSHOTS =============================== //
+class MappedSnapshot : public Snapshot {
+ protected:
+  Parameter write(const nlohmann::json& json) {
+    Parameter root = miru::params::parse_json_node("motion-control", json);
+    miru::config::write_snapshot(path, metadata(), root);
+    return root;
+  }
+
+  nlohmann::json json = {
+    {"speed", 15},
+    {"gain", 0.5},
+    {"enabled", true},
+    {"label", "fast"},
+    {"flags", {true, false}},
+    {"offsets", {1, -2, 3}},
+    {"gains", {0.5, 1.5}},
+    {"tags", {"a", "b"}},
+    {"waypoints", {{{"x", 1}, {"y", 2}}, {{"x", 3}, {"y", 4}}}},
+    {"grid", {{1, 2}, {3}}},
+  };
+};
+
+TEST_F(MappedSnapshot, Views) {
+  write(json);
+  miru::config::MappedSnapshot snapshot(path);
+  EXPECT_EQ(snapshot.config_type_slug(), "motion-control");
+  EXPECT_EQ(snapshot.source(), miru::config::ConfigInstanceSource::FileSystem);
+  EXPECT_EQ(snapshot.config_schema_file(), "schemas/motion-control.json");
+  EXPECT_EQ(snapshot.config_schema_digest(), std::nullopt);
+  EXPECT_EQ(snapshot.config_instance_file(), "instances/motion-control.json");
+
+  miru::config::SnapshotNodeView root = snapshot.root_node();
+  EXPECT_EQ(root.type(), miru::params::ParameterType::PARAMETER_MAP);
+  EXPECT_EQ(root.key(), "motion-control");
+  EXPECT_EQ(root.num_children(), json.size());
+  EXPECT_EQ(root.child(0).key(), "enabled");
+  EXPECT_THROW(root.child(json.size()), std::out_of_range);
+
+  EXPECT_EQ(root.find_child("speed")->as_int(), 15);
+  EXPECT_EQ(root.find_child("gain")->as_double(), 0.5);
+  EXPECT_EQ(root.find_child("enabled")->as_bool(), true);
+  EXPECT_EQ(root.find_child("label")->as_string(), "fast");
+  EXPECT_EQ(root.find_child("doesnt-exist"), std::nullopt);
+
+  miru::config::ArrayView<uint8_t> flags = root.find_child("flags")->as_bool_array();
+  EXPECT_EQ(
+    std::vector<uint8_t>(flags.begin(), flags.end()), std::vector<uint8_t>({1, 0})
+  );
+  miru::config::ArrayView<int64_t> offsets =
+    root.find_child("offsets")->as_integer_array();
+  EXPECT_EQ(
+    std::vector<int64_t>(offsets.begin(), offsets.end()),
+    std::vector<int64_t>({1, -2, 3})
+  );
+  miru::config::ArrayView<double> gains = root.find_child("gains")->as_double_array();
+  ASSERT_EQ(gains.size(), 2);
+  EXPECT_EQ(gains[1], 1.5);
+  miru::config::StringArrayView tags = root.find_child("tags")->as_string_array();
+  ASSERT_EQ(tags.size(), 2);
+  EXPECT_EQ(tags[1], "b");
+
+  EXPECT_THROW(
+    root.find_child("label")->as_int(),
+    miru::params::details::InvalidParameterTypeError
+  );
+  EXPECT_THROW(
+    root.find_child("speed")->as_integer_array(),
+    miru::params::details::InvalidParameterTypeError
+  );
+}
+
+TEST_F(MappedSnapshot, FindNode) {
+  write(json);
+  miru::config::MappedSnapshot snapshot(path);
+  EXPECT_EQ(snapshot.find_node("motion-control")->index(), 0);
+  EXPECT_EQ(snapshot.find_node("motion-control.waypoints.1.y")->as_int(), 4);
+  EXPECT_EQ(snapshot.find_node("motion-control.grid.0")->as_integer_array()[1], 2);
+  for (const std::string& name : {
+         "motion",
+         "motion-control.",
+         "motion-control.doesnt-exist",
+         "motion-control.waypoints.2",
+         "motion-control.waypoints.01",
+         "motion-control.waypoints.x",
+         "motion-control.speed.x",
+         "motion-control.tags.0",
+         "other.speed",
+       }) {
+    EXPECT_EQ(snapshot.find_node(name), std::nullopt) << name;
+  }
+}
+
+TEST_F(MappedSnapshot, Materialize) {
+  Parameter root = write(json);
+  miru::config::MappedSnapshot snapshot(path);
+  EXPECT_EQ(snapshot.num_materialized(), 0);
+
+  const Parameter* waypoint = snapshot.find("motion-control.waypoints.1");
+  ASSERT_NE(waypoint, nullptr);
+  EXPECT_EQ(*waypoint, root.as_map()["waypoints"].as_map_array()[1]);
+  EXPECT_EQ(snapshot.find("motion-control.waypoints.1"), waypoint);
+  EXPECT_EQ(snapshot.find("motion-control.doesnt-exist"), nullptr);
+  EXPECT_EQ(snapshot.num_materialized(), 1);
+
+  EXPECT_EQ(snapshot.root(), root);
+  EXPECT_EQ(&snapshot.find("motion-control")->as_map(), &snapshot.root().as_map());
+  EXPECT_EQ(snapshot.num_materialized(), 2);
+}
+
+TEST_F(MappedSnapshot, LongArrays) {
+  nlohmann::json long_arrays = {
+    {"waypoints", nlohmann::json::array()}, {"grid", nlohmann::json::array()}
+  };
+  for (int i = 0; i < 12; i++) {
+    long_arrays["waypoints"].push_back({{"x", i}});
+    long_arrays["grid"].push_back({i, i + 1});
+  }
+  Parameter root = write(long_arrays);
+  miru::config::MappedSnapshot snapshot(path);
+  for (int i = 0; i < 12; i++) {
+    std::string index = std::to_string(i);
+    EXPECT_EQ(
+      snapshot.find_node("motion-control.waypoints." + index + ".x")->as_int(), i
+    );
+    EXPECT_EQ(
+      snapshot.find_node("motion-control.grid." + index)->as_integer_array()[0], i
+    );
+  }
+  const Parameter* waypoint = snapshot.find("motion-control.waypoints.2");
+  ASSERT_NE(waypoint, nullptr);
+  EXPECT_EQ(waypoint->get_name(), "motion-control.waypoints.2");
+  EXPECT_EQ(waypoint->as_map()["x"].as<int>(), 2);
+  EXPECT_EQ(snapshot.root(), root);
+}
+
+TEST_F(MappedSnapshot, TestdataFiles) {
+  for (const std::string& file_name : {"load.json", "load.yaml"}) {
+    miru::filesys::File file = miru::test_utils::params_testdata_dir().file(file_name);
+    Parameter root = miru::params::parse_file("motion-control", file);
+    miru::config::write_snapshot(path, metadata(), root);
+    EXPECT_EQ(miru::config::MappedSnapshot(path).root(), root);
+  }
+}
+
+TEST_F(MappedSnapshot, Invalid) {
+  write(json);
+  std::string bytes = read_bytes();
+
+  // corrupted strings are only detected by the checksum
+  std::string corrupted = bytes;
+  corrupted[corrupted.find("fast")] = 'l';
+  write_bytes(corrupted);
+  EXPECT_THROW(miru::config::MappedSnapshot{path}, miru::config::InvalidSnapshotError);
+  miru::config::MappedSnapshot unverified(path, false);
+  EXPECT_EQ(unverified.find_node("motion-control.label")->as_string(), "last");
+
+  // the header and the structure of the node table are always validated
+  write_bytes(bytes.substr(0, bytes.size() - 8));
+  EXPECT_THROW(
+    miru::config::MappedSnapshot(path, false), miru::config::InvalidSnapshotError
+  );
+  corrupted = bytes;
+  corrupted[sizeof(miru::config::SnapshotHeader) +
+            offsetof(miru::config::SnapshotNode, a)] ^= 1;
+  write_bytes(corrupted);
+  EXPECT_THROW(
+    miru::config::MappedSnapshot(path, false), miru::config::InvalidSnapshotError
+  );
+  write_bytes("");
+  EXPECT_THROW(
+    miru::config::MappedSnapshot(path, false), miru::config::InvalidSnapshotError
+  );
+  EXPECT_ANY_THROW(miru::config::MappedSnapshot(dir / "doesnt-exist.snapshot"));
+}
+
+TEST_F(MappedSnapshot, ConfigInstance) {
+  std::string schema_file_path = miru::test_utils::config_schemas_testdata_dir()
+                                   .file("motion-control.json")
+                                   .abs_path();
+  std::string instance_file_path = miru::test_utils::config_instances_testdata_dir()
+                                     .file("motion-control.json")
+                                     .abs_path();
+  miru::config::ConfigInstance expected =
+    miru::config::ConfigInstance::from_file(schema_file_path, instance_file_path);
+  expected.save_snapshot(path);
+  EXPECT_EQ(expected.mapped_snapshot(), nullptr);
+
+  miru::config::FromSnapshotOptions options;
+  options.mapped = true;
+  std::shared_ptr<const Parameter> speed_ptr;
+  {
+    miru::config::ConfigInstance config_instance =
+      miru::config::ConfigInstance::from_snapshot(path, options);
+    EXPECT_EQ(
+      config_instance.get_source(), miru::config::ConfigInstanceSource::FileSystem
+    );
+    std::shared_ptr<const miru::config::MappedSnapshot> snapshot =
+      config_instance.mapped_snapshot();
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->find_node("motion-control.speed")->as_int(), 15);
+
+    // queries by name only build the parameters they return
+    auto speed = miru::query::get_param(config_instance, "motion-control.speed");
+    EXPECT_EQ(speed.as<int>(), 15);
+    speed_ptr = miru::query::get_shared_param(config_instance, "motion-control.speed");
+    EXPECT_EQ(snapshot->num_materialized(), 1);
+
+    // other queries build the entire tree
+    EXPECT_EQ(config_instance.root_parameter(), expected.root_parameter());
+    EXPECT_EQ(
+      miru::query::list_params(config_instance).size(),
+      miru::query::list_params(expected).size()
+    );
+  }
+  // shared parameters outlive the config instance (and the mapping)
+  EXPECT_EQ(speed_ptr->as<int>(), 15);
+}
+
+}  // namespace test::config
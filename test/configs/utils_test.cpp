@@ -1,3 +1,10 @@
+// std
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+
 // internal
 #include <configs/errors.hpp>
 #include <configs/instance_impl.hpp>
@@ -63,4 +70,106 @@ TEST(ConfigInstance, ConfigTypeSlugNotFoundYaml) {
   );
 }
 
+// ============================== SCAN CONFIG SLUG ================================= //
+std::optional<std::string> scan_json(const std::string& json) {
+  std::istringstream stream(json);
+  return miru::config::scan_json_config_type_slug(stream);
+}
+
+std::optional<std::string> scan_yaml(const std::string& yaml) {
+  std::istringstream stream(yaml);
+  return miru::config::scan_yaml_config_type_slug(stream);
+}
+
+TEST(ScanConfigTypeSlug, Json) {
+  EXPECT_EQ(scan_json(R"({"$miru_config_type_slug": "motion"})"), "motion");
+  EXPECT_EQ(
+    scan_json(R"( {
+      "$defs": {"a": {"$miru_config_type_slug": "nested", "b": ["}", 1.5e3]}},
+      "type" : "object", "flag": true, "nothing": null,
+      "$miru_config_type_slug" : "motion",
+      "properties": {"unterminated": )"),
+    "motion"
+  );
+  EXPECT_EQ(
+    scan_json(R"({"\"key": 1, "$miru_config_type_slug": "mo\"tion\u00e9"})"),
+    "mo\"tion\u00e9"
+  );
+  EXPECT_EQ(scan_json(R"({"$miru_config_type_slug": ""})"), "");
+}
+
+TEST(ScanConfigTypeSlug, JsonFallsBack) {
+  for (const std::string& json : {
+         "",
+         "[1]",
+         "{}",
+         R"({"type": "object"})",
+         R"({"$miru_config_type_slug": 1})",
+         R"({"$miru_config_type_slug": "unterminated)",
+         R"({"$miru_config_type_slug" "motion"})",
+         R"({"a": {"b": 1}} "$miru_config_type_slug": "motion"})",
+         R"({"a": "\x", "$miru_config_type_slug": "motion"})",
+       }) {
+    EXPECT_EQ(scan_json(json), std::nullopt) << json;
+  }
+}
+
+TEST(ScanConfigTypeSlug, Yaml) {
+  EXPECT_EQ(scan_yaml("$miru_config_type_slug: motion\n"), "motion");
+  EXPECT_EQ(
+    scan_yaml(
+      "%YAML 1.2\n"
+      "---\n"
+      "# comment\n"
+      "type: object\n"
+      "$defs:\n"
+      "  a:\n"
+      "    $miru_config_type_slug: nested\n"
+      "\"$miru_config_type_slug\" : 'mo''tion' # comment\r\n"
+      "\n"
+      "properties: {unterminated: \n"
+    ),
+    "mo'tion"
+  );
+  EXPECT_EQ(scan_yaml("$miru_config_type_slug: \"\"\n"), "");
+}
+
+TEST(ScanConfigTypeSlug, YamlFallsBack) {
+  for (const std::string& yaml : {
+         "",
+         "type: object\n",
+         "{$miru_config_type_slug: motion}\n",
+         "- $miru_config_type_slug: motion\n",
+         "$miru_config_type_slug:\n  motion\n",
+         "$miru_config_type_slug: |\n  motion\n",
+         "$miru_config_type_slug: mo\n\n  tion\n",
+         "$miru_config_type_slug: [motion]\n",
+         "$miru_config_type_slug: \"mo\n  tion\"\n",
+         "$miru_config_type_slug: *alias\n",
+         "a: 1\n---\n$miru_config_type_slug: motion\n",
+       }) {
+    EXPECT_EQ(scan_yaml(yaml), std::nullopt) << yaml;
+  }
+}
+
+TEST(ConfigInstance, ConfigTypeSlugFallsBackToTheFullParse) {
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-config-type-slug-test";
+  std::filesystem::create_directories(dir);
+  std::filesystem::path json_path = dir / "schema.json";
+  // (repeated keys keep the last value)
+  std::ofstream(json_path) << R"({"$miru_config_type_slug": 1, )"
+                              R"("$miru_config_type_slug": "b"})";
+  EXPECT_EQ(
+    miru::config::read_schema_config_type_slug(miru::filesys::File(json_path)), "b"
+  );
+  std::filesystem::path yaml_path = dir / "schema.yaml";
+  std::ofstream(yaml_path) << "{type: object, $miru_config_type_slug: motion}\n";
+  EXPECT_EQ(
+    miru::config::read_schema_config_type_slug(miru::filesys::File(yaml_path)),
+    "motion"
+  );
+  std::filesystem::remove_all(dir);
+}
+
 }  // namespace test::config
\ No newline at end of file
@@ -0,0 +1,213 @@
+// std
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// internal
+#include <configs/errors.hpp>
+#include <filesys/errors.hpp>
+#include <miru/configs/watch.hpp>
+#include <miru/query/query.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::config {
+
+// ===================================== WATCH ===================================== //
+class Watch : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    write_schema("motion-control");
+    write_instance(15);
+    options.debounce = std::chrono::milliseconds(20);
+    options.on_error = [this](const std::string& error) {
+      std::lock_guard<std::mutex> lock(mutex);
+      errors.push_back(error);
+    };
+  }
+  void TearDown() override { std::filesystem::remove_all(dir); }
+
+  void write_schema(const std::string& slug) {
+    std::ofstream(schema_path) << "{\"$miru_config_type_slug\": \"" << slug << "\"}";
+  }
+
+  void write_instance(int speed) {
+    std::ofstream(instance_path) << "{\"speed\": " << speed << "}";
+  }
+
+  miru::config::ConfigWatcher watch() {
+    return miru::config::ConfigWatcher::from_file(schema_path, instance_path, options);
+  }
+
+  static int speed_of(const miru::config::ConfigInstance& config_instance) {
+    std::string slug = config_instance.root_parameter().get_name();
+    return miru::query::get_param(config_instance, slug + ".speed").as<int>();
+  }
+
+  size_t num_errors() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errors.size();
+  }
+
+  bool wait_for_errors(size_t num) {
+    auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+    while (num_errors() < num) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+  }
+
+  static constexpr std::chrono::milliseconds TIMEOUT = std::chrono::seconds(5);
+
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-watch-test";
+  std::filesystem::path schema_path = dir / "motion-control.schema.json";
+  std::filesystem::path instance_path = dir / "motion-control.json";
+  miru::config::WatchOptions options;
+  std::mutex mutex;
+  std::vector<std::string> errors;
+};
+
+TEST_F(Watch, Initial) {
+  miru::config::ConfigWatcher watcher = watch();
+  EXPECT_EQ(watcher.version(), 0);
+  EXPECT_EQ(speed_of(*watcher.current()), 15);
+  EXPECT_FALSE(watcher.last_error().has_value());
+}
+
+TEST_F(Watch, NotFound) {
+  instance_path = dir / "doesnt-exist.json";
+  EXPECT_THROW(watch(), miru::filesys::FileNotFoundError);
+
+  // the directory of the file must exist to be watched
+  instance_path = dir / "doesnt-exist" / "motion-control.json";
+  EXPECT_THROW(watch(), miru::config::WatchError);
+}
+
+TEST_F(Watch, Write) {
+  miru::config::ConfigWatcher watcher = watch();
+  std::shared_ptr<const miru::config::ConfigInstance> initial = watcher.current();
+
+  write_instance(150);
+  ASSERT_TRUE(watcher.wait_for_version(1, TIMEOUT));
+  EXPECT_EQ(speed_of(*watcher.current()), 150);
+  // config instances already returned are unaffected
+  EXPECT_EQ(speed_of(*initial), 15);
+}
+
+TEST_F(Watch, Schema) {
+  miru::config::ConfigWatcher watcher = watch();
+  write_schema("motion");
+  ASSERT_TRUE(watcher.wait_for_version(1, TIMEOUT));
+  EXPECT_EQ(watcher.current()->root_parameter().get_name(), "motion");
+  EXPECT_EQ(speed_of(*watcher.current()), 15);
+}
+
+TEST_F(Watch, AtomicRename) {
+  miru::config::ConfigWatcher watcher = watch();
+
+  // written to a temporary file which is then renamed over the config instance file
+  std::filesystem::path tmp_path = dir / ".motion-control.json.swp";
+  std::ofstream(tmp_path) << "{\"speed\": 16}";
+  std::filesystem::rename(tmp_path, instance_path);
+  ASSERT_TRUE(watcher.wait_for_version(1, TIMEOUT));
+  EXPECT_EQ(speed_of(*watcher.current()), 16);
+
+  // moved away as a backup before the new version is written
+  std::filesystem::rename(instance_path, dir / "motion-control.json~");
+  write_instance(17);
+  ASSERT_TRUE(watcher.wait_for_version(2, TIMEOUT));
+  EXPECT_EQ(speed_of(*watcher.current()), 17);
+}
+
+TEST_F(Watch, Debounce) {
+  options.debounce = std::chrono::milliseconds(200);
+  miru::config::ConfigWatcher watcher = watch();
+
+  // a burst of writes is reloaded once
+  for (int i = 0; i < 10; i++) {
+    write_instance(100 + i);
+  }
+  ASSERT_TRUE(watcher.wait_for_version(1, TIMEOUT));
+  EXPECT_EQ(speed_of(*watcher.current()), 109);
+  EXPECT_FALSE(watcher.wait_for_version(2, std::chrono::milliseconds(400)));
+}
+
+TEST_F(Watch, OtherFiles) {
+  miru::config::ConfigWatcher watcher = watch();
+  std::ofstream(dir / "other.json") << "{\"speed\": 1}";
+  std::filesystem::remove(dir / "other.json");
+  EXPECT_FALSE(watcher.wait_for_version(1, std::chrono::milliseconds(200)));
+}
+
+TEST_F(Watch, Invalid) {
+  miru::config::ConfigWatcher watcher = watch();
+
+  // the current config instance is kept until the file is valid again
+  std::ofstream(instance_path) << "{\"speed\": ";
+  ASSERT_TRUE(wait_for_errors(1));
+  EXPECT_TRUE(watcher.last_error().has_value());
+  EXPECT_EQ(watcher.version(), 0);
+  EXPECT_EQ(speed_of(*watcher.current()), 15);
+
+  write_instance(20);
+  ASSERT_TRUE(watcher.wait_for_version(1, TIMEOUT));
+  EXPECT_EQ(speed_of(*watcher.current()), 20);
+  EXPECT_FALSE(watcher.last_error().has_value());
+}
+
+TEST_F(Watch, Subscribe) {
+  miru::config::ConfigWatcher watcher = watch();
+  std::mutex speeds_mutex;
+  std::vector<int> speeds;
+  std::atomic<int> num_unsubscribed_calls = 0;
+  watcher.subscribe([&](std::shared_ptr<const miru::config::ConfigInstance> reloaded) {
+    std::lock_guard<std::mutex> lock(speeds_mutex);
+    speeds.push_back(speed_of(*reloaded));
+  });
+  miru::config::ConfigWatcher::SubscriptionId id =
+    watcher.subscribe([&](std::shared_ptr<const miru::config::ConfigInstance>) {
+      num_unsubscribed_calls++;
+    });
+  watcher.unsubscribe(id);
+
+  write_instance(30);
+  ASSERT_TRUE(watcher.wait_for_version(1, TIMEOUT));
+  write_instance(31);
+  ASSERT_TRUE(watcher.wait_for_version(2, TIMEOUT));
+  // a failing subscriber is reported (after the other subscribers were called)
+  watcher.subscribe([](std::shared_ptr<const miru::config::ConfigInstance>) {
+    throw std::runtime_error("subscriber failed");
+  });
+  write_instance(32);
+  ASSERT_TRUE(watcher.wait_for_version(3, TIMEOUT));
+  ASSERT_TRUE(wait_for_errors(1));
+  EXPECT_EQ(watcher.last_error(), "subscriber failed");
+
+  std::lock_guard<std::mutex> lock(speeds_mutex);
+  EXPECT_EQ(speeds, std::vector<int>({30, 31, 32}));
+  EXPECT_EQ(num_unsubscribed_calls, 0);
+}
+
+TEST_F(Watch, Move) {
+  miru::config::ConfigWatcher watcher = watch();
+  miru::config::ConfigWatcher moved = std::move(watcher);
+  write_instance(40);
+  ASSERT_TRUE(moved.wait_for_version(1, TIMEOUT));
+  EXPECT_EQ(speed_of(*moved.current()), 40);
+}
+
+}  // namespace test::config
@@ -1,6 +1,7 @@
 // std
 #include <filesystem>
 #include <string>
+#include <vector>
 
 // internal
 #include <filesys/dir.hpp>
@@ -276,4 +277,31 @@ INSTANTIATE_TEST_SUITE_P(
   GitRepoRootDirTestNameGenerator
 );
 
+// ==================================== files() ==================================== //
+TEST(Files, Files) {
+  std::vector<std::string> names;
+  for (const miru::filesys::File& file :
+       miru::test_utils::config_schemas_testdata_dir().files()) {
+    names.push_back(file.name());
+  }
+  std::vector<std::string> expected = {
+    "empty-config-type-slug.json",
+    "empty-config-type-slug.yaml",
+    "missing-config-type-slug.json",
+    "missing-config-type-slug.yaml",
+    "motion-control.json",
+    "motion-control.yaml",
+  };
+  EXPECT_EQ(names, expected);
+
+  // subdirectories are skipped
+  for (const miru::filesys::File& file :
+       miru::test_utils::testdata_dir().subdir("config").files()) {
+    EXPECT_TRUE(std::filesystem::is_regular_file(file.path()));
+  }
+  EXPECT_THROW(
+    miru::filesys::Dir("doesnt/exist").files(), miru::filesys::DirNotFoundError
+  );
+}
+
 }  // namespace test::filesys
\ No newline at end of file
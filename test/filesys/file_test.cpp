@@ -1,5 +1,7 @@
 // std
 #include <filesystem>
+#include <fstream>
+#include <vector>
 
 // internal
 #include <filesys/errors.hpp>
@@ -79,6 +81,18 @@ INSTANTIATE_TEST_SUITE_P(
       "YAML",
       FileExceptionType::None
     },
+    FileTypeStringConversionTestCase{
+      "MSGPACK",
+      miru::filesys::FileType::MSGPACK,
+      "MSGPACK",
+      FileExceptionType::None
+    },
+    FileTypeStringConversionTestCase{
+      "CBOR",
+      miru::filesys::FileType::CBOR,
+      "CBOR",
+      FileExceptionType::None
+    },
     FileTypeStringConversionTestCase{
       "invalid file type",
       std::nullopt,
@@ -177,6 +191,18 @@ INSTANTIATE_TEST_SUITE_P(
       std::optional<miru::filesys::FileType>(miru::filesys::FileType::YAML),
       FileExceptionType::None
     },
+    FileTypeTestCase{
+      "msgpack file",
+      std::filesystem::path("lebron.msgpack"),
+      std::optional<miru::filesys::FileType>(miru::filesys::FileType::MSGPACK),
+      FileExceptionType::None
+    },
+    FileTypeTestCase{
+      "cbor file",
+      std::filesystem::path("lebron.cbor"),
+      std::optional<miru::filesys::FileType>(miru::filesys::FileType::CBOR),
+      FileExceptionType::None
+    },
     FileTypeTestCase{
       "text file",
       std::filesystem::path("mj.txt"),
@@ -320,6 +346,142 @@ TEST_F(ReadString, ValidString) {
   EXPECT_EQ(json, "some random text that came from ben's brain at 7pm on a Wednesday");
 }
 
+// ================================ read_contents() ================================= //
+class ReadContents : public ::testing::Test {
+ protected:
+  void SetUp() override { std::filesystem::create_directories(dir); }
+  void TearDown() override { std::filesystem::remove_all(dir); }
+
+  miru::filesys::File write(const std::string& name, const std::string& content) {
+    std::ofstream(dir / name, std::ios::binary) << content;
+    return miru::filesys::File(dir / name);
+  }
+
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-read-contents-test";
+  miru::filesys::File doesnt_exist{"doesnt/exist.json"};
+  miru::filesys::File text_file =
+    miru::test_utils::filesys_testdata_dir().file("text.txt");
+};
+
+TEST_F(ReadContents, FileNotFound) {
+  EXPECT_THROW(doesnt_exist.read_contents(), miru::filesys::FileNotFoundError);
+}
+
+TEST_F(ReadContents, NotAFile) {
+  miru::filesys::File directory(miru::test_utils::filesys_testdata_dir().path());
+  EXPECT_THROW(directory.read_contents(), miru::filesys::NotAFileError);
+}
+
+TEST_F(ReadContents, SmallFile) {
+  miru::filesys::FileContents contents = text_file.read_contents();
+  EXPECT_FALSE(contents.mapped());
+  EXPECT_EQ(
+    contents.view(), "some random text that came from ben's brain at 7pm on a Wednesday"
+  );
+  EXPECT_EQ(contents.size(), contents.view().size());
+}
+
+TEST_F(ReadContents, EmptyFile) {
+  miru::filesys::FileContents contents = write("empty.txt", "").read_contents();
+  EXPECT_FALSE(contents.mapped());
+  EXPECT_TRUE(contents.view().empty());
+}
+
+TEST_F(ReadContents, LargeFile) {
+  std::string content(miru::filesys::FileContents::MMAP_THRESHOLD * 3 + 17, 'x');
+  for (size_t i = 0; i < content.size(); i += 97) {
+    content[i] = static_cast<char>('a' + i % 26);
+  }
+  miru::filesys::File file = write("large.txt", content);
+  miru::filesys::FileContents contents = file.map_contents();
+  EXPECT_TRUE(contents.mapped());
+  EXPECT_EQ(contents.view(), content);
+  EXPECT_EQ(file.read_string(), content);
+
+  // moving the contents moves the mapping
+  miru::filesys::FileContents moved = std::move(contents);
+  EXPECT_TRUE(moved.mapped());
+  EXPECT_EQ(moved.view(), content);
+}
+
+TEST_F(ReadContents, LargeFileTruncated) {
+  // large files are only mapped when asked for so a file truncated while its contents
+  // are held can't raise SIGBUS
+  std::string content(miru::filesys::FileContents::MMAP_THRESHOLD * 2, 'x');
+  miru::filesys::File file = write("large.txt", content);
+  miru::filesys::FileContents contents = file.read_contents();
+  EXPECT_FALSE(contents.mapped());
+  std::filesystem::resize_file(file.path(), 0);
+  EXPECT_EQ(contents.view(), content);
+}
+
+TEST_F(ReadContents, PooledBuffers) {
+  // buffers returned to the pool are reused without leaking the previous contents
+  for (const std::string& content : {"a much longer piece of text", "short", ""}) {
+    miru::filesys::FileContents contents = write("text.txt", content).read_contents();
+    EXPECT_EQ(contents.view(), content);
+  }
+}
+
+TEST_F(ReadContents, LargeJsonAndYaml) {
+  nlohmann::json json;
+  for (size_t i = 0; i < 5000; i++) {
+    json["key_" + std::to_string(i)] = i;
+  }
+  std::string dumped = json.dump();
+  ASSERT_GE(dumped.size(), miru::filesys::FileContents::MMAP_THRESHOLD);
+  EXPECT_EQ(write("large.json", dumped).read_json(), json);
+  YAML::Node yaml = write("large.yaml", dumped).read_yaml();
+  EXPECT_EQ(yaml["key_4999"].as<int>(), 4999);
+}
+
+// ================================== LoadedFile =================================== //
+class LoadedFile : public ::testing::Test {
+ protected:
+  miru::filesys::File doesnt_exist{"doesnt/exist.json"};
+  miru::filesys::File text_file =
+    miru::test_utils::filesys_testdata_dir().file("text.txt");
+  miru::filesys::File json_file =
+    miru::test_utils::filesys_testdata_dir().file("valid.json");
+  miru::filesys::File yaml_file =
+    miru::test_utils::filesys_testdata_dir().file("valid.yaml");
+};
+
+TEST_F(LoadedFile, FileNotFound) {
+  EXPECT_THROW(
+    miru::filesys::LoadedFile{doesnt_exist}, miru::filesys::FileNotFoundError
+  );
+}
+
+TEST_F(LoadedFile, InvalidFileType) {
+  EXPECT_THROW(
+    miru::filesys::LoadedFile{text_file}, miru::filesys::InvalidFileTypeError
+  );
+}
+
+TEST_F(LoadedFile, Json) {
+  miru::filesys::LoadedFile loaded(json_file);
+  EXPECT_EQ(loaded.file().path(), json_file.path());
+  EXPECT_EQ(loaded.file_type(), miru::filesys::FileType::JSON);
+  EXPECT_EQ(loaded.bytes(), json_file.read_string());
+
+  // the document is parsed once
+  const auto& document = loaded.document();
+  EXPECT_EQ(&document, &loaded.document());
+  EXPECT_EQ(std::get<nlohmann::json>(document), json_file.read_json());
+}
+
+TEST_F(LoadedFile, Yaml) {
+  miru::filesys::LoadedFile loaded(yaml_file);
+  EXPECT_EQ(loaded.file_type(), miru::filesys::FileType::YAML);
+  EXPECT_EQ(loaded.bytes(), yaml_file.read_string());
+  EXPECT_EQ(
+    std::get<YAML::Node>(loaded.document())["name"].as<std::string>(),
+    "Example Test Data"
+  );
+}
+
 // ================================= read_json() =================================== //
 class ReadJson : public ::testing::Test {
  protected:
@@ -358,6 +520,36 @@ TEST_F(ReadJson, ValidJson) {
   EXPECT_EQ(std::get<nlohmann::json>(structured_data)["name"], "Example Test Data");
 }
 
+TEST_F(ReadJson, BinaryEncodings) {
+  nlohmann::json expected = json_file.read_json();
+  std::filesystem::path dir =
+    std::filesystem::temp_directory_path() / "miru-read-json-test";
+  std::filesystem::create_directories(dir);
+  std::vector<uint8_t> msgpack = nlohmann::json::to_msgpack(expected);
+  std::ofstream(dir / "valid.msgpack", std::ios::binary)
+    .write(reinterpret_cast<const char*>(msgpack.data()), msgpack.size());
+  std::vector<uint8_t> cbor = nlohmann::json::to_cbor(expected);
+  std::ofstream(dir / "valid.cbor", std::ios::binary)
+    .write(reinterpret_cast<const char*>(cbor.data()), cbor.size());
+
+  for (const std::string& file_name : {"valid.msgpack", "valid.cbor"}) {
+    miru::filesys::File file(dir / file_name);
+    EXPECT_EQ(file.read_json(), expected);
+    EXPECT_EQ(std::get<nlohmann::json>(file.read_structured_data()), expected);
+    EXPECT_THROW(file.read_yaml(), miru::filesys::InvalidFileTypeError);
+  }
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(ReadJson, OtherFileType) {
+  // rejected before being read, while a missing file is still reported as missing
+  miru::filesys::File yaml_file =
+    miru::test_utils::filesys_testdata_dir().file("valid.yaml");
+  EXPECT_THROW(yaml_file.read_json(), miru::filesys::InvalidFileTypeError);
+  miru::filesys::File doesnt_exist("doesnt/exist.yaml");
+  EXPECT_THROW(doesnt_exist.read_json(), miru::filesys::FileNotFoundError);
+}
+
 // ================================= read_yaml() =================================== //
 class ReadYaml : public ::testing::Test {
  protected:
@@ -1,9 +1,18 @@
+// std
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
 // internal
 #include <http/models/HashSchemaSerializedRequest.h>
 
+#include <http/encoding.hpp>
+#include <http/errors.hpp>
 #include <http/socket_client.hpp>
 #include <http/socket_session.hpp>
 #include <http/utils.hpp>
+#include <test/http/stand_in_agent.hpp>
 #include <test/test_utils/testdata.hpp>
 
 // external
@@ -43,6 +52,135 @@ TEST(HTTPClient, BuildPostRequest) {
   EXPECT_EQ(req.find(http::field::host)->value(), "localhost");
 }
 
+// ================================ BODY ENCODINGS ================================= //
+TEST(HTTPClient, AcceptHeader) {
+  using BodyEncoding = miru::http::BodyEncoding;
+  EXPECT_EQ(miru::http::accept_header({BodyEncoding::JSON}), "application/json");
+  EXPECT_EQ(
+    miru::http::accept_header(
+      {BodyEncoding::MSGPACK, BodyEncoding::CBOR, BodyEncoding::JSON}
+    ),
+    "application/msgpack, application/cbor;q=0.9, application/json;q=0.8"
+  );
+}
+
+TEST(HTTPClient, ContentTypeToBodyEncoding) {
+  using BodyEncoding = miru::http::BodyEncoding;
+  EXPECT_EQ(
+    miru::http::content_type_to_body_encoding("application/msgpack"),
+    BodyEncoding::MSGPACK
+  );
+  EXPECT_EQ(
+    miru::http::content_type_to_body_encoding("Application/X-MsgPack"),
+    BodyEncoding::MSGPACK
+  );
+  EXPECT_EQ(
+    miru::http::content_type_to_body_encoding("application/cbor; charset=binary"),
+    BodyEncoding::CBOR
+  );
+  EXPECT_EQ(
+    miru::http::content_type_to_body_encoding("application/json"), BodyEncoding::JSON
+  );
+  EXPECT_EQ(miru::http::content_type_to_body_encoding(""), BodyEncoding::JSON);
+  EXPECT_EQ(
+    miru::http::content_type_to_body_encoding("text/plain"), BodyEncoding::JSON
+  );
+}
+
+// ============================= ENCODING NEGOTIATION ============================== //
+class EncodingNegotiation : public ::testing::Test {
+ protected:
+  // responds with the first encoding it supports in the order they're accepted
+  static http::response<http::string_body> respond(
+    const http::request<http::string_body>& req,
+    bool ignore_accept
+  ) {
+    std::string accept(req[http::field::accept]);
+    size_t msgpack = accept.find("application/msgpack");
+    size_t cbor = accept.find("application/cbor");
+    if (ignore_accept || (msgpack != std::string::npos && msgpack < cbor)) {
+      std::vector<uint8_t> body = nlohmann::json::to_msgpack(instance());
+      return make_response(
+        req, std::string(body.begin(), body.end()), "application/msgpack"
+      );
+    }
+    if (cbor != std::string::npos) {
+      std::vector<uint8_t> body = nlohmann::json::to_cbor(instance());
+      return make_response(
+        req, std::string(body.begin(), body.end()), "application/cbor"
+      );
+    }
+    return make_response(req, instance().dump(), "application/json");
+  }
+
+  static nlohmann::json instance() {
+    return {{"id", "cfg_inst_123"}, {"content", {{"speed", 89}, {"gains", {1.5, 2}}}}};
+  }
+
+  std::filesystem::path socket_path =
+    std::filesystem::temp_directory_path() / "miru-encoding-negotiation.sock";
+};
+
+TEST_F(EncodingNegotiation, AcceptedEncodings) {
+  using BodyEncoding = miru::http::BodyEncoding;
+  StandInAgent agent(socket_path, [](const auto& req) { return respond(req, false); });
+  miru::http::UnixSocketClient client(agent.socket_path());
+
+  for (auto [encodings, expected] :
+       std::vector<std::pair<std::vector<BodyEncoding>, BodyEncoding>>{
+         {{BodyEncoding::MSGPACK, BodyEncoding::JSON}, BodyEncoding::MSGPACK},
+         {{BodyEncoding::CBOR, BodyEncoding::MSGPACK}, BodyEncoding::CBOR},
+         {{BodyEncoding::JSON}, BodyEncoding::JSON},
+       }) {
+    miru::http::EncodedBody response =
+      client.get_deployed_config_instance_encoded("sha256:abc", "slug", encodings);
+    EXPECT_EQ(response.encoding, expected);
+    nlohmann::json decoded;
+    switch (response.encoding) {
+      case BodyEncoding::MSGPACK:
+        decoded = nlohmann::json::from_msgpack(response.body);
+        break;
+      case BodyEncoding::CBOR:
+        decoded = nlohmann::json::from_cbor(response.body);
+        break;
+      case BodyEncoding::JSON:
+        decoded = nlohmann::json::parse(response.body);
+        break;
+    }
+    EXPECT_EQ(decoded, instance());
+  }
+  EXPECT_EQ(
+    nlohmann::json::parse(client.get_deployed_config_instance_json("sha256:abc", "slug")
+    ),
+    instance()
+  );
+}
+
+TEST_F(EncodingNegotiation, AgentIgnoresTheAcceptHeader) {
+  StandInAgent agent(socket_path, [](const auto& req) { return respond(req, true); });
+  miru::http::UnixSocketClient client(agent.socket_path());
+  EXPECT_EQ(
+    nlohmann::json::parse(client.get_deployed_config_instance_json("sha256:abc", "slug")
+    ),
+    instance()
+  );
+}
+
+TEST_F(EncodingNegotiation, ErrorResponse) {
+  StandInAgent agent(socket_path, [](const auto& req) {
+    return make_response(
+      req, "{}", "application/json", http::status::internal_server_error
+    );
+  });
+  miru::http::UnixSocketClient client(agent.socket_path());
+  EXPECT_THROW(
+    client.get_deployed_config_instance_encoded(
+      "sha256:abc", "slug", {miru::http::BodyEncoding::MSGPACK}
+    ),
+    miru::http::RequestFailedError
+  );
+}
+
 // =============================== SANDBOX TESTS =================================== //
 TEST(HTTPClient, DISABLED_Sandbox) {
   // test route
@@ -0,0 +1,62 @@
+// internal
+#include "test/http/stand_in_agent.hpp"
+
+// external
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+namespace test::http {
+
+namespace beast = boost::beast;
+using stream_protocol = boost::asio::local::stream_protocol;
+
+StandInAgent::StandInAgent(const std::filesystem::path& socket_path, Handler handler)
+  : socket_path_(socket_path), handler_(std::move(handler)), ioc_(), acceptor_(ioc_) {
+  std::filesystem::remove(socket_path_);
+  stream_protocol::endpoint endpoint(socket_path_.string());
+  acceptor_.open(endpoint.protocol());
+  acceptor_.bind(endpoint);
+  acceptor_.listen();
+  accept();
+  thread_ = std::thread([this]() { ioc_.run(); });
+}
+
+StandInAgent::~StandInAgent() {
+  ioc_.stop();
+  thread_.join();
+  std::filesystem::remove(socket_path_);
+}
+
+void StandInAgent::accept() {
+  acceptor_.async_accept([this](beast::error_code ec, stream_protocol::socket socket) {
+    if (ec) {
+      return;
+    }
+    // the connection is served synchronously since the tests make one request at
+    // a time
+    beast::flat_buffer buffer;
+    http::request<http::string_body> req;
+    http::read(socket, buffer, req, ec);
+    if (!ec) {
+      http::response<http::string_body> res = handler_(req);
+      res.prepare_payload();
+      http::write(socket, res, ec);
+    }
+    socket.shutdown(stream_protocol::socket::shutdown_both, ec);
+    accept();
+  });
+}
+
+http::response<http::string_body> make_response(
+  const http::request<http::string_body>& req,
+  std::string body,
+  const std::string& content_type,
+  http::status status
+) {
+  http::response<http::string_body> res(status, req.version());
+  res.set(http::field::content_type, content_type);
+  res.body() = std::move(body);
+  return res;
+}
+
+}  // namespace test::http
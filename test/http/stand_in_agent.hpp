@@ -0,0 +1,51 @@
+#pragma once
+
+// std
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+
+// external
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+namespace test::http {
+
+namespace http = boost::beast::http;
+
+// A local stand-in for the agent which serves requests on a unix socket with the
+// given handler (one request per connection) until it's destroyed.
+class StandInAgent {
+ public:
+  using Handler = std::function<http::response<http::string_body>(
+    const http::request<http::string_body>&
+  )>;
+
+  StandInAgent(const std::filesystem::path& socket_path, Handler handler);
+  ~StandInAgent();
+
+  StandInAgent(const StandInAgent&) = delete;
+  StandInAgent& operator=(const StandInAgent&) = delete;
+
+  std::string socket_path() const { return socket_path_.string(); }
+
+ private:
+  void accept();
+
+  std::filesystem::path socket_path_;
+  Handler handler_;
+  boost::asio::io_context ioc_;
+  boost::asio::local::stream_protocol::acceptor acceptor_;
+  std::thread thread_;
+};
+
+// a response with the given body and content type
+http::response<http::string_body> make_response(
+  const http::request<http::string_body>& req,
+  std::string body,
+  const std::string& content_type,
+  http::status status = http::status::ok
+);
+
+}  // namespace test::http
@@ -0,0 +1,152 @@
+// std
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// unix
+#include <time.h>
+
+// internal
+#include <miru/parallel/thread_pool.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::parallel {
+
+// ================================= THREAD POOL =================================== //
+TEST(ThreadPool, NumThreads) {
+  miru::parallel::ThreadPool pool(3);
+  EXPECT_EQ(pool.num_threads(), 3);
+  miru::parallel::ThreadPool default_pool;
+  EXPECT_GE(default_pool.num_threads(), 1);
+}
+
+TEST(ThreadPool, RunsSubmittedTasks) {
+  miru::parallel::ThreadPool pool(4);
+  std::atomic<int> count(0);
+  miru::parallel::TaskGroup group(pool);
+  for (int i = 0; i < 1000; i++) {
+    group.run([&count]() { count++; });
+  }
+  group.wait();
+  EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(ThreadPool, Shared) {
+  miru::parallel::ThreadPool& shared = miru::parallel::ThreadPool::shared();
+  EXPECT_EQ(&shared, &miru::parallel::ThreadPool::shared());
+  EXPECT_GE(shared.num_threads(), 1);
+}
+
+// ================================== TASK GROUP =================================== //
+int64_t parallel_sum(
+  miru::parallel::ThreadPool& pool,
+  const std::vector<int64_t>& values,
+  size_t begin,
+  size_t end
+) {
+  if (end - begin <= 16) {
+    return std::accumulate(values.begin() + begin, values.begin() + end, int64_t(0));
+  }
+  size_t middle = begin + (end - begin) / 2;
+  int64_t left = 0;
+  miru::parallel::TaskGroup group(pool);
+  group.run([&]() { left = parallel_sum(pool, values, begin, middle); });
+  int64_t right = parallel_sum(pool, values, middle, end);
+  group.wait();
+  return left + right;
+}
+
+TEST(TaskGroup, Nested) {
+  // nested groups must not deadlock even with a single worker since waiting threads
+  // run pending tasks themselves
+  std::vector<int64_t> values(10000);
+  std::iota(values.begin(), values.end(), 0);
+  for (size_t num_threads : {1, 2, 8}) {
+    miru::parallel::ThreadPool pool(num_threads);
+    EXPECT_EQ(parallel_sum(pool, values, 0, values.size()), 49995000);
+  }
+}
+
+TEST(TaskGroup, RethrowsFirstException) {
+  miru::parallel::ThreadPool pool(2);
+  miru::parallel::TaskGroup group(pool);
+  std::atomic<int> count(0);
+  for (int i = 0; i < 10; i++) {
+    group.run([&count, i]() {
+      count++;
+      if (i == 5) {
+        throw std::runtime_error("task failed");
+      }
+    });
+  }
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  EXPECT_EQ(count.load(), 10);
+
+  // the error is only reported once
+  EXPECT_NO_THROW(group.wait());
+}
+
+TEST(TaskGroup, WaitsOnDestruction) {
+  miru::parallel::ThreadPool pool(2);
+  std::atomic<int> count(0);
+  {
+    miru::parallel::TaskGroup group(pool);
+    for (int i = 0; i < 100; i++) {
+      group.run([&count]() { count++; });
+    }
+  }
+  EXPECT_EQ(count.load(), 100);
+}
+
+TEST(TaskGroup, WaitBlocks) {
+  miru::parallel::ThreadPool pool(1);
+  miru::parallel::TaskGroup group(pool);
+  std::atomic<bool> started(false);
+  group.run([&started]() {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  // the waiting thread has nothing to help with so it sleeps rather than spins
+  timespec before;
+  timespec after;
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &before);
+  group.wait();
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &after);
+  int64_t cpu_ns = (after.tv_sec - before.tv_sec) * 1000000000 +
+                   (after.tv_nsec - before.tv_nsec);
+  EXPECT_LT(cpu_ns, 50 * 1000000);
+}
+
+TEST(TaskGroup, WakesForNewTasks) {
+  // the pool's only thread runs a task which waits on a task it submits, which the
+  // waiting thread must then wake up to run
+  miru::parallel::ThreadPool pool(1);
+  miru::parallel::TaskGroup group(pool);
+  std::atomic<bool> started(false);
+  std::atomic<bool> done(false);
+  group.run([&]() {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    group.run([&done]() { done = true; });
+    while (!done) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  group.wait();
+  EXPECT_TRUE(done);
+}
+
+}  // namespace test::parallel
@@ -58,6 +58,17 @@ TEST_F(MapConstructor, success) {
   EXPECT_EQ(map["field2"].as_string(), "value2");
 }
 
+TEST_F(MapConstructor, moved_fields) {
+  std::vector<miru::params::Parameter> fields = {
+    miru::params::Parameter("field2", miru::params::Scalar("value2")),
+    miru::params::Parameter("field1", miru::params::Scalar("value1")),
+  };
+  miru::params::Map map(std::move(fields));
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map["field1"].as_string(), "value1");
+  EXPECT_EQ(map["field2"].as_string(), "value2");
+}
+
 // ================================ MAP ACCESSOR ================================ //
 class MapAccessor : public ::testing::Test {
  protected:
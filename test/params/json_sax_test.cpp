@@ -0,0 +1,294 @@
+// std
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// internal
+#include <miru/params/composite.hpp>
+#include <miru/params/details/errors.hpp>
+#include <params/errors.hpp>
+#include <params/parse.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+namespace test::params {
+
+using Parameter = miru::params::Parameter;
+
+// the json document parser is the reference for the trees built from SAX events
+void expect_same_as_document(const std::string& json) {
+  Parameter expected =
+    miru::params::parse_json_node("slug", nlohmann::json::parse(json));
+  EXPECT_EQ(miru::params::parse_json_string("slug", json), expected);
+}
+
+// =============================== parse_json_string =============================== //
+class ParseJsonString : public ::testing::Test {};
+
+TEST_F(ParseJsonString, Scalars) {
+  expect_same_as_document("true");
+  expect_same_as_document("42");
+  expect_same_as_document("-42");
+  expect_same_as_document("4.2");
+  expect_same_as_document("\"str\"");
+  expect_same_as_document("null");
+}
+
+TEST_F(ParseJsonString, Arrays) {
+  expect_same_as_document("[true, false]");
+  expect_same_as_document("[1, 2, 3]");
+  expect_same_as_document("[1.5, 2.5]");
+  expect_same_as_document("[\"a\", \"b\"]");
+  expect_same_as_document("[]");
+  expect_same_as_document("[[1, 2], [3.5], []]");
+  expect_same_as_document("[[[1], [2]], [[3]]]");
+  expect_same_as_document("[{\"b\": 1, \"a\": [1]}, {\"c\": {\"d\": \"e\"}}]");
+}
+
+TEST_F(ParseJsonString, MixedNumericArrays) {
+  // the type of the first element decides the type of the array
+  expect_same_as_document("[1, 2.5, 3]");
+  expect_same_as_document("[1.5, 2, 3.5]");
+  Parameter param = miru::params::parse_json_string("slug", "[1, 2.5]");
+  EXPECT_EQ(param.as_integer_array(), std::vector<int64_t>({1, 2}));
+}
+
+TEST_F(ParseJsonString, Maps) {
+  expect_same_as_document("{\"b\": {\"d\": 1, \"c\": [1, 2]}, \"a\": null}");
+  Parameter param = miru::params::parse_json_string("slug", "{\"b\": 1, \"a\": 2}");
+  EXPECT_EQ(param.as_map()["a"].get_name(), "slug.a");
+  EXPECT_EQ(param.as_map()["b"].get_name(), "slug.b");
+}
+
+TEST_F(ParseJsonString, DuplicateKeysKeepTheLastValue) {
+  expect_same_as_document("{\"a\": 1, \"b\": 2, \"a\": [3]}");
+  Parameter param =
+    miru::params::parse_json_string("slug", "{\"a\": 1, \"b\": 2, \"a\": [3]}");
+  EXPECT_EQ(param.as_map().size(), 2);
+  EXPECT_EQ(param.as_map()["a"].as_integer_array(), std::vector<int64_t>({3}));
+}
+
+TEST_F(ParseJsonString, LargeIntegers) {
+  int64_t max = std::numeric_limits<int64_t>::max();
+  Parameter param = miru::params::parse_json_string("slug", std::to_string(max));
+  EXPECT_EQ(param.as_int(), max);
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "18446744073709551615"), std::overflow_error
+  );
+}
+
+TEST_F(ParseJsonString, TestdataFile) {
+  miru::filesys::File file = miru::test_utils::params_testdata_dir().file("load.json");
+  std::ifstream stream(file.path());
+  EXPECT_EQ(
+    miru::params::parse_json_stream("slug", stream),
+    miru::params::parse_json_node("slug", file.read_json())
+  );
+}
+
+TEST_F(ParseJsonString, HeterogeneousArrays) {
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "[1, \"a\"]"), std::runtime_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "[true, 1]"), std::runtime_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "[1, true]"), std::runtime_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "[[1], {\"a\": 1}]"), std::runtime_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "[{\"a\": 1}, 1]"), std::runtime_error
+  );
+}
+
+TEST_F(ParseJsonString, NullInArray) {
+  EXPECT_THROW(miru::params::parse_json_string("slug", "[null]"), std::runtime_error);
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "[1, null]"), std::runtime_error
+  );
+}
+
+TEST_F(ParseJsonString, EmptyMap) {
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "{\"a\": {}}"),
+    miru::params::EmptyInitializationError
+  );
+}
+
+TEST_F(ParseJsonString, Malformed) {
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "{\"a\": 1"), nlohmann::json::parse_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", "[1, 2] 3"), nlohmann::json::parse_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", ""), nlohmann::json::parse_error
+  );
+}
+
+TEST_F(ParseJsonString, MaxDepth) {
+  std::string json = "{\"a\": [{\"b\": [1]}, {\"b\": [2]}]}";
+  EXPECT_NO_THROW(miru::params::parse_json_string("slug", json, 4));
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", json, 3),
+    miru::params::MaxDepthExceededError
+  );
+
+  // the default limit keeps trees shallow enough to destroy (recursively)
+  std::string too_deep = std::string(100000, '[') + std::string(100000, ']');
+  EXPECT_THROW(
+    miru::params::parse_json_string("slug", too_deep),
+    miru::params::MaxDepthExceededError
+  );
+}
+
+// ============================ parse_json_string_field ============================ //
+class ParseJsonStringField : public ::testing::Test {};
+
+TEST_F(ParseJsonStringField, BuildsOnlyTheField) {
+  std::string json =
+    "{\"id\": \"abc\", \"content\": {\"speed\": 1, \"modes\": [{\"a\": [1]}]}, "
+    "\"tags\": [null, 1, \"heterogeneous\"], \"created_at\": null}";
+  EXPECT_EQ(
+    miru::params::parse_json_string_field("slug", json, "content"),
+    miru::params::parse_json_node("slug", nlohmann::json::parse(json)["content"])
+  );
+}
+
+TEST_F(ParseJsonStringField, ScalarField) {
+  Parameter param =
+    miru::params::parse_json_string_field("slug", "{\"a\": [1], \"b\": 2}", "b");
+  EXPECT_EQ(param.get_name(), "slug");
+  EXPECT_EQ(param.as_int(), 2);
+}
+
+TEST_F(ParseJsonStringField, MissingField) {
+  std::string json = "{\"a\": {\"content\": 1}}";
+  EXPECT_THROW(
+    miru::params::parse_json_string_field("slug", json, "content"), std::runtime_error
+  );
+}
+
+TEST_F(ParseJsonStringField, MaxDepth) {
+  // only the depth of the field counts
+  std::string json = "{\"a\": {\"b\": {\"c\": 1}}, \"content\": [1]}";
+  EXPECT_NO_THROW(miru::params::parse_json_string_field("slug", json, "content", 1));
+  EXPECT_THROW(
+    miru::params::parse_json_string_field("slug", json, "content", 0),
+    miru::params::MaxDepthExceededError
+  );
+}
+
+TEST_F(ParseJsonStringField, NotAnObject) {
+  EXPECT_THROW(
+    miru::params::parse_json_string_field("slug", "[1, 2]", "content"),
+    std::runtime_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_string_field("slug", "1", "content"), std::runtime_error
+  );
+}
+
+TEST_F(ParseJsonStringField, MalformedAfterField) {
+  std::string json = "{\"content\": 1, \"b\": ";
+  EXPECT_THROW(
+    miru::params::parse_json_string_field("slug", json, "content"),
+    nlohmann::json::parse_error
+  );
+}
+
+// ======================= parse_msgpack_* / parse_cbor_* ========================== //
+std::string to_msgpack(const nlohmann::json& json) {
+  std::vector<uint8_t> bytes = nlohmann::json::to_msgpack(json);
+  return std::string(bytes.begin(), bytes.end());
+}
+
+std::string to_cbor(const nlohmann::json& json) {
+  std::vector<uint8_t> bytes = nlohmann::json::to_cbor(json);
+  return std::string(bytes.begin(), bytes.end());
+}
+
+class ParseBinaryString : public ::testing::Test {};
+
+TEST_F(ParseBinaryString, SameAsTheJsonText) {
+  std::string json =
+    miru::test_utils::params_testdata_dir().file("load.json").read_string();
+  nlohmann::json document = nlohmann::json::parse(json);
+  Parameter expected = miru::params::parse_json_string("slug", json);
+  EXPECT_EQ(miru::params::parse_msgpack_string("slug", to_msgpack(document)), expected);
+  EXPECT_EQ(miru::params::parse_cbor_string("slug", to_cbor(document)), expected);
+
+  std::istringstream msgpack_stream(to_msgpack(document));
+  EXPECT_EQ(miru::params::parse_msgpack_stream("slug", msgpack_stream), expected);
+  std::istringstream cbor_stream(to_cbor(document));
+  EXPECT_EQ(miru::params::parse_cbor_stream("slug", cbor_stream), expected);
+}
+
+TEST_F(ParseBinaryString, Numbers) {
+  // the binary encodings pick the smallest integer / float types for the values
+  nlohmann::json document = {
+    {"small", 1},
+    {"negative", -70000},
+    {"large", std::numeric_limits<int64_t>::max()},
+    {"float", 1.5},
+    {"doubles", {0.1, 2.5e300}},
+  };
+  Parameter expected = miru::params::parse_json_string("slug", document.dump());
+  EXPECT_EQ(miru::params::parse_msgpack_string("slug", to_msgpack(document)), expected);
+  EXPECT_EQ(miru::params::parse_cbor_string("slug", to_cbor(document)), expected);
+
+  document = {{"too_large", std::numeric_limits<uint64_t>::max()}};
+  EXPECT_THROW(
+    miru::params::parse_msgpack_string("slug", to_msgpack(document)),
+    std::overflow_error
+  );
+}
+
+TEST_F(ParseBinaryString, Field) {
+  nlohmann::json document = {
+    {"id", "abc"},
+    {"content", {{"speed", 1}, {"modes", {{{"a", {1}}}}}}},
+    {"tags", {nullptr, 1, "heterogeneous"}},
+  };
+  Parameter expected = miru::params::parse_json_node("slug", document["content"]);
+  EXPECT_EQ(
+    miru::params::parse_msgpack_string_field("slug", to_msgpack(document), "content"),
+    expected
+  );
+  EXPECT_EQ(
+    miru::params::parse_cbor_string_field("slug", to_cbor(document), "content"),
+    expected
+  );
+  EXPECT_THROW(
+    miru::params::parse_msgpack_string_field("slug", to_msgpack(document), "other"),
+    std::runtime_error
+  );
+}
+
+TEST_F(ParseBinaryString, Malformed) {
+  std::string msgpack = to_msgpack({{"a", {1, 2, 3}}});
+  EXPECT_THROW(
+    miru::params::parse_msgpack_string("slug", msgpack.substr(0, msgpack.size() - 1)),
+    nlohmann::json::parse_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_msgpack_string("slug", msgpack + "x"),
+    nlohmann::json::parse_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_cbor_string("slug", to_msgpack({{"a", 1}})), std::exception
+  );
+}
+
+}  // namespace test::params
@@ -0,0 +1,165 @@
+// std
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// internal
+#include <miru/params/lazy.hpp>
+#include <miru/query/query.hpp>
+#include <params/parse.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+namespace test::params {
+
+using LazyParameterTree = miru::params::LazyParameterTree;
+using Parameter = miru::params::Parameter;
+
+const std::string LAZY_JSON = R"({
+  "speed": 15,
+  "name": "rover }{][",
+  "features": {"spin": true, "jump": false},
+  "empty": [],
+  "scalars": [1, 2, 3],
+  "waypoints": [
+    {"x": 1.5, "y": [1, 2], "tags": ["a", "b"]},
+    {"x": 2.5, "y": [3, 4], "tags": []}
+  ],
+  "grid": [[[1, 2], [3]], [[4]]],
+  "nothing": null
+})";
+
+// =============================== LAZY PARAMETER TREE ============================= //
+class LazyParameterTreeTest : public ::testing::Test {
+ protected:
+  LazyParameterTree lazy = LazyParameterTree("slug", LAZY_JSON);
+  Parameter eager = miru::params::parse_json_string("slug", LAZY_JSON);
+};
+
+TEST_F(LazyParameterTreeTest, IndexesContainers) {
+  EXPECT_EQ(lazy.num_containers(), 17);
+  EXPECT_EQ(lazy.num_materialized(), 0);
+}
+
+TEST_F(LazyParameterTreeTest, MatchesTheEagerTree) {
+  miru::query::SearchParamFilters all;
+  all.leaves_only = false;
+  std::vector<Parameter> params = miru::query::get_params(eager, all);
+  ASSERT_EQ(params.size(), 19);
+  for (const Parameter& param : params) {
+    const Parameter* found = lazy.find(param.get_name());
+    ASSERT_NE(found, nullptr) << param.get_name();
+    EXPECT_EQ(*found, param) << param.get_name();
+  }
+  // (queries treat nested arrays as leaves)
+  EXPECT_EQ(
+    *lazy.find("slug.grid.0.1"), Parameter("slug.grid.0.1", std::vector<int64_t>({3}))
+  );
+  EXPECT_EQ(lazy.root(), eager);
+}
+
+TEST_F(LazyParameterTreeTest, BuildsOnlyWhatIsLookedUp) {
+  const Parameter* x = lazy.find("slug.waypoints.1.x");
+  ASSERT_NE(x, nullptr);
+  EXPECT_EQ(x->as_double(), 2.5);
+  EXPECT_EQ(lazy.num_materialized(), 1);
+
+  // repeated lookups return the same parameter
+  EXPECT_EQ(lazy.find("slug.waypoints.1.x"), x);
+  EXPECT_EQ(lazy.num_materialized(), 1);
+
+  const Parameter* waypoint = lazy.find("slug.waypoints.1");
+  ASSERT_NE(waypoint, nullptr);
+  EXPECT_EQ(waypoint->as_map()["x"].as_double(), 2.5);
+  EXPECT_EQ(lazy.num_materialized(), 2);
+}
+
+TEST_F(LazyParameterTreeTest, MissingParameters) {
+  EXPECT_EQ(lazy.find("other"), nullptr);
+  EXPECT_EQ(lazy.find("slug."), nullptr);
+  EXPECT_EQ(lazy.find("slugs.speed"), nullptr);
+  EXPECT_EQ(lazy.find("slug.doesnt_exist"), nullptr);
+  EXPECT_EQ(lazy.find("slug.speed.x"), nullptr);
+  EXPECT_EQ(lazy.find("slug.waypoints.2"), nullptr);
+  EXPECT_EQ(lazy.find("slug.waypoints.01"), nullptr);
+  EXPECT_EQ(lazy.find("slug.waypoints.x"), nullptr);
+  EXPECT_EQ(lazy.find("slug.waypoints.0.tags.0"), nullptr);
+  EXPECT_EQ(lazy.find("slug.scalars.0"), nullptr);
+  EXPECT_EQ(lazy.find("slug.empty.0"), nullptr);
+  EXPECT_EQ(lazy.find("slug.grid.0.0.0"), nullptr);
+  EXPECT_EQ(lazy.num_materialized(), 0);
+}
+
+TEST_F(LazyParameterTreeTest, ConcurrentLookups) {
+  std::vector<std::thread> threads;
+  std::vector<const Parameter*> found(8, nullptr);
+  for (size_t i = 0; i < found.size(); i++) {
+    threads.emplace_back([&, i]() { found[i] = lazy.find("slug.features"); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const Parameter* param : found) {
+    EXPECT_EQ(param, found[0]);
+  }
+  EXPECT_EQ(lazy.num_materialized(), 1);
+}
+
+TEST(LazyParameterTree, DuplicateKeysKeepTheLastValue) {
+  LazyParameterTree lazy("slug", R"({"a": 1, "b": {"c": 2}, "a": {"d": 3}})");
+  EXPECT_EQ(lazy.find("slug.a.d")->as_int(), 3);
+  EXPECT_EQ(
+    lazy.root(),
+    miru::params::parse_json_string("slug", R"({"a": {"d": 3}, "b": {"c": 2}})")
+  );
+}
+
+TEST(LazyParameterTree, EscapedKeys) {
+  LazyParameterTree lazy("slug", R"({"a\"b": {"c\\d": "e\"}"}})");
+  EXPECT_EQ(lazy.find("slug.a\"b.c\\d")->as_string(), "e\"}");
+}
+
+TEST(LazyParameterTree, ScalarDocument) {
+  LazyParameterTree lazy("slug", " 42 ");
+  EXPECT_EQ(lazy.root().as_int(), 42);
+  EXPECT_EQ(lazy.find("slug.a"), nullptr);
+}
+
+TEST(LazyParameterTree, Field) {
+  std::string json = R"({"id": "abc", "content": {"speed": 15}, "tags": [null, 1]})";
+  LazyParameterTree lazy("slug", json, "content");
+  EXPECT_EQ(lazy.find("slug.speed")->as_int(), 15);
+  EXPECT_EQ(
+    lazy.root(), miru::params::parse_json_string_field("slug", json, "content")
+  );
+
+  EXPECT_THROW(LazyParameterTree("slug", json, "doesnt_exist"), std::runtime_error);
+  EXPECT_THROW(LazyParameterTree("slug", "[1]", "content"), std::runtime_error);
+}
+
+TEST(LazyParameterTree, MalformedStructure) {
+  EXPECT_THROW(LazyParameterTree("slug", ""), std::runtime_error);
+  EXPECT_THROW(LazyParameterTree("slug", "{\"a\": [1}"), std::runtime_error);
+  EXPECT_THROW(LazyParameterTree("slug", "{\"a\": 1"), std::runtime_error);
+  EXPECT_THROW(LazyParameterTree("slug", "{\"a\": \"1}"), std::runtime_error);
+  EXPECT_THROW(LazyParameterTree("slug", "{\"a\": 1} 2"), std::runtime_error);
+}
+
+TEST(LazyParameterTree, ErrorsAreReportedWhenLookedUp) {
+  LazyParameterTree lazy(
+    "slug", R"({"a": {"b": tru}, "c": 1, "d": [{"e": 1}, [2]], "f": {}})"
+  );
+  EXPECT_EQ(lazy.find("slug.c")->as_int(), 1);
+  EXPECT_THROW(lazy.find("slug.a.b"), nlohmann::json::parse_error);
+  EXPECT_THROW(lazy.find("slug.a"), nlohmann::json::parse_error);
+  EXPECT_THROW(lazy.find("slug.d.1"), std::runtime_error);
+  EXPECT_THROW(lazy.find("slug.d"), std::runtime_error);
+  EXPECT_THROW(lazy.find("slug.f"), std::invalid_argument);
+  EXPECT_THROW(lazy.root(), nlohmann::json::parse_error);
+}
+
+}  // namespace test::params
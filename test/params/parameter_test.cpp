@@ -2324,4 +2324,52 @@ TEST_F(ParameterValidTypeConversions, map_array_type_conversion_success) {
   }
 }
 
-}  // namespace test::params
\ No newline at end of file
+// ================================ SUBTREE TYPES ================================== //
+TEST(ParameterSubtreeTypes, Leaf) {
+  miru::params::Parameter param("test", miru::params::Scalar("value"));
+  EXPECT_EQ(
+    param.get_subtree_types(),
+    miru::params::type_mask(miru::params::ParameterType::PARAMETER_SCALAR)
+  );
+  EXPECT_EQ(
+    miru::params::Parameter().get_subtree_types(),
+    miru::params::type_mask(miru::params::ParameterType::PARAMETER_NOT_SET)
+  );
+}
+
+TEST(ParameterSubtreeTypes, Nested) {
+  miru::params::Parameter map_array(
+    "maps",
+    miru::params::MapArray{std::vector<miru::params::Parameter>{miru::params::Parameter(
+      "maps.0",
+      miru::params::Map{std::vector<miru::params::Parameter>{
+        miru::params::Parameter("maps.0.flag", true),
+        miru::params::Parameter("maps.0.gains", std::vector<double>{1.0, 2.0})
+      }}
+    )}}
+  );
+  miru::params::ParameterTypeMask types = map_array.get_subtree_types();
+  EXPECT_TRUE(miru::params::contains_type(types, miru::params::PARAMETER_MAP_ARRAY));
+  EXPECT_TRUE(miru::params::contains_type(types, miru::params::PARAMETER_MAP));
+  EXPECT_TRUE(miru::params::contains_type(types, miru::params::PARAMETER_BOOL));
+  EXPECT_TRUE(miru::params::contains_type(types, miru::params::PARAMETER_DOUBLE_ARRAY));
+  EXPECT_FALSE(miru::params::contains_type(types, miru::params::PARAMETER_STRING));
+  EXPECT_FALSE(miru::params::contains_type(types, miru::params::PARAMETER_SCALAR));
+}
+
+TEST(ParameterTypeMask, RoundTrip) {
+  for (miru::params::ParameterType type :
+       {miru::params::PARAMETER_NOT_SET,
+        miru::params::PARAMETER_STRING_ARRAY,
+        miru::params::PARAMETER_NULL,
+        miru::params::PARAMETER_MAP_ARRAY}) {
+    EXPECT_EQ(
+      miru::params::type_from_mask_bit(miru::params::type_mask_bit(type)), type
+    );
+  }
+  static_assert(
+    miru::params::type_mask(miru::params::PARAMETER_NULL) == (uint32_t(1) << 16)
+  );
+}
+
+}  // namespace test::params
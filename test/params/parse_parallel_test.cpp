@@ -0,0 +1,226 @@
+// std
+#include <stdexcept>
+#include <string>
+
+// internal
+#include <miru/parallel/thread_pool.hpp>
+#include <miru/params/parallel.hpp>
+#include <params/errors.hpp>
+#include <params/parse.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+#include <yaml-cpp/yaml.h>
+
+#include <nlohmann/json.hpp>
+
+namespace test::params {
+
+using ParallelParseOptions = miru::params::ParallelParseOptions;
+using Parameter = miru::params::Parameter;
+
+// a map of maps, arrays of maps and nested arrays which are each wide enough to be
+// split across the pool
+nlohmann::json wide_json(size_t width) {
+  nlohmann::json json = nlohmann::json::object();
+  for (size_t i = 0; i < width; i++) {
+    nlohmann::json group = nlohmann::json::object();
+    group["speed"] = i;
+    group["gain"] = i / 2.0;
+    group["label"] = "group " + std::to_string(i);
+    group["tags"] = {"a", "b"};
+    json["group_" + std::to_string(i)] = group;
+  }
+  nlohmann::json waypoints = nlohmann::json::array();
+  nlohmann::json grid = nlohmann::json::array();
+  for (size_t i = 0; i < width; i++) {
+    waypoints.push_back({{"x", i}, {"y", {i, i + 1}}});
+    grid.push_back({{i}, {i, i + 1}, nlohmann::json::array()});
+  }
+  json["waypoints"] = waypoints;
+  json["grid"] = grid;
+  return json;
+}
+
+// options which split every node with children into chunks of a single child
+ParallelParseOptions split_everything(miru::parallel::ThreadPool& pool) {
+  ParallelParseOptions options;
+  options.pool = &pool;
+  options.min_parallel_children = 2;
+  options.chunk_size = 1;
+  return options;
+}
+
+// =========================== parse_json_node (parallel) ========================== //
+class ParseJsonNodeParallel : public ::testing::Test {
+ protected:
+  miru::parallel::ThreadPool pool = miru::parallel::ThreadPool(4);
+};
+
+TEST_F(ParseJsonNodeParallel, MatchesTheSerialParse) {
+  nlohmann::json json = wide_json(1000);
+  Parameter expected = miru::params::parse_json_node("slug", json);
+
+  ParallelParseOptions options;
+  options.pool = &pool;
+  EXPECT_EQ(miru::params::parse_json_node("slug", json, options), expected);
+  EXPECT_EQ(
+    miru::params::parse_json_node("slug", json, split_everything(pool)), expected
+  );
+  // the shared pool by default
+  EXPECT_EQ(
+    miru::params::parse_json_node("slug", json, ParallelParseOptions()), expected
+  );
+}
+
+TEST_F(ParseJsonNodeParallel, TestdataFile) {
+  nlohmann::json json =
+    miru::test_utils::params_testdata_dir().file("load.json").read_json();
+  EXPECT_EQ(
+    miru::params::parse_json_node("slug", json, split_everything(pool)),
+    miru::params::parse_json_node("slug", json)
+  );
+}
+
+TEST_F(ParseJsonNodeParallel, Scalars) {
+  for (const auto& json : {
+         nlohmann::json(nullptr),
+         nlohmann::json(true),
+         nlohmann::json(42),
+         nlohmann::json("str"),
+         nlohmann::json::array(),
+         nlohmann::json::array({1, 2}),
+       }) {
+    EXPECT_EQ(
+      miru::params::parse_json_node("slug", json, split_everything(pool)),
+      miru::params::parse_json_node("slug", json)
+    );
+  }
+}
+
+TEST_F(ParseJsonNodeParallel, LargeIntegers) {
+  // integers beyond 32 bits are kept like the SAX parse does
+  std::string json_str =
+    "{\"v\": 5000000000, \"vs\": [5000000000, -5000000000], "
+    "\"maps\": [{\"v\": 9223372036854775807}, {\"v\": -2147483649}]}";
+  nlohmann::json json = nlohmann::json::parse(json_str);
+  Parameter expected = miru::params::parse_json_string("slug", json_str);
+  Parameter parsed =
+    miru::params::parse_json_node("slug", json, split_everything(pool));
+  EXPECT_EQ(parsed, expected);
+  EXPECT_EQ(parsed.as_map()["v"].as<int64_t>(), 5000000000);
+  EXPECT_EQ(miru::params::parse_json_node("slug", json), expected);
+
+  // unsigned integers must fit in a signed 64 bit integer
+  json = nlohmann::json::parse("{\"v\": 9223372036854775808}");
+  EXPECT_THROW(
+    miru::params::parse_json_node("slug", json, split_everything(pool)),
+    std::overflow_error
+  );
+  json = nlohmann::json::parse("{\"vs\": [1, 18446744073709551615]}");
+  EXPECT_THROW(miru::params::parse_json_node("slug", json), std::overflow_error);
+}
+
+TEST_F(ParseJsonNodeParallel, Errors) {
+  nlohmann::json json = wide_json(100);
+  json["waypoints"].push_back({1, 2});
+  EXPECT_THROW(
+    miru::params::parse_json_node("slug", json, split_everything(pool)),
+    std::runtime_error
+  );
+
+  json = wide_json(100);
+  json["group_42"]["tags"] = {nullptr, "a"};
+  EXPECT_THROW(
+    miru::params::parse_json_node("slug", json, split_everything(pool)),
+    std::runtime_error
+  );
+}
+
+TEST_F(ParseJsonNodeParallel, MaxDepth) {
+  nlohmann::json json = wide_json(100);
+  json["group_42"]["deep"] = {{"a", {{"b", nlohmann::json::array({1})}}}};
+  // group_42.deep.a.b is nested in 5 maps / arrays
+  ParallelParseOptions options = split_everything(pool);
+  options.max_depth = 5;
+  EXPECT_NO_THROW(miru::params::parse_json_node("slug", json, options));
+  options.max_depth = 4;
+  EXPECT_THROW(
+    miru::params::parse_json_node("slug", json, options),
+    miru::params::MaxDepthExceededError
+  );
+  // also when the nested subtree isn't split
+  options.min_parallel_children = ParallelParseOptions::DEFAULT_MIN_PARALLEL_CHILDREN;
+  EXPECT_THROW(
+    miru::params::parse_json_node("slug", json, options),
+    miru::params::MaxDepthExceededError
+  );
+}
+
+// =========================== parse_yaml_node (parallel) ========================== //
+class ParseYamlNodeParallel : public ::testing::Test {
+ protected:
+  miru::parallel::ThreadPool pool = miru::parallel::ThreadPool(4);
+};
+
+TEST_F(ParseYamlNodeParallel, MatchesTheSerialParse) {
+  // json is valid yaml
+  YAML::Node yaml = YAML::Load(wide_json(1000).dump());
+  Parameter expected = miru::params::parse_yaml_node("slug", yaml);
+
+  ParallelParseOptions options;
+  options.pool = &pool;
+  EXPECT_EQ(miru::params::parse_yaml_node("slug", yaml, options), expected);
+  EXPECT_EQ(
+    miru::params::parse_yaml_node("slug", yaml, split_everything(pool)), expected
+  );
+}
+
+TEST_F(ParseYamlNodeParallel, TestdataFile) {
+  YAML::Node yaml =
+    miru::test_utils::params_testdata_dir().file("load.yaml").read_yaml();
+  EXPECT_EQ(
+    miru::params::parse_yaml_node("slug", yaml, split_everything(pool)),
+    miru::params::parse_yaml_node("slug", yaml)
+  );
+}
+
+TEST_F(ParseYamlNodeParallel, MaxDepth) {
+  YAML::Node yaml = YAML::Load("a: {b: [{c: [1]}, {c: [2]}]}\nd: 1\n");
+  ParallelParseOptions options = split_everything(pool);
+  options.max_depth = 5;
+  EXPECT_NO_THROW(miru::params::parse_yaml_node("slug", yaml, options));
+  options.max_depth = 4;
+  EXPECT_THROW(
+    miru::params::parse_yaml_node("slug", yaml, options),
+    miru::params::MaxDepthExceededError
+  );
+}
+
+TEST_F(ParseYamlNodeParallel, Errors) {
+  YAML::Node yaml = YAML::Load("a: {b: [[1], {c: 1}]}\nd: 1\n");
+  EXPECT_THROW(
+    miru::params::parse_yaml_node("slug", yaml, split_everything(pool)),
+    std::runtime_error
+  );
+  yaml = YAML::Load("a: [~, 1]\nd: 1\n");
+  EXPECT_THROW(
+    miru::params::parse_yaml_node("slug", yaml, split_everything(pool)),
+    std::runtime_error
+  );
+}
+
+// ============================== parse_file (parallel) ============================ //
+TEST(ParseFileParallel, MatchesTheSerialParse) {
+  miru::parallel::ThreadPool pool(2);
+  for (const std::string& file_name : {"load.json", "load.yaml"}) {
+    miru::filesys::File file = miru::test_utils::params_testdata_dir().file(file_name);
+    EXPECT_EQ(
+      miru::params::parse_file("slug", file, split_everything(pool)),
+      miru::params::parse_file("slug", file)
+    );
+  }
+}
+
+}  // namespace test::params
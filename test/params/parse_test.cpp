@@ -1,7 +1,10 @@
 // std
 #include <execinfo.h>
 
+#include <string>
+
 // internal
+#include <params/errors.hpp>
 #include <params/parse.hpp>
 #include <test/test_utils/testdata.hpp>
 #include <test/test_utils/utils.hpp>
@@ -19,6 +22,28 @@ enum class LoaderExceptionType {
 
 using Scalar = miru::params::Scalar;
 
+// a document of depth nested maps (or arrays) around a value
+std::string nested_document(size_t depth, bool maps) {
+  std::string document;
+  for (size_t i = 0; i < depth; i++) {
+    document += maps ? "{\"a\": " : "[";
+  }
+  document += maps ? "1" : "[1]";
+  for (size_t i = 0; i < depth; i++) {
+    document += maps ? "}" : "]";
+  }
+  return document;
+}
+
+// the name of the innermost value of a nested_document() of nested maps
+std::string nested_name(const std::string& root_name, size_t depth) {
+  std::string name = root_name;
+  for (size_t i = 0; i < depth; i++) {
+    name += ".a";
+  }
+  return name;
+}
+
 // ================================ parse_json_node ================================ //
 class ParseJsonNode : public ::testing::Test {
  protected:
@@ -227,6 +252,44 @@ TEST_F(ParseJsonNode, ValidMapArray) {
   );
 }
 
+TEST_F(ParseJsonNode, DeepDocuments) {
+  // (deep enough to need a lot of stack for a recursive parse)
+  size_t depth = 10000;
+  nlohmann::json json = nlohmann::json::parse(nested_document(depth, true));
+  auto param = miru::params::parse_json_node("test", json, depth);
+  const miru::params::Parameter* leaf = &param;
+  for (size_t i = 0; i < depth; i++) {
+    leaf = &leaf->as_map()["a"];
+  }
+  EXPECT_EQ(leaf->get_name(), nested_name("test", depth));
+  EXPECT_EQ(leaf->as_int(), 1);
+}
+
+TEST_F(ParseJsonNode, MaxDepth) {
+  // the innermost scalar array counts as a level
+  nlohmann::json arrays = nlohmann::json::parse(nested_document(9, false));
+  EXPECT_NO_THROW(miru::params::parse_json_node("test", arrays, 10));
+  EXPECT_THROW(
+    miru::params::parse_json_node("test", arrays, 9),
+    miru::params::MaxDepthExceededError
+  );
+
+  nlohmann::json maps = nlohmann::json::parse(nested_document(10, true));
+  EXPECT_NO_THROW(miru::params::parse_json_node("test", maps, 10));
+  EXPECT_THROW(
+    miru::params::parse_json_node("test", maps, 9),
+    miru::params::MaxDepthExceededError
+  );
+
+  nlohmann::json too_deep = nlohmann::json::parse(
+    nested_document(miru::params::DEFAULT_MAX_DEPTH + 1, true)
+  );
+  EXPECT_THROW(
+    miru::params::parse_json_node("test", too_deep),
+    miru::params::MaxDepthExceededError
+  );
+}
+
 // ================================== load_yaml ==================================== //
 class ParseYamlNode : public ::testing::Test {
  protected:
@@ -453,4 +516,33 @@ TEST_F(ParseYamlNode, ValidMapArray) {
   );
 }
 
-}  // namespace test::params
\ No newline at end of file
+TEST_F(ParseYamlNode, DeepDocuments) {
+  // (yaml-cpp refuses to load documents much deeper than this itself)
+  size_t depth = 400;
+  YAML::Node yaml = YAML::Load(nested_document(depth, true));
+  auto param = miru::params::parse_yaml_node("test", yaml, depth);
+  const miru::params::Parameter* leaf = &param;
+  for (size_t i = 0; i < depth; i++) {
+    leaf = &leaf->as_map()["a"];
+  }
+  EXPECT_EQ(leaf->get_name(), nested_name("test", depth));
+  EXPECT_EQ(leaf->as_scalar(), Scalar("1"));
+}
+
+TEST_F(ParseYamlNode, MaxDepth) {
+  YAML::Node arrays = YAML::Load(nested_document(9, false));
+  EXPECT_NO_THROW(miru::params::parse_yaml_node("test", arrays, 10));
+  EXPECT_THROW(
+    miru::params::parse_yaml_node("test", arrays, 9),
+    miru::params::MaxDepthExceededError
+  );
+
+  YAML::Node maps = YAML::Load(nested_document(10, true));
+  EXPECT_NO_THROW(miru::params::parse_yaml_node("test", maps, 10));
+  EXPECT_THROW(
+    miru::params::parse_yaml_node("test", maps, 9),
+    miru::params::MaxDepthExceededError
+  );
+}
+
+}  // namespace test::params
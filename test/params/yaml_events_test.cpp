@@ -0,0 +1,140 @@
+// std
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+// internal
+#include <miru/params/composite.hpp>
+#include <params/errors.hpp>
+#include <params/parse.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+#include <yaml-cpp/yaml.h>
+
+namespace test::params {
+
+using Parameter = miru::params::Parameter;
+using Scalar = miru::params::Scalar;
+
+// the loaded yaml node is the reference for the trees built from parser events
+void expect_same_as_node(const std::string& yaml) {
+  Parameter expected = miru::params::parse_yaml_node("slug", YAML::Load(yaml));
+  EXPECT_EQ(miru::params::parse_yaml_string("slug", yaml), expected);
+}
+
+// =============================== parse_yaml_string =============================== //
+class ParseYamlString : public ::testing::Test {};
+
+TEST_F(ParseYamlString, Scalars) {
+  expect_same_as_node("true");
+  expect_same_as_node("42");
+  expect_same_as_node("4.2");
+  expect_same_as_node("str");
+  expect_same_as_node("'quoted str'");
+  expect_same_as_node("!!str 42");
+  expect_same_as_node("~");
+  expect_same_as_node("null");
+}
+
+TEST_F(ParseYamlString, EmptyDocument) {
+  expect_same_as_node("");
+  expect_same_as_node("# only a comment");
+  EXPECT_TRUE(miru::params::parse_yaml_string("slug", "").is_null());
+}
+
+TEST_F(ParseYamlString, OnlyTheFirstDocument) {
+  expect_same_as_node("a: 1\n---\nb: 2\n");
+}
+
+TEST_F(ParseYamlString, Sequences) {
+  expect_same_as_node("[1, 2, 3]");
+  expect_same_as_node("- a\n- b\n");
+  expect_same_as_node("[]");
+  expect_same_as_node("[[1, 2], [3], []]");
+  expect_same_as_node("[[[1], [2]], [[3]]]");
+  expect_same_as_node("- b: 1\n  a: [1]\n- c:\n    d: e\n");
+}
+
+TEST_F(ParseYamlString, Maps) {
+  expect_same_as_node("b:\n  d: 1\n  c: [1, 2]\na: ~\n");
+  expect_same_as_node("{b: 1, a: {c: 2}}");
+  Parameter param = miru::params::parse_yaml_string("slug", "b: 1\na: 2\n");
+  EXPECT_EQ(param.as_map()["a"].get_name(), "slug.a");
+  EXPECT_EQ(param.as_map()["a"].as_scalar(), Scalar("2"));
+}
+
+TEST_F(ParseYamlString, NullKeysAndElements) {
+  expect_same_as_node("~: 1\n");
+  expect_same_as_node("[a, ~]");
+  expect_same_as_node("- a\n-\n");
+  EXPECT_THROW(miru::params::parse_yaml_string("slug", "[~, a]"), std::runtime_error);
+}
+
+TEST_F(ParseYamlString, Aliases) {
+  expect_same_as_node("a: &x 1\nb: *x\n");
+  expect_same_as_node("a: &x {c: [1, 2]}\nb: *x\n");
+  expect_same_as_node("a: &x [&y {c: 1}, {c: 2}]\nb: *y\nc: *x\n");
+  expect_same_as_node("a: &x key\n*x : 1\n");
+  expect_same_as_node("a: &x ~\nb: *x\n");
+  expect_same_as_node("a: &x\n  b: &y [1]\n  c: *y\nd: *x\n");
+}
+
+TEST_F(ParseYamlString, TestdataFile) {
+  miru::filesys::File file = miru::test_utils::params_testdata_dir().file("load.yaml");
+  std::ifstream stream(file.path());
+  EXPECT_EQ(
+    miru::params::parse_yaml_stream("slug", stream),
+    miru::params::parse_yaml_node("slug", file.read_yaml())
+  );
+}
+
+TEST_F(ParseYamlString, DuplicateKeys) {
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", "a: 1\nb: 2\na: 3\n"),
+    miru::params::DuplicateFieldNamesError
+  );
+}
+
+TEST_F(ParseYamlString, HeterogeneousSequences) {
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", "[1, [2]]"), std::runtime_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", "[[1], {a: 1}]"), std::runtime_error
+  );
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", "[{a: 1}, 1]"), std::runtime_error
+  );
+}
+
+TEST_F(ParseYamlString, ComplexKeys) {
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", "? [a, b]\n: 1\n"), std::runtime_error
+  );
+}
+
+TEST_F(ParseYamlString, MaxDepth) {
+  std::string yaml = "a:\n  - b: [1]\n  - b: [2]\n";
+  EXPECT_NO_THROW(miru::params::parse_yaml_string("slug", yaml, 4));
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", yaml, 3),
+    miru::params::MaxDepthExceededError
+  );
+  // aliases are expanded so they count at the depth they are used
+  std::string aliased = "a: &x {b: [1]}\nc: {d: *x}\n";
+  EXPECT_NO_THROW(miru::params::parse_yaml_string("slug", aliased, 4));
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", aliased, 3),
+    miru::params::MaxDepthExceededError
+  );
+}
+
+TEST_F(ParseYamlString, Malformed) {
+  EXPECT_THROW(
+    miru::params::parse_yaml_string("slug", "a: 'unterminated"), YAML::ParserException
+  );
+}
+
+}  // namespace test::params
@@ -0,0 +1,175 @@
+// std
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// internal
+#include <configs/instance_impl.hpp>
+#include <miru/query/cache.hpp>
+#include <miru/query/query.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::query {
+
+using SearchParamFilters = miru::query::SearchParamFilters;
+using SearchParamFiltersBuilder = miru::query::SearchParamFiltersBuilder;
+
+// ============================== CANONICAL FILTERS ================================ //
+TEST(CanonicalFilters, OrderIndependent) {
+  SearchParamFilters a = SearchParamFiltersBuilder()
+                           .with_param_names({"a.b", "a.c"})
+                           .with_prefixes({"x", "y"})
+                           .build();
+  SearchParamFilters b = SearchParamFiltersBuilder()
+                           .with_param_names({"a.c", "a.b"})
+                           .with_prefixes({"y", "x"})
+                           .build();
+  EXPECT_EQ(a.canonical_hash(), b.canonical_hash());
+  EXPECT_TRUE(a.equivalent(b));
+}
+
+TEST(CanonicalFilters, NamesAndPrefixesAreDistinct) {
+  SearchParamFilters names = SearchParamFiltersBuilder().with_param_name("a").build();
+  SearchParamFilters prefixes = SearchParamFiltersBuilder().with_prefix("a").build();
+  EXPECT_NE(names.canonical_hash(), prefixes.canonical_hash());
+  EXPECT_FALSE(names.equivalent(prefixes));
+}
+
+TEST(CanonicalFilters, LeavesOnly) {
+  SearchParamFilters a =
+    SearchParamFiltersBuilder().with_prefix("a").with_leaves_only(true).build();
+  SearchParamFilters b =
+    SearchParamFiltersBuilder().with_prefix("a").with_leaves_only(false).build();
+  EXPECT_NE(a.canonical_hash(), b.canonical_hash());
+  EXPECT_FALSE(a.equivalent(b));
+}
+
+// ================================= QUERY CACHE ================================== //
+TEST(QueryCache, ZeroCapacity) {
+  EXPECT_THROW(miru::query::QueryCache(0), std::invalid_argument);
+}
+
+TEST(QueryCache, HitsAndMisses) {
+  miru::params::Parameter param("a", 1);
+  miru::query::QueryCache cache(4);
+  SearchParamFilters filters = SearchParamFiltersBuilder().with_param_name("a").build();
+
+  std::vector<const miru::params::Parameter*> result;
+  EXPECT_FALSE(cache.get(filters, result));
+  cache.put(filters, {&param});
+  EXPECT_TRUE(cache.get(filters, result));
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0], &param);
+
+  miru::query::QueryCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.size, 1);
+  EXPECT_EQ(stats.capacity, 4);
+}
+
+TEST(QueryCache, EvictsLeastRecentlyUsed) {
+  miru::query::QueryCache cache(2);
+  SearchParamFilters a = SearchParamFiltersBuilder().with_param_name("a").build();
+  SearchParamFilters b = SearchParamFiltersBuilder().with_param_name("b").build();
+  SearchParamFilters c = SearchParamFiltersBuilder().with_param_name("c").build();
+
+  std::vector<const miru::params::Parameter*> result;
+  cache.put(a, {});
+  cache.put(b, {});
+
+  // touch 'a' so that 'b' is the least recently used entry
+  EXPECT_TRUE(cache.get(a, result));
+  cache.put(c, {});
+
+  EXPECT_EQ(cache.stats().size, 2);
+  EXPECT_TRUE(cache.get(a, result));
+  EXPECT_FALSE(cache.get(b, result));
+  EXPECT_TRUE(cache.get(c, result));
+}
+
+TEST(QueryCache, Clear) {
+  miru::query::QueryCache cache(2);
+  SearchParamFilters a = SearchParamFiltersBuilder().with_param_name("a").build();
+  cache.put(a, {});
+  cache.clear();
+
+  std::vector<const miru::params::Parameter*> result;
+  EXPECT_FALSE(cache.get(a, result));
+  EXPECT_EQ(cache.stats().size, 0);
+}
+
+// ========================== CONFIG INSTANCE QUERY CACHE ========================== //
+TEST(ConfigInstanceQueryCache, DisabledByDefault) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("yaml");
+  EXPECT_EQ(config_instance.query_cache(), nullptr);
+
+  auto speed = miru::query::get_param(config_instance, "motion-control.speed");
+  EXPECT_EQ(speed.as<int>(), 15);
+
+  miru::query::QueryCacheStats stats = config_instance.query_cache_stats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+}
+
+TEST(ConfigInstanceQueryCache, RepeatedQueries) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("yaml");
+  config_instance.enable_query_cache(8);
+
+  SearchParamFilters filters =
+    SearchParamFiltersBuilder().with_prefix("motion-control.accelerometer").build();
+  std::vector<miru::params::Parameter> first =
+    miru::query::get_params(config_instance, filters);
+  std::vector<miru::params::Parameter> second =
+    miru::query::get_params(config_instance, filters);
+  EXPECT_FALSE(first.empty());
+  EXPECT_EQ(first, second);
+
+  miru::query::QueryCacheStats stats = config_instance.query_cache_stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.size, 1);
+
+  // disabling the cache drops the cached results
+  config_instance.disable_query_cache();
+  EXPECT_EQ(config_instance.query_cache(), nullptr);
+  EXPECT_EQ(miru::query::get_params(config_instance, filters), first);
+}
+
+TEST(ConfigInstanceQueryCache, LazyResultsInTreeOrder) {
+  miru::config::FromFileOptions options;
+  options.lazy = true;
+  miru::config::ConfigInstance lazy =
+    miru::test_utils::load_motion_control("json", options);
+  miru::config::ConfigInstance eager = miru::test_utils::load_motion_control("json");
+  lazy.enable_query_cache(8);
+
+  std::vector<std::string> names = {
+    "motion-control.speed",
+    "motion-control.accelerometer.scaling_factor.x",
+    "motion-control.accelerometer.id",
+    "motion-control.features.jump",
+  };
+  SearchParamFilters forward =
+    SearchParamFiltersBuilder().with_param_names(names).build();
+  std::reverse(names.begin(), names.end());
+  SearchParamFilters reversed =
+    SearchParamFiltersBuilder().with_param_names(names).build();
+
+  // the results don't depend on the order of the names, how the config instance was
+  // loaded or whether they were cached by a query naming them in another order
+  std::vector<miru::params::Parameter> expected =
+    miru::query::get_params(eager, forward);
+  ASSERT_EQ(expected.size(), 4);
+  EXPECT_EQ(miru::query::get_params(eager, reversed), expected);
+  EXPECT_EQ(miru::query::get_params(lazy, reversed), expected);
+  EXPECT_EQ(miru::query::get_params(lazy, forward), expected);
+  EXPECT_EQ(lazy.query_cache_stats().hits, 1);
+}
+
+}  // namespace test::query
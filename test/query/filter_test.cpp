@@ -111,6 +111,23 @@ TEST_F(SearchParamFiltersBuilderTest, WithLeavesOnlyFalse) {
   EXPECT_FALSE(filters.leaves_only);
 }
 
+TEST_F(SearchParamFiltersBuilderTest, WithTypes) {
+  miru::query::SearchParamFiltersBuilder builder;
+  EXPECT_FALSE(builder.build().has_type_filter());
+  builder.with_type(miru::params::ParameterType::PARAMETER_MAP);
+  builder.with_types(
+    {miru::params::ParameterType::PARAMETER_DOUBLE_ARRAY,
+     miru::params::ParameterType::PARAMETER_MAP}
+  );
+  auto filters = builder.build();
+  EXPECT_TRUE(filters.has_type_filter());
+  EXPECT_EQ(
+    filters.types,
+    miru::params::type_mask(miru::params::ParameterType::PARAMETER_MAP) |
+      miru::params::type_mask(miru::params::ParameterType::PARAMETER_DOUBLE_ARRAY)
+  );
+}
+
 // ============================== MATCHING OPERATIONS ============================== //
 class SearchParamFiltersMatchingTest : public ::testing::Test {};
 
@@ -346,4 +363,35 @@ TEST_F(SearchParamFiltersContinueSearchTest, ContinueSearchComplex1) {
   EXPECT_FALSE(filters.continue_search(map4));
 }
 
-}  // namespace test::query
\ No newline at end of file
+TEST_F(SearchParamFiltersContinueSearchTest, ContinueSearchTypes) {
+  auto filters = miru::query::SearchParamFiltersBuilder()
+                   .with_type(miru::params::ParameterType::PARAMETER_BOOL)
+                   .build();
+
+  miru::params::Parameter scalars = miru::params::Parameter(
+    "prefix.test",
+    miru::params::Map(
+      {miru::params::Parameter("prefix.test.hello", miru::params::Scalar("value"))}
+    )
+  );
+  EXPECT_FALSE(filters.continue_search(scalars));
+  EXPECT_FALSE(filters.matches(*scalars.as_map().begin()));
+
+  miru::params::Parameter bools = miru::params::Parameter(
+    "prefix.test",
+    miru::params::Map({miru::params::Parameter("prefix.test.hello", true)})
+  );
+  EXPECT_TRUE(filters.continue_search(bools));
+  EXPECT_TRUE(filters.matches(*bools.as_map().begin()));
+}
+
+TEST(SearchParamFiltersCanonical, Types) {
+  auto filters1 = miru::query::SearchParamFiltersBuilder()
+                    .with_type(miru::params::ParameterType::PARAMETER_BOOL)
+                    .build();
+  auto filters2 = miru::query::SearchParamFiltersBuilder().build();
+  EXPECT_FALSE(filters1.equivalent(filters2));
+  EXPECT_NE(filters1.canonical_hash(), filters2.canonical_hash());
+}
+
+}  // namespace test::query
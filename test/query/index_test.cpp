@@ -0,0 +1,248 @@
+// internal
+#include <miru/query/details/hash.hpp>
+#include <miru/query/index.hpp>
+#include <miru/query/query.hpp>
+#include <miru/query/ros2.hpp>
+#include <params/parse.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::query {
+
+std::shared_ptr<const miru::params::Parameter> index_test_tree() {
+  nlohmann::json data = {
+    {"motors",
+     {{"left", {{"kp", 1.5}, {"ki", 0.1}}}, {"right", {{"kp", 1.6}, {"ki", 0.2}}}}},
+    {"waypoints", {{{"x", 1}, {"y", 2}}, {{"x", 3}, {"y", 4}}}},
+    {"gains", {1, 2, 3}},
+    {"name", "robot"},
+  };
+  return std::make_shared<const miru::params::Parameter>(
+    miru::params::parse_json_node("cfg", data)
+  );
+}
+
+// ================================= FNV-1A HASH ================================== //
+TEST(Fnv1a, Incremental) {
+  uint64_t parent = miru::query::details::fnv1a("motors.left");
+  EXPECT_EQ(
+    miru::query::details::fnv1a(".kp", parent),
+    miru::query::details::fnv1a("motors.left.kp")
+  );
+}
+
+TEST(Fnv1a, Constexpr) {
+  constexpr uint64_t hash = miru::query::details::fnv1a("a");
+  static_assert(hash != miru::query::details::FNV_OFFSET_BASIS);
+  EXPECT_EQ(hash, miru::query::details::fnv1a(std::string("a")));
+}
+
+// ================================= PARAM INDEX ================================== //
+TEST(ParamIndex, NullRoot) {
+  EXPECT_THROW(miru::query::ParamIndex(nullptr), std::invalid_argument);
+}
+
+TEST(ParamIndex, IndexesEveryParameter) {
+  miru::query::ParamIndex index(index_test_tree());
+  // root, motors, left, left.kp, left.ki, right, right.kp, right.ki, waypoints,
+  // waypoints.0, waypoints.0.x, waypoints.0.y, waypoints.1, waypoints.1.x,
+  // waypoints.1.y, gains, name
+  EXPECT_EQ(index.size(), 17);
+}
+
+TEST(ParamIndex, Find) {
+  miru::query::ParamIndex index(index_test_tree());
+
+  const miru::params::Parameter* kp = index.find("cfg.motors.left.kp");
+  ASSERT_NE(kp, nullptr);
+  EXPECT_EQ(kp->as<double>(), 1.5);
+
+  const miru::params::Parameter* waypoint = index.find("cfg.waypoints.1.y");
+  ASSERT_NE(waypoint, nullptr);
+  EXPECT_EQ(waypoint->as<int>(), 4);
+
+  const miru::params::Parameter* motors = index.find("cfg.motors");
+  ASSERT_NE(motors, nullptr);
+  EXPECT_TRUE(motors->is_map());
+
+  const miru::params::Parameter* root = index.find("cfg");
+  EXPECT_EQ(root, &index.root());
+}
+
+TEST(ParamIndex, FindMissing) {
+  miru::query::ParamIndex index(index_test_tree());
+  EXPECT_EQ(index.find("cfg.motors.left.kd"), nullptr);
+  EXPECT_EQ(index.find("cfg.motors.left.k"), nullptr);
+  EXPECT_EQ(index.find(""), nullptr);
+}
+
+TEST(ParamIndex, FindWithPrecomputedHash) {
+  miru::query::ParamIndex index(index_test_tree());
+  uint64_t hash = miru::query::details::fnv1a("cfg.name");
+  const miru::params::Parameter* name = index.find("cfg.name", hash);
+  ASSERT_NE(name, nullptr);
+  EXPECT_EQ(name->as<std::string>(), "robot");
+}
+
+TEST(ParamIndex, SharesTree) {
+  std::shared_ptr<const miru::params::Parameter> tree = index_test_tree();
+  std::weak_ptr<const miru::params::Parameter> weak_tree = tree;
+  auto index = std::make_shared<miru::query::ParamIndex>(tree);
+  tree.reset();
+  EXPECT_FALSE(weak_tree.expired());
+  index.reset();
+  EXPECT_TRUE(weak_tree.expired());
+}
+
+// ================================ TYPE POSTINGS ================================= //
+std::vector<std::string> names_of(
+  const std::vector<const miru::params::Parameter*>& params
+) {
+  std::vector<std::string> names;
+  for (const auto* param : params) {
+    names.push_back(param->get_name());
+  }
+  return names;
+}
+
+TEST(ParamIndex, FindByTypes) {
+  miru::query::ParamIndex index(index_test_tree());
+
+  EXPECT_EQ(
+    names_of(index.find_by_types(miru::params::type_mask(miru::params::PARAMETER_MAP))),
+    std::vector<std::string>(
+      {"cfg",
+       "cfg.motors",
+       "cfg.motors.left",
+       "cfg.motors.right",
+       "cfg.waypoints.0",
+       "cfg.waypoints.1"}
+    )
+  );
+  EXPECT_EQ(
+    index.count_by_types(miru::params::type_mask(miru::params::PARAMETER_MAP)), 6
+  );
+
+  // several types are merged back into tree order (map keys are sorted)
+  miru::params::ParameterTypeMask types =
+    miru::params::type_mask(miru::params::PARAMETER_MAP_ARRAY) |
+    miru::params::type_mask(miru::params::PARAMETER_INTEGER_ARRAY) |
+    miru::params::type_mask(miru::params::PARAMETER_STRING);
+  EXPECT_EQ(
+    names_of(index.find_by_types(types)),
+    std::vector<std::string>({"cfg.gains", "cfg.name", "cfg.waypoints"})
+  );
+
+  EXPECT_TRUE(index.find_by_types(miru::params::type_mask(miru::params::PARAMETER_NULL))
+                .empty());
+  EXPECT_TRUE(index.find_by_types(miru::params::EMPTY_TYPE_MASK).empty());
+}
+
+TEST(ParamIndex, TypeQueriesMatchTraversal) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+
+  for (bool leaves_only : {true, false}) {
+    for (const std::string prefix : {"", "motion-control.accelerometer"}) {
+      auto builder = miru::query::SearchParamFiltersBuilder()
+                       .with_types(
+                         {miru::params::PARAMETER_MAP,
+                          miru::params::PARAMETER_INTEGER,
+                          miru::params::PARAMETER_DOUBLE}
+                       )
+                       .with_leaves_only(leaves_only);
+      if (!prefix.empty()) {
+        builder.with_prefix(prefix);
+      }
+      auto filters = builder.build();
+      // served by the type posting lists
+      auto indexed = miru::query::details::find_all(config_instance, filters);
+      // served by the (pruned) traversal
+      auto traversed =
+        miru::query::details::find_all(config_instance.root_parameter(), filters);
+      EXPECT_FALSE(traversed.empty());
+      EXPECT_EQ(indexed, traversed);
+    }
+  }
+}
+
+// ================================= SORTED LEAVES ================================= //
+using LeafIterator = miru::query::ParamIndex::LeafIterator;
+
+std::vector<std::string_view> leaf_names(std::pair<LeafIterator, LeafIterator> range) {
+  std::vector<std::string_view> names;
+  for (auto it = range.first; it != range.second; ++it) {
+    names.push_back(it->name);
+  }
+  return names;
+}
+
+TEST(ParamIndex, SortedLeaves) {
+  miru::query::ParamIndex index(index_test_tree());
+  const auto& leaves = index.sorted_leaves();
+  ASSERT_EQ(leaves.size(), 10);
+  EXPECT_TRUE(std::is_sorted(
+    leaves.begin(),
+    leaves.end(),
+    [](const auto& lhs, const auto& rhs) { return lhs.name < rhs.name; }
+  ));
+  EXPECT_EQ(leaves.front().name, "cfg.gains");
+  EXPECT_EQ(leaves.front().depth, 1);
+  EXPECT_EQ(leaves.front().param, index.find("cfg.gains"));
+}
+
+TEST(ParamIndex, LeavesUnder) {
+  miru::query::ParamIndex index(index_test_tree());
+  EXPECT_EQ(
+    leaf_names(index.leaves_under("cfg.motors.left")),
+    std::vector<std::string_view>({"cfg.motors.left.ki", "cfg.motors.left.kp"})
+  );
+  EXPECT_EQ(leaf_names(index.leaves_under("cfg.waypoints")).size(), 4);
+  EXPECT_EQ(leaf_names(index.leaves_under("")).size(), 10);
+  // leaves are not nested under themselves
+  EXPECT_TRUE(leaf_names(index.leaves_under("cfg.name")).empty());
+  EXPECT_TRUE(leaf_names(index.leaves_under("cfg.motors.le")).empty());
+}
+
+TEST(ParamIndex, LeavesUnderSimilarNames) {
+  // '-' sorts before the delimiter and '0' and 'b' after it
+  nlohmann::json data = {
+    {"a", {{"x", 1}}}, {"a-b", 2}, {"a0", 3}, {"ab", {{"y", 4}}}
+  };
+  miru::query::ParamIndex index(std::make_shared<const miru::params::Parameter>(
+    miru::params::parse_json_node("cfg", data)
+  ));
+  EXPECT_EQ(
+    leaf_names(index.leaves_under("cfg.a")), std::vector<std::string_view>({"cfg.a.x"})
+  );
+}
+
+TEST(ParamIndex, DeepTree) {
+  // (deep enough to need a lot of stack for a recursive traversal)
+  size_t depth = 10000;
+  std::string json;
+  std::string leaf_name = "root";
+  for (size_t i = 0; i < depth; i++) {
+    json += "{\"a\": ";
+    leaf_name += ".a";
+  }
+  json += "1" + std::string(depth, '}');
+  auto root = std::make_shared<const miru::params::Parameter>(
+    miru::params::parse_json_string("root", json, depth)
+  );
+
+  miru::query::ParamIndex index(root);
+  EXPECT_EQ(index.size(), depth + 1);
+  ASSERT_NE(index.find(leaf_name), nullptr);
+  EXPECT_EQ(index.find(leaf_name)->as_int(), 1);
+  ASSERT_EQ(index.sorted_leaves().size(), 1);
+  EXPECT_EQ(index.sorted_leaves()[0].depth, depth);
+
+  // the ros2 interface indexes the parameters it's given
+  miru::query::ROS2NodeI ros2_node(root);
+  EXPECT_EQ(ros2_node.get_parameter(leaf_name).as_int(), 1);
+}
+
+}  // namespace test::query
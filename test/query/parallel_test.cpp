@@ -0,0 +1,120 @@
+// std
+#include <string>
+#include <vector>
+
+// internal
+#include <miru/configs/instance.hpp>
+#include <miru/query/parallel.hpp>
+#include <miru/query/query.hpp>
+#include <params/parse.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::query {
+
+// a map with a wide map array ("waypoints") and a wide map ("zones")
+miru::params::Parameter wide_test_tree(size_t width) {
+  nlohmann::json waypoints = nlohmann::json::array();
+  nlohmann::json zones = nlohmann::json::object();
+  for (size_t i = 0; i < width; i++) {
+    waypoints.push_back({{"x", i}, {"y", i % 7}, {"tags", {"a", "b"}}});
+    zones["zone_" + std::to_string(i)] = {{"radius", 0.5 * i}};
+  }
+  nlohmann::json data = {{"waypoints", waypoints}, {"zones", zones}, {"name", "fleet"}};
+  return miru::params::parse_json_node("cfg", data);
+}
+
+miru::query::ParallelQueryOptions small_chunk_options(
+  miru::parallel::ThreadPool* pool
+) {
+  miru::query::ParallelQueryOptions options;
+  options.pool = pool;
+  options.min_parallel_children = 8;
+  options.chunk_size = 5;
+  return options;
+}
+
+std::vector<miru::query::SearchParamFilters> parallel_test_filters() {
+  return {
+    miru::query::SearchParamFilters(),
+    miru::query::SearchParamFiltersBuilder().with_leaves_only(false).build(),
+    miru::query::SearchParamFiltersBuilder().with_prefix("cfg.waypoints.1").build(),
+    miru::query::SearchParamFiltersBuilder()
+      .with_param_names({"cfg.zones.zone_3.radius", "cfg.waypoints.99.y"})
+      .build(),
+    miru::query::SearchParamFiltersBuilder()
+      .with_value_predicate(miru::query::ValuePredicate::equal_to(3))
+      .build(),
+  };
+}
+
+// ============================== PARALLEL TRAVERSAL =============================== //
+TEST(ParallelQuery, MatchesSerial) {
+  miru::params::Parameter root = wide_test_tree(200);
+  miru::parallel::ThreadPool pool(4);
+  for (const auto& options :
+       {small_chunk_options(&pool), small_chunk_options(nullptr)}) {
+    for (const auto& filters : parallel_test_filters()) {
+      EXPECT_EQ(
+        miru::query::details::find_all(root, filters, options),
+        miru::query::details::find_all(root, filters)
+      ) << miru::query::to_string(filters);
+    }
+  }
+}
+
+TEST(ParallelQuery, BelowThresholdIsSerial) {
+  miru::params::Parameter root = wide_test_tree(20);
+  miru::query::ParallelQueryOptions options;
+  options.min_parallel_children = 1000;
+  EXPECT_EQ(
+    miru::query::details::find_all(root, miru::query::SearchParamFilters(), options),
+    miru::query::details::find_all(root, miru::query::SearchParamFilters())
+  );
+}
+
+TEST(ParallelQuery, Roots) {
+  miru::params::Parameter root = wide_test_tree(50);
+  const miru::params::MapArray& waypoints = root.as_map()["waypoints"].as_map_array();
+  miru::parallel::ThreadPool pool(3);
+  auto options = small_chunk_options(&pool);
+  for (const auto& filters : parallel_test_filters()) {
+    EXPECT_EQ(
+      miru::query::details::find_all(waypoints, filters, options),
+      miru::query::details::find_all(waypoints, filters)
+    );
+  }
+}
+
+TEST(ParallelQuery, PublicApi) {
+  miru::params::Parameter root = wide_test_tree(100);
+  miru::parallel::ThreadPool pool(2);
+  auto options = small_chunk_options(&pool);
+  auto filters =
+    miru::query::SearchParamFiltersBuilder().with_prefix("cfg.zones").build();
+  EXPECT_EQ(
+    miru::query::get_params(root, filters, options),
+    miru::query::get_params(root, filters)
+  );
+  EXPECT_EQ(
+    miru::query::list_params(root, options).size(),
+    miru::query::list_params(root).size()
+  );
+  EXPECT_EQ(miru::query::get_param_refs(root, filters, options).size(), 100);
+}
+
+TEST(ParallelQuery, ConfigInstance) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ParallelQueryOptions options;
+  options.min_parallel_children = 2;
+  options.chunk_size = 1;
+  EXPECT_EQ(
+    miru::query::list_params(config_instance, options),
+    miru::query::list_params(config_instance)
+  );
+}
+
+}  // namespace test::query
@@ -0,0 +1,195 @@
+// internal
+#include <configs/instance_impl.hpp>
+#include <miru/query/details/errors.hpp>
+#include <miru/query/details/hash.hpp>
+#include <miru/query/path.hpp>
+#include <miru/query/query.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::query {
+
+// ================================== PARAM PATH =================================== //
+TEST(ParamPath, Segments) {
+  miru::query::ParamPath path("motors.left.kp");
+  EXPECT_EQ(path.name(), "motors.left.kp");
+  ASSERT_EQ(path.num_segments(), 3);
+  EXPECT_EQ(path.segment(0), "motors");
+  EXPECT_EQ(path.segment(1), "left");
+  EXPECT_EQ(path.segment(2), "kp");
+}
+
+TEST(ParamPath, SegmentHashes) {
+  miru::query::ParamPath path("motors.left.kp");
+  EXPECT_EQ(path.segment_hash(0), miru::query::details::fnv1a("motors"));
+  EXPECT_EQ(path.segment_hash(1), miru::query::details::fnv1a("motors.left"));
+  EXPECT_EQ(path.segment_hash(2), miru::query::details::fnv1a("motors.left.kp"));
+  EXPECT_EQ(path.hash(), path.segment_hash(2));
+}
+
+TEST(ParamPath, TrailingDelimiter) {
+  miru::query::ParamPath path("motors.left.");
+  EXPECT_EQ(path.name(), "motors.left");
+  EXPECT_EQ(path.num_segments(), 2);
+}
+
+TEST(ParamPath, SingleSegment) {
+  miru::query::ParamPath path("motors");
+  ASSERT_EQ(path.num_segments(), 1);
+  EXPECT_EQ(path.segment(0), "motors");
+}
+
+// =============================== STATIC PARAM PATH =============================== //
+using namespace miru::query::literals;
+
+TEST(StaticParamPath, CompileTime) {
+  constexpr miru::query::StaticParamPath path = "motors.left.kp"_mp;
+  static_assert(path.num_segments() == 3);
+  static_assert(path.segment(1) == "left");
+  static_assert(path.segment_length(2) == 2);
+  static_assert(path.hash() == miru::query::details::fnv1a("motors.left.kp"));
+  static_assert(path.segment_hash(0) == miru::query::details::fnv1a("motors"));
+  static_assert(path.segment_hash(1) == miru::query::details::fnv1a("motors.left"));
+  EXPECT_EQ(path.name(), "motors.left.kp");
+}
+
+TEST(StaticParamPath, TrailingDelimiter) {
+  constexpr miru::query::StaticParamPath path = "motors.left."_mp;
+  static_assert(path.name() == "motors.left");
+  static_assert(path.num_segments() == 2);
+}
+
+TEST(StaticParamPath, TooManySegments) {
+  std::string name = "a";
+  for (size_t i = 0; i < miru::query::MAX_STATIC_PATH_SEGMENTS; i++) {
+    name += ".a";
+  }
+  EXPECT_THROW(
+    miru::query::StaticParamPath(name.data(), name.size()), std::length_error
+  );
+}
+
+TEST(StaticParamPath, MatchesParamPath) {
+  constexpr miru::query::StaticParamPath static_path = "motors.left.kp"_mp;
+  miru::query::ParamPath from_static(static_path);
+  miru::query::ParamPath from_string("motors.left.kp");
+  EXPECT_EQ(from_static.name(), from_string.name());
+  EXPECT_EQ(from_static.hash(), from_string.hash());
+  ASSERT_EQ(from_static.num_segments(), from_string.num_segments());
+  for (size_t i = 0; i < from_static.num_segments(); i++) {
+    EXPECT_EQ(from_static.segment(i), from_string.segment(i));
+    EXPECT_EQ(from_static.segment_hash(i), from_string.segment_hash(i));
+  }
+}
+
+// ================================ PATH QUERIES =================================== //
+TEST(PathQueries, StaticPath) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("json");
+  EXPECT_TRUE(miru::query::has_param(config_instance, "motion-control.speed"_mp));
+  EXPECT_FALSE(miru::query::has_param(config_instance, "motion-control.speeed"_mp));
+  EXPECT_EQ(
+    miru::query::get_param(config_instance, "motion-control.speed"_mp).as<int>(), 15
+  );
+  EXPECT_THROW(
+    miru::query::get_param(config_instance, "motion-control.speeed"_mp),
+    miru::query::details::ParameterNotFoundError
+  );
+}
+
+TEST(PathQueries, RuntimePath) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("yaml");
+  miru::query::ParamPath speed("motion-control.speed");
+  EXPECT_TRUE(miru::query::has_param(config_instance, speed));
+  EXPECT_EQ(
+    miru::query::find_param(config_instance, speed),
+    miru::query::find_param(config_instance, "motion-control.speed"_mp)
+  );
+  EXPECT_EQ(
+    miru::query::get_param(config_instance, speed),
+    miru::query::get_param(config_instance, "motion-control.speed")
+  );
+}
+
+TEST(PathQueries, NonLeaf) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("json");
+  EXPECT_TRUE(
+    miru::query::get_param(config_instance, "motion-control.accelerometer"_mp).is_map()
+  );
+}
+
+// ================================= PARAM HANDLE ================================== //
+TEST(ParamHandle, Resolve) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("json");
+  miru::query::ParamPath path("motion-control.speed");
+  miru::query::ParamHandle speed = path.resolve(config_instance);
+
+  EXPECT_EQ(speed.get<int>(), 15);
+  EXPECT_EQ(speed->get_name(), "motion-control.speed");
+  EXPECT_EQ(
+    &speed.parameter(), &(*config_instance.param_index()->find("motion-control.speed"))
+  );
+}
+
+TEST(ParamHandle, ResolveMatchesQuery) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("yaml");
+  miru::query::ParamHandle accelerometer =
+    miru::query::ParamPath("motion-control.accelerometer.id").resolve(config_instance);
+  EXPECT_EQ(
+    accelerometer.parameter(),
+    miru::query::get_param(config_instance, "motion-control.accelerometer.id")
+  );
+}
+
+TEST(ParamHandle, DoesntExist) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("json");
+  miru::query::ParamPath path("motion-control.doesnt_exist");
+  EXPECT_THROW(
+    path.resolve(config_instance), miru::query::details::ParameterNotFoundError
+  );
+}
+
+TEST(ParamHandle, OutlivesConfigInstance) {
+  auto config_instance = std::make_unique<miru::config::ConfigInstance>(
+    miru::test_utils::load_motion_control("json")
+  );
+  miru::query::ParamHandle speed =
+    miru::query::ParamPath("motion-control.speed").resolve(*config_instance);
+  config_instance.reset();
+  EXPECT_EQ(speed.get<int>(), 15);
+}
+
+TEST(ParamHandle, Rebind) {
+  miru::config::ConfigInstance json_instance =
+    miru::test_utils::load_motion_control("json");
+  miru::config::ConfigInstance yaml_instance =
+    miru::test_utils::load_motion_control("yaml");
+
+  miru::query::ParamHandle speed =
+    miru::query::ParamPath("motion-control.speed").resolve(json_instance);
+  const miru::params::Parameter* json_speed = &speed.parameter();
+
+  // rebinding against the same instance is a no-op
+  speed.rebind(json_instance);
+  EXPECT_EQ(&speed.parameter(), json_speed);
+
+  speed.rebind(yaml_instance);
+  EXPECT_NE(&speed.parameter(), json_speed);
+  EXPECT_EQ(speed.get<int>(), 15);
+}
+
+TEST(ConfigInstanceParamIndex, BuiltOnce) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("json");
+  EXPECT_EQ(config_instance.param_index(), config_instance.param_index());
+  EXPECT_EQ(&config_instance.param_index()->root(), &config_instance.root_parameter());
+}
+
+}  // namespace test::query
@@ -0,0 +1,216 @@
+// std
+#include <vector>
+
+// internal
+#include <miru/configs/instance.hpp>
+#include <miru/query/predicate.hpp>
+#include <miru/query/query.hpp>
+#include <query/details/kernels.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::query {
+
+using ValuePredicate = miru::query::ValuePredicate;
+
+// =================================== KERNELS ===================================== //
+TEST(PredicateKernels, CountInRange) {
+  std::vector<double> doubles = {-1.0, 0.0, 0.5, 1.0, 1.5};
+  EXPECT_EQ(
+    miru::query::details::count_in_range(doubles.data(), doubles.size(), 0.0, 1.0), 3
+  );
+  std::vector<int64_t> ints = {-3, 0, 2, 7};
+  EXPECT_EQ(miru::query::details::count_in_range(ints.data(), ints.size(), 0, 5), 2);
+  EXPECT_EQ(miru::query::details::count_in_range(ints.data(), 0, 0, 5), 0);
+}
+
+TEST(PredicateKernels, CountOneOf) {
+  std::vector<int64_t> ints = {1, 2, 3, 2, 5};
+  std::vector<double> candidates = {2, 5};
+  EXPECT_EQ(
+    miru::query::details::count_one_of(
+      ints.data(), ints.size(), candidates.data(), candidates.size()
+    ),
+    3
+  );
+  EXPECT_EQ(
+    miru::query::details::count_one_of(ints.data(), ints.size(), candidates.data(), 0),
+    0
+  );
+}
+
+// ============================== NUMERIC PREDICATES =============================== //
+TEST(ValuePredicate, InvalidRange) {
+  EXPECT_THROW(ValuePredicate::in_range(1, 0), std::invalid_argument);
+}
+
+TEST(ValuePredicate, NumericLeaves) {
+  miru::params::Parameter integer("a", int64_t(5));
+  miru::params::Parameter number("b", 0.25);
+  miru::params::Parameter text("c", std::string("5"));
+
+  EXPECT_TRUE(ValuePredicate::in_range(0, 10).matches(integer));
+  EXPECT_FALSE(ValuePredicate::in_range(6, 10).matches(integer));
+  EXPECT_TRUE(ValuePredicate::not_in_range(6, 10).matches(integer));
+  EXPECT_TRUE(ValuePredicate::equal_to(5).matches(integer));
+  EXPECT_TRUE(ValuePredicate::one_of({0.25, 0.5}).matches(number));
+  EXPECT_FALSE(ValuePredicate::one_of({0.5}).matches(number));
+
+  // numeric predicates never match non-numeric types
+  EXPECT_FALSE(ValuePredicate::in_range(0, 10).matches(text));
+  EXPECT_FALSE(ValuePredicate::not_in_range(6, 10).matches(text));
+}
+
+TEST(ValuePredicate, NumericArrays) {
+  miru::params::Parameter ints("a", std::vector<int64_t>{1, 2, 3});
+  miru::params::Parameter doubles("b", std::vector<double>{});
+
+  EXPECT_TRUE(ValuePredicate::in_range(1, 3).matches(ints));
+  EXPECT_FALSE(ValuePredicate::in_range(2, 3).matches(ints));
+  EXPECT_TRUE(ValuePredicate::in_range(2, 3).for_any().matches(ints));
+  EXPECT_TRUE(ValuePredicate::not_in_range(2, 3).for_any().matches(ints));
+  EXPECT_FALSE(ValuePredicate::not_in_range(0, 3).for_any().matches(ints));
+  EXPECT_TRUE(ValuePredicate::equal_to(2).for_any().matches(ints));
+
+  // an empty array satisfies every 'all' predicate and no 'any' predicate
+  EXPECT_TRUE(ValuePredicate::in_range(0, 1).matches(doubles));
+  EXPECT_FALSE(ValuePredicate::in_range(0, 1).for_any().matches(doubles));
+}
+
+TEST(ValuePredicate, LargeArrays) {
+  // spans several kernel blocks with the only out of range value in the last one
+  std::vector<double> values(3 * miru::query::details::KERNEL_BLOCK_SIZE + 7, 0.5);
+  miru::params::Parameter in_range("a", values);
+  values.back() = 2.0;
+  miru::params::Parameter out_of_range("b", values);
+
+  EXPECT_TRUE(ValuePredicate::in_range(0, 1).matches(in_range));
+  EXPECT_FALSE(ValuePredicate::in_range(0, 1).matches(out_of_range));
+  EXPECT_FALSE(ValuePredicate::not_in_range(0, 1).for_any().matches(in_range));
+  EXPECT_TRUE(ValuePredicate::not_in_range(0, 1).for_any().matches(out_of_range));
+}
+
+TEST(ValuePredicate, Scalars) {
+  miru::params::Parameter number("a", miru::params::Scalar("1.5"));
+  miru::params::Parameter text("b", miru::params::Scalar("fast"));
+  miru::params::Parameter mixed(
+    "c",
+    std::vector<miru::params::Scalar>{
+      miru::params::Scalar("1"), miru::params::Scalar("fast")
+    }
+  );
+
+  EXPECT_TRUE(ValuePredicate::in_range(1, 2).matches(number));
+  EXPECT_FALSE(ValuePredicate::in_range(1, 2).matches(text));
+  EXPECT_FALSE(ValuePredicate::not_in_range(1, 2).matches(text));
+  EXPECT_TRUE(ValuePredicate::equal_to("fast").matches(text));
+  EXPECT_FALSE(ValuePredicate::in_range(0, 2).matches(mixed));
+  EXPECT_TRUE(ValuePredicate::in_range(0, 2).for_any().matches(mixed));
+  EXPECT_TRUE(ValuePredicate::equal_to("fast").for_any().matches(mixed));
+}
+
+TEST(ValuePredicate, NonNumericScalars) {
+  // only whole, finite decimal numbers are compared as numbers
+  for (const std::string& str :
+       {"", " 1.5", "1.5 ", "0x1p0", "-0X1", "inf", "-infinity", "nan", "1e999"}) {
+    miru::params::Parameter scalar("a", miru::params::Scalar(str));
+    EXPECT_FALSE(ValuePredicate::in_range(-1e308, 1e308).matches(scalar)) << str;
+    EXPECT_FALSE(ValuePredicate::not_in_range(0, 1).matches(scalar)) << str;
+  }
+  miru::params::Parameter exponent("a", miru::params::Scalar("-1.5e-3"));
+  EXPECT_TRUE(ValuePredicate::in_range(-1, 0).matches(exponent));
+}
+
+// =============================== STRING PREDICATES =============================== //
+TEST(ValuePredicate, Strings) {
+  miru::params::Parameter text("a", std::string("left"));
+  miru::params::Parameter texts("b", std::vector<std::string>{"left", "right"});
+
+  EXPECT_TRUE(ValuePredicate::equal_to("left").matches(text));
+  EXPECT_TRUE(ValuePredicate::equal_to(std::string("left")).matches(text));
+  EXPECT_FALSE(ValuePredicate::equal_to("right").matches(text));
+  EXPECT_TRUE(ValuePredicate::one_of({"left", "right"}).matches(texts));
+  EXPECT_FALSE(ValuePredicate::equal_to("left").matches(texts));
+  EXPECT_TRUE(ValuePredicate::equal_to("left").for_any().matches(texts));
+  EXPECT_FALSE(
+    ValuePredicate::equal_to("left").matches(miru::params::Parameter("c", int64_t(1)))
+  );
+}
+
+TEST(ValuePredicate, Equality) {
+  EXPECT_EQ(ValuePredicate::in_range(0, 1), ValuePredicate::in_range(0, 1));
+  EXPECT_EQ(
+    ValuePredicate::in_range(0, 1).hash(), ValuePredicate::in_range(0, 1).hash()
+  );
+  EXPECT_NE(ValuePredicate::in_range(0, 1), ValuePredicate::in_range(0, 1).for_any());
+  EXPECT_NE(ValuePredicate::in_range(0, 1), ValuePredicate::not_in_range(0, 1));
+  EXPECT_NE(ValuePredicate::equal_to(1), ValuePredicate::equal_to("1"));
+}
+
+// ================================ FILTER QUERIES ================================= //
+TEST(ValuePredicateFilters, GetParams) {
+  for (const std::string ext : {"json", "yaml"}) {
+    miru::config::ConfigInstance config_instance =
+      miru::test_utils::load_motion_control(ext);
+    auto filters = miru::query::SearchParamFiltersBuilder()
+                     .with_prefix("motion-control.accelerometer")
+                     .with_value_predicate(ValuePredicate::equal_to(1))
+                     .build();
+    std::vector<miru::params::Parameter> params =
+      miru::query::get_params(config_instance, filters);
+    ASSERT_EQ(params.size(), 3) << ext;
+    EXPECT_EQ(params[0].get_name(), "motion-control.accelerometer.scaling_factor.x");
+
+    EXPECT_EQ(
+      miru::query::get_param(
+        config_instance,
+        miru::query::SearchParamFiltersBuilder()
+          .with_value_predicate(ValuePredicate::in_range(11, 20))
+          .build()
+      )
+        .get_name(),
+      "motion-control.speed"
+    );
+  }
+}
+
+TEST(ValuePredicateFilters, IndexMatchesTraversal) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("json");
+  std::vector<ValuePredicate> predicates = {
+    ValuePredicate::in_range(0, 1),
+    ValuePredicate::not_in_range(0, 1),
+    ValuePredicate::equal_to("123"),
+  };
+  for (const auto& predicate : predicates) {
+    auto filters =
+      miru::query::SearchParamFiltersBuilder().with_value_predicate(predicate).build();
+    EXPECT_EQ(
+      miru::query::details::find_all(config_instance, filters),
+      miru::query::details::find_all(config_instance.root_parameter(), filters)
+    );
+  }
+}
+
+TEST(ValuePredicateFilters, Canonical) {
+  auto filters1 = miru::query::SearchParamFiltersBuilder()
+                    .with_value_predicate(ValuePredicate::in_range(0, 1))
+                    .with_value_predicate(ValuePredicate::equal_to("a"))
+                    .build();
+  auto filters2 = miru::query::SearchParamFiltersBuilder()
+                    .with_value_predicates(
+                      {ValuePredicate::equal_to("a"), ValuePredicate::in_range(0, 1)}
+                    )
+                    .build();
+  auto filters3 = miru::query::SearchParamFiltersBuilder()
+                    .with_value_predicate(ValuePredicate::in_range(0, 2))
+                    .with_value_predicate(ValuePredicate::equal_to("a"))
+                    .build();
+  EXPECT_TRUE(filters1.equivalent(filters2));
+  EXPECT_EQ(filters1.canonical_hash(), filters2.canonical_hash());
+  EXPECT_FALSE(filters1.equivalent(filters3));
+}
+
+}  // namespace test::query
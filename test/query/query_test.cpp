@@ -149,6 +149,25 @@ TEST(GetParamsByNameTests, DoesntExist) {
   );
 }
 
+TEST(GetParamsTests, DeepTree) {
+  // (deep enough to need a lot of stack for a recursive traversal)
+  size_t depth = 10000;
+  std::string json;
+  for (size_t i = 0; i < depth; i++) {
+    json += "{\"a\": ";
+  }
+  json += "1" + std::string(depth, '}');
+  miru::params::Parameter root = miru::params::parse_json_string("root", json, depth);
+
+  miru::query::SearchParamFilters all;
+  all.leaves_only = false;
+  auto params = miru::query::get_param_refs(root, all);
+  ASSERT_EQ(params.size(), depth + 1);
+  EXPECT_EQ(params[0]->get_name(), "root");
+  EXPECT_EQ(params[depth].as<int>(), 1);
+  EXPECT_EQ(miru::query::list_params(root).size(), 1);
+}
+
 // =================================== GET PARAM ==================================== //
 enum class QueryException { None, ParameterNotFound, TooManyResults };
 
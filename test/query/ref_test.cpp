@@ -0,0 +1,116 @@
+// std
+#include <type_traits>
+
+// internal
+#include <miru/configs/instance.hpp>
+#include <miru/query/index.hpp>
+#include <miru/query/query.hpp>
+#include <miru/query/ref.hpp>
+#include <test/test_utils/testdata.hpp>
+
+// external
+#include <gtest/gtest.h>
+
+namespace test::query {
+
+// querying a temporary root for references must not compile
+template <typename RootT, typename = void>
+struct can_get_param_ref : std::false_type {};
+
+template <typename RootT>
+struct can_get_param_ref<
+  RootT,
+  std::void_t<decltype(miru::query::get_param_ref(
+    std::declval<RootT>(), std::declval<const std::string&>()
+  ))>> : std::true_type {};
+
+static_assert(can_get_param_ref<const miru::params::Parameter&>::value);
+static_assert(!can_get_param_ref<miru::params::Parameter&&>::value);
+
+miru::query::SearchParamFilters accelerometer_filters() {
+  return miru::query::SearchParamFiltersBuilder()
+    .with_param_name("motion-control.accelerometer")
+    .with_leaves_only(false)
+    .build();
+}
+
+// ================================ PARAMETER REF ================================== //
+TEST(ParameterRef, PointsIntoTree) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+
+  miru::query::ParameterRef accelerometer =
+    miru::query::get_param_ref(config_instance, accelerometer_filters());
+  miru::query::ParameterRef speed =
+    miru::query::get_param_ref(config_instance, "motion-control.speed");
+
+  EXPECT_TRUE(accelerometer->is_map());
+  EXPECT_EQ(speed.as<int>(), 15);
+  EXPECT_EQ(
+    miru::query::get_param(config_instance, accelerometer_filters()),
+    accelerometer.copy()
+  );
+
+  // no copies: the reference is the parameter in the config instance's tree
+  EXPECT_EQ(
+    &speed.get(), config_instance.param_index()->find("motion-control.speed")
+  );
+}
+
+TEST(ParameterRef, NotFound) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  EXPECT_THROW(
+    miru::query::get_param_ref(config_instance, "motion-control.speeed"),
+    miru::query::details::ParameterNotFoundError
+  );
+}
+
+TEST(ParameterRef, GetParamRefs) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  auto filters = miru::query::SearchParamFiltersBuilder()
+                   .with_prefix("motion-control.features")
+                   .build();
+  std::vector<miru::params::Parameter> params =
+    miru::query::get_params(config_instance, filters);
+  std::vector<miru::query::ParameterRef> refs =
+    miru::query::get_param_refs(config_instance, filters);
+  ASSERT_EQ(refs.size(), params.size());
+  for (size_t i = 0; i < refs.size(); i++) {
+    EXPECT_EQ(*refs[i], params[i]);
+  }
+  EXPECT_EQ(
+    miru::query::list_param_refs(config_instance).size(),
+    miru::query::list_params(config_instance).size()
+  );
+}
+
+TEST(ParameterRef, SurvivesMove) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ParameterRef speed =
+    miru::query::get_param_ref(config_instance, "motion-control.speed");
+  miru::config::ConfigInstance moved = std::move(config_instance);
+  EXPECT_EQ(speed.as<int>(), 15);
+  EXPECT_EQ(&speed.get(), moved.param_index()->find("motion-control.speed"));
+}
+
+// ================================ SHARED PARAMS ================================== //
+TEST(SharedParam, OutlivesConfigInstance) {
+  std::shared_ptr<const miru::params::Parameter> accelerometer;
+  {
+    miru::config::ConfigInstance config_instance =
+      miru::test_utils::load_motion_control();
+    accelerometer =
+      miru::query::get_shared_param(config_instance, accelerometer_filters());
+    EXPECT_EQ(
+      accelerometer.get(),
+      &miru::query::get_param_ref(config_instance, accelerometer_filters()).get()
+    );
+  }
+  EXPECT_TRUE(accelerometer->is_map());
+  EXPECT_EQ(accelerometer->get_name(), "motion-control.accelerometer");
+}
+
+}  // namespace test::query
@@ -7,6 +7,7 @@
 #include <miru/query/ros2.hpp>
 #include <test/query/query_test.hpp>
 #include <test/test_utils/query.hpp>
+#include <test/test_utils/testdata.hpp>
 #include <test/test_utils/utils.hpp>
 
 // external
@@ -45,6 +46,17 @@ TEST(ROS2GetParamTests, DoesntExist) {
   );
 }
 
+TEST(ROS2GetParamTests, Ref) {
+  miru::params::Parameter parameter("exists", 42.3);
+  miru::query::ROS2NodeI ROS2NodeI(parameter);
+  miru::query::ParameterRef ref = ROS2NodeI.get_parameter_ref("exists");
+  EXPECT_EQ(ref.as<double>(), 42.3);
+  EXPECT_THROW(
+    ROS2NodeI.get_parameter_ref("doesnt_exist"),
+    miru::query::details::ParameterNotFoundError
+  );
+}
+
 // ====================== GET PARAMETER WITH DEFAULT PARAMETER ===================== //
 TEST(ROS2GetParamWithDefaultParameterTests, Exists) {
   miru::params::Parameter parameter("exists", 42.3);
@@ -178,4 +190,247 @@ TEST(ROS2GetParamsTests, DoesntExist) {
   );
 }
 
-}  // namespace test::query
\ No newline at end of file
+// ================================ CONFIG INSTANCE ================================ //
+TEST(ROS2ConfigInstanceTests, SharesTree) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  // references point into the config instance's tree instead of a copy of it
+  miru::query::ParameterRef ref = ROS2NodeI.get_parameter_ref("motion-control.speed");
+  EXPECT_EQ(&ref.get(), config_instance.param_index()->find("motion-control.speed"));
+  EXPECT_EQ(ROS2NodeI.get_parameter("motion-control.speed").as<int>(), 15);
+}
+
+TEST(ROS2ConfigInstanceTests, OnlyLeavesAreParameters) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  EXPECT_TRUE(ROS2NodeI.has_parameter("motion-control.features.spin"));
+  EXPECT_FALSE(ROS2NodeI.has_parameter("motion-control.features"));
+  EXPECT_FALSE(ROS2NodeI.has_parameter("motion-control.features."));
+  EXPECT_THROW(
+    ROS2NodeI.get_parameter("motion-control.features"),
+    miru::query::details::ParameterNotFoundError
+  );
+}
+
+TEST(ROS2ConfigInstanceTests, GetParametersInRequestedOrder) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  auto params = ROS2NodeI.get_parameters(
+    {"motion-control.speed", "motion-control.accelerometer.id"}
+  );
+  ASSERT_EQ(params.size(), 2);
+  EXPECT_EQ(params[0].get_name(), "motion-control.speed");
+  EXPECT_EQ(params[1].get_name(), "motion-control.accelerometer.id");
+}
+
+// =============================== LIST PARAMETERS ================================= //
+TEST(ROS2ListParamsTests, Prefix) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  auto result = ROS2NodeI.list_parameters(
+    {"motion-control.accelerometer"}, miru::query::ROS2NodeI::DEPTH_RECURSIVE
+  );
+  EXPECT_EQ(
+    result.names,
+    std::vector<std::string>({
+      "motion-control.accelerometer.id",
+      "motion-control.accelerometer.offsets.x",
+      "motion-control.accelerometer.offsets.y",
+      "motion-control.accelerometer.offsets.z",
+      "motion-control.accelerometer.scaling_factor.x",
+      "motion-control.accelerometer.scaling_factor.y",
+      "motion-control.accelerometer.scaling_factor.z",
+    })
+  );
+  EXPECT_EQ(
+    result.prefixes,
+    std::vector<std::string>({
+      "motion-control.accelerometer",
+      "motion-control.accelerometer.offsets",
+      "motion-control.accelerometer.scaling_factor",
+    })
+  );
+
+  // the prefix itself is listed if it is a parameter
+  result = ROS2NodeI.list_parameters({"motion-control.speed"}, 0);
+  EXPECT_EQ(result.names, std::vector<std::string>({"motion-control.speed"}));
+  EXPECT_EQ(result.prefixes, std::vector<std::string>({"motion-control"}));
+
+  // prefixes match whole segments only
+  EXPECT_TRUE(ROS2NodeI.list_parameters({"motion-control.feat"}, 0).names.empty());
+}
+
+TEST(ROS2ListParamsTests, Depth) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  // the delimiter after the prefix is counted like in rclcpp
+  EXPECT_TRUE(
+    ROS2NodeI.list_parameters({"motion-control.accelerometer"}, 1).names.empty()
+  );
+  EXPECT_EQ(
+    ROS2NodeI.list_parameters({"motion-control.speed"}, 1).names,
+    std::vector<std::string>({"motion-control.speed"})
+  );
+  EXPECT_EQ(
+    ROS2NodeI.list_parameters({"motion-control.accelerometer"}, 2).names,
+    std::vector<std::string>({"motion-control.accelerometer.id"})
+  );
+  EXPECT_EQ(
+    ROS2NodeI.list_parameters({"motion-control.accelerometer"}, 3).names.size(), 7
+  );
+  EXPECT_EQ(
+    ROS2NodeI.list_parameters({}, 2).names,
+    std::vector<std::string>({"motion-control.speed"})
+  );
+  EXPECT_TRUE(ROS2NodeI.list_parameters({}, 1).names.empty());
+  EXPECT_EQ(
+    ROS2NodeI.list_parameters({}, miru::query::ROS2NodeI::DEPTH_RECURSIVE).names.size(),
+    11
+  );
+}
+
+TEST(ROS2ListParamsTests, EmptyPrefix) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  // unlike no prefixes, an empty prefix matches nothing
+  EXPECT_TRUE(ROS2NodeI.list_parameters({""}, 2).names.empty());
+  EXPECT_TRUE(
+    ROS2NodeI.list_parameters({""}, miru::query::ROS2NodeI::DEPTH_RECURSIVE)
+      .names.empty()
+  );
+  EXPECT_EQ(
+    ROS2NodeI.list_parameters({"", "motion-control.accelerometer"}, 2).names,
+    std::vector<std::string>({"motion-control.accelerometer.id"})
+  );
+}
+
+TEST(ROS2ListParamsTests, OverlappingPrefixes) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  auto result = ROS2NodeI.list_parameters(
+    {"motion-control.features", "motion-control", "motion-control.features.spin"}, 0
+  );
+  EXPECT_EQ(result.names.size(), 11);
+  EXPECT_TRUE(std::is_sorted(result.names.begin(), result.names.end()));
+  EXPECT_EQ(result.prefixes.size(), 5);
+}
+
+// ========================== GET PARAMETERS BY PREFIX ============================= //
+TEST(ROS2GetParamsByPrefixTests, Simple) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  auto params = ROS2NodeI.get_parameters_by_prefix("motion-control.features");
+  ASSERT_EQ(params.size(), 3);
+  EXPECT_EQ(params.begin()->first, "backflip");
+  EXPECT_EQ(params.at("spin").get_name(), "motion-control.features.spin");
+  EXPECT_TRUE(params.at("spin").as<bool>());
+
+  EXPECT_EQ(ROS2NodeI.get_parameters_by_prefix("").size(), 11);
+  EXPECT_EQ(
+    ROS2NodeI.get_parameters_by_prefix("").begin()->first,
+    "motion-control.accelerometer.id"
+  );
+  EXPECT_TRUE(ROS2NodeI.get_parameters_by_prefix("motion-control.speed").empty());
+}
+
+TEST(ROS2GetParamsByPrefixTests, Typed) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  std::map<std::string, bool> features;
+  EXPECT_TRUE(ROS2NodeI.get_parameters("motion-control.features", features));
+  EXPECT_EQ(
+    features,
+    (std::map<std::string, bool>{{"backflip", false}, {"jump", false}, {"spin", true}})
+  );
+
+  std::map<std::string, int64_t> offsets = {{"w", 2}};
+  EXPECT_TRUE(
+    ROS2NodeI.get_parameters("motion-control.accelerometer.offsets", offsets)
+  );
+  EXPECT_EQ(offsets.size(), 4);
+  EXPECT_EQ(offsets.at("x"), 0);
+
+  std::map<std::string, double> missing = {{"w", 2.0}};
+  EXPECT_FALSE(ROS2NodeI.get_parameters("motion-control.missing", missing));
+  EXPECT_EQ(missing.size(), 1);
+
+  EXPECT_THROW(
+    ROS2NodeI.get_parameters("motion-control.features", offsets),
+    miru::params::details::InvalidParameterTypeError
+  );
+}
+
+// ============================== DECLARE PARAMETER ================================ //
+TEST(ROS2DeclareParamTests, Exists) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control();
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  miru::query::DeclaredParameter<int64_t> speed =
+    ROS2NodeI.declare_parameter("motion-control.speed", int64_t(10));
+  EXPECT_TRUE(speed.from_config());
+  EXPECT_EQ(speed.name(), "motion-control.speed");
+  EXPECT_EQ(*speed, 15);
+  EXPECT_EQ(speed.value(), 15);
+
+  auto id = ROS2NodeI.declare_parameter("motion-control.accelerometer.id", "none");
+  EXPECT_EQ(id->size(), 3);
+  const std::string& id_value = id;
+  EXPECT_EQ(id_value, "123");
+
+  auto spin = ROS2NodeI.declare_parameter<bool>("motion-control.features.spin");
+  EXPECT_TRUE(*spin);
+}
+
+TEST(ROS2DeclareParamTests, Scalars) {
+  miru::config::ConfigInstance config_instance =
+    miru::test_utils::load_motion_control("yaml");
+  miru::query::ROS2NodeI ROS2NodeI(config_instance);
+
+  // yaml scalars are parsed once at declaration
+  auto speed = ROS2NodeI.declare_parameter<int64_t>("motion-control.speed");
+  EXPECT_EQ(*speed, 15);
+  EXPECT_THROW(
+    ROS2NodeI.declare_parameter<int64_t>("motion-control.features.spin"),
+    miru::params::details::InvalidParameterTypeError
+  );
+}
+
+TEST(ROS2DeclareParamTests, DoesntExist) {
+  miru::params::Parameter parameter("exists", 42.3);
+  miru::query::ROS2NodeI ROS2NodeI(parameter);
+
+  auto missing =
+    ROS2NodeI.declare_parameter("doesnt_exist", std::vector<double>{1, 2});
+  EXPECT_FALSE(missing.from_config());
+  EXPECT_EQ(*missing, std::vector<double>({1, 2}));
+
+  EXPECT_THROW(
+    ROS2NodeI.declare_parameter<double>("doesnt_exist"),
+    miru::query::details::ParameterNotFoundError
+  );
+  EXPECT_THROW(
+    ROS2NodeI.declare_parameter("exists", std::string("default")),
+    miru::params::details::InvalidParameterTypeError
+  );
+}
+
+}  // namespace test::query
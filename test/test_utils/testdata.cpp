@@ -1,5 +1,9 @@
+// std
+#include <string>
+
 // internal
 #include <filesys/dir.hpp>
+#include <test/test_utils/testdata.hpp>
 
 namespace miru::test_utils {
 
@@ -38,4 +42,17 @@ miru::filesys::Dir query_testdata_dir() {
   return miru::filesys::Dir(testdata_dir_.path() / "query");
 }
 
+miru::config::ConfigInstance load_motion_control(
+  const std::string& ext,
+  const miru::config::FromFileOptions& options
+) {
+  miru::filesys::File schema_file =
+    config_schemas_testdata_dir().file("motion-control." + ext);
+  miru::filesys::File instance_file =
+    config_instances_testdata_dir().file("motion-control." + ext);
+  return miru::config::ConfigInstance::from_file(
+    schema_file.abs_path(), instance_file.abs_path(), options
+  );
+}
+
 }  // namespace miru::test_utils
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
+// std
+#include <string>
+
 // internal
 #include <filesys/dir.hpp>
+#include <miru/configs/instance.hpp>
 
 namespace miru::test_utils {
 
@@ -13,4 +17,11 @@ miru::filesys::Dir filesys_testdata_dir();
 miru::filesys::Dir params_testdata_dir();
 miru::filesys::Dir query_testdata_dir();
 
+// loads the motion-control schema and config instance files of the given extension
+// ('json' or 'yaml') from the config testdata
+miru::config::ConfigInstance load_motion_control(
+  const std::string& ext = "json",
+  const miru::config::FromFileOptions& options = miru::config::FromFileOptions()
+);
+
 }  // namespace miru::test_utils